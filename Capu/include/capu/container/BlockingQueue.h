@@ -18,19 +18,25 @@
 #define CAPU_BLOCKINGQUEUE_H
 
 #include "capu/container/Queue.h"
-#include "capu/os/Semaphore.h"
+#include "capu/os/CondVar.h"
 #include "capu/os/LightweightMutex.h"
+#include "capu/os/Time.h"
 #include "capu/util/ScopedLock.h"
 
 namespace capu
 {
     /**
      * Queue for concurrent access. All methods are threadsafe.
+     *
+     * The batch functions move many elements under a single lock acquisition and wake up the
+     * waiting consumers at once, which pays off when elements are produced or consumed in bursts.
      */
     template <class T>
     class BlockingQueue: private Queue<T>
     {
     public:
+        BlockingQueue();
+
         virtual ~BlockingQueue();
 
         /**
@@ -39,6 +45,14 @@ namespace capu
          */
         void push(const T& element);
 
+        /**
+         * Inserts a range of elements into the queue in their order
+         * @param begin iterator to the first element
+         * @param end iterator behind the last element
+         */
+        template<typename Iterator>
+        void pushBatch(Iterator begin, Iterator end);
+
         /**
          * Remove and return an element from the queue
          * @param element Pointer which will receive the removed element
@@ -47,6 +61,22 @@ namespace capu
          */
         status_t pop(T* element = 0, const uint32_t timeoutMillis = 0);
 
+        /**
+         * Waits until the queue holds elements and removes up to maxCount of them
+         * @param elements list to which the removed elements are appended in their order
+         * @param maxCount maximum number of elements to remove
+         * @param timeoutMillis Milliseconds to wait blocking for elements, 0 waits forever
+         * @return CAPU_OK if at least one element was removed, CAPU_ETIMEOUT if timeout occured
+         */
+        status_t popBatch(List<T>& elements, uint_t maxCount, const uint32_t timeoutMillis = 0);
+
+        /**
+         * Removes all elements without waiting
+         * @param elements list to which the removed elements are appended in their order
+         * @return the number of removed elements
+         */
+        uint_t drainTo(List<T>& elements);
+
         /**
          * Peeks an element from the queue but does not remove it.
          * @param element The element to which the peeked value should get copied.
@@ -63,10 +93,27 @@ namespace capu
         bool empty();
 
     private:
-        Semaphore mSemaphore;
+        /**
+         * Waits until the queue holds elements, the mutex must be held
+         */
+        status_t waitForElements(const uint32_t timeoutMillis);
+
+        /**
+         * Wakes up consumers after count elements were inserted, the mutex must be held
+         */
+        void wakeConsumers(uint_t count);
+
         LightweightMutex mMutex;
+        CondVar mNotEmpty;
+        uint32_t mWaitingConsumers;
     };
 
+    template <class T>
+    inline BlockingQueue<T>::BlockingQueue()
+        : mWaitingConsumers(0)
+    {
+    }
+
     template <class T>
     inline BlockingQueue<T>::~BlockingQueue()
     {
@@ -79,12 +126,44 @@ namespace capu
         return Queue<T>::empty();
     }
 
+    template <class T>
+    inline void BlockingQueue<T>::wakeConsumers(uint_t count)
+    {
+        // nobody to wake up, skip the system call
+        if (mWaitingConsumers == 0 || count == 0)
+        {
+            return;
+        }
+        if (count == 1)
+        {
+            mNotEmpty.signal();
+        }
+        else
+        {
+            mNotEmpty.broadcast();
+        }
+    }
+
     template <class T>
     inline void BlockingQueue<T>::push(const T& element)
     {
         ScopedLightweightMutexLock locker(mMutex);
         Queue<T>::push(element);
-        mSemaphore.release();
+        wakeConsumers(1);
+    }
+
+    template <class T>
+    template <typename Iterator>
+    inline void BlockingQueue<T>::pushBatch(Iterator begin, Iterator end)
+    {
+        ScopedLightweightMutexLock locker(mMutex);
+        uint_t count = 0;
+        for (; begin != end; ++begin)
+        {
+            Queue<T>::push(*begin);
+            ++count;
+        }
+        wakeConsumers(count);
     }
 
     template <class T>
@@ -94,18 +173,78 @@ namespace capu
         return Queue<T>::peek(element);
     }
 
+    template <class T>
+    inline status_t BlockingQueue<T>::waitForElements(const uint32_t timeoutMillis)
+    {
+        if (!Queue<T>::empty())
+        {
+            return CAPU_OK;
+        }
+
+        const uint64_t deadline = Time::GetMonotonicNanoseconds() + static_cast<uint64_t>(timeoutMillis) * 1000000;
+        status_t retVal = CAPU_OK;
+        ++mWaitingConsumers;
+        while (Queue<T>::empty())
+        {
+            uint32_t waitMillis = 0;
+            if (timeoutMillis != 0)
+            {
+                const uint64_t now = Time::GetMonotonicNanoseconds();
+                if (now >= deadline)
+                {
+                    retVal = CAPU_ETIMEOUT;
+                    break;
+                }
+                // round up, 0 would wait forever
+                waitMillis = static_cast<uint32_t>((deadline - now + 999999) / 1000000);
+            }
+            mNotEmpty.wait(mMutex, waitMillis);
+        }
+        --mWaitingConsumers;
+        return retVal;
+    }
+
     template <class T>
     inline status_t BlockingQueue<T>::pop(T* element, const uint32_t timeoutMillis)
     {
-        // wait outside the lock
-        status_t retVal = mSemaphore.tryAquire(timeoutMillis);
+        ScopedLightweightMutexLock locker(mMutex);
+        status_t retVal = waitForElements(timeoutMillis);
         if (retVal != CAPU_OK)
         {
             return retVal;
         }
-        ScopedLightweightMutexLock locker(mMutex);
         return Queue<T>::pop(element);
     }
+
+    template <class T>
+    inline status_t BlockingQueue<T>::popBatch(List<T>& elements, uint_t maxCount, const uint32_t timeoutMillis)
+    {
+        if (maxCount == 0)
+        {
+            return CAPU_EINVAL;
+        }
+        ScopedLightweightMutexLock locker(mMutex);
+        status_t retVal = waitForElements(timeoutMillis);
+        if (retVal != CAPU_OK)
+        {
+            return retVal;
+        }
+        for (uint_t i = 0; i < maxCount && !Queue<T>::empty(); ++i)
+        {
+            elements.push_back(Queue<T>::front());
+            Queue<T>::pop();
+        }
+        return CAPU_OK;
+    }
+
+    template <class T>
+    inline uint_t BlockingQueue<T>::drainTo(List<T>& elements)
+    {
+        ScopedLightweightMutexLock locker(mMutex);
+        const uint_t count = Queue<T>::size();
+        Queue<T>::popAll(elements);
+        return count;
+    }
 }
 
 #endif // CAPU_BLOCKINGQUEUE_H
@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_BOUNDEDMPMCQUEUE_H
+#define CAPU_BOUNDEDMPMCQUEUE_H
+
+#include "capu/Config.h"
+#include "capu/Error.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/CondVar.h"
+#include "capu/os/LightweightMutex.h"
+#include "capu/os/Time.h"
+#include "capu/util/ScopedLock.h"
+
+namespace capu
+{
+    /**
+     * Lock-free queue with a fixed capacity for any number of producers and consumers, after Dmitry Vyukov.
+     *
+     * Every slot of the ring carries a sequence number which tells whether it is ready to be written or read
+     * in the current round, so producers and consumers only compete on their own position counter. There is
+     * no allocation per element and tryPush/tryPop never block.
+     *
+     * The blocking push and pop only park when the queue is full or empty. A successful push or pop only takes
+     * a lock if a thread on the other side is parked, otherwise it does not leave user space.
+     *
+     * T must be default constructible and copyable.
+     */
+    template<typename T, uint32_t CAPACITY = 1024>
+    class BoundedMpmcQueue
+    {
+    public:
+        BoundedMpmcQueue();
+
+        /**
+         * Appends an element if the queue is not full
+         * @param element the element
+         * @return true if the element was appended, false if the queue is full
+         */
+        bool tryPush(const T& element);
+
+        /**
+         * Removes the oldest element if the queue is not empty
+         * @param element receives the removed element
+         * @return true if an element was removed, false if the queue is empty
+         */
+        bool tryPop(T& element);
+
+        /**
+         * Appends an element, waits while the queue is full
+         * @param element the element
+         * @param timeoutMillis milliseconds to wait for free space, 0 waits forever
+         * @return CAPU_OK if the element was appended, CAPU_ETIMEOUT if the queue stayed full
+         */
+        status_t push(const T& element, uint32_t timeoutMillis = 0);
+
+        /**
+         * Removes the oldest element, waits while the queue is empty
+         * @param element receives the removed element, may be 0 to drop it
+         * @param timeoutMillis milliseconds to wait for an element, 0 waits forever
+         * @return CAPU_OK if an element was removed, CAPU_ETIMEOUT if the queue stayed empty
+         */
+        status_t pop(T* element = 0, uint32_t timeoutMillis = 0);
+
+        /**
+         * Returns the number of elements. The result is only a snapshot if other threads access the queue.
+         * @return the number of elements
+         */
+        uint_t size() const;
+
+        /**
+         * @return true if the queue holds no elements
+         */
+        bool empty() const;
+
+        /**
+         * @return the maximum number of elements
+         */
+        uint_t capacity() const;
+
+    private:
+        static_assert(CAPACITY > 1 && (CAPACITY & (CAPACITY - 1)) == 0, "BoundedMpmcQueue CAPACITY must be a power of two");
+
+        struct Cell
+        {
+            Atomic<uint_t> sequence;
+            T element;
+        };
+
+        /**
+         * Threads which wait for one side of the queue
+         */
+        struct Waiters
+        {
+            Atomic<uint32_t> count;
+            LightweightMutex mutex;
+            CondVar condition;
+        };
+
+        /**
+         * Number of failed attempts before a blocking call parks, a short spin catches
+         * elements which are in flight
+         */
+        static const uint32_t SpinCount = 64;
+
+        bool pushElement(const T& element);
+        bool popElement(T& element);
+        static void Wake(Waiters& waiters);
+        static uint32_t RemainingMillis(uint64_t deadline);
+
+        // producers and consumers write their positions concurrently, keep them on different cache lines
+        Atomic<uint_t> mEnqueuePosition;
+        char mPadding1[64];
+        Atomic<uint_t> mDequeuePosition;
+        char mPadding2[64];
+        Cell mCells[CAPACITY];
+        Waiters mConsumers;
+        Waiters mProducers;
+
+        BoundedMpmcQueue(const BoundedMpmcQueue&);
+        BoundedMpmcQueue& operator=(const BoundedMpmcQueue&);
+    };
+
+    template<typename T, uint32_t CAPACITY>
+    inline BoundedMpmcQueue<T, CAPACITY>::BoundedMpmcQueue()
+        : mEnqueuePosition(0)
+        , mDequeuePosition(0)
+    {
+        for (uint_t i = 0; i < CAPACITY; ++i)
+        {
+            mCells[i].sequence.store(i);
+        }
+        mConsumers.count.store(0);
+        mProducers.count.store(0);
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool BoundedMpmcQueue<T, CAPACITY>::pushElement(const T& element)
+    {
+        uint_t position = mEnqueuePosition.load();
+        for (;;)
+        {
+            Cell& cell = mCells[position & (CAPACITY - 1)];
+            const int_t difference = static_cast<int_t>(cell.sequence.load() - position);
+            if (difference == 0)
+            {
+                // the slot is free in this round, claim it
+                if (mEnqueuePosition.compareExchange(position, position + 1))
+                {
+                    cell.element = element;
+                    cell.sequence.store(position + 1);
+                    return true;
+                }
+                // another producer was faster, position holds the new value
+            }
+            else if (difference < 0)
+            {
+                // the slot still holds the element of the previous round
+                return false;
+            }
+            else
+            {
+                position = mEnqueuePosition.load();
+            }
+        }
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool BoundedMpmcQueue<T, CAPACITY>::popElement(T& element)
+    {
+        uint_t position = mDequeuePosition.load();
+        for (;;)
+        {
+            Cell& cell = mCells[position & (CAPACITY - 1)];
+            const int_t difference = static_cast<int_t>(cell.sequence.load() - (position + 1));
+            if (difference == 0)
+            {
+                // the slot was written in this round, claim it
+                if (mDequeuePosition.compareExchange(position, position + 1))
+                {
+                    element = cell.element;
+                    // free the slot for the next round
+                    cell.sequence.store(position + CAPACITY);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // the slot was not written yet
+                return false;
+            }
+            else
+            {
+                position = mDequeuePosition.load();
+            }
+        }
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline void BoundedMpmcQueue<T, CAPACITY>::Wake(Waiters& waiters)
+    {
+        // the waiter registers before it checks the queue again, so it sees the change or is seen here
+        if (waiters.count.load() > 0)
+        {
+            ScopedLightweightMutexLock lock(waiters.mutex);
+            waiters.condition.signal();
+        }
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline uint32_t BoundedMpmcQueue<T, CAPACITY>::RemainingMillis(uint64_t deadline)
+    {
+        const uint64_t now = Time::GetMonotonicNanoseconds();
+        if (now >= deadline)
+        {
+            return 0;
+        }
+        // round up, 0 would wait forever
+        return static_cast<uint32_t>((deadline - now + 999999) / 1000000);
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool BoundedMpmcQueue<T, CAPACITY>::tryPush(const T& element)
+    {
+        if (!pushElement(element))
+        {
+            return false;
+        }
+        Wake(mConsumers);
+        return true;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool BoundedMpmcQueue<T, CAPACITY>::tryPop(T& element)
+    {
+        if (!popElement(element))
+        {
+            return false;
+        }
+        Wake(mProducers);
+        return true;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline status_t BoundedMpmcQueue<T, CAPACITY>::push(const T& element, uint32_t timeoutMillis)
+    {
+        for (uint32_t i = 0; i < SpinCount; ++i)
+        {
+            if (tryPush(element))
+            {
+                return CAPU_OK;
+            }
+        }
+
+        const uint64_t deadline = Time::GetMonotonicNanoseconds() + static_cast<uint64_t>(timeoutMillis) * 1000000;
+        status_t result = CAPU_OK;
+        {
+            ScopedLightweightMutexLock lock(mProducers.mutex);
+            ++mProducers.count;
+            // consumers are only woken after the lock is released, they may wait for producers themselves
+            while (!pushElement(element))
+            {
+                uint32_t waitMillis = 0;
+                if (timeoutMillis != 0)
+                {
+                    waitMillis = RemainingMillis(deadline);
+                    if (waitMillis == 0)
+                    {
+                        result = CAPU_ETIMEOUT;
+                        break;
+                    }
+                }
+                mProducers.condition.wait(mProducers.mutex, waitMillis);
+            }
+            --mProducers.count;
+        }
+        if (result == CAPU_OK)
+        {
+            Wake(mConsumers);
+        }
+        return result;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline status_t BoundedMpmcQueue<T, CAPACITY>::pop(T* element, uint32_t timeoutMillis)
+    {
+        T dropped;
+        T& target = (element != 0) ? *element : dropped;
+        for (uint32_t i = 0; i < SpinCount; ++i)
+        {
+            if (tryPop(target))
+            {
+                return CAPU_OK;
+            }
+        }
+
+        const uint64_t deadline = Time::GetMonotonicNanoseconds() + static_cast<uint64_t>(timeoutMillis) * 1000000;
+        status_t result = CAPU_OK;
+        {
+            ScopedLightweightMutexLock lock(mConsumers.mutex);
+            ++mConsumers.count;
+            while (!popElement(target))
+            {
+                uint32_t waitMillis = 0;
+                if (timeoutMillis != 0)
+                {
+                    waitMillis = RemainingMillis(deadline);
+                    if (waitMillis == 0)
+                    {
+                        result = CAPU_ETIMEOUT;
+                        break;
+                    }
+                }
+                mConsumers.condition.wait(mConsumers.mutex, waitMillis);
+            }
+            --mConsumers.count;
+        }
+        if (result == CAPU_OK)
+        {
+            Wake(mProducers);
+        }
+        return result;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline uint_t BoundedMpmcQueue<T, CAPACITY>::size() const
+    {
+        const uint_t dequeuePosition = mDequeuePosition.load();
+        const uint_t enqueuePosition = mEnqueuePosition.load();
+        const int_t size = static_cast<int_t>(enqueuePosition - dequeuePosition);
+        if (size <= 0)
+        {
+            return 0;
+        }
+        return static_cast<uint_t>(size) < CAPACITY ? static_cast<uint_t>(size) : CAPACITY;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool BoundedMpmcQueue<T, CAPACITY>::empty() const
+    {
+        return size() == 0;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline uint_t BoundedMpmcQueue<T, CAPACITY>::capacity() const
+    {
+        return CAPACITY;
+    }
+}
+
+#endif // CAPU_BOUNDEDMPMCQUEUE_H
@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_CONCURRENTHASHTABLE_H
+#define CAPU_CONCURRENTHASHTABLE_H
+
+#include "capu/Error.h"
+#include "capu/Config.h"
+#include "capu/container/HashTable.h"
+#include "capu/container/FlatHashTable.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/LightweightMutex.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Time.h"
+
+namespace capu
+{
+    /**
+     * Thread-safe hash table which stripes the keys over a number of independently locked HashTable shards.
+     * Operations on keys of different shards never contend.
+     *
+     * With lock-free reads enabled, readers do not take the shard lock at all. Each shard is then copied on
+     * write: a writer modifies a copy of the shard, publishes it and deletes the old version as soon as all
+     * readers which might still use it have left. Readers announce themselves in one of two counters selected
+     * by the epoch of the shard, so writers only wait for the readers of past epochs. This makes reads cheap
+     * and writes expensive, use it for data which is read much more often than it is modified.
+     *
+     * Values are always returned by copy, references into the table would not be safe from other threads.
+     */
+    template <class Key, class T, class C = Comparator, class H = CapuDefaultHashFunction<sizeof(uint_t)*8> >
+    class ConcurrentHashTable
+    {
+    public:
+        /// defines the default number of shards as bit size
+        static const uint8_t DefaultShardBitCount;
+
+        /**
+         * Statistics of a single shard
+         */
+        struct ShardStatistics
+        {
+            ShardStatistics()
+                : count(0)
+                , lockCount(0)
+                , contendedLockCount(0)
+                , lockWaitTime(0)
+            {
+            }
+
+            uint_t count; // number of elements in the shard
+            uint64_t lockCount; // number of times the shard lock was taken
+            uint64_t contendedLockCount; // number of times the shard lock was held by another thread
+            uint64_t lockWaitTime; // accumulated time in microseconds spent waiting for the shard lock
+        };
+
+        /**
+         * Constructor.
+         * @param shardBitCount The bit size of the number of shards.
+         * @param lockFreeReads If set to true, readers do not lock and writers copy the shard they modify.
+         */
+        ConcurrentHashTable(const uint8_t shardBitCount = DefaultShardBitCount, const bool lockFreeReads = false);
+
+        /**
+         * Destructor.
+         */
+        ~ConcurrentHashTable();
+
+        /**
+         * Put a new value to the table.
+         * @param key Key value
+         * @param value New value that will be put to the table
+         * @param oldValue Receives the value which got replaced. Optional.
+         * @return CAPU_OK if put is successful
+         *         CAPU_ENO_MEMORY if allocation of element is failed
+         */
+        status_t put(const Key& key, const T& value, T* oldValue = 0);
+
+        /**
+         * Get a copy of the value associated with key.
+         * @param key Key
+         * @param value Receives the value if the key is contained in the table
+         * @return CAPU_OK if the value has been retrieved successfully
+         *         CAPU_ENOT_EXIST if there is no element with the given key
+         */
+        status_t get(const Key& key, T& value) const;
+
+        /**
+         * Checks whether the given key is present in the table.
+         * @param key The key.
+         * @return True if the key is present, false otherwise.
+         */
+        bool contains(const Key& key) const;
+
+        /**
+         * Removes the value associated with key.
+         * @param key Key value.
+         * @param oldValue Receives the value of the removed element. Optional.
+         * @return CAPU_OK if remove is successful
+         *         CAPU_ERANGE if the key was not found in the table.
+         */
+        status_t remove(const Key& key, T* oldValue = 0);
+
+        /**
+         * Returns the number of elements. The shards are counted one after another, so the result is
+         * not an atomic snapshot when other threads modify the table at the same time.
+         * @return number of elements in the table
+         */
+        uint_t count() const;
+
+        /**
+         * Removes all elements.
+         */
+        void clear();
+
+        /**
+         * @return the number of shards
+         */
+        uint32_t getShardCount() const;
+
+        /**
+         * Returns the statistics of a single shard.
+         * @param shardIndex index of the shard, must be smaller than getShardCount()
+         * @return the statistics of the shard
+         */
+        ShardStatistics getShardStatistics(uint32_t shardIndex) const;
+
+    private:
+        typedef HashTable<Key, T, C, H> ShardTable;
+
+        struct Shard
+        {
+            Shard()
+                : table(new ShardTable())
+                , epoch(0)
+            {
+                readers[0] = 0;
+                readers[1] = 0;
+            }
+
+            ~Shard()
+            {
+                delete table.load();
+            }
+
+            LightweightMutex mutex;
+            Atomic<ShardTable*> table;
+            Atomic<uint_t> epoch;
+            Atomic<uint_t> readers[2];
+            ShardStatistics statistics;
+
+            // keep shards on different cache lines
+            char padding[64];
+        };
+
+        /**
+         * Locks the mutex of a shard and updates its lock statistics.
+         */
+        class ShardLock
+        {
+        public:
+            explicit ShardLock(Shard& shard);
+            ~ShardLock();
+
+        private:
+            Shard& mShard;
+
+            ShardLock(const ShardLock&);
+            ShardLock& operator=(const ShardLock&);
+        };
+
+        /**
+         * Announces a lock-free reader of a shard as long as it exists.
+         */
+        class ShardReader
+        {
+        public:
+            explicit ShardReader(Shard& shard);
+            ~ShardReader();
+
+            const ShardTable& getTable() const;
+
+        private:
+            Atomic<uint_t>& mReaders;
+            const ShardTable* mTable;
+
+            ShardReader(const ShardReader&);
+            ShardReader& operator=(const ShardReader&);
+        };
+
+        Shard& getShard(const Key& key) const;
+        void publish(Shard& shard, ShardTable* table);
+
+        const uint8_t mShardBitCount;
+        const bool mLockFreeReads;
+        Shard* mShards;
+
+        ConcurrentHashTable(const ConcurrentHashTable&);
+        ConcurrentHashTable& operator=(const ConcurrentHashTable&);
+    };
+
+    template <class Key, class T, class C, class H>
+    const uint8_t ConcurrentHashTable<Key, T, C, H>::DefaultShardBitCount = 4u;
+
+    template <class Key, class T, class C, class H>
+    inline ConcurrentHashTable<Key, T, C, H>::ConcurrentHashTable(const uint8_t shardBitCount, const bool lockFreeReads)
+        : mShardBitCount(shardBitCount)
+        , mLockFreeReads(lockFreeReads)
+        , mShards(new Shard[static_cast<uint_t>(1) << shardBitCount])
+    {
+    }
+
+    template <class Key, class T, class C, class H>
+    inline ConcurrentHashTable<Key, T, C, H>::~ConcurrentHashTable()
+    {
+        delete[] mShards;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline status_t ConcurrentHashTable<Key, T, C, H>::put(const Key& key, const T& value, T* oldValue)
+    {
+        Shard& shard = getShard(key);
+        ShardLock lock(shard);
+
+        if (!mLockFreeReads)
+        {
+            return shard.table.load()->put(key, value, oldValue);
+        }
+
+        ShardTable* modified = new ShardTable(*shard.table.load());
+        const status_t result = modified->put(key, value, oldValue);
+        if (CAPU_OK != result)
+        {
+            delete modified;
+            return result;
+        }
+        publish(shard, modified);
+        return CAPU_OK;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline status_t ConcurrentHashTable<Key, T, C, H>::get(const Key& key, T& value) const
+    {
+        Shard& shard = getShard(key);
+        status_t result = CAPU_ENOT_EXIST;
+
+        if (mLockFreeReads)
+        {
+            ShardReader reader(shard);
+            const T& found = reader.getTable().at(key, &result);
+            if (CAPU_OK == result)
+            {
+                value = found;
+            }
+        }
+        else
+        {
+            ShardLock lock(shard);
+            const T& found = static_cast<const ShardTable*>(shard.table.load())->at(key, &result);
+            if (CAPU_OK == result)
+            {
+                value = found;
+            }
+        }
+        return result;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline bool ConcurrentHashTable<Key, T, C, H>::contains(const Key& key) const
+    {
+        Shard& shard = getShard(key);
+
+        if (mLockFreeReads)
+        {
+            ShardReader reader(shard);
+            return reader.getTable().contains(key);
+        }
+
+        ShardLock lock(shard);
+        return shard.table.load()->contains(key);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline status_t ConcurrentHashTable<Key, T, C, H>::remove(const Key& key, T* oldValue)
+    {
+        Shard& shard = getShard(key);
+        ShardLock lock(shard);
+
+        if (!mLockFreeReads)
+        {
+            return shard.table.load()->remove(key, oldValue);
+        }
+
+        if (!shard.table.load()->contains(key))
+        {
+            // nothing to copy
+            return CAPU_ERANGE;
+        }
+
+        ShardTable* modified = new ShardTable(*shard.table.load());
+        modified->remove(key, oldValue);
+        publish(shard, modified);
+        return CAPU_OK;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint_t ConcurrentHashTable<Key, T, C, H>::count() const
+    {
+        uint_t result = 0;
+        for (uint32_t i = 0; i < getShardCount(); ++i)
+        {
+            ShardLock lock(mShards[i]);
+            result += mShards[i].table.load()->count();
+        }
+        return result;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void ConcurrentHashTable<Key, T, C, H>::clear()
+    {
+        for (uint32_t i = 0; i < getShardCount(); ++i)
+        {
+            Shard& shard = mShards[i];
+            ShardLock lock(shard);
+            if (mLockFreeReads)
+            {
+                publish(shard, new ShardTable());
+            }
+            else
+            {
+                shard.table.load()->clear();
+            }
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint32_t ConcurrentHashTable<Key, T, C, H>::getShardCount() const
+    {
+        return static_cast<uint32_t>(1) << mShardBitCount;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename ConcurrentHashTable<Key, T, C, H>::ShardStatistics ConcurrentHashTable<Key, T, C, H>::getShardStatistics(uint32_t shardIndex) const
+    {
+        Shard& shard = mShards[shardIndex];
+
+        // do not count the access to the statistics itself
+        shard.mutex.lock();
+        ShardStatistics result = shard.statistics;
+        result.count = shard.table.load()->count();
+        shard.mutex.unlock();
+
+        return result;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename ConcurrentHashTable<Key, T, C, H>::Shard& ConcurrentHashTable<Key, T, C, H>::getShard(const Key& key) const
+    {
+        if (0 == mShardBitCount)
+        {
+            return mShards[0];
+        }
+
+        // the shard tables use the lower bits of the hash, so the shard is selected by the upper bits of a mixed hash
+        const uint_t hash = internal::MixHash(static_cast<uint_t>(H::Digest(key, sizeof(uint_t) * 8)));
+        return mShards[hash >> (sizeof(uint_t) * 8 - mShardBitCount)];
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void ConcurrentHashTable<Key, T, C, H>::publish(Shard& shard, ShardTable* table)
+    {
+        ShardTable* previous = shard.table.load();
+        shard.table = table;
+
+        // every reader which may still use the previous table has incremented one of the reader
+        // counters before the exchange. Advancing the epoch before waiting for a counter moves new
+        // readers to the other counter, so the awaited one drains even under continuous reads.
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            const uint_t epoch = shard.epoch.load();
+            shard.epoch = epoch + 1;
+            while (shard.readers[epoch & 1].load() != 0)
+            {
+                Thread::Sleep(0);
+            }
+        }
+
+        delete previous;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline ConcurrentHashTable<Key, T, C, H>::ShardLock::ShardLock(Shard& shard)
+        : mShard(shard)
+    {
+        if (!mShard.mutex.trylock())
+        {
+            const uint64_t start = Time::GetMicroseconds();
+            mShard.mutex.lock();
+            mShard.statistics.lockWaitTime += Time::GetMicroseconds() - start;
+            ++mShard.statistics.contendedLockCount;
+        }
+        ++mShard.statistics.lockCount;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline ConcurrentHashTable<Key, T, C, H>::ShardLock::~ShardLock()
+    {
+        mShard.mutex.unlock();
+    }
+
+    template <class Key, class T, class C, class H>
+    inline ConcurrentHashTable<Key, T, C, H>::ShardReader::ShardReader(Shard& shard)
+        : mReaders(shard.readers[shard.epoch.load() & 1])
+        , mTable(0)
+    {
+        ++mReaders;
+        mTable = shard.table.load();
+    }
+
+    template <class Key, class T, class C, class H>
+    inline ConcurrentHashTable<Key, T, C, H>::ShardReader::~ShardReader()
+    {
+        --mReaders;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline const typename ConcurrentHashTable<Key, T, C, H>::ShardTable& ConcurrentHashTable<Key, T, C, H>::ShardReader::getTable() const
+    {
+        return *mTable;
+    }
+}
+
+#endif // CAPU_CONCURRENTHASHTABLE_H
@@ -0,0 +1,1117 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_FLATHASHTABLE_H
+#define CAPU_FLATHASHTABLE_H
+
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include "capu/Error.h"
+#include "capu/Config.h"
+#include "capu/container/Comparator.h"
+#include "capu/container/Hash.h"
+#include "capu/os/Memory.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CAPU_FLATHASHTABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace capu
+{
+    namespace internal
+    {
+        /**
+         * A group of control bytes of a FlatHashTable which is probed at once.
+         * A control byte is either Empty, Deleted or holds the lower 7 bits of the hash of a full slot.
+         * All match functions return a bit mask with one bit per control byte of the group.
+         */
+        class FlatHashTableGroup
+        {
+        public:
+            static const int8_t Empty = -128;
+            static const int8_t Deleted = -2;
+
+#ifdef CAPU_FLATHASHTABLE_SSE2
+            static const uint32_t Width = 16;
+
+            explicit FlatHashTableGroup(const int8_t* control)
+                : mControl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control)))
+            {
+            }
+
+            uint32_t match(int8_t hash) const
+            {
+                return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), mControl)));
+            }
+
+            uint32_t matchEmpty() const
+            {
+                return match(Empty);
+            }
+
+            uint32_t matchEmptyOrDeleted() const
+            {
+                // only Empty and Deleted have the sign bit set
+                return static_cast<uint32_t>(_mm_movemask_epi8(mControl));
+            }
+
+        private:
+            __m128i mControl;
+#else
+            static const uint32_t Width = 8;
+
+            explicit FlatHashTableGroup(const int8_t* control)
+                : mControl(control)
+            {
+            }
+
+            uint32_t match(int8_t hash) const
+            {
+                uint32_t result = 0;
+                for (uint32_t i = 0; i < Width; ++i)
+                {
+                    result |= static_cast<uint32_t>(mControl[i] == hash) << i;
+                }
+                return result;
+            }
+
+            uint32_t matchEmpty() const
+            {
+                return match(Empty);
+            }
+
+            uint32_t matchEmptyOrDeleted() const
+            {
+                uint32_t result = 0;
+                for (uint32_t i = 0; i < Width; ++i)
+                {
+                    result |= static_cast<uint32_t>(mControl[i] < 0) << i;
+                }
+                return result;
+            }
+
+        private:
+            const int8_t* mControl;
+#endif
+        };
+
+        /**
+         * Returns the index of the lowest set bit, mask must not be 0
+         */
+        inline uint32_t LowestBitIndex(uint32_t mask)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<uint32_t>(__builtin_ctz(mask));
+#elif defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return static_cast<uint32_t>(index);
+#else
+            uint32_t index = 0;
+            while ((mask & 1u) == 0)
+            {
+                mask >>= 1;
+                ++index;
+            }
+            return index;
+#endif
+        }
+
+        /**
+         * Spreads the entropy of a hash value over all of its bits
+         */
+        inline uint64_t MixHash(uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        /**
+         * Spreads the entropy of a hash value over all of its bits
+         */
+        inline uint32_t MixHash(uint32_t hash)
+        {
+            hash ^= hash >> 16;
+            hash *= 0x85ebca6bU;
+            hash ^= hash >> 13;
+            hash *= 0xc2b2ae35U;
+            hash ^= hash >> 16;
+            return hash;
+        }
+    }
+
+    /**
+     * Table object container where keys are found and retrieved via hashs.
+     *
+     * Offers the interface of HashTable but stores keys and values inline in one array using open addressing.
+     * Every slot has a control byte holding 7 bits of the hash of its key, so a group of slots is probed with a
+     * single SIMD comparison and keys are only compared for slots whose control byte matches.
+     * Iterators get invalid on rehashing, like the iterators of HashTable.
+     */
+    template <class Key, class T, class C = Comparator, class H = CapuDefaultHashFunction<sizeof(uint_t)*8> >
+    class FlatHashTable
+    {
+    public:
+        /// defines to amount of bits to use for the initial table size
+        static const uint8_t DefaultHashTableBitSize;
+
+        class Pair
+        {
+        public:
+            Pair(const Key& key_, const T& value_)
+                : key(key_)
+                , value(value_)
+            {
+            }
+
+            Pair(const Key& key_, T&& value_)
+                : key(key_)
+                , value(std::move(value_))
+            {
+            }
+
+            const Key key;
+            T value;
+        };
+
+        class ConstIterator
+        {
+        public:
+
+            friend class FlatHashTable;
+            friend class Iterator;
+
+            /**
+             * Constructor.
+             * @param control Pointer to the control byte of the slot on which iteration should start.
+             * @param slot Pointer to the slot on which iteration should start.
+             * @param controlEnd Pointer behind the last control byte.
+             */
+            ConstIterator(const int8_t* control, const Pair* slot, const int8_t* controlEnd)
+                : mControl(control)
+                , mSlot(slot)
+                , mControlEnd(controlEnd)
+            {
+                skipEmptySlots();
+            }
+
+            /**
+             * Indirection
+             * @return the current value referenced by the iterator
+             */
+            const Pair& operator*()
+            {
+                return *mSlot;
+            }
+
+            /**
+             * Dereference
+             * @return a pointer to the current object the iterator points to
+             */
+            const Pair* operator->()
+            {
+                return mSlot;
+            }
+
+            /**
+             * Compares two iterators
+             * @return true if the iterators point to the same position
+             */
+            bool operator==(const ConstIterator& iter) const
+            {
+                return (mSlot == iter.mSlot);
+            }
+
+            /**
+             * Compares two iterators
+             * @return true if the iterators do not point to the same position
+             */
+            bool operator!=(const ConstIterator& iter) const
+            {
+                return (mSlot != iter.mSlot);
+            }
+
+            /**
+             * Step the iterator forward to the next element (prefix operator)
+             * @return the next iterator
+             */
+            ConstIterator& operator++()
+            {
+                ++mControl;
+                ++mSlot;
+                skipEmptySlots();
+                return *this;
+            }
+
+            /**
+             * Step the iterator forward to the next element (postfix operator)
+             * @return the next iterator
+             */
+            ConstIterator operator++(int32_t)
+            {
+                ConstIterator oldValue(*this);
+                ++(*this);
+                return oldValue;
+            }
+
+        private:
+            void skipEmptySlots()
+            {
+                while (mControl != mControlEnd && *mControl < 0)
+                {
+                    ++mControl;
+                    ++mSlot;
+                }
+            }
+
+            const int8_t* mControl;
+            const Pair* mSlot;
+            const int8_t* mControlEnd;
+        };
+
+        /**
+         * Internal helper class to perform iterations over the map entries.
+         */
+        class Iterator
+        {
+        public:
+
+            friend class FlatHashTable;
+
+            /**
+             * Constructor.
+             * @param control Pointer to the control byte of the slot on which iteration should start.
+             * @param slot Pointer to the slot on which iteration should start.
+             * @param controlEnd Pointer behind the last control byte.
+             */
+            Iterator(const int8_t* control, Pair* slot, const int8_t* controlEnd)
+                : mControl(control)
+                , mSlot(slot)
+                , mControlEnd(controlEnd)
+            {
+                skipEmptySlots();
+            }
+
+            /**
+             * Convert Constructor
+             * @param iter ConstIterator to convert from
+             */
+            Iterator(const ConstIterator& iter)
+                : mControl(iter.mControl)
+                , mSlot(const_cast<Pair*>(iter.mSlot))
+                , mControlEnd(iter.mControlEnd)
+            {
+            }
+
+            /**
+             * Indirection
+             * @return the current value referenced by the iterator
+             */
+            Pair& operator*()
+            {
+                return *mSlot;
+            }
+
+            /**
+             * Dereference
+             * @return a pointer to the current object the iterator points to
+             */
+            Pair* operator->()
+            {
+                return mSlot;
+            }
+
+            /**
+             * Compares two iterators
+             * @return true if the iterators point to the same position
+             */
+            bool operator==(const Iterator& iter) const
+            {
+                return (mSlot == iter.mSlot);
+            }
+
+            /**
+             * Compares two iterators
+             * @return true if the iterators do not point to the same position
+             */
+            bool operator!=(const Iterator& iter) const
+            {
+                return (mSlot != iter.mSlot);
+            }
+
+            /**
+             * Step the iterator forward to the next element (prefix operator)
+             * @return the next iterator
+             */
+            Iterator& operator++()
+            {
+                ++mControl;
+                ++mSlot;
+                skipEmptySlots();
+                return *this;
+            }
+
+            /**
+             * Step the iterator forward to the next element (postfix operator)
+             * @return the next iterator
+             */
+            Iterator operator++(int32_t)
+            {
+                Iterator oldValue(*this);
+                ++(*this);
+                return oldValue;
+            }
+
+        private:
+            void skipEmptySlots()
+            {
+                while (mControl != mControlEnd && *mControl < 0)
+                {
+                    ++mControl;
+                    ++mSlot;
+                }
+            }
+
+            const int8_t* mControl;
+            Pair* mSlot;
+            const int8_t* mControlEnd;
+        };
+
+        /**
+         * Copy constructor
+         */
+        FlatHashTable(const FlatHashTable& other);
+
+        /**
+         * Constructs FlatHashTable.
+         */
+        FlatHashTable();
+
+        /**
+         * Constructor.
+         * @param initialBitSize The bit size of the initial number of slots of the map.
+         * @param resizeable Indicates if the map resizes automatically if necessary. If set to false, a 'put' may
+         *                   return NO_MEMORY if too many items were added.
+         */
+        FlatHashTable(const uint8_t initialBitSize, const bool resizeable = true);
+
+        /**
+         * Destructor.
+         */
+        ~FlatHashTable();
+
+        /**
+         * overloading subscript operator to get read and write access to element referenced by given key.
+         *
+         * @param key Key value
+         * @return value Value referenced by key. If no value is stored for given key, a default constructed object is added and returned
+         */
+        T& operator[](const Key& key);
+
+        /**
+         * put a new value to the hashtable.
+         *
+         * NOTE: Not STL compatible
+         *
+         * @param key               Key value
+         * @param value             new value that will be put to hash table
+         * @param oldValue          Buffer which receives the overwritten value if the key was already present. Optional.
+         * @return CAPU_OK if put is successful
+         *         CAPU_ENO_MEMORY if the table is full and not resizeable
+         *
+         */
+        status_t put(const Key& key, const T& value, T* oldValue = NULL);
+
+        /**
+         * Get const value associated with key in the hashtable.
+         * @param key        Key
+         * @param returnCode parameter to retrieve status code. Optional.
+         *       Possible status codes:
+         *       CAPU_OK if the key is contained in the hash table and the element has been retrieved successfully
+         *       CAPU_ENOT_EXIST if there is no element in hash table with specified key
+         *
+         * @return element
+         */
+        const T& at(const Key& key, status_t* returnCode = 0) const;
+
+        /**
+         * Get value associated with key in the hashtable.
+         * @param key        Key
+         * @param returnCode parameter to retrieve status code. Optional.
+         *       Possible status codes:
+         *       CAPU_OK if the key is contained in the hash table and the element has been retrieved successfully
+         *       CAPU_ENOT_EXIST if there is no element in hash table with specified key
+         *
+         * @return element
+         */
+        T& at(const Key& key, status_t* returnCode = 0);
+
+        /**
+         * Tries to find an element in the table.
+         * @param key       Key
+         * @return iterator pointing to the entry where the key got found
+         *         iterator pointing to the end() element otherwise
+         */
+        Iterator find(const Key& key);
+
+        /**
+         * Tries to find an element in the read only table.
+         * @param key       Key
+         * @return ConstIterator pointing to the entry where the key got found
+         *         ConstIterator pointing to the end() element otherwise
+         */
+        ConstIterator find(const Key& key) const;
+
+        /**
+         * Checks weather the given key is present in the table.
+         *
+         * NOTE: Not STL compatible
+         *
+         * @param key The key.
+         * @return True if the key is present, false otherwise.
+         */
+        bool contains(const Key& key) const;
+
+        /**
+         * Removes the value associated with key in the hashtable.
+         *
+         * NOTE: Not STL compatible
+         *
+         * @param key               Key value.
+         * @param value_old         Buffer which will be used to store value of removed element.
+         *                          Default value is 0 to indicate that it should be discarded.
+         *
+         * @return CAPU_OK if remove is successful
+         *         CAPU_ERANGE if the key was not found in the map.
+         */
+        status_t remove(const Key& key, T* value_old = 0);
+
+        /**
+         * Remove the element where the iterator is pointing to
+         * @param the iterator to the element to remove, points to the next element afterwards
+         * @param out parameter to the removed element
+         * @return   CAPU_OK if remove is successful
+         */
+        status_t remove(Iterator& iter, T* value_old = 0);
+
+        /**
+         * Returns count of the hashtable.
+         * @return number of elements in hash table
+         */
+        uint_t count() const;
+
+        /**
+         * Clears all keys and values of the hashtable.
+         */
+        void clear();
+
+        /**
+         * Returns an iterator for iterating over the key and values in the map.
+         * @return Iterator
+         */
+        Iterator begin();
+
+        /**
+         * Returns a ConstIterator for iterating over the key and values in the map.
+         * @return ConstIterator
+         */
+        ConstIterator begin() const;
+
+        /**
+         * returns an iterator pointing after the last element of the list
+         * @return iterator
+         */
+        Iterator end();
+
+        /**
+         * returns a ConstIterator pointing after the last element of the list
+         * @return ConstIterator
+         */
+        ConstIterator end() const;
+
+        /**
+         * Reserve space for given number of bits elements. Does nothing if the
+         * table is already bigger.
+         * @param bitsize The requested bit size of the map.
+         */
+        void reserve(uint8_t bitsize);
+
+        /**
+         * Assignment operator for FlatHashTable
+         * @param FlatHashTable to copy from
+         * @return reference to FlatHashTable with copied data
+         */
+        FlatHashTable<Key, T, C, H>& operator=(const FlatHashTable<Key, T, C, H>& other);
+
+        /**
+         * Swap this FlatHashTable with another
+         * @param other FlatHashTable to copy from
+         */
+        void swap(FlatHashTable<Key, T, C, H>& other);
+
+    private:
+        typedef internal::FlatHashTableGroup Group;
+
+        uint8_t mBitCount; // bit size of the slot count
+        uint_t mCapacity; // number of slots
+        Byte* mMemory; // control bytes followed by the slots
+        int8_t* mControl; // one control byte per slot plus a copy of the first group for wrap around probing
+        Pair* mSlots; // key value pairs
+        uint_t mCount; // the current entry count
+        uint_t mGrowthLeft; // number of empty slots which may still be filled before rehashing
+        const bool mResizeable; // indicates if rehashing will be done
+        const C mComparator; // compares keys
+        T mDefaultValue; // returned by at if the key is not found
+
+        static uint_t MaxLoad(uint_t capacity);
+        static uint8_t CalcBitCount(uint8_t bitCount);
+        static uint_t CalcHash(const Key& key);
+        static int8_t ControlHash(uint_t hash);
+
+        void allocate(uint8_t bitCount);
+        void destructAll();
+        void rehash(uint8_t bitCount);
+        void setControl(uint_t index, int8_t control);
+        bool findIndex(const Key& key, uint_t hash, uint_t& index) const;
+        uint_t findInsertIndex(uint_t hash) const;
+        void insertNew(uint_t hash, const Key& key, const T& value);
+        void removeIndex(uint_t index, T* value_old);
+    };
+
+    /**
+    * swap specialization for FlatHashTable<Key, T, C, H>
+    * @param first first FlatHashTable
+    * @param second FlatHashTable to swap with first
+    */
+    template <class Key, class T, class C, class H>
+    inline void swap(FlatHashTable<Key, T, C, H>& first, FlatHashTable<Key, T, C, H>& second)
+    {
+        first.swap(second);
+    }
+
+    template <class Key, class T, class C, class H>
+    const uint8_t FlatHashTable<Key, T, C, H>::DefaultHashTableBitSize = 4u;
+
+    template <class Key, class T, class C, class H>
+    inline FlatHashTable<Key, T, C, H>::FlatHashTable()
+        : mBitCount(0)
+        , mCapacity(0)
+        , mMemory(0)
+        , mControl(0)
+        , mSlots(0)
+        , mCount(0)
+        , mGrowthLeft(0)
+        , mResizeable(true)
+        , mComparator()
+        , mDefaultValue()
+    {
+        allocate(CalcBitCount(DefaultHashTableBitSize));
+    }
+
+    template <class Key, class T, class C, class H>
+    inline FlatHashTable<Key, T, C, H>::FlatHashTable(const uint8_t initialBitSize, const bool resizeable)
+        : mBitCount(0)
+        , mCapacity(0)
+        , mMemory(0)
+        , mControl(0)
+        , mSlots(0)
+        , mCount(0)
+        , mGrowthLeft(0)
+        , mResizeable(resizeable)
+        , mComparator()
+        , mDefaultValue()
+    {
+        allocate(CalcBitCount(initialBitSize));
+    }
+
+    template <class Key, class T, class C, class H>
+    inline FlatHashTable<Key, T, C, H>::FlatHashTable(const FlatHashTable<Key, T, C, H>& other)
+        : mBitCount(0)
+        , mCapacity(0)
+        , mMemory(0)
+        , mControl(0)
+        , mSlots(0)
+        , mCount(0)
+        , mGrowthLeft(0)
+        , mResizeable(other.mResizeable)
+        , mComparator()
+        , mDefaultValue()
+    {
+        allocate(other.mBitCount);
+        for (ConstIterator iter = other.begin(); iter != other.end(); ++iter)
+        {
+            insertNew(CalcHash(iter->key), iter->key, iter->value);
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline FlatHashTable<Key, T, C, H>& FlatHashTable<Key, T, C, H>::operator=(const FlatHashTable<Key, T, C, H>& other)
+    {
+        if (&other == this)
+        {
+            // self assignment
+            return *this;
+        }
+        if (!mResizeable && mCapacity != other.mCapacity)
+        {
+            // no modification allowed
+            return *this;
+        }
+
+        destructAll();
+        delete[] mMemory;
+        allocate(other.mBitCount);
+
+        for (ConstIterator iter = other.begin(); iter != other.end(); ++iter)
+        {
+            insertNew(CalcHash(iter->key), iter->key, iter->value);
+        }
+
+        return *this;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline FlatHashTable<Key, T, C, H>::~FlatHashTable()
+    {
+        destructAll();
+        delete[] mMemory;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint_t FlatHashTable<Key, T, C, H>::count() const
+    {
+        return mCount;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline bool FlatHashTable<Key, T, C, H>::contains(const Key& key) const
+    {
+        uint_t index = 0;
+        return findIndex(key, CalcHash(key), index);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline T& FlatHashTable<Key, T, C, H>::operator[](const Key& key)
+    {
+        const uint_t hash = CalcHash(key);
+        uint_t index = 0;
+        if (findIndex(key, hash, index))
+        {
+            return mSlots[index].value;
+        }
+
+        //if key is not in hash table, add default constructed value to it
+        if (put(key, T()) != CAPU_OK)
+        {
+            return mDefaultValue;
+        }
+        return at(key);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline status_t FlatHashTable<Key, T, C, H>::put(const Key& key, const T& value, T* oldValue)
+    {
+        const uint_t hash = CalcHash(key);
+
+        // check if we already have the key in the map, if so, just override the value
+        uint_t index = 0;
+        if (findIndex(key, hash, index))
+        {
+            if (oldValue)
+            {
+                *oldValue = mSlots[index].value;
+            }
+            mSlots[index].value = value;
+            return CAPU_OK;
+        }
+
+        if (0 == mGrowthLeft)
+        {
+            if (mCount < MaxLoad(mCapacity) / 2)
+            {
+                // mostly deleted slots, rehashing in place gets rid of them
+                rehash(mBitCount);
+            }
+            else if (mResizeable)
+            {
+                rehash(mBitCount + 1);
+            }
+            else if (mCount < MaxLoad(mCapacity))
+            {
+                rehash(mBitCount);
+            }
+            else
+            {
+                // if resizing is disabled, we're done here!
+                return CAPU_ENO_MEMORY;
+            }
+        }
+
+        insertNew(hash, key, value);
+        return CAPU_OK;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline const T& FlatHashTable<Key, T, C, H>::at(const Key& key, status_t* returnCode) const
+    {
+        uint_t index = 0;
+        const bool found = findIndex(key, CalcHash(key), index);
+        if (returnCode)
+        {
+            *returnCode = found ? CAPU_OK : CAPU_ENOT_EXIST;
+        }
+        return found ? mSlots[index].value : mDefaultValue;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline T& FlatHashTable<Key, T, C, H>::at(const Key& key, status_t* returnCode)
+    {
+        uint_t index = 0;
+        const bool found = findIndex(key, CalcHash(key), index);
+        if (returnCode)
+        {
+            *returnCode = found ? CAPU_OK : CAPU_ENOT_EXIST;
+        }
+        return found ? mSlots[index].value : mDefaultValue;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename FlatHashTable<Key, T, C, H>::Iterator FlatHashTable<Key, T, C, H>::find(const Key& key)
+    {
+        uint_t index = 0;
+        if (findIndex(key, CalcHash(key), index))
+        {
+            return Iterator(mControl + index, mSlots + index, mControl + mCapacity);
+        }
+
+        // no entry found -> return end iterator
+        return end();
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename FlatHashTable<Key, T, C, H>::ConstIterator FlatHashTable<Key, T, C, H>::find(const Key& key) const
+    {
+        uint_t index = 0;
+        if (findIndex(key, CalcHash(key), index))
+        {
+            return ConstIterator(mControl + index, mSlots + index, mControl + mCapacity);
+        }
+
+        // no entry found -> return end iterator
+        return end();
+    }
+
+    template <class Key, class T, class C, class H>
+    inline status_t FlatHashTable<Key, T, C, H>::remove(const Key& key, T* value_old)
+    {
+        uint_t index = 0;
+        if (!findIndex(key, CalcHash(key), index))
+        {
+            // element was not found
+            return CAPU_ERANGE;
+        }
+
+        removeIndex(index, value_old);
+        return CAPU_OK;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline status_t FlatHashTable<Key, T, C, H>::remove(Iterator& iter, T* value_old)
+    {
+        const uint_t index = static_cast<uint_t>(iter.mSlot - mSlots);
+        ++iter;
+        removeIndex(index, value_old);
+        return CAPU_OK;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::clear()
+    {
+        destructAll();
+        Memory::Set(mControl, Group::Empty, mCapacity + Group::Width);
+        mCount = 0;
+        mGrowthLeft = MaxLoad(mCapacity);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename FlatHashTable<Key, T, C, H>::Iterator FlatHashTable<Key, T, C, H>::begin()
+    {
+        return Iterator(mControl, mSlots, mControl + mCapacity);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename FlatHashTable<Key, T, C, H>::ConstIterator FlatHashTable<Key, T, C, H>::begin() const
+    {
+        return ConstIterator(mControl, mSlots, mControl + mCapacity);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename FlatHashTable<Key, T, C, H>::Iterator FlatHashTable<Key, T, C, H>::end()
+    {
+        return Iterator(mControl + mCapacity, mSlots + mCapacity, mControl + mCapacity);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename FlatHashTable<Key, T, C, H>::ConstIterator FlatHashTable<Key, T, C, H>::end() const
+    {
+        return ConstIterator(mControl + mCapacity, mSlots + mCapacity, mControl + mCapacity);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::reserve(uint8_t bitsize)
+    {
+        if (bitsize <= mBitCount)
+        {
+            return;
+        }
+        rehash(bitsize);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::swap(FlatHashTable<Key, T, C, H>& other)
+    {
+        using std::swap;
+        swap(mBitCount, other.mBitCount);
+        swap(mCapacity, other.mCapacity);
+        swap(mMemory, other.mMemory);
+        swap(mControl, other.mControl);
+        swap(mSlots, other.mSlots);
+        swap(mCount, other.mCount);
+        swap(mGrowthLeft, other.mGrowthLeft);
+        swap(const_cast<bool&>(mResizeable), const_cast<bool&>(other.mResizeable)); // make mResizable mutable only for swap
+        // no need to swap mComparator, it must be the same
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint_t FlatHashTable<Key, T, C, H>::MaxLoad(uint_t capacity)
+    {
+        // keep at least 1/8 of the slots empty to terminate probing early
+        return capacity - capacity / 8;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint8_t FlatHashTable<Key, T, C, H>::CalcBitCount(uint8_t bitCount)
+    {
+        // the table must at least hold one group
+        uint8_t minimum = 0;
+        while ((static_cast<uint_t>(1) << minimum) < Group::Width)
+        {
+            ++minimum;
+        }
+        return bitCount < minimum ? minimum : bitCount;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint_t FlatHashTable<Key, T, C, H>::CalcHash(const Key& key)
+    {
+        return internal::MixHash(static_cast<uint_t>(H::Digest(key, sizeof(uint_t) * 8)));
+    }
+
+    template <class Key, class T, class C, class H>
+    inline int8_t FlatHashTable<Key, T, C, H>::ControlHash(uint_t hash)
+    {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::allocate(uint8_t bitCount)
+    {
+        mBitCount = bitCount;
+        mCapacity = static_cast<uint_t>(1) << bitCount;
+
+        // slots are placed behind the control bytes, keep them properly aligned
+        const uint_t alignment = std::alignment_of<Pair>::value;
+        const uint_t controlSize = ((mCapacity + Group::Width + alignment - 1) / alignment) * alignment;
+
+        mMemory = new Byte[controlSize + sizeof(Pair) * mCapacity];
+        mControl = reinterpret_cast<int8_t*>(mMemory);
+        mSlots = reinterpret_cast<Pair*>(mMemory + controlSize);
+        Memory::Set(mControl, Group::Empty, mCapacity + Group::Width);
+
+        mCount = 0;
+        mGrowthLeft = MaxLoad(mCapacity);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::destructAll()
+    {
+        for (uint_t i = 0; i < mCapacity; ++i)
+        {
+            if (mControl[i] >= 0)
+            {
+                mSlots[i].~Pair();
+            }
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::rehash(uint8_t bitCount)
+    {
+        Byte* oldMemory = mMemory;
+        const int8_t* oldControl = mControl;
+        Pair* oldSlots = mSlots;
+        const uint_t oldCapacity = mCapacity;
+        const uint_t count = mCount;
+
+        allocate(bitCount);
+
+        for (uint_t i = 0; i < oldCapacity; ++i)
+        {
+            if (oldControl[i] >= 0)
+            {
+                Pair& pair = oldSlots[i];
+                const uint_t hash = CalcHash(pair.key);
+                const uint_t index = findInsertIndex(hash);
+                setControl(index, ControlHash(hash));
+                new (&mSlots[index]) Pair(pair.key, std::move(pair.value));
+                pair.~Pair();
+            }
+        }
+        mCount = count;
+        mGrowthLeft -= count;
+
+        delete[] oldMemory;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::setControl(uint_t index, int8_t control)
+    {
+        mControl[index] = control;
+        if (index < Group::Width)
+        {
+            // keep the copy of the first group behind the last slot in sync
+            mControl[mCapacity + index] = control;
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline bool FlatHashTable<Key, T, C, H>::findIndex(const Key& key, uint_t hash, uint_t& index) const
+    {
+        const uint_t mask = mCapacity - 1;
+        const int8_t control = ControlHash(hash);
+        uint_t position = (hash >> 7) & mask;
+        uint_t step = 0;
+
+        for (;;)
+        {
+            const Group group(mControl + position);
+            uint32_t matches = group.match(control);
+            while (matches != 0)
+            {
+                const uint_t candidate = (position + internal::LowestBitIndex(matches)) & mask;
+                if (mComparator(mSlots[candidate].key, key))
+                {
+                    index = candidate;
+                    return true;
+                }
+                matches &= matches - 1;
+            }
+
+            if (group.matchEmpty() != 0)
+            {
+                // the key would have been inserted in this group
+                return false;
+            }
+
+            // triangular probing visits every group once
+            step += Group::Width;
+            if (step > mCapacity)
+            {
+                return false;
+            }
+            position = (position + step) & mask;
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline uint_t FlatHashTable<Key, T, C, H>::findInsertIndex(uint_t hash) const
+    {
+        const uint_t mask = mCapacity - 1;
+        uint_t position = (hash >> 7) & mask;
+        uint_t step = 0;
+
+        for (;;)
+        {
+            const uint32_t free = Group(mControl + position).matchEmptyOrDeleted();
+            if (free != 0)
+            {
+                return (position + internal::LowestBitIndex(free)) & mask;
+            }
+
+            step += Group::Width;
+            position = (position + step) & mask;
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::insertNew(uint_t hash, const Key& key, const T& value)
+    {
+        const uint_t index = findInsertIndex(hash);
+        if (mControl[index] == Group::Empty)
+        {
+            --mGrowthLeft;
+        }
+        setControl(index, ControlHash(hash));
+        new (&mSlots[index]) Pair(key, value);
+        ++mCount;
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void FlatHashTable<Key, T, C, H>::removeIndex(uint_t index, T* value_old)
+    {
+        if (value_old)
+        {
+            // perform the copy operation into the old value
+            *value_old = mSlots[index].value;
+        }
+
+        mSlots[index].~Pair();
+        --mCount;
+
+        // a slot can be marked empty again if no probe sequence ever had to skip over it, that is if
+        // the surrounding slots never formed a full group
+        const uint_t mask = mCapacity - 1;
+        const uint32_t emptyBefore = Group(mControl + ((index - Group::Width) & mask)).matchEmpty();
+        const uint32_t emptyAfter = Group(mControl + index).matchEmpty();
+        if (emptyBefore != 0 && emptyAfter != 0)
+        {
+            uint32_t emptyBeforeDistance = 0;
+            for (uint32_t bit = Group::Width - 1; (emptyBefore & (1u << bit)) == 0; --bit)
+            {
+                ++emptyBeforeDistance;
+            }
+            if (emptyBeforeDistance + internal::LowestBitIndex(emptyAfter) < Group::Width)
+            {
+                setControl(index, Group::Empty);
+                ++mGrowthLeft;
+                return;
+            }
+        }
+
+        setControl(index, Group::Deleted);
+    }
+}
+
+#endif // CAPU_FLATHASHTABLE_H
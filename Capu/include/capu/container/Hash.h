@@ -20,9 +20,174 @@
 #include "capu/Config.h"
 #include "capu/util/Traits.h"
 #include "capu/os/Debug.h"
+#include "capu/os/Memory.h"
 
 namespace capu
 {
+    namespace internal
+    {
+        /// secrets of the fast hash, odd numbers with balanced bits
+        static const uint64_t FastHashSecret0 = 0xa0761d6478bd642fULL;
+        static const uint64_t FastHashSecret1 = 0xe7037ed1a0b428dbULL;
+        static const uint64_t FastHashSecret2 = 0x8ebc6af09c88c6e3ULL;
+        static const uint64_t FastHashSecret3 = 0x589965cc75374cc3ULL;
+
+        /**
+         * Multiplies two 64 bit values and folds the upper half of the 128 bit product into the lower half
+         */
+        inline uint64_t FoldedMultiply(const uint64_t a, const uint64_t b)
+        {
+#if defined(__SIZEOF_INT128__)
+            const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+            const uint64_t aLow = a & 0xFFFFFFFFu;
+            const uint64_t aHigh = a >> 32;
+            const uint64_t bLow = b & 0xFFFFFFFFu;
+            const uint64_t bHigh = b >> 32;
+
+            const uint64_t lowLow = aLow * bLow;
+            const uint64_t lowHigh = aLow * bHigh;
+            const uint64_t highLow = aHigh * bLow;
+            const uint64_t cross = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFu) + highLow; // cannot overflow
+
+            const uint64_t low = (cross << 32) | (lowLow & 0xFFFFFFFFu);
+            const uint64_t high = aHigh * bHigh + (cross >> 32) + (lowHigh >> 32);
+            return low ^ high;
+#endif
+        }
+
+        inline uint64_t Read64(const uint8_t* data)
+        {
+            uint64_t result;
+            Memory::Copy(&result, data, sizeof(result));
+            return result;
+        }
+
+        inline uint64_t Read32(const uint8_t* data)
+        {
+            uint32_t result;
+            Memory::Copy(&result, data, sizeof(result));
+            return result;
+        }
+
+        /**
+         * Hashes len bytes of data. Consumes 16 bytes per step, respectively 48 bytes in three independent
+         * lanes for longer inputs. Reads are unaligned and in native byte order, so results are only stable
+         * on one platform.
+         */
+        inline uint64_t FastHashBytes(const void* data, const uint_t len)
+        {
+            const uint8_t* ptr = static_cast<const uint8_t*>(data);
+            uint64_t seed = FoldedMultiply(FastHashSecret0, FastHashSecret1);
+            uint64_t a = 0;
+            uint64_t b = 0;
+
+            if (len <= 16)
+            {
+                if (len >= 4)
+                {
+                    // two possibly overlapping reads from each end cover all bytes
+                    const uint_t offset = (len >> 3) << 2;
+                    a = (Read32(ptr) << 32) | Read32(ptr + offset);
+                    b = (Read32(ptr + len - 4) << 32) | Read32(ptr + len - 4 - offset);
+                }
+                else if (len > 0)
+                {
+                    a = (static_cast<uint64_t>(ptr[0]) << 16) | (static_cast<uint64_t>(ptr[len >> 1]) << 8) | ptr[len - 1];
+                }
+            }
+            else
+            {
+                uint_t remaining = len;
+                if (remaining > 48)
+                {
+                    uint64_t seed1 = seed;
+                    uint64_t seed2 = seed;
+                    do
+                    {
+                        seed = FoldedMultiply(Read64(ptr) ^ FastHashSecret1, Read64(ptr + 8) ^ seed);
+                        seed1 = FoldedMultiply(Read64(ptr + 16) ^ FastHashSecret2, Read64(ptr + 24) ^ seed1);
+                        seed2 = FoldedMultiply(Read64(ptr + 32) ^ FastHashSecret3, Read64(ptr + 40) ^ seed2);
+                        ptr += 48;
+                        remaining -= 48;
+                    }
+                    while (remaining > 48);
+                    seed ^= seed1 ^ seed2;
+                }
+                while (remaining > 16)
+                {
+                    seed = FoldedMultiply(Read64(ptr) ^ FastHashSecret1, Read64(ptr + 8) ^ seed);
+                    ptr += 16;
+                    remaining -= 16;
+                }
+
+                // the last 16 bytes, possibly overlapping with the ones already consumed
+                a = Read64(ptr + remaining - 16);
+                b = Read64(ptr + remaining - 8);
+            }
+
+            return FoldedMultiply(FoldedMultiply(a ^ FastHashSecret1, b ^ seed) ^ FastHashSecret0 ^ len, FastHashSecret1);
+        }
+
+        /**
+         * Hashes an integral value
+         */
+        template<typename T>
+        inline uint64_t FastHashPrimitive(const T key)
+        {
+            return FoldedMultiply(static_cast<uint64_t>(key) ^ FastHashSecret0, FastHashSecret1);
+        }
+
+        /**
+         * Returns the bit pattern of a float. Values which compare equal give the same pattern,
+         * so -0.0 is mapped to 0.0 and all NaNs are mapped to the same quiet NaN.
+         */
+        inline uint32_t CanonicalFloatBits(const float key)
+        {
+            if (key == 0.0f)
+            {
+                return 0u;
+            }
+            if (key != key)
+            {
+                return 0x7FC00000u;
+            }
+            uint32_t bits;
+            Memory::Copy(&bits, &key, sizeof(bits));
+            return bits;
+        }
+
+        /**
+         * Returns the bit pattern of a double. Values which compare equal give the same pattern,
+         * so -0.0 is mapped to 0.0 and all NaNs are mapped to the same quiet NaN.
+         */
+        inline uint64_t CanonicalDoubleBits(const double key)
+        {
+            if (key == 0.0)
+            {
+                return 0u;
+            }
+            if (key != key)
+            {
+                return 0x7FF8000000000000ULL;
+            }
+            uint64_t bits;
+            Memory::Copy(&bits, &key, sizeof(bits));
+            return bits;
+        }
+
+        inline uint64_t FastHashPrimitive(const float key)
+        {
+            return FastHashPrimitive(CanonicalFloatBits(key));
+        }
+
+        inline uint64_t FastHashPrimitive(const double key)
+        {
+            return FastHashPrimitive(CanonicalDoubleBits(key));
+        }
+    }
+
     /*************************************************************************************/
     /****************************** Resizers Traits **************************************/
     /*************************************************************************************/
@@ -113,7 +278,8 @@ namespace capu
          */
         static uint32_t Hash(const float key)
         {
-            return Hash(static_cast<int32_t>(key));
+            // hash the bit pattern, round values only differ in their upper bits
+            return static_cast<uint32_t>(internal::FastHashPrimitive(key));
         }
 
         /**
@@ -123,7 +289,8 @@ namespace capu
          */
         static uint32_t Hash(const double key)
         {
-            return Hash(static_cast<int64_t>(key));
+            // hash the bit pattern, round values only differ in their upper bits
+            return static_cast<uint32_t>(internal::FastHashPrimitive(key));
         }
 
         //FNV Hash
@@ -237,7 +404,6 @@ namespace capu
             return key ^ (((((key >> 32) ^ key) >> 16) ^ key) >> 8);
         }
 
-        //FNV Hash
         /**
          * Compute a hashvalue for the given key.
          * @param key The key to hash
@@ -245,10 +411,10 @@ namespace capu
          */
         static uint64_t Hash(const float key)
         {
-            return Hash(static_cast<int64_t>(key));
+            // hash the bit pattern, round values only differ in their upper bits
+            return internal::FastHashPrimitive(key);
         }
 
-        //FNV Hash
         /**
          * Compute a hashvalue for the given key.
          * @param key The key to hash
@@ -256,7 +422,8 @@ namespace capu
          */
         static uint64_t Hash(const double key)
         {
-            return Hash(static_cast<int64_t>(key));
+            // hash the bit pattern, round values only differ in their upper bits
+            return internal::FastHashPrimitive(key);
         }
 
         //FNV Hash
@@ -522,6 +689,65 @@ namespace capu
             return Hasher<T, Type<T>::Identifier, uint64_t>::Hash(key, bitsize);
         }
     };
+
+    /**************************************************************************************/
+    /********************************* Fast hash function *********************************/
+    /**************************************************************************************/
+
+    /**
+     * Hasher trait of the FastHashFunction, can be specialized for own types like Hasher
+     */
+    template<typename T, int TYPE>
+    struct FastHasher
+    {
+        static uint64_t Hash(const T& key)
+        {
+            // default hasher
+            return internal::FastHashBytes(&key, sizeof(T));
+        }
+    };
+
+    template<typename T>
+    struct FastHasher<T, CAPU_TYPE_PRIMITIVE>
+    {
+        static uint64_t Hash(const T key)
+        {
+            return internal::FastHashPrimitive(key);
+        }
+    };
+
+    template<typename T>
+    struct FastHasher<T, CAPU_TYPE_ENUM>
+    {
+        static uint64_t Hash(const T key)
+        {
+            return internal::FastHashPrimitive(static_cast<int64_t>(key));
+        }
+    };
+
+    template<typename T>
+    struct FastHasher<T, CAPU_TYPE_POINTER>
+    {
+        static uint64_t Hash(const T key)
+        {
+            return internal::FastHashPrimitive(reinterpret_cast<uint_t>(key));
+        }
+    };
+
+    /**
+     * Alternative to the CapuDefaultHashFunction for HashTable and HashSet. Based on a folded 64 bit
+     * multiplication in the style of wyhash, it mixes all bits of the key into the result and consumes
+     * 16 bytes per step for strings and other byte keys.
+     */
+    struct FastHashFunction
+    {
+        template<typename T>
+        static uint_t Digest(const T& key, const uint8_t bitsize = sizeof(uint_t) * 8)
+        {
+            Debug::Assert(bitsize <= sizeof(uint_t) * 8);
+            return Resizer<uint_t>::Resize(static_cast<uint_t>(FastHasher<T, Type<T>::Identifier>::Hash(key)), bitsize);
+        }
+    };
 }
 #endif /* CAPU_HASH_H */
 
@@ -41,6 +41,9 @@ namespace capu
         /// defines to amount of bits to use for hash set size
         static const uint8_t DefaultHashTableBitSize;
 
+        /// defines how many old buckets get migrated by each put while an incremental rehash is ongoing
+        static const uint_t IncrementalRehashBucketsPerPut;
+
 
         class Pair
         {
@@ -319,8 +322,11 @@ namespace capu
          * @param initialBitSize The bit size of the initial size of the map.
          * @param resizeable Indicates if the map resizes automatically if necessary. If set to false, a 'put' may
          *                   return NO_MEMORY if too many items were added.
+         * @param incrementalRehash If set to true, resizing does not rebuild the map at once. Instead the entries
+         *                   of the old buckets are migrated step by step by the following puts, which keeps
+         *                   the latency of a single put low. Existing entries keep their place in memory.
          */
-        HashTable(const uint8_t initialBitSize, const bool resizeable = true);
+        HashTable(const uint8_t initialBitSize, const bool resizeable = true, const bool incrementalRehash = false);
 
         /**
          * Destructor.
@@ -483,6 +489,29 @@ namespace capu
        void swap(HashTable<Key, T, C, H>& other);
 
     private:
+        /**
+         * Additional memory for entries which gets allocated when the map grows incrementally.
+         * The entries are constructed on first use to spread the cost over the puts.
+         */
+        struct EntryBlock
+        {
+            EntryBlock(uint_t count_, EntryBlock* next_)
+                : entries(static_cast<HashTableEntry*>(::operator new(count_ * sizeof(HashTableEntry))))
+                , count(count_)
+                , next(next_)
+            {
+            }
+
+            ~EntryBlock()
+            {
+                ::operator delete(entries);
+            }
+
+            HashTableEntry* entries;
+            const uint_t count;
+            EntryBlock* next;
+        };
+
         uint8_t mBitCount; // bit size for the hash function
         uint_t mSize; // the size of the data list
         uint_t mThreshold; // defines when a rehashing may occur
@@ -492,15 +521,27 @@ namespace capu
         HashTableEntry* mFirstFreeHashMapEntry; // start of pointer list of free entries
         uint_t mCount; // the current entry count
         const bool mResizeable; // indicates if rehashing will be done
+        const bool mIncrementalRehash; // indicates if rehashing is spread over multiple puts
         const C mComparator; // compares keys
+        EntryBlock* mEntryBlocks; // additional entry memory of incremental rehashing, newest first
+        HashTableEntry* mUnusedEntry; // next never used entry in the newest entry block
+        HashTableEntry** mOldBuckets; // bucket list which gets migrated, 0 if no rehash is ongoing
+        uint8_t mOldBitCount; // bit size for the hash function of the old bucket list
+        uint_t mOldSize; // the size of the old bucket list
+        uint_t mMigrationIndex; // all old buckets before this index are migrated already
 
         void initializeLastEntry();
         void destructAll();
         void rehash();
+        void startIncrementalRehash();
+        void migrateBuckets(uint_t bucketCount);
+        void releaseIncrementalRehashData();
         uint_t calcHashValue(const Key& key) const;
+        HashTableEntry** getBucket(const Key& key) const;
+        HashTableEntry* acquireEntry();
         HashTableEntry* internalGet(const Key& key) const;
-        void internalPut(HashTableEntry* entry, uint_t hashValue);
-        void internalRemove(HashTableEntry* entry, const uint_t hashValue, T* value_old = 0);
+        void internalPut(HashTableEntry* entry, HashTableEntry*& bucket);
+        void internalRemove(HashTableEntry* entry, HashTableEntry*& bucket, T* value_old = 0);
     };
 
     /**
@@ -518,6 +559,8 @@ namespace capu
     const float  HashTable<Key, T, C, H>::DefaultHashTableMaxLoadFactor = 0.8f;
     template <class Key, class T, class C, class H>
     const uint8_t  HashTable<Key, T, C, H>::DefaultHashTableBitSize = 4u;
+    template <class Key, class T, class C, class H>
+    const uint_t  HashTable<Key, T, C, H>::IncrementalRehashBucketsPerPut = 4u;
 
     template <class Key, class T, class C, class H>
     inline HashTable<Key, T, C, H>::HashTable()
@@ -530,7 +573,14 @@ namespace capu
         , mFirstFreeHashMapEntry(mData)
         , mCount(0)
         , mResizeable(true)
+        , mIncrementalRehash(false)
         , mComparator()
+        , mEntryBlocks(0)
+        , mUnusedEntry(0)
+        , mOldBuckets(0)
+        , mOldBitCount(0)
+        , mOldSize(0)
+        , mMigrationIndex(0)
     {
         Memory::Set(mBuckets, 0, sizeof(HashTableEntry*) * mSize);
         initializeLastEntry();
@@ -547,7 +597,14 @@ namespace capu
         , mFirstFreeHashMapEntry(mData)
         , mCount(0) // will get increased by internalPut
         , mResizeable(other.mResizeable)
+        , mIncrementalRehash(other.mIncrementalRehash)
         , mComparator()
+        , mEntryBlocks(0)
+        , mUnusedEntry(0)
+        , mOldBuckets(0)
+        , mOldBitCount(0)
+        , mOldSize(0)
+        , mMigrationIndex(0)
     {
         Memory::Set(mBuckets, 0, sizeof(HashTableEntry*) * mSize);
         initializeLastEntry();
@@ -559,14 +616,14 @@ namespace capu
         while (iter != other.end())
         {
             mFirstFreeHashMapEntry->constructKeyValue(iter->key, iter->value);
-            internalPut(mFirstFreeHashMapEntry, calcHashValue(iter->key));
+            internalPut(mFirstFreeHashMapEntry, *getBucket(iter->key));
             ++iter;
             ++mFirstFreeHashMapEntry;
         }
     }
 
     template <class Key, class T, class C, class H>
-    inline HashTable<Key, T, C, H>::HashTable(const uint8_t initialBitSize, const bool resizeable)
+    inline HashTable<Key, T, C, H>::HashTable(const uint8_t initialBitSize, const bool resizeable, const bool incrementalRehash)
         : mBitCount(initialBitSize)
         , mSize(static_cast<uint_t>(1) << mBitCount)
         , mThreshold(static_cast<uint_t>(mSize * DefaultHashTableMaxLoadFactor))
@@ -576,7 +633,14 @@ namespace capu
         , mFirstFreeHashMapEntry(mData)
         , mCount(0)
         , mResizeable(resizeable)
+        , mIncrementalRehash(incrementalRehash)
         , mComparator()
+        , mEntryBlocks(0)
+        , mUnusedEntry(0)
+        , mOldBuckets(0)
+        , mOldBitCount(0)
+        , mOldSize(0)
+        , mMigrationIndex(0)
     {
         Memory::Set(mBuckets, 0, sizeof(HashTableEntry*) * mSize);
         initializeLastEntry();
@@ -597,6 +661,7 @@ namespace capu
         }
 
         destructAll();
+        releaseIncrementalRehashData();
 
         delete[] mBuckets;
         delete[] mData;
@@ -627,6 +692,7 @@ namespace capu
     inline HashTable<Key, T, C, H>::~HashTable()
     {
         destructAll();
+        releaseIncrementalRehashData();
         delete[] mBuckets;
         delete[] mData;
     }
@@ -666,10 +732,16 @@ namespace capu
     template <class Key, class T, class C, class H>
     inline status_t HashTable<Key, T, C, H>::put(const Key& key, const T& value, T* oldValue)
     {
-        uint_t hashValue = calcHashValue(key);
+        if (mOldBuckets)
+        {
+            // continue an ongoing incremental rehash before the buckets get looked at
+            migrateBuckets(IncrementalRehashBucketsPerPut);
+        }
+
+        HashTableEntry** bucket = getBucket(key);
 
         // check if we already have the key in the map, if so, just override the value
-        HashTableEntry* current = mBuckets[hashValue];
+        HashTableEntry* current = *bucket;
         if (current)
         {
             do
@@ -688,8 +760,10 @@ namespace capu
             while (current->isChainElement);
         }
 
-        // check if the next free entry is outside of the threshold (resizing would be necessary)
-        if (mFirstFreeHashMapEntry == mData + mThreshold)
+        HashTableEntry* newentry = acquireEntry();
+
+        // no free entry left within the threshold (resizing would be necessary)
+        if (!newentry)
         {
             if (!mResizeable)
             {
@@ -697,18 +771,13 @@ namespace capu
                 return CAPU_ENO_MEMORY;
             }
             rehash();
-            hashValue = calcHashValue(key); // calculate the new index (in the resized map)
+            bucket = getBucket(key); // get the new bucket (in the resized map)
+            newentry = acquireEntry();
         }
 
-        // the entry holding the values is the first free entry
-        HashTableEntry* newentry = mFirstFreeHashMapEntry;
-
-        // adjust the pointer to the next free entry ('preconnected' through constructor)
-        mFirstFreeHashMapEntry = mFirstFreeHashMapEntry->next;
-
         newentry->constructKeyValue(key, value);
 
-        internalPut(newentry, hashValue);
+        internalPut(newentry, *bucket);
 
         // done
         return CAPU_OK;
@@ -787,15 +856,15 @@ namespace capu
     template <class Key, class T, class C, class H>
     inline status_t HashTable<Key, T, C, H>::remove(const Key& key, T* value_old)
     {
-        const uint_t hashValue = calcHashValue(key);
-        HashTableEntry* current = mBuckets[hashValue];
+        HashTableEntry** bucket = getBucket(key);
+        HashTableEntry* current = *bucket;
         if (current)
         {
             do
             {
                 if (mComparator(current->getKeyValuePair().key, key))
                 {
-                    internalRemove(current, hashValue, value_old);
+                    internalRemove(current, *bucket, value_old);
 
                     // done
                     return CAPU_OK;
@@ -813,18 +882,18 @@ namespace capu
     inline status_t HashTable<Key, T, C, H>::remove(Iterator& iter, T* value_old)
     {
         HashTableEntry* current = iter.mCurrentHashMapEntry;
-        uint_t hashValue = calcHashValue(current->getKeyValuePair().key);
+        HashTableEntry** bucket = getBucket(current->getKeyValuePair().key);
 
         iter.mCurrentHashMapEntry = current->next;
 
-        internalRemove(current, hashValue, value_old);
+        internalRemove(current, *bucket, value_old);
 
         // done
         return CAPU_OK;
     }
 
     template <class Key, class T, class C, class H>
-    inline void HashTable<Key, T, C, H>::internalRemove(HashTableEntry* entry, const uint_t hashValue, T* value_old)
+    inline void HashTable<Key, T, C, H>::internalRemove(HashTableEntry* entry, HashTableEntry*& bucket, T* value_old)
     {
         if (value_old)
         {
@@ -839,9 +908,9 @@ namespace capu
         // so that the current element is taken out of the chain
         entry->previous->next = entry->next;
         entry->next->previous = entry->previous;
-        if (mBuckets[hashValue] == entry)
+        if (bucket == entry)
         {
-            mBuckets[hashValue] = entry->next->isChainElement ? entry->next : 0;
+            bucket = entry->next->isChainElement ? entry->next : 0;
             entry->next->isChainElement = false;
         }
 
@@ -864,8 +933,12 @@ namespace capu
 
         // reset all buckets and link entries to empty list
         Memory::Set(mBuckets, 0, sizeof(HashTableEntry*) * mSize);
+        delete[] mOldBuckets;
+        mOldBuckets = 0;
+
+        const uint_t dataSize = static_cast<uint_t>(mLastHashMapEntry - mData);
         HashTableEntry* entry = mData;
-        for (uint32_t i = 0; i < mThreshold + 1; ++i)
+        for (uint_t i = 0; i < dataSize + 1; ++i)
         {
             entry->previous = 0;
             entry->next = entry + 1;
@@ -877,6 +950,19 @@ namespace capu
         mFirstFreeHashMapEntry = mData;
         initializeLastEntry();
         mCount = 0;
+
+        // put the used entries of additional blocks in front of the free list
+        for (EntryBlock* block = mEntryBlocks; block != 0; block = block->next)
+        {
+            HashTableEntry* blockEnd = (block == mEntryBlocks) ? mUnusedEntry : block->entries + block->count;
+            for (entry = block->entries; entry != blockEnd; ++entry)
+            {
+                entry->previous = 0;
+                entry->next = mFirstFreeHashMapEntry;
+                entry->isChainElement = false;
+                mFirstFreeHashMapEntry = entry;
+            }
+        }
     }
 
     template <class Key, class T, class C, class H>
@@ -903,11 +989,45 @@ namespace capu
         return typename HashTable<Key, T, C, H>::ConstIterator(mLastHashMapEntry, mLastHashMapEntry);
     }
 
+    template <class Key, class T, class C, class H>
+    inline typename HashTable<Key, T, C, H>::HashTableEntry** HashTable<Key, T, C, H>::getBucket(const Key& key) const
+    {
+        if (mOldBuckets)
+        {
+            // keys of old buckets which are not migrated yet are still found in the old bucket list
+            const uint_t oldHashValue = H::Digest(key, mOldBitCount);
+            if (oldHashValue >= mMigrationIndex)
+            {
+                return &mOldBuckets[oldHashValue];
+            }
+        }
+        return &mBuckets[calcHashValue(key)];
+    }
+
+    template <class Key, class T, class C, class H>
+    inline typename HashTable<Key, T, C, H>::HashTableEntry* HashTable<Key, T, C, H>::acquireEntry()
+    {
+        if (mFirstFreeHashMapEntry != mLastHashMapEntry)
+        {
+            // adjust the pointer to the next free entry ('preconnected' through constructor)
+            HashTableEntry* entry = mFirstFreeHashMapEntry;
+            mFirstFreeHashMapEntry = entry->next;
+            return entry;
+        }
+
+        if (mEntryBlocks && mUnusedEntry != mEntryBlocks->entries + mEntryBlocks->count)
+        {
+            // construct the next entry of the newest block on first use
+            return new (mUnusedEntry++) HashTableEntry();
+        }
+
+        return 0;
+    }
+
     template <class Key, class T, class C, class H>
     inline typename HashTable<Key, T, C, H>::HashTableEntry* HashTable<Key, T, C, H>::internalGet(const Key& key) const
     {
-        const uint_t hashValue = calcHashValue(key);
-        HashTableEntry* current = mBuckets[hashValue];
+        HashTableEntry* current = *getBucket(key);
         if (current)
         {
             do
@@ -925,10 +1045,10 @@ namespace capu
     }
 
     template <class Key, class T, class C, class H>
-    inline void HashTable<Key, T, C, H>::internalPut(HashTableEntry* newentry, const uint_t hashValue)
+    inline void HashTable<Key, T, C, H>::internalPut(HashTableEntry* newentry, HashTableEntry*& bucket)
     {
         // chaining of entries
-        HashTableEntry* entry = mBuckets[hashValue];
+        HashTableEntry* entry = bucket;
         if (entry)
         {
             // chaining
@@ -940,7 +1060,7 @@ namespace capu
             entry = mLastHashMapEntry->next;
         }
 
-        mBuckets[hashValue]   = newentry;
+        bucket                = newentry;
         newentry->next        = entry;
         newentry->previous    = entry->previous;
         newentry->isChainElement = false;
@@ -957,7 +1077,7 @@ namespace capu
             return;
         }
 
-        HashTable<Key, T, C, H> tmp(bitsize, mResizeable);
+        HashTable<Key, T, C, H> tmp(bitsize, mResizeable, mIncrementalRehash);
         for (Iterator it = begin(); it != end(); ++it)
         {
             tmp.put(it->key, it->value);
@@ -968,7 +1088,93 @@ namespace capu
     template <class Key, class T, class C, class H>
     inline void HashTable<Key, T, C, H>::rehash()
     {
-        reserve(mBitCount + 1);
+        if (mIncrementalRehash)
+        {
+            startIncrementalRehash();
+        }
+        else
+        {
+            reserve(mBitCount + 1);
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void HashTable<Key, T, C, H>::startIncrementalRehash()
+    {
+        if (mOldBuckets)
+        {
+            // the previous rehash must be complete before the next one can start
+            migrateBuckets(mOldSize);
+        }
+
+        // entries never move, the additional ones are taken from a new block
+        const uint_t newSize = mSize << 1;
+        const uint_t newThreshold = static_cast<uint_t>(newSize * DefaultHashTableMaxLoadFactor);
+        mEntryBlocks = new EntryBlock(newThreshold - mThreshold, mEntryBlocks);
+        mUnusedEntry = mEntryBlocks->entries;
+
+        mOldBuckets = mBuckets;
+        mOldBitCount = mBitCount;
+        mOldSize = mSize;
+        mMigrationIndex = 0;
+
+        ++mBitCount;
+        mSize = newSize;
+        mThreshold = newThreshold;
+        mBuckets = new HashTableEntry*[mSize];
+        Memory::Set(mBuckets, 0, sizeof(HashTableEntry*) * mSize);
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void HashTable<Key, T, C, H>::migrateBuckets(uint_t bucketCount)
+    {
+        // the new entry block has room for more than mOldSize / 2 entries, so migrating at least
+        // two buckets per put completes the rehash before the next one is necessary
+        for (; bucketCount > 0 && mMigrationIndex < mOldSize; --bucketCount)
+        {
+            HashTableEntry* entry = mOldBuckets[mMigrationIndex];
+            mOldBuckets[mMigrationIndex] = 0;
+            ++mMigrationIndex;
+
+            while (entry)
+            {
+                HashTableEntry* nextEntry = entry->next->isChainElement ? entry->next : 0;
+
+                // take the entry out of its chain and put it to the new bucket
+                entry->previous->next = entry->next;
+                entry->next->previous = entry->previous;
+                if (nextEntry)
+                {
+                    nextEntry->isChainElement = false;
+                }
+                internalPut(entry, mBuckets[calcHashValue(entry->getKeyValuePair().key)]);
+                --mCount; // internalPut counts the entry again
+
+                entry = nextEntry;
+            }
+        }
+
+        if (mMigrationIndex == mOldSize)
+        {
+            delete[] mOldBuckets;
+            mOldBuckets = 0;
+        }
+    }
+
+    template <class Key, class T, class C, class H>
+    inline void HashTable<Key, T, C, H>::releaseIncrementalRehashData()
+    {
+        // entries are destructed already
+        while (mEntryBlocks)
+        {
+            EntryBlock* block = mEntryBlocks;
+            mEntryBlocks = block->next;
+            delete block;
+        }
+        mUnusedEntry = 0;
+
+        delete[] mOldBuckets;
+        mOldBuckets = 0;
     }
 
     template <class Key, class T, class C, class H>
@@ -1004,6 +1210,13 @@ namespace capu
         swap(mFirstFreeHashMapEntry, other.mFirstFreeHashMapEntry);
         swap(mCount, other.mCount);
         swap(const_cast<bool&>(mResizeable), const_cast<bool&>(other.mResizeable)); // make mResizable mutable only for swap
+        swap(const_cast<bool&>(mIncrementalRehash), const_cast<bool&>(other.mIncrementalRehash));
+        swap(mEntryBlocks, other.mEntryBlocks);
+        swap(mUnusedEntry, other.mUnusedEntry);
+        swap(mOldBuckets, other.mOldBuckets);
+        swap(mOldBitCount, other.mOldBitCount);
+        swap(mOldSize, other.mOldSize);
+        swap(mMigrationIndex, other.mMigrationIndex);
         // no need to swap mComparator, it must be the same
     }
 }
@@ -18,6 +18,7 @@
 #define CAPU_MEMORYPOOL_H
 
 #include "capu/Config.h"
+#include "capu/Error.h"
 
 namespace capu
 {
@@ -54,11 +55,34 @@ namespace capu
         T* getEntry();
 
         /**
-         * Releases the given entry
+         * Releases the given entry in constant time
+         * @param entry the entry to release, must have been returned by getEntry of this pool
+         * @return CAPU_OK if the entry was released
+         *         CAPU_EINVAL if the entry does not belong to this pool
+         *         CAPU_ERROR if the entry has already been released
          */
-        void releaseEntry(const T* entry);
+        status_t releaseEntry(const T* entry);
+
+        /**
+         * Returns the number of entries which are currently in use
+         * @return the number of used entries
+         */
+        uint_t getUsedCount() const;
+
+        /**
+         * Returns the maximum number of entries which were in use at the same time
+         * since construction of the pool
+         * @return the high water mark of used entries
+         */
+        uint_t getHighWaterMark() const;
 
     private:
+        /**
+         * Maps the given data pointer to its pool entry
+         * @return the entry containing the data or 0 if the pointer is not a data pointer of this pool
+         */
+        MemoryPoolEntry* getPoolEntry(const T* entry);
+
         /**
          * Internal array with the data
          */
@@ -68,12 +92,24 @@ namespace capu
          * Pointer to the next free entry or 0 if the pool is full
          */
         MemoryPoolEntry* m_nextFreeEntry;
+
+        /**
+         * Number of entries currently in use
+         */
+        uint_t m_usedCount;
+
+        /**
+         * Maximum number of entries which were in use at the same time
+         */
+        uint_t m_highWaterMark;
     };
 
     template<typename T, uint_t SIZE>
     inline
     MemoryPool<T, SIZE>::MemoryPool()
         : m_nextFreeEntry(&m_entries[0])
+        , m_usedCount(0)
+        , m_highWaterMark(0)
     {
         MemoryPoolEntry* current = &m_entries[0];
         MemoryPoolEntry* end = &m_entries[SIZE - 1];
@@ -94,8 +130,18 @@ namespace capu
         
         if (m_nextFreeEntry != 0)
         {
-            result = &m_nextFreeEntry->m_data;
-            m_nextFreeEntry = m_nextFreeEntry->nextFreePointer;
+            MemoryPoolEntry* entry = m_nextFreeEntry;
+            result = &entry->m_data;
+            m_nextFreeEntry = entry->nextFreePointer;
+
+            // an entry in use points to itself, which can never happen inside of the free list
+            entry->nextFreePointer = entry;
+
+            ++m_usedCount;
+            if (m_usedCount > m_highWaterMark)
+            {
+                m_highWaterMark = m_usedCount;
+            }
         }
 
         return result;
@@ -103,22 +149,63 @@ namespace capu
 
     template<typename T, uint_t SIZE>
     inline
-    void MemoryPool<T, SIZE>::releaseEntry(const T* entry)
+    status_t MemoryPool<T, SIZE>::releaseEntry(const T* entry)
     {
-        MemoryPoolEntry* current = &m_entries[0];
-        MemoryPoolEntry* end = &m_entries[SIZE - 1];
+        MemoryPoolEntry* poolEntry = getPoolEntry(entry);
+        if (0 == poolEntry)
+        {
+            return CAPU_EINVAL;
+        }
 
-        while (end >= current)
+        if (poolEntry->nextFreePointer != poolEntry)
         {
-            if (&end->m_data == entry)
-            {
-                end->nextFreePointer = m_nextFreeEntry;
-                m_nextFreeEntry = end;
-                return;
-            }
-            --end;
+            // entry is already part of the free list
+            return CAPU_ERROR;
+        }
+
+        poolEntry->nextFreePointer = m_nextFreeEntry;
+        m_nextFreeEntry = poolEntry;
+        --m_usedCount;
+        return CAPU_OK;
+    }
+
+    template<typename T, uint_t SIZE>
+    inline
+    uint_t MemoryPool<T, SIZE>::getUsedCount() const
+    {
+        return m_usedCount;
+    }
+
+    template<typename T, uint_t SIZE>
+    inline
+    uint_t MemoryPool<T, SIZE>::getHighWaterMark() const
+    {
+        return m_highWaterMark;
+    }
+
+    template<typename T, uint_t SIZE>
+    inline
+    typename MemoryPool<T, SIZE>::MemoryPoolEntry* MemoryPool<T, SIZE>::getPoolEntry(const T* entry)
+    {
+        // all data members are sizeof(MemoryPoolEntry) apart, so the index can be computed from the byte offset
+        const Byte* first = reinterpret_cast<const Byte*>(&m_entries[0].m_data);
+        const Byte* current = reinterpret_cast<const Byte*>(entry);
+
+        if (current < first)
+        {
+            return 0;
+        }
+
+        const uint_t offset = static_cast<uint_t>(current - first);
+        const uint_t index = offset / sizeof(MemoryPoolEntry);
+        if (index >= SIZE || offset % sizeof(MemoryPoolEntry) != 0)
+        {
+            // outside of the pool or not pointing to the start of a data member
+            return 0;
         }
+
+        return &m_entries[index];
     }
 }
 
-#endif // CAPU_MEMORYPOOL_H
\ No newline at end of file
+#endif // CAPU_MEMORYPOOL_H
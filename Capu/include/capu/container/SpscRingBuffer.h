@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_SPSCRINGBUFFER_H
+#define CAPU_SPSCRINGBUFFER_H
+
+#include "capu/Config.h"
+#include "capu/os/Atomic.h"
+#include "capu/util/ScopedPointer.h"
+
+namespace capu
+{
+    /**
+     * Lock-free ring buffer which hands elements from exactly one producer thread to exactly one consumer thread.
+     *
+     * Unlike RingBuffer, a full buffer rejects new elements instead of overwriting the oldest ones. Each side
+     * only writes its own position and caches the position of the other side, so the cache line of the other
+     * side is only read when the cached value is used up.
+     *
+     * Besides copying elements in and out, the buffer exposes its contiguous free or filled space: claimWrite()
+     * returns space to construct elements in place, commitWrite() publishes them; claimRead() returns filled
+     * space to process in place, commitRead() releases it.
+     */
+    template<typename T>
+    class SpscRingBuffer
+    {
+    public:
+        /**
+         * @param capacity the minimum number of elements, rounded up to a power of two
+         */
+        explicit SpscRingBuffer(uint_t capacity);
+
+        /**
+         * Appends an element. Must only be called by the producer.
+         * @param element the element
+         * @return true if the element was appended, false if the buffer is full
+         */
+        bool push(const T& element);
+
+        /**
+         * Removes the oldest element. Must only be called by the consumer.
+         * @param element receives the element
+         * @return true if an element was removed, false if the buffer is empty
+         */
+        bool pop(T& element);
+
+        /**
+         * Appends as many of the given elements as fit. Must only be called by the producer.
+         * @param elements the elements
+         * @param count the number of elements
+         * @return the number of appended elements
+         */
+        uint_t write(const T* elements, uint_t count);
+
+        /**
+         * Removes up to count of the oldest elements. Must only be called by the consumer.
+         * @param elements receives the elements
+         * @param count maximum number of elements
+         * @return the number of removed elements
+         */
+        uint_t read(T* elements, uint_t count);
+
+        /**
+         * Claims contiguous free space. Must only be called by the producer.
+         * @param span receives the first free element
+         * @param maxCount maximum number of elements to claim
+         * @return the number of elements which may be written to span, 0 if the buffer is full
+         */
+        uint_t claimWrite(T*& span, uint_t maxCount);
+
+        /**
+         * Publishes elements written to the space returned by claimWrite(). Must only be called by the producer.
+         * @param count the number of written elements, at most the number of claimed elements
+         */
+        void commitWrite(uint_t count);
+
+        /**
+         * Claims the contiguous oldest elements. Must only be called by the consumer.
+         * @param span receives the oldest element
+         * @param maxCount maximum number of elements to claim
+         * @return the number of elements which may be read from span, 0 if the buffer is empty
+         */
+        uint_t claimRead(const T*& span, uint_t maxCount);
+
+        /**
+         * Releases elements claimed by claimRead() for reuse. Must only be called by the consumer.
+         * @param count the number of processed elements, at most the number of claimed elements
+         */
+        void commitRead(uint_t count);
+
+        /**
+         * Returns the number of elements. The result is only a snapshot if other threads access the buffer.
+         * @return the number of elements
+         */
+        uint_t size() const;
+
+        /**
+         * @return true if the buffer holds no elements
+         */
+        bool empty() const;
+
+        /**
+         * @return the maximum number of elements
+         */
+        uint_t capacity() const;
+
+    private:
+        static uint_t RoundUpToPowerOfTwo(uint_t value);
+
+        /**
+         * Returns the free space, reads the position of the consumer only if the cached one shows less than wanted
+         */
+        uint_t freeSpace(uint_t wanted);
+
+        /**
+         * Returns the filled space, reads the position of the producer only if the cached one shows less than wanted
+         */
+        uint_t filledSpace(uint_t wanted);
+
+        const uint_t mCapacity;
+        const uint_t mMask;
+        ScopedArray<T> mElements;
+
+        // written by the producer only, on a cache line of its own
+        char mPadding1[64];
+        Atomic<uint_t> mWritePosition;
+        uint_t mCachedReadPosition;
+
+        // written by the consumer only
+        char mPadding2[64];
+        Atomic<uint_t> mReadPosition;
+        uint_t mCachedWritePosition;
+        char mPadding3[64];
+
+        SpscRingBuffer(const SpscRingBuffer&);
+        SpscRingBuffer& operator=(const SpscRingBuffer&);
+    };
+
+    template<typename T>
+    inline SpscRingBuffer<T>::SpscRingBuffer(uint_t capacity)
+        : mCapacity(RoundUpToPowerOfTwo(capacity))
+        , mMask(mCapacity - 1)
+        , mElements(mCapacity)
+        , mWritePosition(0)
+        , mCachedReadPosition(0)
+        , mReadPosition(0)
+        , mCachedWritePosition(0)
+    {
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::RoundUpToPowerOfTwo(uint_t value)
+    {
+        uint_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::freeSpace(uint_t wanted)
+    {
+        const uint_t writePosition = mWritePosition.load();
+        uint_t free = mCapacity - (writePosition - mCachedReadPosition);
+        if (free < wanted)
+        {
+            // only look at the consumer's cache line if the cached position does not suffice
+            mCachedReadPosition = mReadPosition.loadAcquire();
+            free = mCapacity - (writePosition - mCachedReadPosition);
+        }
+        return free;
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::filledSpace(uint_t wanted)
+    {
+        const uint_t readPosition = mReadPosition.load();
+        uint_t filled = mCachedWritePosition - readPosition;
+        if (filled < wanted)
+        {
+            mCachedWritePosition = mWritePosition.loadAcquire();
+            filled = mCachedWritePosition - readPosition;
+        }
+        return filled;
+    }
+
+    template<typename T>
+    inline bool SpscRingBuffer<T>::push(const T& element)
+    {
+        if (freeSpace(1) == 0)
+        {
+            return false;
+        }
+        const uint_t writePosition = mWritePosition.load();
+        mElements[writePosition & mMask] = element;
+        mWritePosition.storeRelease(writePosition + 1);
+        return true;
+    }
+
+    template<typename T>
+    inline bool SpscRingBuffer<T>::pop(T& element)
+    {
+        if (filledSpace(1) == 0)
+        {
+            return false;
+        }
+        const uint_t readPosition = mReadPosition.load();
+        element = mElements[readPosition & mMask];
+        mReadPosition.storeRelease(readPosition + 1);
+        return true;
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::claimWrite(T*& span, uint_t maxCount)
+    {
+        const uint_t free = freeSpace(maxCount);
+        const uint_t index = mWritePosition.load() & mMask;
+        uint_t count = mCapacity - index;
+        if (count > free)
+        {
+            count = free;
+        }
+        if (count > maxCount)
+        {
+            count = maxCount;
+        }
+        span = mElements.get() + index;
+        return count;
+    }
+
+    template<typename T>
+    inline void SpscRingBuffer<T>::commitWrite(uint_t count)
+    {
+        mWritePosition.storeRelease(mWritePosition.load() + count);
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::claimRead(const T*& span, uint_t maxCount)
+    {
+        const uint_t filled = filledSpace(maxCount);
+        const uint_t index = mReadPosition.load() & mMask;
+        uint_t count = mCapacity - index;
+        if (count > filled)
+        {
+            count = filled;
+        }
+        if (count > maxCount)
+        {
+            count = maxCount;
+        }
+        span = mElements.get() + index;
+        return count;
+    }
+
+    template<typename T>
+    inline void SpscRingBuffer<T>::commitRead(uint_t count)
+    {
+        mReadPosition.storeRelease(mReadPosition.load() + count);
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::write(const T* elements, uint_t count)
+    {
+        const uint_t free = freeSpace(count);
+        if (count > free)
+        {
+            count = free;
+        }
+        const uint_t writePosition = mWritePosition.load();
+        const uint_t index = writePosition & mMask;
+        // up to the end of the array, then the rest from its beginning
+        const uint_t firstSpan = (count < mCapacity - index) ? count : mCapacity - index;
+        T* target = mElements.get();
+        for (uint_t i = 0; i < firstSpan; ++i)
+        {
+            target[index + i] = elements[i];
+        }
+        for (uint_t i = firstSpan; i < count; ++i)
+        {
+            target[i - firstSpan] = elements[i];
+        }
+        mWritePosition.storeRelease(writePosition + count);
+        return count;
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::read(T* elements, uint_t count)
+    {
+        const uint_t filled = filledSpace(count);
+        if (count > filled)
+        {
+            count = filled;
+        }
+        const uint_t readPosition = mReadPosition.load();
+        const uint_t index = readPosition & mMask;
+        const uint_t firstSpan = (count < mCapacity - index) ? count : mCapacity - index;
+        const T* source = mElements.get();
+        for (uint_t i = 0; i < firstSpan; ++i)
+        {
+            elements[i] = source[index + i];
+        }
+        for (uint_t i = firstSpan; i < count; ++i)
+        {
+            elements[i] = source[i - firstSpan];
+        }
+        mReadPosition.storeRelease(readPosition + count);
+        return count;
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::size() const
+    {
+        const uint_t readPosition = mReadPosition.load();
+        return mWritePosition.load() - readPosition;
+    }
+
+    template<typename T>
+    inline bool SpscRingBuffer<T>::empty() const
+    {
+        return size() == 0;
+    }
+
+    template<typename T>
+    inline uint_t SpscRingBuffer<T>::capacity() const
+    {
+        return mCapacity;
+    }
+}
+
+#endif // CAPU_SPSCRINGBUFFER_H
@@ -20,7 +20,8 @@
 #include "capu/Config.h"
 #include "capu/os/StringUtils.h"
 #include "capu/container/Hash.h"
-#include "capu/container/vector.h"
+#include "capu/os/Memory.h"
+#include "capu/util/Allocator.h"
 #include <algorithm>
 #include <cctype>
 
@@ -28,31 +29,50 @@ namespace capu
 {
     /**
      * Character strings.
+     * Strings of up to InlineCapacity characters are stored inside the object, longer ones
+     * in memory of ALLOCATOR which is taken with allocateArray, see Allocator.
      */
-    class String
+    template<class ALLOCATOR = Allocator<char> >
+    class BasicString
     {
     public:
+        /// number of characters which are stored without allocating memory
+        static const uint_t InlineCapacity = 23u;
+
+        BasicString();
+
+        /**
+         * Create an empty string which takes its memory from the given allocator
+         * @param allocator the allocator to use
+         */
+        explicit BasicString(const ALLOCATOR& allocator);
 
-        String();
         /**
          * Create a string from some characters
          * @param data Pointer to characters
          */
-        String(const char* data);
+        BasicString(const char* data);
+
+        /**
+         * Create a string from some characters in memory of the given allocator
+         * @param data Pointer to characters
+         * @param allocator the allocator to use
+         */
+        BasicString(const char* data, const ALLOCATOR& allocator);
 
         /**
          * Create a string from some characters but not starting from the front
          * @param data Pointer to the characters to copy from
          * @param start Position within characters to start copying from
          */
-        String(const char* data, uint_t start);
+        BasicString(const char* data, uint_t start);
         /**
          * Create a string from some characters, only taking some from the middle
          * @param data Pointer to character
          * @param start Position within characters to start copying from
          * @param end Position within characters to stop copying
          */
-        String(const char* data, const uint_t start, const uint_t end);
+        BasicString(const char* data, const uint_t start, const uint_t end);
 
         /**
          * Create a string from some other string, only taking some from the middle
@@ -60,29 +80,29 @@ namespace capu
          * @param start Position within characters to start copying from
          * @param end Position within characters to stop copying
          */
-        String(const String& other, const uint_t start, const uint_t end);
+        BasicString(const BasicString& other, const uint_t start, const uint_t end);
 
         /**
          * Create a string with initial size and all characters set to the given character
          * @param initialSize for the string
          * @param character to initialize string
          */
-        String(uint_t initialSize, char character);
+        BasicString(uint_t initialSize, char character);
 
         /**
-         * Create a string by copying from another
+         * Create a string by copying from another, the allocator is copied as well
          */
-        String(const String& other);
+        BasicString(const BasicString& other);
 
         /**
          * Move constructor
          */
-        String(String&& other);
+        BasicString(BasicString&& other);
 
         /**
          * Destructor.
          */
-        ~String();
+        ~BasicString();
 
         void resize(uint_t newSize);
 
@@ -100,22 +120,22 @@ namespace capu
         /**
          * Assign a string by copying from another
          */
-        String& operator=(const String& other);
+        BasicString& operator=(const BasicString& other);
 
         /**
          * Assign a string by copying from some characters
          */
-        String& operator=(const char* other);
+        BasicString& operator=(const char* other);
 
         /**
          * Assign a char to the string
          */
-        String& operator=(char other);
+        BasicString& operator=(char other);
 
         /**
          * Move assignment
          */
-        String& operator=(String&& other);
+        BasicString& operator=(BasicString&& other);
 
         /**
          * Adds the given character string to the string
@@ -132,17 +152,17 @@ namespace capu
         /**
          * Add two strings together and return the concatenated string
          */
-        String operator+(const String& rOperand) const;
+        BasicString operator+(const BasicString& rOperand) const;
 
         /**
          * Concatenate a c-style string and return the result
          */
-        String operator+(const char* rOperand) const;
+        BasicString operator+(const char* rOperand) const;
 
         /**
          * Return if this string equals another
          */
-        bool operator==(const String& other) const;
+        bool operator==(const BasicString& other) const;
 
         /**
          * Return if this string equals another
@@ -152,7 +172,7 @@ namespace capu
         /**
          * Return if this string does not equalsanother
          */
-        bool operator!=(const String& other) const;
+        bool operator!=(const BasicString& other) const;
 
         /**
          * Return if this string does not equalsanother
@@ -162,12 +182,12 @@ namespace capu
         /**
          * Return if this string is lexicographically ordered before other
          */
-        bool operator<(const String& other) const;
+        bool operator<(const BasicString& other) const;
 
         /**
          * Return if this string is lexicographically ordered after other
          */
-        bool operator>(const String& other) const;
+        bool operator>(const BasicString& other) const;
 
         /**
          * Access operator to access a special character
@@ -186,14 +206,14 @@ namespace capu
          * @param other The String to append
          * @return Reference to this string
          */
-        String& append(const String& other);
+        BasicString& append(const BasicString& other);
 
         /**
          * Append the given characters to this string
          * @param other The characters to append
          * @return Reference to this string
          */
-        String& append(const char* other);
+        BasicString& append(const char* other);
 
         /**
          * Return the length of the string
@@ -214,21 +234,21 @@ namespace capu
          * @param offset The index from where the search for the substring has to be started (default 0).
          * @return The index of the found substring or -1 if the substring was not found.
          */
-        int_t find(const String& substr, const uint_t offset = 0) const;
+        int_t find(const BasicString& substr, const uint_t offset = 0) const;
 
         /**
          * Checks if the String starts with the given string
          * @param other string to check
          * @return true if String starts with other string. False otherwise
          */
-        bool startsWith(const String& other) const;
+        bool startsWith(const BasicString& other) const;
 
         /**
          * Checks if the String ends with the given string
          * @param other string to check
          * @return true if String ends with other string. False otherwise
          */
-        bool endsWith(const String& other) const;
+        bool endsWith(const BasicString& other) const;
 
         /**
          * Return the index of the last occurence of the given character within the string
@@ -251,7 +271,7 @@ namespace capu
          * @param other The other string
          * @return Reference to this string
          */
-        String& swap(String& other);
+        BasicString& swap(BasicString& other);
 
         /**
          * Truncated the string to the given length.
@@ -264,7 +284,7 @@ namespace capu
          * @param length the new length of the string
          * @return Reference to this string.
          */
-        String& truncate(uint_t length);
+        BasicString& truncate(uint_t length);
 
         /**
          * Extracts a substring of the string with the given start and length.
@@ -277,7 +297,7 @@ namespace capu
          * @param length the length of the substring
          * @return The substring.
          */
-        String substr(uint_t start, int_t length) const;
+        BasicString substr(uint_t start, int_t length) const;
 
         /**
          * Replaces a substring within the string with a substitutionary string, starting at a given character position.
@@ -286,71 +306,155 @@ namespace capu
          * @param offset the start character position for starting the replacement.
          * @return string The string with replaced search substring.
          */
-        String replace(const String& search, const String& replace, const int_t offset = 0) const;
+        BasicString replace(const BasicString& search, const BasicString& replace, const int_t offset = 0) const;
+
+        /**
+         * Returns a copy of the allocator of the string
+         * @return the allocator
+         */
+        ALLOCATOR get_allocator() const;
+
+        /**
+         * Returns the number of characters the string can hold without allocating
+         * @return the capacity
+         */
+        uint_t getCapacity() const;
 
     private:
+        /**
+         * The characters and their length. Derives from the allocator to take no space for stateless ones.
+         */
+        struct Data : public ALLOCATOR
+        {
+            explicit Data(const ALLOCATOR& allocator);
+
+            char* chars;
+            uint_t size;
+            union
+            {
+                uint_t capacity; // used if chars is allocated
+                char inlineChars[InlineCapacity + 1];
+            };
+        };
+
         void initData(const char* data);
         void initFromGivenData(const char* data, const uint_t end, const uint_t start, uint_t size);
-        String& appendWithKnownLength(const char* other, uint_t length);
-
-        vector<char> m_data;
-        uint_t m_size;
+        BasicString& appendWithKnownLength(const char* other, uint_t length);
+        void assign(const char* other, uint_t length);
+        void reserveCapacity(uint_t capacity, uint_t minimumGrowth);
+        void takeData(BasicString& other);
+        void releaseData();
+        bool isInline() const;
+        ALLOCATOR& getAllocator();
+
+        Data m_data;
     };
 
+    /**
+     * String which uses the global heap
+     */
+    typedef BasicString<> String;
+
     /**
      * Specialization of Hash in order to calculate the Hash differently for strings
      */
-    template<>
-    struct Hasher<String, CAPU_TYPE_CLASS, uint_t>
+    template<class ALLOCATOR>
+    struct Hasher<BasicString<ALLOCATOR>, CAPU_TYPE_CLASS, uint_t>
     {
-        static uint_t Hash(const String key, const uint8_t bitsize)
+        static uint_t Hash(const BasicString<ALLOCATOR>& key, const uint8_t bitsize)
         {
             return HashCalculator<uint_t>::Hash(key.c_str(), bitsize);
         }
     };
 
+    /**
+     * Specialization of FastHasher which hashes the characters of the string
+     */
+    template<class ALLOCATOR>
+    struct FastHasher<BasicString<ALLOCATOR>, CAPU_TYPE_CLASS>
+    {
+        static uint64_t Hash(const BasicString<ALLOCATOR>& key)
+        {
+            return internal::FastHashBytes(key.c_str(), key.getLength());
+        }
+    };
+
     /**
      * Overloading swap for String
      */
-    inline void swap(String& first, String& second)
+    template<class ALLOCATOR>
+    inline void swap(BasicString<ALLOCATOR>& first, BasicString<ALLOCATOR>& second)
     {
         first.swap(second);
     }
 
     // global comparison
-    inline bool operator==(const char* a, const String& b)
+    template<class ALLOCATOR>
+    inline bool operator==(const char* a, const BasicString<ALLOCATOR>& b)
     {
         return b == a;
     }
 
-    inline bool operator!=(const char* a, const String& b)
+    template<class ALLOCATOR>
+    inline bool operator!=(const char* a, const BasicString<ALLOCATOR>& b)
     {
         return b != a;
     }
 
     /*
-     * Implementation String
+     * Implementation BasicString
      */
-    inline String::String()
-        : m_data(), m_size(0)
+    template<class ALLOCATOR>
+    const uint_t BasicString<ALLOCATOR>::InlineCapacity;
+
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::Data::Data(const ALLOCATOR& allocator)
+        : ALLOCATOR(allocator)
+        , chars(inlineChars)
+        , size(0)
+    {
+        inlineChars[0] = '\0';
+    }
+
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString()
+        : m_data(ALLOCATOR())
+    {
+    }
+
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const ALLOCATOR& allocator)
+        : m_data(allocator)
+    {
+    }
+
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(uint_t initialSize, char character)
+        : m_data(ALLOCATOR())
     {
+        reserveCapacity(initialSize, 0);
+        Memory::Set(m_data.chars, character, initialSize);
+        m_data.chars[initialSize] = '\0';
+        m_data.size = initialSize;
     }
 
-    inline String::String(uint_t initialSize, char character)
-        : m_data(initialSize + 1, character)
-        , m_size(initialSize)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const char* other)
+        : m_data(ALLOCATOR())
     {
-        m_data[initialSize] = '\0';
+        initData(other);
     }
 
-    inline String::String(const char* other)
-        : m_data(), m_size(0)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const char* other, const ALLOCATOR& allocator)
+        : m_data(allocator)
     {
         initData(other);
     }
 
-    inline String::String(const char* data, uint_t start)
-        : m_data(), m_size(0)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const char* data, uint_t start)
+        : m_data(ALLOCATOR())
     {
         if (data)
         {
@@ -359,31 +463,36 @@ namespace capu
         }
     }
 
-    inline String::String(const String& other, const uint_t start, const uint_t end)
-        : m_data(), m_size(0)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const BasicString& other, const uint_t start, const uint_t end)
+        : m_data(other.get_allocator())
     {
-        initFromGivenData(other.c_str(), start, end, other.m_size);
+        initFromGivenData(other.c_str(), start, end, other.m_data.size);
     }
 
-    inline String::String(const char* data, const uint_t start, const uint_t end)
-        : m_data(), m_size(0)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const char* data, const uint_t start, const uint_t end)
+        : m_data(ALLOCATOR())
     {
         initFromGivenData(data, start, end, StringUtils::Strnlen(data, end + 1));
     }
 
-    inline String::String(const String& other)
-        : m_data(other.m_data), m_size(other.m_size)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(const BasicString& other)
+        : m_data(other.get_allocator())
     {
+        assign(other.m_data.chars, other.m_data.size);
     }
 
-    inline String::String(String&& other)
-        : m_data(std::move(other.m_data))
-        , m_size(other.m_size)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::BasicString(BasicString&& other)
+        : m_data(other.get_allocator())
     {
-        other.m_size = 0;
+        takeData(other);
     }
 
-    inline void String::initFromGivenData(const char* data, const uint_t start, const uint_t end, uint_t size)
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::initFromGivenData(const char* data, const uint_t start, const uint_t end, uint_t size)
     {
         // no data
         if (!data)
@@ -411,197 +520,177 @@ namespace capu
         }
 
         // do the work
-        const char* startdata = data + start;
-        m_size = theend - start + 1;
-
-        m_data.reserve(m_size + 1);
-        m_data.clear();
-        m_data.insert(m_data.end(), startdata, startdata + m_size);
-        m_data.push_back('\0');
+        assign(data + start, theend - start + 1);
     }
 
-    inline String::~String()
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>::~BasicString()
     {
-        initData(0);
+        releaseData();
     }
 
-    inline void String::resize(uint_t newSize)
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::resize(uint_t newSize)
     {
-        if (newSize>0)
+        if (newSize > m_data.size)
         {
-            m_data.resize(newSize + 1); // additional byte for null termination
-            m_data[newSize] = 0;
+            reserveCapacity(newSize, 0);
+            Memory::Set(m_data.chars + m_data.size, 0, newSize - m_data.size);
         }
-        else
-        {
-            m_data.resize(0);
-        }
-        m_size = newSize;
+        m_data.chars[newSize] = '\0';
+        m_data.size = newSize;
     }
 
-    inline String& String::operator=(const String& other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::operator=(const BasicString& other)
     {
-        m_data = other.m_data;
-        m_size = other.m_size;
+        if (this != &other)
+        {
+            assign(other.m_data.chars, other.m_data.size);
+        }
         return *this;
     }
 
-    inline String& String::operator=(const char* other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::operator=(const char* other)
     {
         initData(other);
         return *this;
     }
 
-    inline String& String::operator=(String&& other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::operator=(BasicString&& other)
     {
-        m_data = std::move(other.m_data);
-        m_size = other.m_size;
-        other.m_size = 0;
+        if (this != &other)
+        {
+            releaseData();
+            getAllocator() = other.getAllocator();
+            takeData(other);
+        }
         return *this;
     }
 
-    inline String String::operator+(const String& rOperand) const
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR> BasicString<ALLOCATOR>::operator+(const BasicString& rOperand) const
     {
-        String result(*this);
+        BasicString result(*this);
         return result.append(rOperand);
     }
 
-    inline String String::operator+(const char* rOperand) const
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR> BasicString<ALLOCATOR>::operator+(const char* rOperand) const
     {
-        String result(c_str());
+        BasicString result(*this);
         return result.append(rOperand);
     }
 
-    inline String operator+(const char* lOperand, const String& rOperand)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR> operator+(const char* lOperand, const BasicString<ALLOCATOR>& rOperand)
     {
-        String result(lOperand);
+        BasicString<ALLOCATOR> result(lOperand, rOperand.get_allocator());
         return result.append(rOperand);
     }
 
-    inline bool String::operator==(const String& other) const
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::operator==(const BasicString& other) const
     {
-        const char null(0);
-        const char* str1 = m_data.data();
-        if (!str1)
-        {
-            str1 = &null;
-        }
-        const char* str2 = other.m_data.data();
-        if (!str2)
-        {
-            str2 = &null;
-        }
-        return StringUtils::Strcmp(str1, str2) == 0;
+        return StringUtils::Strcmp(m_data.chars, other.m_data.chars) == 0;
     }
 
-    inline bool String::operator==(const char* other) const
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::operator==(const char* other) const
     {
-        const char null(0);
-        const char* str1 = m_data.data();
-        if (!str1)
-        {
-            str1 = &null;
-        }
         if (!other)
         {
-            other = &null;
+            return m_data.chars[0] == '\0';
         }
-        return StringUtils::Strcmp(str1, other) == 0;
+        return StringUtils::Strcmp(m_data.chars, other) == 0;
     }
 
-    inline bool String::operator<(const String& other) const
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::operator<(const BasicString& other) const
     {
-        const char null(0);
-        const char* str1 = m_data.data();
-        if (!str1)
-        {
-            str1 = &null;
-        }
-        const char* str2 = other.m_data.data();
-        if (!str2)
-        {
-            str2 = &null;
-        }
-        return StringUtils::Strcmp(str1, str2) < 0;
+        return StringUtils::Strcmp(m_data.chars, other.m_data.chars) < 0;
     }
 
-    inline bool String::operator>(const String& other) const
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::operator>(const BasicString& other) const
     {
-        const char null(0);
-        const char* str1 = m_data.data();
-        if (!str1)
-        {
-            str1 = &null;
-        }
-        const char* str2 = other.m_data.data();
-        if (!str2)
-        {
-            str2 = &null;
-        }
-        return StringUtils::Strcmp(str1, str2) > 0;
+        return StringUtils::Strcmp(m_data.chars, other.m_data.chars) > 0;
     }
 
-    inline void String::operator+=(const char* other)
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::operator+=(const char* other)
     {
         append(other);
     }
 
-    inline String& String::operator=(char other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::operator=(char other)
     {
         char tmp[2] = {other, '\0'};
         return operator=(tmp);
     }
 
-    inline void String::operator+=(char other)
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::operator+=(char other)
     {
         char tmp[2] = {other, '\0'};
         operator+=(tmp);
     }
 
-    inline bool String::operator!=(const String& other) const
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::operator!=(const BasicString& other) const
     {
         return !operator==(other);
     }
 
-    inline bool String::operator!=(const char* other) const
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::operator!=(const char* other) const
     {
         return !operator==(other);
     }
 
-    inline char& String::operator[](uint_t index)
+    template<class ALLOCATOR>
+    inline char& BasicString<ALLOCATOR>::operator[](uint_t index)
     {
-        return m_data[index];
+        return m_data.chars[index];
     }
 
-    inline const char& String::operator[](uint_t index) const
+    template<class ALLOCATOR>
+    inline const char& BasicString<ALLOCATOR>::operator[](uint_t index) const
     {
-        return m_data[index];
+        return m_data.chars[index];
     }
 
-    inline String& String::append(const String& other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::append(const BasicString& other)
     {
-        return appendWithKnownLength(other.data(), other.getLength());
+        return appendWithKnownLength(other.m_data.chars, other.m_data.size);
     }
 
-    inline void String::toUpperCase()
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::toUpperCase()
     {
         const uint_t length = getLength();
         for (uint_t i = 0; i < length; ++i)
         {
-            m_data[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(m_data[i])));
+            m_data.chars[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(m_data.chars[i])));
         }
     }
 
-    inline void String::toLowerCase()
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::toLowerCase()
     {
         const uint_t length = getLength();
         for (uint_t i = 0; i < length; ++i)
         {
-            m_data[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(m_data[i])));
+            m_data.chars[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(m_data.chars[i])));
         }
     }
 
-    inline String& String::append(const char* other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::append(const char* other)
     {
         if (other && *other)
         {
@@ -611,80 +700,179 @@ namespace capu
         return *this;
     }
 
-    inline String& String::appendWithKnownLength(const char* other, uint_t otherLength)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::appendWithKnownLength(const char* other, uint_t otherLength)
     {
-        if (m_data.data() || other)
+        if (otherLength > 0)
         {
-            m_data.reserve(m_size + otherLength + 1);
-            m_data.resize(m_size);
-            m_data.insert(m_data.end(), other, other + otherLength);
-            m_data.push_back('\0');
-            m_size += otherLength;
+            // other may point into this string, grow with exponential steps to keep appending cheap
+            const uint_t newSize = m_data.size + otherLength;
+            if (newSize > getCapacity())
+            {
+                const bool isOwnData = other >= m_data.chars && other <= m_data.chars + m_data.size;
+                const uint_t offset = isOwnData ? other - m_data.chars : 0;
+                reserveCapacity(newSize, getCapacity());
+                if (isOwnData)
+                {
+                    other = m_data.chars + offset;
+                }
+            }
+            Memory::Move(m_data.chars + m_data.size, other, otherLength);
+            m_data.size = newSize;
+            m_data.chars[newSize] = '\0';
         }
         return *this;
     }
 
-    inline const char* String::c_str() const
+    template<class ALLOCATOR>
+    inline const char* BasicString<ALLOCATOR>::c_str() const
     {
-        return m_data.size() > 0 ? m_data.data() : "";
+        return m_data.chars;
     }
 
-    inline const char* String::data() const
+    template<class ALLOCATOR>
+    inline const char* BasicString<ALLOCATOR>::data() const
     {
-        return m_data.data();
+        return m_data.size > 0 ? m_data.chars : 0;
     }
 
-    inline char* String::data()
+    template<class ALLOCATOR>
+    inline char* BasicString<ALLOCATOR>::data()
     {
-        return m_data.data();
+        return m_data.size > 0 ? m_data.chars : 0;
     }
 
-    inline void String::initData(const char* data)
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::initData(const char* data)
     {
         if (data)
         {
-            m_size = StringUtils::Strlen(data);
-            m_data.clear();
-            m_data.reserve(m_size + 1);
-            m_data.insert(m_data.end(), data, data + m_size);
-            m_data.push_back('\0');
+            assign(data, StringUtils::Strlen(data));
         }
         else
         {
-            m_data.clear();
-            m_size = 0;
+            m_data.size = 0;
+            m_data.chars[0] = '\0';
         }
     }
 
-    inline uint_t String::getLength() const
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::assign(const char* other, uint_t length)
     {
-        return m_size;
+        if (length > getCapacity())
+        {
+            // other may point into this string, so it is copied before the old memory is released
+            char* chars = getAllocator().allocateArray(length + 1);
+            Memory::Copy(chars, other, length);
+            releaseData();
+            m_data.chars = chars;
+            m_data.capacity = length;
+        }
+        else
+        {
+            Memory::Move(m_data.chars, other, length);
+        }
+        m_data.chars[length] = '\0';
+        m_data.size = length;
     }
 
-    inline int_t String::find(const char ch, const uint_t offset) const
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::reserveCapacity(uint_t capacity, uint_t minimumGrowth)
+    {
+        const uint_t currentCapacity = getCapacity();
+        if (capacity > currentCapacity)
+        {
+            const uint_t newCapacity = std::max(capacity, currentCapacity + minimumGrowth);
+            char* chars = getAllocator().allocateArray(newCapacity + 1);
+            Memory::Copy(chars, m_data.chars, m_data.size + 1);
+            releaseData();
+            m_data.chars = chars;
+            m_data.capacity = newCapacity;
+        }
+    }
+
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::takeData(BasicString& other)
+    {
+        if (other.isInline())
+        {
+            Memory::Copy(m_data.inlineChars, other.m_data.inlineChars, other.m_data.size + 1);
+        }
+        else
+        {
+            m_data.chars = other.m_data.chars;
+            m_data.capacity = other.m_data.capacity;
+        }
+        m_data.size = other.m_data.size;
+
+        other.m_data.chars = other.m_data.inlineChars;
+        other.m_data.chars[0] = '\0';
+        other.m_data.size = 0;
+    }
+
+    template<class ALLOCATOR>
+    inline void BasicString<ALLOCATOR>::releaseData()
+    {
+        if (!isInline())
+        {
+            getAllocator().deallocateArray(m_data.chars, m_data.capacity + 1);
+            m_data.chars = m_data.inlineChars;
+        }
+    }
+
+    template<class ALLOCATOR>
+    inline bool BasicString<ALLOCATOR>::isInline() const
+    {
+        return m_data.chars == m_data.inlineChars;
+    }
+
+    template<class ALLOCATOR>
+    inline ALLOCATOR& BasicString<ALLOCATOR>::getAllocator()
+    {
+        return m_data;
+    }
+
+    template<class ALLOCATOR>
+    inline uint_t BasicString<ALLOCATOR>::getCapacity() const
+    {
+        return isInline() ? InlineCapacity : m_data.capacity;
+    }
+
+    template<class ALLOCATOR>
+    inline uint_t BasicString<ALLOCATOR>::getLength() const
+    {
+        return m_data.size;
+    }
+
+    template<class ALLOCATOR>
+    inline int_t BasicString<ALLOCATOR>::find(const char ch, const uint_t offset) const
     {
         return StringUtils::IndexOf(c_str(), ch, offset);
     }
 
-    inline int_t String::find(const String& substr, const uint_t offset) const
+    template<class ALLOCATOR>
+    inline int_t BasicString<ALLOCATOR>::find(const BasicString& substr, const uint_t offset) const
     {
         return StringUtils::IndexOf(c_str(), substr.c_str(), offset);;
     }
 
-    inline int_t String::rfind(const char ch) const
+    template<class ALLOCATOR>
+    inline int_t BasicString<ALLOCATOR>::rfind(const char ch) const
     {
         return StringUtils::LastIndexOf(c_str(), ch);
     }
 
-    inline String& String::swap(String& other)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::swap(BasicString& other)
     {
-        m_data.swap(other.m_data);
-        using std::swap;
-        swap(m_size, other.m_size);
+        BasicString tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
         return *this;
     }
 
-    inline String& String::truncate(uint_t length)
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR>& BasicString<ALLOCATOR>::truncate(uint_t length)
     {
         if (length >= getLength())
         {
@@ -693,40 +881,41 @@ namespace capu
         }
 
         // set new size and append null char after end of string
-        m_size = length;
-        m_data.resize(length + 1);
-        m_data[length] = 0;
+        m_data.size = length;
+        m_data.chars[length] = '\0';
         return *this;
     }
-
-    inline String String::substr(uint_t start, int_t length) const
+    template<class ALLOCATOR>
+    inline BasicString<ALLOCATOR> BasicString<ALLOCATOR>::substr(uint_t start, int_t length) const
     {
-        if (length < 0 || static_cast<uint_t>(length) > m_size)
+        if (length < 0 || static_cast<uint_t>(length) > m_data.size)
         {
             // take the complete substring starting with start
-            return String(*this, start, m_size);
+            return BasicString(*this, start, m_data.size);
         }
         else
         {
             if (length == 0)
             {
-                return String("");
+                return BasicString(get_allocator());
             }
             // calculate end position and cut out substring
-            return String(*this, start, start + length - 1);
+            return BasicString(*this, start, start + length - 1);
         }
     }
 
+    template<class ALLOCATOR>
     inline
     bool
-    String::startsWith(const String& other) const
+    BasicString<ALLOCATOR>::startsWith(const BasicString& other) const
     {
         return find(other, 0) == 0;
     }
 
+    template<class ALLOCATOR>
     inline
     bool
-    String::endsWith(const String& other) const
+    BasicString<ALLOCATOR>::endsWith(const BasicString& other) const
     {
         bool result = false;
         uint_t ownLen = getLength();
@@ -739,11 +928,12 @@ namespace capu
         return result;
     }
 
+    template<class ALLOCATOR>
     inline
-        String
-        String::replace(const String& search, const String& replace, const int_t offset) const
+        BasicString<ALLOCATOR>
+        BasicString<ALLOCATOR>::replace(const BasicString& search, const BasicString& replace, const int_t offset) const
     {
-        String result = substr(0, offset);
+        BasicString result = substr(0, offset);
         const int_t searchLen = search.getLength();
         int_t nextPos;
         int_t lastPos = offset;
@@ -756,6 +946,13 @@ namespace capu
         return result + substr(lastPos, -1);
     }
 
+    template<class ALLOCATOR>
+    inline
+    ALLOCATOR
+    BasicString<ALLOCATOR>::get_allocator() const
+    {
+        return m_data;
+    }
 }
 
 #endif // CAPU_STRING_H
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_WORKSTEALINGDEQUE_H
+#define CAPU_WORKSTEALINGDEQUE_H
+
+#include "capu/Config.h"
+#include "capu/os/Atomic.h"
+
+namespace capu
+{
+    /**
+     * Lock-free double ended queue of pointers after Chase and Lev with a fixed capacity.
+     *
+     * One owner thread pushes and pops at the bottom end, any number of other threads steal
+     * from the top end. The owner works in LIFO order on the most recently pushed elements
+     * while thieves take the oldest ones, so both rarely touch the same slot. Only the
+     * competition for the last element is decided by a compare-exchange.
+     *
+     * The capacity is fixed, push fails if the deque is full and the caller has to put the
+     * element elsewhere.
+     */
+    template<typename T, uint32_t CAPACITY = 1024>
+    class WorkStealingDeque
+    {
+    public:
+        WorkStealingDeque();
+
+        /**
+         * Pushes an element to the bottom. Must only be called by the owner.
+         * @param element the element, must not be 0
+         * @return true if the element was pushed, false if the deque is full
+         */
+        bool push(T* element);
+
+        /**
+         * Takes the most recently pushed element from the bottom. Must only be called by the owner.
+         * @return the element or 0 if the deque is empty
+         */
+        T* pop();
+
+        /**
+         * Takes the oldest element from the top. May be called by any thread.
+         * @return the element or 0 if the deque is empty or another thread took the element first
+         */
+        T* steal();
+
+        /**
+         * Returns the number of elements. The result is only a snapshot if other threads access the deque.
+         * @return the number of elements
+         */
+        uint_t size() const;
+
+        /**
+         * @return true if the deque holds no elements
+         */
+        bool empty() const;
+
+    private:
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "WorkStealingDeque CAPACITY must be a power of two");
+
+        Atomic<int_t> mTop;
+        Atomic<int_t> mBottom;
+        Atomic<T*> mElements[CAPACITY];
+
+        WorkStealingDeque(const WorkStealingDeque&);
+        WorkStealingDeque& operator=(const WorkStealingDeque&);
+    };
+
+    template<typename T, uint32_t CAPACITY>
+    inline WorkStealingDeque<T, CAPACITY>::WorkStealingDeque()
+        : mTop(0)
+        , mBottom(0)
+    {
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool WorkStealingDeque<T, CAPACITY>::push(T* element)
+    {
+        const int_t bottom = mBottom.load();
+        const int_t top = mTop.load();
+        if (bottom - top >= static_cast<int_t>(CAPACITY))
+        {
+            return false;
+        }
+        mElements[bottom & (CAPACITY - 1)].store(element);
+        mBottom.store(bottom + 1);
+        return true;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline T* WorkStealingDeque<T, CAPACITY>::pop()
+    {
+        // reserve the bottom element before looking at top, thieves see the reservation
+        const int_t bottom = mBottom.load() - 1;
+        mBottom.store(bottom);
+        int_t top = mTop.load();
+        if (top > bottom)
+        {
+            // was empty
+            mBottom.store(bottom + 1);
+            return 0;
+        }
+
+        T* element = mElements[bottom & (CAPACITY - 1)].load();
+        if (top == bottom)
+        {
+            // last element, compete with the thieves for it
+            if (!mTop.compareExchange(top, top + 1))
+            {
+                element = 0;
+            }
+            mBottom.store(bottom + 1);
+        }
+        return element;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline T* WorkStealingDeque<T, CAPACITY>::steal()
+    {
+        int_t top = mTop.load();
+        const int_t bottom = mBottom.load();
+        if (top >= bottom)
+        {
+            return 0;
+        }
+
+        // read before claiming, once top moves the owner may overwrite the slot
+        T* element = mElements[top & (CAPACITY - 1)].load();
+        if (!mTop.compareExchange(top, top + 1))
+        {
+            return 0;
+        }
+        return element;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline uint_t WorkStealingDeque<T, CAPACITY>::size() const
+    {
+        const int_t size = mBottom.load() - mTop.load();
+        return size > 0 ? static_cast<uint_t>(size) : 0;
+    }
+
+    template<typename T, uint32_t CAPACITY>
+    inline bool WorkStealingDeque<T, CAPACITY>::empty() const
+    {
+        return size() == 0;
+    }
+}
+
+#endif // CAPU_WORKSTEALINGDEQUE_H
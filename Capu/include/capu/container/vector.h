@@ -23,18 +23,21 @@
 #include "capu/util/Iterator.h"
 #include "capu/util/AlgorithmRaw.h"
 #include "capu/util/Algorithm.h"
+#include "capu/util/Allocator.h"
 #include <new>
 #include <initializer_list>
 #include <assert.h>
 #include <algorithm>
+#include <utility>
 
 namespace capu
 {
     /**
      * Basic Vector implementation
      * The internal memory is doubled if the vector is full
+     * The memory is taken from ALLOCATOR with allocateArray/deallocateArray, see Allocator
      */
-    template<typename T>
+    template<typename T, class ALLOCATOR = Allocator<T> >
     class vector
     {
     private:
@@ -46,7 +49,7 @@ namespace capu
         class InternalIterator : public capu::iterator<random_access_iterator_tag, TYPE>
         {
         public:
-            friend class vector<T>;
+            friend class vector<T, ALLOCATOR>;
 
             /**
              * Default constructor for the iterator
@@ -358,29 +361,38 @@ namespace capu
          */
         vector();
 
+        /**
+         * Creates a new vector which takes its memory from the given allocator
+         * @param allocator the allocator to use
+         */
+        explicit vector(const ALLOCATOR& allocator);
+
         /**
          * Creates a new vector with a given initial size
          * and initializes elements with default values
          * @param initialSize for the Vector
+         * @param allocator the allocator to use
          */
-        vector(const uint_t initialSize);
+        vector(const uint_t initialSize, const ALLOCATOR& allocator = ALLOCATOR());
 
         /**
          * Initializes the vector with the given size and sets all elements
          * to the given value
          * @param initialSize for the Vector
          * @param value to set for all elements
+         * @param allocator the allocator to use
          */
-        vector(const uint_t initialSize, const T& value);
+        vector(const uint_t initialSize, const T& value, const ALLOCATOR& allocator = ALLOCATOR());
 
         /**
          * Initializes the vector from given initializer_list
          * @param init the initializer_list
+         * @param allocator the allocator to use
          */
-        vector(std::initializer_list<T> init);
+        vector(std::initializer_list<T> init, const ALLOCATOR& allocator = ALLOCATOR());
 
         /**
-         * Initializes the vector from another vector
+         * Initializes the vector from another vector, the allocator is copied as well
          */
         vector(const vector& other);
 
@@ -414,6 +426,19 @@ namespace capu
          */
         status_t push_back(const T& value);
 
+        /**
+         * Moves an Element to the end of the vector
+         * @param value the value to move into the vector
+         */
+        status_t push_back(T&& value);
+
+        /**
+         * Constructs an Element in place at the end of the vector
+         * @param args the arguments passed to the constructor of the element
+         */
+        template <typename... Args>
+        status_t emplace_back(Args&&... args);
+
         /**
          * Removes the last element of the vector.
          * Returns CAPU_ERANGE if vector was empty.
@@ -513,7 +538,7 @@ namespace capu
          * @param other Vector to compare with
          * @return true if both vectors are identical
          */
-        bool operator==(const vector<T>& other) const;
+        bool operator==(const vector<T, ALLOCATOR>& other) const;
 
         /**
          * Returns a new Iterator to the start of the Vector
@@ -582,6 +607,21 @@ namespace capu
          **/
         status_t insert(const Iterator& iterator, const T& value);
 
+        /**
+         * Moves the given value into the specified iterator position
+         * @param iterator iterator where value is to be inserted
+         * @param value value to move into the vector
+         **/
+        status_t insert(const Iterator& iterator, T&& value);
+
+        /**
+         * Constructs an element in place at the specified iterator position
+         * @param iterator iterator where the element is to be inserted
+         * @param args the arguments passed to the constructor of the element
+         **/
+        template <typename... Args>
+        status_t emplace(const Iterator& iterator, Args&&... args);
+
         /**
         * Inserts the given range of value at the specified iterator position
         * @param iterator iterator where value is to be inserted
@@ -595,29 +635,55 @@ namespace capu
          * Exchange the content of this vector with other
          * @param other the other vector
          */
-        void swap(vector<T>& other);
+        void swap(vector<T, ALLOCATOR>& other);
 
-    protected:
-    private:
         /**
-         * Internal data to store the elements
+         * Returns a copy of the allocator of the vector
+         * @return the allocator
          */
-        T* m_data;
+        ALLOCATOR get_allocator() const;
 
+    protected:
+    private:
         /**
-         * Iterator which points one after the end of the data
+         * Allocator and internal data, a stateless allocator takes no space as empty base
          */
-        T* m_dataEnd;
+        struct Data : public ALLOCATOR
+        {
+            explicit Data(const ALLOCATOR& allocator);
+
+            /**
+             * Internal data to store the elements
+             */
+            T* elements;
+
+            /**
+             * Iterator which points one after the end of the data
+             */
+            T* elementsEnd;
+
+            /**
+             * Iterator which points to one after the end of the capacity
+             */
+            T* capacityEnd;
+        };
+
+        Data m_data;
 
         /**
-         * Iterator which points to one after the end of the capacity
+         * Returns the allocator for the internal data
          */
-        T* m_capacityEnd;
+        ALLOCATOR& getAllocator();
 
         /**
          * Internal method to double the current memory
          */
         void grow(uint_t requiredCapacity);
+
+        /**
+         * Internal method to get uninitialized memory for a number of elements from the allocator
+         */
+        T* allocateMemory(uint_t capacity);
     };
 
 
@@ -626,175 +692,211 @@ namespace capu
      * @param first first vector
      * @param second vector to swap with first
      */
-    template <typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    void swap(vector<T>& first, vector<T>& second)
+    void swap(vector<T, ALLOCATOR>& first, vector<T, ALLOCATOR>& second)
     {
         first.swap(second);
     }
 
-    template<typename T>
-    T& capu::vector<T>::front()
+    template<typename T, class ALLOCATOR>
+    T& vector<T, ALLOCATOR>::front()
     {
-        return *m_data;
+        return *m_data.elements;
     }
 
-    template<typename T>
-    const T& capu::vector<T>::front() const
+    template<typename T, class ALLOCATOR>
+    const T& vector<T, ALLOCATOR>::front() const
     {
-        return *m_data;
+        return *m_data.elements;
     }
 
-    template<typename T>
-    T& capu::vector<T>::back()
+    template<typename T, class ALLOCATOR>
+    T& vector<T, ALLOCATOR>::back()
     {
-        return *(m_dataEnd -1);
+        return *(m_data.elementsEnd -1);
     }
 
-    template<typename T>
-    const T& capu::vector<T>::back() const
+    template<typename T, class ALLOCATOR>
+    const T& vector<T, ALLOCATOR>::back() const
     {
-        return *(m_dataEnd - 1);
+        return *(m_data.elementsEnd - 1);
     }
 
-    template<typename T>
-    T*  capu::vector<T>::data()
+    template<typename T, class ALLOCATOR>
+    T*  vector<T, ALLOCATOR>::data()
     {
-        return m_data;
+        return m_data.elements;
     }
 
-    template<typename T>
-    const T*  capu::vector<T>::data() const
+    template<typename T, class ALLOCATOR>
+    const T*  vector<T, ALLOCATOR>::data() const
     {
-        return m_data;
+        return m_data.elements;
+    }
+
+    template<typename T, class ALLOCATOR>
+    status_t vector<T, ALLOCATOR>::insert(const Iterator& iterator, const T& value)
+    {
+        return emplace(iterator, value);
     }
 
-    template<typename T>
-    status_t capu::vector<T>::insert(const Iterator& iterator, const T& value)
+    template<typename T, class ALLOCATOR>
+    status_t vector<T, ALLOCATOR>::insert(const Iterator& iterator, T&& value)
     {
-        const uint_t numberFromBeginning = (iterator.m_current - m_data);
-        if (m_dataEnd == m_capacityEnd)
+        return emplace(iterator, std::move(value));
+    }
+
+    template<typename T, class ALLOCATOR>
+    template <typename... Args>
+    status_t vector<T, ALLOCATOR>::emplace(const Iterator& iterator, Args&&... args)
+    {
+        if (iterator.m_current == m_data.elementsEnd)
+        {
+            return emplace_back(std::forward<Args>(args)...);
+        }
+
+        // construct first, the arguments may refer to elements which are moved below
+        T value(std::forward<Args>(args)...);
+
+        const uint_t numberFromBeginning = (iterator.m_current - m_data.elements);
+        if (m_data.elementsEnd == m_data.capacityEnd)
         {
-            /*status = */
-            // todo: should check status of grow here
             grow(size() + 1);
         }
 
         // move back
-        new(m_dataEnd)T();
-        copy_backward(m_data + numberFromBeginning, m_dataEnd, m_dataEnd + 1u);
-        ++m_dataEnd;
+        T* insertPosition = m_data.elements + numberFromBeginning;
+        new(m_data.elementsEnd)T(std::move(*(m_data.elementsEnd - 1)));
+        std::move_backward(insertPosition, m_data.elementsEnd - 1, m_data.elementsEnd);
+        ++m_data.elementsEnd;
 
-        m_data[numberFromBeginning] = value;
+        *insertPosition = std::move(value);
         return CAPU_OK;
     }
 
-    template <typename T>
+    template<typename T, class ALLOCATOR>
     template <typename InputIt>
-    status_t capu::vector<T>::insert(const Iterator& iterator, InputIt first, InputIt last)
+    status_t vector<T, ALLOCATOR>::insert(const Iterator& iterator, InputIt first, InputIt last)
     {
         typedef typename capu::iterator_traits<InputIt>::difference_type distanceType;
         const distanceType numberOfNewElements = distance(first, last);
-        const uint_t insertOffset = (iterator.m_current - m_data);
+        const uint_t insertOffset = (iterator.m_current - m_data.elements);
         grow(size() + numberOfNewElements);
 
         const distanceType numberOfExistingElementsThatNeedToBeMoved = size() - insertOffset;
         if (numberOfExistingElementsThatNeedToBeMoved > numberOfNewElements)
         {
             // existing elements move must be split
-            copy_to_raw(m_dataEnd - numberOfNewElements, m_dataEnd, m_dataEnd);
+            copy_to_raw(m_data.elementsEnd - numberOfNewElements, m_data.elementsEnd, m_data.elementsEnd);
             const uint_t numberOfExistingElementsToCopyDirectly = numberOfExistingElementsThatNeedToBeMoved - numberOfNewElements;
-            copy_backward(m_data + insertOffset, m_data + insertOffset + numberOfExistingElementsToCopyDirectly, m_dataEnd);
-            copy(first, last, m_data + insertOffset);
+            copy_backward(m_data.elements + insertOffset, m_data.elements + insertOffset + numberOfExistingElementsToCopyDirectly, m_data.elementsEnd);
+            copy(first, last, m_data.elements + insertOffset);
         }
         else
         {
             // insert new elements must be split
-            copy_to_raw(m_data + insertOffset, m_dataEnd, m_dataEnd + numberOfNewElements - numberOfExistingElementsThatNeedToBeMoved);
+            copy_to_raw(m_data.elements + insertOffset, m_data.elementsEnd, m_data.elementsEnd + numberOfNewElements - numberOfExistingElementsThatNeedToBeMoved);
 
             const distanceType numberOfElementsToInsertDirectly = numberOfExistingElementsThatNeedToBeMoved;
             InputIt insertDirectlyEnd = first;
             advance(insertDirectlyEnd, numberOfElementsToInsertDirectly);
 
-            copy(first, insertDirectlyEnd, m_data + insertOffset);
-            copy_to_raw(insertDirectlyEnd, last, m_dataEnd);
+            copy(first, insertDirectlyEnd, m_data.elements + insertOffset);
+            copy_to_raw(insertDirectlyEnd, last, m_data.elementsEnd);
         }
-        m_dataEnd += numberOfNewElements;
+        m_data.elementsEnd += numberOfNewElements;
 
         return CAPU_OK;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    bool capu::vector<T>::empty() const
+    bool vector<T, ALLOCATOR>::empty() const
     {
-        return m_data == m_dataEnd;
+        return m_data.elements == m_data.elementsEnd;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    capu::vector<T>::vector(const vector& other)
-        : m_data(other.capacity() == 0u ? nullptr : reinterpret_cast<T*>(new Byte[sizeof(T) * other.capacity()]))
-        , m_dataEnd( m_data + other.size())
-        , m_capacityEnd( m_data + other.capacity())
+    vector<T, ALLOCATOR>::Data::Data(const ALLOCATOR& allocator)
+        : ALLOCATOR(allocator)
+        , elements(0)
+        , elementsEnd(0)
+        , capacityEnd(0)
     {
-        copy_to_raw(other.m_data, other.m_dataEnd, m_data);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>::vector(vector&& other)
+    vector<T, ALLOCATOR>::vector(const vector& other)
         : m_data(other.m_data)
-        , m_dataEnd(other.m_dataEnd)
-        , m_capacityEnd(other.m_capacityEnd)
     {
-        other.m_data = nullptr;
-        other.m_dataEnd = nullptr;
-        other.m_capacityEnd = nullptr;
+        m_data.elements = allocateMemory(other.capacity());
+        m_data.elementsEnd = m_data.elements + other.size();
+        m_data.capacityEnd = m_data.elements + other.capacity();
+        copy_to_raw(other.m_data.elements, other.m_data.elementsEnd, m_data.elements);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>::vector()
-        : m_data(0)
-        , m_dataEnd(0)
-        , m_capacityEnd(0)
+    vector<T, ALLOCATOR>::vector(vector&& other)
+        : m_data(std::move(other.m_data))
     {
+        other.m_data.elements = nullptr;
+        other.m_data.elementsEnd = nullptr;
+        other.m_data.capacityEnd = nullptr;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>::vector(const uint_t initialSize, const T& value)
-        : m_data(initialSize == 0u ? nullptr : reinterpret_cast<T*>(new Byte[sizeof(T) * initialSize]))
-        , m_dataEnd(m_data + initialSize)
-        , m_capacityEnd(m_data + initialSize)
+    vector<T, ALLOCATOR>::vector()
+        : m_data(ALLOCATOR())
     {
-        fill_n_raw(m_data, initialSize, value);
     }
 
+    template<typename T, class ALLOCATOR>
+    inline
+    vector<T, ALLOCATOR>::vector(const ALLOCATOR& allocator)
+        : m_data(allocator)
+    {
+    }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>::vector(std::initializer_list<T> init)
-        : vector()
+    vector<T, ALLOCATOR>::vector(const uint_t initialSize, const T& value, const ALLOCATOR& allocator)
+        : m_data(allocator)
+    {
+        m_data.elements = allocateMemory(initialSize);
+        m_data.elementsEnd = m_data.elements + initialSize;
+        m_data.capacityEnd = m_data.elements + initialSize;
+        fill_n_raw(m_data.elements, initialSize, value);
+    }
+
+
+    template<typename T, class ALLOCATOR>
+    inline
+    vector<T, ALLOCATOR>::vector(std::initializer_list<T> init, const ALLOCATOR& allocator)
+        : vector(allocator)
     {
         insert(end(), std::begin(init), std::end(init));
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>::vector(const uint_t initialSize)
-        : m_data(initialSize == 0u ? nullptr : reinterpret_cast<T*>(new Byte[sizeof(T) * initialSize]))
-        , m_dataEnd(m_data + initialSize)
-        , m_capacityEnd(m_data + initialSize)
+    vector<T, ALLOCATOR>::vector(const uint_t initialSize, const ALLOCATOR& allocator)
+        : m_data(allocator)
     {
-        fill_n_raw(m_data, initialSize);
+        m_data.elements = allocateMemory(initialSize);
+        m_data.elementsEnd = m_data.elements + initialSize;
+        m_data.capacityEnd = m_data.elements + initialSize;
+        fill_n_raw(m_data.elements, initialSize);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>&
-    vector<T>::operator=(const vector<T>& other)
+    vector<T, ALLOCATOR>&
+    vector<T, ALLOCATOR>::operator=(const vector<T, ALLOCATOR>& other)
     {
         if (this != &other)
         {
@@ -802,60 +904,80 @@ namespace capu
             const uint_t numberOfElementsInOther = other.size();
             reserve(numberOfElementsInOther);
 
-            copy_to_raw(other.m_data, other.m_dataEnd, m_data);
-            m_dataEnd = m_data + numberOfElementsInOther;
+            copy_to_raw(other.m_data.elements, other.m_data.elementsEnd, m_data.elements);
+            m_data.elementsEnd = m_data.elements + numberOfElementsInOther;
         }
         return *this;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    vector<T>&
-    vector<T>::operator=(vector&& other)
+    vector<T, ALLOCATOR>&
+    vector<T, ALLOCATOR>::operator=(vector&& other)
     {
-        vector<T> tmp(std::move(other));
+        vector<T, ALLOCATOR> tmp(std::move(other));
         this->swap(tmp);
         return *this;
     }
 
-    template<typename T>
-    inline vector<T>::~vector()
+    template<typename T, class ALLOCATOR>
+    inline vector<T, ALLOCATOR>::~vector()
     {
         clear();
-        const Byte* untypedMemory = reinterpret_cast<Byte*>(m_data);
-        delete[] untypedMemory;
+        if (m_data.elements)
+        {
+            getAllocator().deallocateArray(m_data.elements, capacity());
+        }
+    }
+
+    template<typename T, class ALLOCATOR>
+    inline
+    status_t
+    vector<T, ALLOCATOR>::push_back(const T& value)
+    {
+        return emplace_back(value);
+    }
+
+    template<typename T, class ALLOCATOR>
+    inline
+    status_t
+    vector<T, ALLOCATOR>::push_back(T&& value)
+    {
+        return emplace_back(std::move(value));
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
+    template <typename... Args>
     inline
     status_t
-    vector<T>::push_back(const T& value)
+    vector<T, ALLOCATOR>::emplace_back(Args&&... args)
     {
-        status_t status = CAPU_OK;
-        if (m_dataEnd == m_capacityEnd)
+        if (m_data.elementsEnd == m_data.capacityEnd)
         {
-            /*status = */
-            // todo: should check status of grow here
+            // the arguments may refer to elements of this vector, so construct the new
+            // element before the old memory is released
+            T value(std::forward<Args>(args)...);
             grow(size() + 1);
+            new(m_data.elementsEnd)T(std::move(value));
+        }
+        else
+        {
+            new(m_data.elementsEnd)T(std::forward<Args>(args)...);
         }
 
-        T* thing = reinterpret_cast<T*>(m_dataEnd);
-        new(thing)T(value);
-
-        ++m_dataEnd;
-
-        return status;
+        ++m_data.elementsEnd;
+        return CAPU_OK;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     status_t
-    vector<T>::pop_back()
+    vector<T, ALLOCATOR>::pop_back()
     {
-        if (m_dataEnd > m_data)
+        if (m_data.elementsEnd > m_data.elements)
         {
-            (m_dataEnd - 1)->~T();
-            --m_dataEnd;
+            (m_data.elementsEnd - 1)->~T();
+            --m_data.elementsEnd;
             return CAPU_OK;
         }
         else
@@ -864,19 +986,19 @@ namespace capu
         }
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     void
-    vector<T>::clear()
+    vector<T, ALLOCATOR>::clear()
     {
-        destruct_raw(m_data, m_dataEnd);
-        m_dataEnd = m_data;
+        destruct_raw(m_data.elements, m_data.elementsEnd);
+        m_data.elementsEnd = m_data.elements;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     void
-    vector<T>::grow(uint_t requiredCapacity)
+    vector<T, ALLOCATOR>::grow(uint_t requiredCapacity)
     {
         const uint_t currentCapacity = capacity();
         if (requiredCapacity > currentCapacity)
@@ -894,16 +1016,16 @@ namespace capu
         }
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     void
-    vector<T>::resize(const uint_t newSize)
+    vector<T, ALLOCATOR>::resize(const uint_t newSize)
     {
         const uint_t previousNumberOfElements = size();
         if (newSize < previousNumberOfElements)
         {
             // must delete excess elements
-            destruct_raw(m_data + newSize, m_data + previousNumberOfElements);
+            destruct_raw(m_data.elements + newSize, m_data.elements + previousNumberOfElements);
         }
         else
         {
@@ -914,137 +1036,138 @@ namespace capu
             }
             // initialize new objects
             const uint_t numberOfNewObjects = newSize - previousNumberOfElements;
-            fill_n_raw(m_data + previousNumberOfElements, numberOfNewObjects);
+            fill_n_raw(m_data.elements + previousNumberOfElements, numberOfNewObjects);
 
         }
-        m_dataEnd = m_data + newSize;
+        m_data.elementsEnd = m_data.elements + newSize;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     void
-    vector<T>::reserve(const uint_t newSize)
+    vector<T, ALLOCATOR>::reserve(const uint_t newSize)
     {
         if (newSize > capacity())
         {
             const uint_t currentNumberOfElements = size();
-            void* newMemory = new Byte[sizeof(T) * newSize];
-            T* newTypedMemory = reinterpret_cast<T*>(newMemory);
+            T* newTypedMemory = allocateMemory(newSize);
 
-            move_to_raw(m_data, m_dataEnd, newTypedMemory);
-            destruct_raw(m_data, m_dataEnd);
+            move_to_raw(m_data.elements, m_data.elementsEnd, newTypedMemory);
+            destruct_raw(m_data.elements, m_data.elementsEnd);
 
             // delete previous memory
-            Byte* untypedMemory = reinterpret_cast<Byte*>(m_data);
-            delete[] untypedMemory;
-            m_data = newTypedMemory;
-            m_dataEnd = m_data + currentNumberOfElements;
-            m_capacityEnd = m_data + newSize;
+            if (m_data.elements)
+            {
+                getAllocator().deallocateArray(m_data.elements, capacity());
+            }
+            m_data.elements = newTypedMemory;
+            m_data.elementsEnd = m_data.elements + currentNumberOfElements;
+            m_data.capacityEnd = m_data.elements + newSize;
         }
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     void
-    vector<T>::shrink_to_fit()
+    vector<T, ALLOCATOR>::shrink_to_fit()
     {
-        vector<T> tmp(0);
+        vector<T, ALLOCATOR> tmp(getAllocator());
         tmp.insert(tmp.begin(), this->begin(), this->end());
         this->swap(tmp);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     T&
-    vector<T>::operator[](const uint_t index)
+    vector<T, ALLOCATOR>::operator[](const uint_t index)
     {
-        return *(m_data + index);
+        return *(m_data.elements + index);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     const T&
-    vector<T>::operator[](const uint_t index) const
+    vector<T, ALLOCATOR>::operator[](const uint_t index) const
     {
-        return *(m_data + index);
+        return *(m_data.elements + index);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     uint_t
-    vector<T>::size() const
+    vector<T, ALLOCATOR>::size() const
     {
-        const uint_t numberOfElements = (m_dataEnd - m_data);
+        const uint_t numberOfElements = (m_data.elementsEnd - m_data.elements);
         return numberOfElements;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    uint_t vector<T>::capacity() const
+    uint_t vector<T, ALLOCATOR>::capacity() const
     {
-        return (m_capacityEnd - m_data);
+        return (m_data.capacityEnd - m_data.elements);
     }
 
-    template <typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    typename vector<T>::Iterator vector<T>::begin()
+    typename vector<T, ALLOCATOR>::Iterator vector<T, ALLOCATOR>::begin()
     {
-        return Iterator(m_data);
+        return Iterator(m_data.elements);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    typename vector<T>::ConstIterator
-    vector<T>::begin() const
+    typename vector<T, ALLOCATOR>::ConstIterator
+    vector<T, ALLOCATOR>::begin() const
     {
-        return ConstIterator(m_data);
+        return ConstIterator(m_data.elements);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    typename vector<T>::ConstIterator
-    vector<T>::cbegin() const
+    typename vector<T, ALLOCATOR>::ConstIterator
+    vector<T, ALLOCATOR>::cbegin() const
     {
-        return ConstIterator(m_data);
+        return ConstIterator(m_data.elements);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    typename vector<T>::Iterator
-    vector<T>::end()
+    typename vector<T, ALLOCATOR>::Iterator
+    vector<T, ALLOCATOR>::end()
     {
-        return Iterator(m_dataEnd);
+        return Iterator(m_data.elementsEnd);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    typename vector<T>::ConstIterator
-    vector<T>::end() const
+    typename vector<T, ALLOCATOR>::ConstIterator
+    vector<T, ALLOCATOR>::end() const
     {
-        return ConstIterator(m_dataEnd);
+        return ConstIterator(m_data.elementsEnd);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    typename vector<T>::ConstIterator
-    vector<T>::cend() const
+    typename vector<T, ALLOCATOR>::ConstIterator
+    vector<T, ALLOCATOR>::cend() const
     {
-        return ConstIterator(m_dataEnd);
+        return ConstIterator(m_data.elementsEnd);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    status_t vector<T>::erase(const uint_t index, T* elementOld)
+    status_t vector<T, ALLOCATOR>::erase(const uint_t index, T* elementOld)
     {
-        const Iterator current = Iterator(m_data + index);
+        const Iterator current = Iterator(m_data.elements + index);
         return erase(current, elementOld);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    status_t vector<T>::erase(const Iterator& iterator, T* elementOld)
+    status_t vector<T, ALLOCATOR>::erase(const Iterator& iterator, T* elementOld)
     {
-        if(iterator.m_current >= m_dataEnd)
+        if(iterator.m_current >= m_data.elementsEnd)
         {
             return CAPU_EINVAL;
         }
@@ -1054,32 +1177,54 @@ namespace capu
             *elementOld = *iterator;
         }
 
-        copy(iterator + 1u, Iterator(m_dataEnd), iterator);
+        copy(iterator + 1u, Iterator(m_data.elementsEnd), iterator);
         resize(size() - 1);
 
         return CAPU_OK;
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
     bool
-    vector<T>::operator==(const vector<T>& other) const
+    vector<T, ALLOCATOR>::operator==(const vector<T, ALLOCATOR>& other) const
     {
         if (size() != other.size())
         {
             return false;
         }
-        return equal(m_data, m_dataEnd, other.m_data);
+        return equal(m_data.elements, m_data.elementsEnd, other.m_data.elements);
     }
 
-    template<typename T>
+    template<typename T, class ALLOCATOR>
     inline
-    void vector<T>::swap(vector<T>& other)
+    void vector<T, ALLOCATOR>::swap(vector<T, ALLOCATOR>& other)
     {
         using std::swap;
-        swap(m_data, other.m_data);
-        swap(m_dataEnd, other.m_dataEnd);
-        swap(m_capacityEnd, other.m_capacityEnd);
+        swap(m_data.elements, other.m_data.elements);
+        swap(m_data.elementsEnd, other.m_data.elementsEnd);
+        swap(m_data.capacityEnd, other.m_data.capacityEnd);
+        swap(getAllocator(), other.getAllocator());
+    }
+
+    template<typename T, class ALLOCATOR>
+    inline
+    ALLOCATOR vector<T, ALLOCATOR>::get_allocator() const
+    {
+        return m_data;
+    }
+
+    template<typename T, class ALLOCATOR>
+    inline
+    ALLOCATOR& vector<T, ALLOCATOR>::getAllocator()
+    {
+        return m_data;
+    }
+
+    template<typename T, class ALLOCATOR>
+    inline
+    T* vector<T, ALLOCATOR>::allocateMemory(uint_t capacity)
+    {
+        return capacity == 0u ? nullptr : getAllocator().allocateArray(capacity);
     }
 }
 
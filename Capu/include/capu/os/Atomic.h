@@ -54,6 +54,32 @@ namespace capu
             mValue.store(value);
         }
 
+        /**
+         * Loads the value without ordering other reads and writes, e.g. for flags which guard no data
+         */
+        T loadRelaxed() const
+        {
+            return mValue.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Loads the value, later reads and writes of this thread are not moved before the load.
+         * Pairs with storeRelease() of another thread.
+         */
+        T loadAcquire() const
+        {
+            return mValue.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Stores the value, earlier reads and writes of this thread are not moved after the store.
+         * Pairs with loadAcquire() of another thread.
+         */
+        void storeRelease(T value)
+        {
+            mValue.store(value, std::memory_order_release);
+        }
+
         T operator=(T value)
         {
             mValue.store(value);
@@ -90,6 +116,17 @@ namespace capu
             return mValue -= value;
         }
 
+        /**
+         * Replaces the value with desired if it is equal to expected.
+         * @param expected the value to compare with, receives the current value if the comparison fails
+         * @param desired the new value
+         * @return true if the value was replaced, false otherwise
+         */
+        bool compareExchange(T& expected, T desired)
+        {
+            return mValue.compare_exchange_strong(expected, desired);
+        }
+
         static_assert(std::is_integral<T>::value || std::is_pointer<T>::value,
                       "Atomic<T> supports only integral and pointer types");
         static_assert(sizeof(T) <= sizeof(capu::uint_t),
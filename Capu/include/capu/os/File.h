@@ -157,6 +157,12 @@ namespace capu
          */
         status_t flush();
 
+        /**
+         * Flushes the stream and makes the operating system write the file to the device
+         * @return CAPU_OK if the file was written, CAPU_ERROR otherwise
+         */
+        status_t sync();
+
         /**
          * Close the stream.
          *@return
@@ -251,6 +257,13 @@ namespace capu
         return capu::os::arch::File::flush();
     }
 
+    inline
+    status_t
+    File::sync()
+    {
+        return capu::os::arch::File::sync();
+    }
+
     inline
     status_t
     File::close()
@@ -44,6 +44,7 @@ namespace capu
             using capu::posix::File::seek;
             using capu::posix::File::getCurrentPosition;
             using capu::posix::File::flush;
+            using capu::posix::File::sync;
             using capu::posix::File::renameTo;
             using capu::posix::File::createFile;
             using capu::posix::File::createDirectory;
@@ -28,6 +28,7 @@ namespace capu
         public:
             using capu::posix::Time::GetMilliseconds;
             using capu::posix::Time::GetMicroseconds;
+            using capu::posix::Time::GetMonotonicNanoseconds;
         };
     }
 }
@@ -36,6 +36,7 @@ namespace capu
             using capu::posix::File::seek;
             using capu::posix::File::getCurrentPosition;
             using capu::posix::File::flush;
+            using capu::posix::File::sync;
             using capu::posix::File::close;
             using capu::posix::File::createFile;
             using capu::posix::File::createDirectory;
@@ -19,6 +19,7 @@
 
 #include <mach/clock.h>
 #include <mach/mach.h>
+#include <mach/mach_time.h>
 
 namespace capu
 {
@@ -29,6 +30,7 @@ namespace capu
         public:
             static uint64_t GetMilliseconds();
             static uint64_t GetMicroseconds();
+            static uint64_t GetMonotonicNanoseconds();
         private:
             static void getTimeInternal(mach_timespec_t& ts);
             static uint64_t getMultipliedTime(const uint_t& secondsFactor, const uint_t& nanosecondsFactor);
@@ -48,6 +50,18 @@ namespace capu
             return getMultipliedTime(microsecondsPerSecond, nanosecondsPerMicrosecond);
         }
 
+        inline uint64_t Time::GetMonotonicNanoseconds()
+        {
+            static mach_timebase_info_data_t timebase = { 0, 0 };
+            if (timebase.denom == 0)
+            {
+                mach_timebase_info(&timebase);
+            }
+            const uint64_t ticks = mach_absolute_time();
+            // split up to avoid an overflow for big numerators
+            return (ticks / timebase.denom) * timebase.numer + (ticks % timebase.denom) * timebase.numer / timebase.denom;
+        }
+
         inline void Time::getTimeInternal(mach_timespec_t& ts)
         {
             clock_serv_t cl;
@@ -20,6 +20,7 @@
 #include "capu/os/Socket.h"
 #include "capu/util/Delegate.h"
 #include "capu/container/Pair.h"
+#include "capu/container/vector.h"
 
 #include CAPU_PLATFORM_INCLUDE(NonBlockSocketChecker)
 
@@ -41,6 +41,7 @@ namespace capu
             using generic::File::seek;
             status_t getCurrentPosition(uint_t& position) const;
             status_t flush();
+            status_t sync();
             status_t close();
             status_t renameTo(const capu::String& newName);
             status_t createFile();
@@ -302,6 +303,17 @@ namespace capu
             return CAPU_ERROR;
         }
 
+        inline
+        status_t
+        File::sync()
+        {
+            if (mHandle != NULL && fflush(mHandle) == 0 && fsync(fileno(mHandle)) == 0)
+            {
+                return CAPU_OK;
+            }
+            return CAPU_ERROR;
+        }
+
         inline
         status_t
         File::close()
@@ -28,6 +28,7 @@ namespace capu
         public:
             static uint64_t GetMilliseconds();
             static uint64_t GetMicroseconds();
+            static uint64_t GetMonotonicNanoseconds();
         };
 
         inline uint64_t Time::GetMilliseconds()
@@ -45,6 +46,16 @@ namespace capu
             }
             return static_cast<uint64_t>(currentTime.tv_sec) * 1000000ULL + static_cast<uint64_t>(currentTime.tv_nsec) / 1000ULL;
         }
+
+        inline uint64_t Time::GetMonotonicNanoseconds()
+        {
+            struct timespec currentTime;
+            if (clock_gettime(CLOCK_MONOTONIC, &currentTime) != 0)
+            {
+                return 0;
+            }
+            return static_cast<uint64_t>(currentTime.tv_sec) * 1000000000ULL + static_cast<uint64_t>(currentTime.tv_nsec);
+        }
     }
 }
 
@@ -38,6 +38,11 @@ namespace capu
          * CAUTION: This is not guaranteed to represent a specific absolute time, only use this for relative timing!
          */
         static uint64_t GetMicroseconds();
+        /**
+         * Get a monotonic nanoseconds counter which is not affected by changes of the system time.
+         * CAUTION: This does not represent a specific absolute time, only use this for relative timing!
+         */
+        static uint64_t GetMonotonicNanoseconds();
     };
 
     inline
@@ -53,6 +58,13 @@ namespace capu
     {
         return capu::os::arch::Time::GetMicroseconds();
     }
+
+    inline
+    uint64_t
+    Time::GetMonotonicNanoseconds()
+    {
+        return capu::os::arch::Time::GetMonotonicNanoseconds();
+    }
 }
 #endif //CAPU_TIME_H
 
@@ -20,6 +20,7 @@
 #include "capu/os/Generic/File.h"
 #include "capu/os/FileMode.h"
 #include "MinimalWindowsH.h"
+#include <io.h>
 
 
 namespace capu
@@ -39,6 +40,7 @@ namespace capu
             using generic::File::seek;
             status_t getCurrentPosition(uint_t& position) const;
             status_t flush();
+            status_t sync();
             status_t close();
             status_t renameTo(const capu::String& newPath);
             status_t copyTo(const capu::String& otherPath);
@@ -317,6 +319,17 @@ namespace capu
             return CAPU_ERROR;
         }
 
+        inline
+        status_t
+        File::sync()
+        {
+            if (mHandle != NULL && fflush(mHandle) == 0 && _commit(_fileno(mHandle)) == 0)
+            {
+                return CAPU_OK;
+            }
+            return CAPU_ERROR;
+        }
+
         inline
         status_t
         File::close()
@@ -30,6 +30,7 @@ namespace capu
         public:
             static uint64_t GetMilliseconds();
             static uint64_t GetMicroseconds();
+            static uint64_t GetMonotonicNanoseconds();
         };
 
     }
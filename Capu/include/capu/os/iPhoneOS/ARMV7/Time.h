@@ -31,6 +31,7 @@ namespace capu
             public:
                 using capu::iphoneos::Time::GetMilliseconds;
                 using capu::iphoneos::Time::GetMicroseconds;
+                using capu::iphoneos::Time::GetMonotonicNanoseconds;
             };
         }
     }
@@ -36,6 +36,7 @@ namespace capu
                 using capu::os::File::seek;
                 using capu::os::File::getCurrentPosition;
                 using capu::os::File::flush;
+                using capu::os::File::sync;
                 using capu::os::File::close;
                 using capu::os::File::createFile;
                 using capu::os::File::createDirectory;
@@ -28,6 +28,7 @@ namespace capu
         public:
             using capu::os::Time::GetMilliseconds;
             using capu::os::Time::GetMicroseconds;
+            using capu::os::Time::GetMonotonicNanoseconds;
         };
     }
 }
@@ -38,6 +38,7 @@ namespace capu
                 using capu::iphoneos::File::seek;
                 using capu::iphoneos::File::getCurrentPosition;
                 using capu::iphoneos::File::flush;
+                using capu::iphoneos::File::sync;
                 using capu::iphoneos::File::close;
                 using capu::iphoneos::File::createFile;
                 using capu::iphoneos::File::createDirectory;
@@ -122,7 +122,11 @@ namespace capu
         return MoveRawHelper<InputIt, OutputIt, T,
             std::is_same<InputItCategory, random_access_iterator_tag>::value &&
             std::is_same<OutputItCategory, random_access_iterator_tag>::value &&
+#ifdef CAPU_LIMITED_TRAIT_SUPPORT
             std::is_pod<T>::value
+#else
+            std::is_trivially_copyable<T>::value
+#endif
             >::move(first, last, dest);
     }
 
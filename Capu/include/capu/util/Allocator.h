@@ -17,8 +17,18 @@
 #ifndef CAPU_ALLOCATOR_H
 #define CAPU_ALLOCATOR_H
 
+#include "capu/Config.h"
+#include <new>
+
 namespace capu
 {
+    /**
+     * Allocator which uses the global heap.
+     *
+     * Single elements are returned constructed by allocate() and destroyed by deallocate().
+     * Arrays as used by containers are returned as uninitialized memory by allocateArray(), the
+     * container constructs and destroys the elements itself.
+     */
     template<typename T>
     class Allocator
     {
@@ -27,6 +37,20 @@ namespace capu
         T* allocate();
         void deallocate(T*& element);
 
+        /**
+         * Allocates uninitialized memory for a number of elements.
+         * @param count the number of elements, must not be 0
+         * @return pointer to the memory
+         */
+        T* allocateArray(uint_t count);
+
+        /**
+         * Releases memory allocated by allocateArray.
+         * @param memory the memory to release, may be 0
+         * @param count the number of elements which was passed to allocateArray
+         */
+        void deallocateArray(T* memory, uint_t count);
+
     protected:
     private:
     };
@@ -44,6 +68,18 @@ namespace capu
         element = 0;
     }
 
+    template<typename T>
+    inline T* Allocator<T>::allocateArray(uint_t count)
+    {
+        return reinterpret_cast<T*>(new Byte[sizeof(T) * count]);
+    }
+
+    template<typename T>
+    inline void Allocator<T>::deallocateArray(T* memory, uint_t /*count*/)
+    {
+        delete[] reinterpret_cast<Byte*>(memory);
+    }
+
 }
 
 #endif // CAPU_Allocator_H
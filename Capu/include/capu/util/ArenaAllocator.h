@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_ARENAALLOCATOR_H
+#define CAPU_ARENAALLOCATOR_H
+
+#include "capu/Config.h"
+#include <new>
+
+namespace capu
+{
+    /**
+     * Bump memory arena. Memory is handed out by advancing a pointer through a block and is only
+     * given back all at once by reset(). If the first block is exhausted, further blocks are taken
+     * from the heap; they are released on reset() so the arena settles on its initial block.
+     *
+     * Intended for short lived scratch data, e.g. containers which are filled and dropped every frame.
+     * The arena is not thread-safe.
+     */
+    class Arena
+    {
+    public:
+        /**
+         * Constructor.
+         * @param capacity the size of the initial block in bytes
+         */
+        explicit Arena(uint_t capacity);
+
+        /**
+         * Destructor. Releases all blocks, objects in the arena are not destroyed.
+         */
+        ~Arena();
+
+        /**
+         * Allocates memory from the arena.
+         * @param size the number of bytes
+         * @param alignment the alignment of the memory, must be a power of two
+         * @return pointer to the memory
+         */
+        void* allocate(uint_t size, uint_t alignment);
+
+        /**
+         * Gives back memory if it was the last allocation, otherwise the memory is kept until reset().
+         * Allows a container which grows in the arena to reuse the space of its previous buffer.
+         * @param memory the memory returned by allocate
+         * @param size the size which was passed to allocate
+         */
+        void deallocate(void* memory, uint_t size);
+
+        /**
+         * Makes all memory of the arena available again and releases additional blocks.
+         * Objects in the arena must not be used afterwards.
+         */
+        void reset();
+
+        /**
+         * @return the number of bytes currently allocated from the arena
+         */
+        uint_t getUsedSize() const;
+
+        /**
+         * @return the number of additional blocks which had to be taken from the heap since the last reset
+         */
+        uint_t getOverflowBlockCount() const;
+
+    private:
+        struct Block
+        {
+            Block* previous;
+            Byte* end;
+        };
+
+        static Block* CreateBlock(uint_t capacity, Block* previous);
+        static Byte* GetBlockData(Block* block);
+
+        const uint_t mCapacity;
+        Block* mFirstBlock;
+        Block* mCurrentBlock;
+        Byte* mCurrent;
+        uint_t mUsedSize;
+        uint_t mOverflowBlockCount;
+
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+    };
+
+    /**
+     * Allocator which takes its memory from an Arena, usable for vector and String.
+     * Copies of the allocator share the same arena.
+     */
+    template<typename T>
+    class ArenaAllocator
+    {
+    public:
+        /**
+         * Constructor.
+         * @param arena the arena to allocate from, must outlive all allocations
+         */
+        explicit ArenaAllocator(Arena& arena);
+
+        T* allocate();
+        void deallocate(T*& element);
+
+        T* allocateArray(uint_t count);
+        void deallocateArray(T* memory, uint_t count);
+
+        /**
+         * @return the arena of the allocator
+         */
+        Arena& getArena() const;
+
+    private:
+        Arena* mArena;
+    };
+
+    inline Arena::Arena(uint_t capacity)
+        : mCapacity(capacity)
+        , mFirstBlock(CreateBlock(capacity, 0))
+        , mCurrentBlock(mFirstBlock)
+        , mCurrent(GetBlockData(mFirstBlock))
+        , mUsedSize(0)
+        , mOverflowBlockCount(0)
+    {
+    }
+
+    inline Arena::~Arena()
+    {
+        reset();
+        delete[] reinterpret_cast<Byte*>(mFirstBlock);
+    }
+
+    inline void* Arena::allocate(uint_t size, uint_t alignment)
+    {
+        const uint_t misalignment = reinterpret_cast<uint_t>(mCurrent) & (alignment - 1);
+        Byte* result = mCurrent + (misalignment ? alignment - misalignment : 0);
+        if (result + size > mCurrentBlock->end)
+        {
+            // the new block is large enough for this allocation in any case
+            const uint_t blockCapacity = (size + alignment > mCapacity) ? size + alignment : mCapacity;
+            mCurrentBlock = CreateBlock(blockCapacity, mCurrentBlock);
+            ++mOverflowBlockCount;
+            mCurrent = GetBlockData(mCurrentBlock);
+            return allocate(size, alignment);
+        }
+
+        mUsedSize += (result + size) - mCurrent;
+        mCurrent = result + size;
+        return result;
+    }
+
+    inline void Arena::deallocate(void* memory, uint_t size)
+    {
+        Byte* bytes = static_cast<Byte*>(memory);
+        if (bytes && bytes + size == mCurrent)
+        {
+            mCurrent = bytes;
+            mUsedSize -= size;
+        }
+    }
+
+    inline void Arena::reset()
+    {
+        while (mCurrentBlock != mFirstBlock)
+        {
+            Block* previous = mCurrentBlock->previous;
+            delete[] reinterpret_cast<Byte*>(mCurrentBlock);
+            mCurrentBlock = previous;
+        }
+        mCurrent = GetBlockData(mFirstBlock);
+        mUsedSize = 0;
+        mOverflowBlockCount = 0;
+    }
+
+    inline uint_t Arena::getUsedSize() const
+    {
+        return mUsedSize;
+    }
+
+    inline uint_t Arena::getOverflowBlockCount() const
+    {
+        return mOverflowBlockCount;
+    }
+
+    inline Arena::Block* Arena::CreateBlock(uint_t capacity, Block* previous)
+    {
+        Block* block = reinterpret_cast<Block*>(new Byte[sizeof(Block) + capacity]);
+        block->previous = previous;
+        block->end = GetBlockData(block) + capacity;
+        return block;
+    }
+
+    inline Byte* Arena::GetBlockData(Block* block)
+    {
+        return reinterpret_cast<Byte*>(block + 1);
+    }
+
+    template<typename T>
+    inline ArenaAllocator<T>::ArenaAllocator(Arena& arena)
+        : mArena(&arena)
+    {
+    }
+
+    template<typename T>
+    inline T* ArenaAllocator<T>::allocate()
+    {
+        return new(mArena->allocate(sizeof(T), alignof(T))) T();
+    }
+
+    template<typename T>
+    inline void ArenaAllocator<T>::deallocate(T*& element)
+    {
+        if (element)
+        {
+            element->~T();
+            mArena->deallocate(element, sizeof(T));
+            element = 0;
+        }
+    }
+
+    template<typename T>
+    inline T* ArenaAllocator<T>::allocateArray(uint_t count)
+    {
+        return static_cast<T*>(mArena->allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    template<typename T>
+    inline void ArenaAllocator<T>::deallocateArray(T* memory, uint_t count)
+    {
+        mArena->deallocate(memory, sizeof(T) * count);
+    }
+
+    template<typename T>
+    inline Arena& ArenaAllocator<T>::getArena() const
+    {
+        return *mArena;
+    }
+}
+
+#endif // CAPU_ARENAALLOCATOR_H
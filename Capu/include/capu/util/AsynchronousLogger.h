@@ -19,49 +19,194 @@
 
 #include "capu/util/Logger.h"
 #include "capu/os/Thread.h"
-#include "capu/container/BlockingQueue.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/CondVar.h"
+#include "capu/os/LightweightMutex.h"
 #include "capu/util/ILogAppender.h"
 #include "capu/util/LogMessage.h"
+#include "capu/util/ScopedPointer.h"
 
 namespace capu
 {
+    /**
+     * Behavior of an AsynchronousLogger if all message slots are in use
+     */
+    enum EOverflowPolicy
+    {
+        /**
+         * The log statement waits for a free slot
+         */
+        OVERFLOW_BLOCK,
+
+        /**
+         * The log statement is dropped without formatting it
+         */
+        OVERFLOW_DROP_NEWEST,
+
+        /**
+         * The oldest message which is not output yet is dropped to make room
+         */
+        OVERFLOW_DROP_OLDEST
+    };
+
      /**
      * Outputs LogMessages in a separate Thread
+     * Log statements format directly into a preallocated ring of message slots, the
+     * memory of a slot is reused for later messages. The output thread sleeps until
+     * messages are available and outputs all available messages at once.
      */
     class AsynchronousLogger: public Logger, private Runnable
     {
     public:
         
         /**
-         * Constructor of AsynchronousConsoleLogAppender
+         * Constructor of AsynchronousLogger
          * The output thread is started immediately 
+         * @param appender to use for logging
+         * @param overflowPolicy behavior if all slots are in use
+         * @param capacity number of message slots, rounded up to a power of two
          */
-        AsynchronousLogger(ILogAppender& appender);
+        AsynchronousLogger(ILogAppender& appender, EOverflowPolicy overflowPolicy = OVERFLOW_BLOCK, uint32_t capacity = 1024);
 
         /**
-         * Destructor of AsynchronousConsoleLogAppender
+         * Destructor of AsynchronousLogger
+         * Outputs all pending messages before it returns
          */
         virtual ~AsynchronousLogger();
 
         /**
          * @name Asynchronous implementation of log method
+         * Copies the message into a slot
          * @see Logger
          */
         virtual void log(const LogMessage& message) override;
 
+        /**
+         * @name Provides a free slot to the log statement
+         * A statement which is made while the same thread formats another one, e.g. in an
+         * operator<< which logs, never waits for a slot. It is dropped if all slots are in use.
+         * @see Logger
+         */
+        virtual bool claimMessage(const LogContext& context, ELogLevel logLevel, LogMessage*& message) override;
+
+        /**
+         * @name Hands the slot over to the output thread
+         * @see Logger
+         */
+        virtual void commitMessage(LogMessage& message) override;
+
+        /**
+         * Returns the number of messages which were dropped because all slots were in use
+         * @return the number of dropped messages
+         */
+        uint32_t getDroppedMessageCount() const;
+
+        /**
+         * Returns the number of log statements which had to wait for a free slot
+         * @return the number of blocked log statements
+         */
+        uint32_t getBlockedMessageCount() const;
+
     private:
 
-        typedef BlockingQueue<LogMessage> LogQueue;
+        /**
+         * Claims the slot at the end of the ring
+         * @param position receives the position of the claimed slot, or the position
+         *        which could not be claimed
+         * @return true if the slot was claimed, false if all slots are in use
+         */
+        bool claimSlot(uint_t& position);
+
+        /**
+         * Takes the committed message at the given position if it is the oldest one
+         * @param position of the message
+         * @return true if the message was taken
+         */
+        bool takeSlot(uint_t position);
+
+        /**
+         * Makes a slot which was taken by takeSlot() available again
+         * @param position of the slot
+         */
+        void freeSlot(uint_t position);
+
+        /**
+         * Returns if the thread formats a message into a slot, so waiting for a free slot could wait for itself
+         * @param threadId of the thread
+         */
+        bool hasUncommittedSlot(uint_t threadId) const;
+
+        /**
+         * Wakes up all log statements which wait for free slots
+         */
+        void wakeWaitingStatements();
+
+        /**
+         * Returns if the oldest slot holds a committed message
+         */
+        bool hasCommittedSlot() const;
+
+        /**
+         * Outputs all committed messages
+         */
+        void drain();
 
         /**
          * Thread in which the message are logged
          */
         Thread m_loggerThread;
 
+        const EOverflowPolicy m_overflowPolicy;
+        const uint_t m_capacity;
+        const uint_t m_mask;
+
+        /**
+         * Ring of message slots, the sequence number of a slot tells whether
+         * it is free or holds a message in the current round of the ring
+         */
+        ScopedArray<LogMessage> m_messages;
+        ScopedArray<Atomic<uint_t> > m_sequences;
+
+        /**
+         * Thread which formats into a slot, 0 once the message is committed
+         */
+        ScopedArray<Atomic<uint_t> > m_slotOwners;
+
+        /**
+         * Message which is output, swapped with the committed slot
+         */
+        LogMessage m_outputMessage;
+
+        /**
+         * Positions of the next slot to claim and the oldest slot to output,
+         * they are written concurrently and kept on different cache lines
+         */
+        Atomic<uint_t> m_claimPosition;
+        char m_padding1[64];
+        Atomic<uint_t> m_outputPosition;
+        char m_padding2[64];
+
+        /**
+         * Id of the output thread, which drops statements instead of waiting for itself
+         */
+        Atomic<uint_t> m_outputThreadId;
+
+        Atomic<uint32_t> m_droppedMessages;
+        Atomic<uint32_t> m_blockedMessages;
+
+        /**
+         * The output thread waits on m_committed while it sets m_outputWaiting
+         */
+        Atomic<uint32_t> m_outputWaiting;
+        LightweightMutex m_outputMutex;
+        CondVar m_committed;
+
         /**
-         * Queue with messages to log
+         * Blocked log statements wait on m_released
          */
-       LogQueue m_logQueue;
+        Atomic<uint32_t> m_waitingStatements;
+        LightweightMutex m_releaseMutex;
+        CondVar m_released;
 
         /**
          * Internal run method for the thread
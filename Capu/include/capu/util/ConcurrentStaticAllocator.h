@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_CONCURRENTSTATICALLOCATOR_H
+#define CAPU_CONCURRENTSTATICALLOCATOR_H
+
+#include "capu/Config.h"
+#include "capu/os/Atomic.h"
+#include <new>
+#include <type_traits>
+
+namespace capu
+{
+    /**
+     * Thread-safe variant of the StaticAllocator. Holds a fixed amount of memory for COUNT objects
+     * and manages it with a lock-free free list, so allocate and deallocate may be called from
+     * any thread without external locking.
+     *
+     * The head of the free list is tagged with a modification counter to prevent the ABA problem.
+     * Index and tag share one machine word, so COUNT is limited to 2^16 - 1 entries on 32 bit
+     * architectures.
+     *
+     * Threads which allocate and deallocate a lot can use a LocalCache to take entries from
+     * and return entries to the shared free list in batches.
+     */
+    template<typename T, uint32_t COUNT>
+    class ConcurrentStaticAllocator
+    {
+    public:
+        typedef T* pointer;
+        typedef const T* const_pointer;
+
+        /**
+         * Per thread cache of free entries of a ConcurrentStaticAllocator. The cache itself is
+         * not thread-safe and must only be used by one thread at a time. It refills from the
+         * allocator in batches if it runs empty and returns a batch if it holds too many entries.
+         * All cached entries are returned on destruction.
+         */
+        class LocalCache
+        {
+        public:
+            typedef T* pointer;
+            typedef const T* const_pointer;
+
+            /**
+             * Constructor.
+             * @param allocator the allocator which provides the memory
+             * @param batchSize number of entries which are moved between cache and allocator at once
+             */
+            LocalCache(ConcurrentStaticAllocator& allocator, uint32_t batchSize = 32);
+
+            /**
+             * Destructor, returns all cached entries to the allocator.
+             */
+            ~LocalCache();
+
+            pointer allocate();
+            void deallocate(pointer& ptr);
+
+            /**
+             * Checks if the given pointer is inside the managed memory of the underlying allocator.
+             * @param ptr The pointer to check.
+             * @return True if the given pointer is managed by the allocator, false otherwise.
+             */
+            bool isManagedMemory(T* ptr) const;
+
+            /**
+             * @return the number of entries currently held by the cache
+             */
+            uint32_t getCachedCount() const;
+
+        private:
+            void spill(uint32_t count);
+
+            ConcurrentStaticAllocator& mAllocator;
+            const uint32_t mBatchSize;
+            uint32_t mFirstIndex;
+            uint32_t mCount;
+
+            LocalCache(const LocalCache&);
+            LocalCache& operator=(const LocalCache&);
+        };
+
+        ConcurrentStaticAllocator();
+
+        pointer allocate();
+        void deallocate(pointer& ptr);
+
+        /**
+        * Checks if the given pointer is inside the managed memory of the allocator.
+        * @param ptr The pointer to check.
+        * @return True if the given pointer is managed by the allocator, false otherwise.
+        */
+        bool isManagedMemory(T* ptr) const;
+
+    private:
+        static const uint32_t IndexBits = sizeof(uint_t) * 4;
+        static const uint_t IndexMask = (static_cast<uint_t>(1) << IndexBits) - 1;
+        static const uint32_t InvalidIndex = static_cast<uint32_t>(IndexMask);
+
+        static_assert(COUNT > 0 && COUNT < InvalidIndex, "ConcurrentStaticAllocator COUNT is out of range");
+
+        struct MemoryEntry
+        {
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type element;
+            Atomic<uint32_t> nextFreeIndex;
+        };
+
+        static uint_t MakeHead(uint32_t index, uint_t tag);
+        static T* Construct(MemoryEntry& entry);
+        uint32_t getIndex(T* ptr) const;
+
+        /**
+         * Takes up to maxCount linked entries from the free list.
+         * @param firstIndex receives the index of the first taken entry
+         * @return the number of entries taken
+         */
+        uint32_t pop(uint32_t maxCount, uint32_t& firstIndex);
+
+        /**
+         * Puts the linked entries from firstIndex to lastIndex back to the free list.
+         */
+        void push(uint32_t firstIndex, uint32_t lastIndex);
+
+        MemoryEntry mData[COUNT];
+        Atomic<uint_t> mFreeHead;
+
+        ConcurrentStaticAllocator(const ConcurrentStaticAllocator&);
+        ConcurrentStaticAllocator& operator=(const ConcurrentStaticAllocator&);
+    };
+
+    template<typename T, uint32_t COUNT>
+    inline ConcurrentStaticAllocator<T, COUNT>::ConcurrentStaticAllocator()
+        : mFreeHead(MakeHead(0, 0))
+    {
+        for (uint32_t i = 0; i < COUNT - 1; ++i)
+        {
+            mData[i].nextFreeIndex = i + 1;
+        }
+        mData[COUNT - 1].nextFreeIndex = InvalidIndex;
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline typename ConcurrentStaticAllocator<T, COUNT>::pointer ConcurrentStaticAllocator<T, COUNT>::allocate()
+    {
+        uint32_t index = InvalidIndex;
+        if (0 == pop(1, index))
+        {
+            return 0;
+        }
+        return Construct(mData[index]);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline void ConcurrentStaticAllocator<T, COUNT>::deallocate(pointer& ptr)
+    {
+        const uint32_t index = getIndex(ptr);
+        ptr->~T();
+        ptr = 0;
+        push(index, index);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline bool ConcurrentStaticAllocator<T, COUNT>::isManagedMemory(T* ptr) const
+    {
+        // do some pointer arithmetic to check if the given ptr is inside our memory bounds
+        const MemoryEntry* toCheck = reinterpret_cast<const MemoryEntry*>(ptr);
+        return toCheck >= &mData[0] && toCheck <= &mData[COUNT - 1];
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline uint_t ConcurrentStaticAllocator<T, COUNT>::MakeHead(uint32_t index, uint_t tag)
+    {
+        return (tag << IndexBits) | (static_cast<uint_t>(index) & IndexMask);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline T* ConcurrentStaticAllocator<T, COUNT>::Construct(MemoryEntry& entry)
+    {
+        void* memory = &entry.element;
+
+// disable Visual Studio specific warning
+#if (_MSC_VER >= 1400)
+#pragma warning(disable : 4345)
+#endif
+
+        // construct object of type T at memory
+        return new(memory) T();
+
+#if (_MSC_VER >= 1400)
+#pragma warning(default : 4345)
+#endif
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline uint32_t ConcurrentStaticAllocator<T, COUNT>::getIndex(T* ptr) const
+    {
+        // the element is the first member, so the MemoryEntry is at the same position as the T*
+        return static_cast<uint32_t>(reinterpret_cast<const MemoryEntry*>(ptr) - &mData[0]);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline uint32_t ConcurrentStaticAllocator<T, COUNT>::pop(uint32_t maxCount, uint32_t& firstIndex)
+    {
+        uint_t head = mFreeHead.load();
+        for (;;)
+        {
+            const uint32_t first = static_cast<uint32_t>(head & IndexMask);
+            if (InvalidIndex == first)
+            {
+                return 0;
+            }
+
+            // walk along the list, the links may be outdated if another thread modified the list
+            // in the meantime, but then the tag of the head has changed and the exchange fails
+            uint32_t last = first;
+            uint32_t count = 1;
+            uint32_t next = mData[last].nextFreeIndex;
+            while (count < maxCount && next < COUNT)
+            {
+                last = next;
+                next = mData[last].nextFreeIndex;
+                ++count;
+            }
+            if (next >= COUNT)
+            {
+                next = InvalidIndex;
+            }
+
+            if (mFreeHead.compareExchange(head, MakeHead(next, (head >> IndexBits) + 1)))
+            {
+                firstIndex = first;
+                return count;
+            }
+        }
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline void ConcurrentStaticAllocator<T, COUNT>::push(uint32_t firstIndex, uint32_t lastIndex)
+    {
+        uint_t head = mFreeHead.load();
+        do
+        {
+            mData[lastIndex].nextFreeIndex = static_cast<uint32_t>(head & IndexMask);
+        }
+        while (!mFreeHead.compareExchange(head, MakeHead(firstIndex, (head >> IndexBits) + 1)));
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline ConcurrentStaticAllocator<T, COUNT>::LocalCache::LocalCache(ConcurrentStaticAllocator& allocator, uint32_t batchSize)
+        : mAllocator(allocator)
+        , mBatchSize(batchSize > 0 ? batchSize : 1)
+        , mFirstIndex(InvalidIndex)
+        , mCount(0)
+    {
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline ConcurrentStaticAllocator<T, COUNT>::LocalCache::~LocalCache()
+    {
+        spill(mCount);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline typename ConcurrentStaticAllocator<T, COUNT>::LocalCache::pointer ConcurrentStaticAllocator<T, COUNT>::LocalCache::allocate()
+    {
+        if (0 == mCount)
+        {
+            mCount = mAllocator.pop(mBatchSize, mFirstIndex);
+            if (0 == mCount)
+            {
+                return 0;
+            }
+        }
+
+        MemoryEntry& entry = mAllocator.mData[mFirstIndex];
+        mFirstIndex = entry.nextFreeIndex;
+        --mCount;
+        return Construct(entry);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline void ConcurrentStaticAllocator<T, COUNT>::LocalCache::deallocate(pointer& ptr)
+    {
+        const uint32_t index = mAllocator.getIndex(ptr);
+        ptr->~T();
+        ptr = 0;
+
+        mAllocator.mData[index].nextFreeIndex = mFirstIndex;
+        mFirstIndex = index;
+        ++mCount;
+
+        if (mCount >= 2 * mBatchSize)
+        {
+            spill(mBatchSize);
+        }
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline bool ConcurrentStaticAllocator<T, COUNT>::LocalCache::isManagedMemory(T* ptr) const
+    {
+        return mAllocator.isManagedMemory(ptr);
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline uint32_t ConcurrentStaticAllocator<T, COUNT>::LocalCache::getCachedCount() const
+    {
+        return mCount;
+    }
+
+    template<typename T, uint32_t COUNT>
+    inline void ConcurrentStaticAllocator<T, COUNT>::LocalCache::spill(uint32_t count)
+    {
+        if (0 == count)
+        {
+            return;
+        }
+
+        const uint32_t first = mFirstIndex;
+        uint32_t last = first;
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            last = mAllocator.mData[last].nextFreeIndex;
+        }
+        mFirstIndex = mAllocator.mData[last].nextFreeIndex;
+        mCount -= count;
+
+        mAllocator.push(first, last);
+    }
+}
+
+#endif // CAPU_CONCURRENTSTATICALLOCATOR_H
@@ -37,9 +37,20 @@ namespace capu
          */
         virtual void logMessage(const LogMessage& logMessage) override;
 
+        /**
+         * Prints all messages under one lock and flushes the console once
+         * @see ILogAppender
+         */
+        virtual void logBatch(const LogMessage* logMessages, uint_t count) override;
+
         virtual ~ConsoleLogAppender();
     private:
 
+        /**
+         * Prints a message without flushing the console
+         */
+        static void Print(const LogMessage& logMessage);
+
         /**
          * Mutex to make messages to console atomic
          */
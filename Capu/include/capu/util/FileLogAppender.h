@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_FILELOGAPPENDER_H
+#define CAPU_FILELOGAPPENDER_H
+
+#include "capu/util/LogAppenderBase.h"
+#include "capu/util/LogMessage.h"
+#include "capu/util/Runnable.h"
+#include "capu/util/ScopedPointer.h"
+#include "capu/os/File.h"
+#include "capu/os/Thread.h"
+#include "capu/os/CondVar.h"
+#include "capu/os/LightweightMutex.h"
+#include "capu/container/String.h"
+
+namespace capu
+{
+    /**
+     * Logs messages to a file
+     *
+     * Messages are formatted directly into a user space buffer, which is written to the
+     * file when it is full, after the flush interval or on flush(). An existing file is
+     * appended to.
+     *
+     * If the file would exceed the maximum size, it is renamed to <path>.1, earlier
+     * rotated files move up by one and the oldest one beyond the maximum count is removed.
+     * A compressor, if set, compresses <path>.1 in a background thread.
+     */
+    class FileLogAppender: public LogAppenderBase, private Runnable
+    {
+    public:
+
+        /**
+         * When the file is written to the device
+         */
+        enum ESyncPolicy
+        {
+            SYNC_NEVER,      // leave it to the operating system
+            SYNC_ON_ROTATE,  // before a file is rotated and when the appender is destroyed
+            SYNC_ON_FLUSH    // whenever the buffer is written to the file
+        };
+
+        /**
+         * Compresses rotated files
+         */
+        class ICompressor
+        {
+        public:
+            virtual ~ICompressor() {}
+
+            /**
+             * Writes the compressed content of a file to another file, called in the background thread
+             * @param sourcePath file to compress, removed by the appender afterwards
+             * @param targetPath file to write
+             * @return CAPU_OK if the target was written
+             */
+            virtual status_t compress(const String& sourcePath, const String& targetPath) = 0;
+
+            /**
+             * Returns the extension which is appended to compressed files, e.g. ".gz"
+             */
+            virtual const char* getExtension() const = 0;
+        };
+
+        /**
+         * Settings of a FileLogAppender
+         */
+        struct Configuration
+        {
+            /**
+             * Sets the defaults: 256 KiB buffer, flush every second, no rotation, no sync, no compression
+             */
+            Configuration();
+
+            /**
+             * Size of the user space buffer in bytes
+             */
+            uint32_t bufferSize;
+
+            /**
+             * Maximum time buffered data waits for the file, 0 to write it only when the buffer is full
+             */
+            uint32_t flushIntervalMilliseconds;
+
+            /**
+             * Size in bytes above which the file is rotated, 0 to never rotate
+             */
+            uint64_t maxFileSize;
+
+            /**
+             * Number of rotated files to keep
+             */
+            uint32_t maxRotatedFiles;
+
+            ESyncPolicy syncPolicy;
+
+            /**
+             * Compressor for rotated files, 0 to keep them uncompressed, must outlive the appender
+             */
+            ICompressor* compressor;
+        };
+
+        /**
+         * Opens the file, starts the background thread if there is a flush interval or compressor
+         * @param path of the log file
+         * @param configuration settings of the appender
+         */
+        FileLogAppender(const String& path, const Configuration& configuration = Configuration());
+
+        /**
+         * Writes all buffered messages and closes the file
+         */
+        virtual ~FileLogAppender();
+
+        /**
+         * @name log implementation of FileLogAppender
+         * @see LogAppenderBase
+         */
+        virtual void logMessage(const LogMessage& logMessage) override;
+
+        /**
+         * Buffers all messages under one lock
+         * @see ILogAppender
+         */
+        virtual void logBatch(const LogMessage* logMessages, uint_t count) override;
+
+        /**
+         * Writes the buffered messages to the file
+         */
+        void flush();
+
+        /**
+         * Returns if the file could be opened, messages are dropped otherwise
+         */
+        bool isOpen() const;
+
+        /**
+         * Returns the path of a rotated file without compression extension
+         * @param index of the rotated file, 1 for the newest one
+         */
+        String getRotatedPath(uint32_t index) const;
+
+    private:
+
+        /**
+         * Appends a message to the buffer, rotates the file first if the message does not fit into it
+         */
+        void writeMessage(const LogMessage& logMessage);
+
+        /**
+         * Appends data to the buffer, writes the buffer to the file first if it is full
+         */
+        void append(const char* data, uint32_t length);
+
+        /**
+         * Writes the buffer to the file and syncs it if the policy says so
+         */
+        void writeBuffer();
+
+        /**
+         * Opens the file for appending
+         */
+        void openFile();
+
+        /**
+         * Closes the file, renames the rotated files and opens a new one
+         */
+        void rotate();
+
+        /**
+         * Renames a rotated file with or without compression extension
+         */
+        void renameRotatedFile(uint32_t from, uint32_t to);
+
+        /**
+         * Removes a rotated file with and without compression extension
+         */
+        void removeRotatedFile(uint32_t index);
+
+        /**
+         * Background thread, flushes after the interval and compresses rotated files
+         */
+        virtual void run() override;
+
+        const String m_path;
+        const Configuration m_configuration;
+
+        File m_file;
+        bool m_isOpen;
+
+        /**
+         * Bytes in the file, without the buffered ones
+         */
+        uint64_t m_fileSize;
+
+        ScopedArray<char> m_buffer;
+        const uint32_t m_bufferSize;
+        uint32_t m_bufferedBytes;
+
+        /**
+         * Monotonic time in milliseconds when the oldest buffered byte was appended
+         */
+        uint64_t m_bufferedSince;
+
+        /**
+         * Guards everything above, the background thread waits on m_workAvailable
+         */
+        LightweightMutex m_mutex;
+        CondVar m_workAvailable;
+
+        /**
+         * True while <path>.1 waits for compression, rotation waits on m_compressionDone until it is compressed
+         */
+        bool m_compressionPending;
+        CondVar m_compressionDone;
+
+        Thread m_workerThread;
+
+        FileLogAppender(const FileLogAppender&);
+        FileLogAppender& operator=(const FileLogAppender&);
+    };
+}
+
+#endif // CAPU_FILELOGAPPENDER_H
@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_FUTURE_H
+#define CAPU_FUTURE_H
+
+#include "capu/Config.h"
+#include "capu/Error.h"
+#include "capu/container/vector.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/CondVar.h"
+#include "capu/os/LightweightMutex.h"
+#include "capu/util/Runnable.h"
+#include "capu/util/shared_ptr.h"
+#include <utility>
+
+namespace capu
+{
+    class ThreadPool;
+
+    namespace internal
+    {
+        class FutureStateBase;
+
+        /**
+         * Continuation of a future which receives the value of the future before it is run
+         */
+        class FutureContinuation : public Runnable
+        {
+        public:
+            virtual void takeArgument(const FutureStateBase& antecedent) = 0;
+        };
+
+        /**
+         * Completion state which is shared by a Future and the one who provides its value
+         */
+        class FutureStateBase
+        {
+        public:
+            /**
+             * @param pool the pool which runs the continuations, may be 0 to run them in the completing thread
+             */
+            explicit FutureStateBase(ThreadPool* pool);
+            virtual ~FutureStateBase();
+
+            bool isReady() const;
+
+            /**
+             * Waits until the state is ready
+             * @param timeoutMillis maximum time to wait, 0 waits forever
+             * @return CAPU_OK if ready, CAPU_ETIMEOUT if the timeout elapsed
+             */
+            status_t wait(uint32_t timeoutMillis) const;
+
+            /**
+             * Runs the continuation on the pool once the state is ready, immediately if it is ready already
+             */
+            void addContinuation(const shared_ptr<FutureContinuation>& continuation);
+
+            ThreadPool* getPool() const;
+
+        protected:
+            status_t setReady();
+
+        private:
+            void schedule(const shared_ptr<FutureContinuation>& continuation);
+
+            ThreadPool* mPool;
+            Atomic<uint32_t> mReady;
+            mutable LightweightMutex mMutex;
+            mutable CondVar mReadyCondition;
+            vector<shared_ptr<FutureContinuation> > mContinuations;
+
+            FutureStateBase(const FutureStateBase&);
+            FutureStateBase& operator=(const FutureStateBase&);
+        };
+
+        template<typename T>
+        class FutureState : public FutureStateBase
+        {
+        public:
+            explicit FutureState(ThreadPool* pool)
+                : FutureStateBase(pool)
+                , mValueClaimed(0)
+                , mValue()
+            {
+            }
+
+            status_t setValue(const T& value)
+            {
+                // only the thread which claims the value writes it, readers wait for setReady
+                uint32_t unclaimed = 0;
+                if (!mValueClaimed.compareExchange(unclaimed, 1))
+                {
+                    return CAPU_ERROR;
+                }
+                mValue = value;
+                return setReady();
+            }
+
+            const T& getValue() const
+            {
+                return mValue;
+            }
+
+        private:
+            Atomic<uint32_t> mValueClaimed;
+            T mValue;
+        };
+
+        template<>
+        class FutureState<void> : public FutureStateBase
+        {
+        public:
+            explicit FutureState(ThreadPool* pool)
+                : FutureStateBase(pool)
+            {
+            }
+
+            status_t setValue()
+            {
+                return setReady();
+            }
+
+            void getValue() const
+            {
+            }
+        };
+
+        /**
+         * Calls a function and stores its result in a FutureState
+         */
+        template<typename R>
+        struct FutureInvoker
+        {
+            template<typename F>
+            static void Run(FutureState<R>& state, F& function)
+            {
+                state.setValue(function());
+            }
+
+            template<typename F, typename A>
+            static void Run(FutureState<R>& state, F& function, const A& argument)
+            {
+                state.setValue(function(argument));
+            }
+        };
+
+        template<>
+        struct FutureInvoker<void>
+        {
+            template<typename F>
+            static void Run(FutureState<void>& state, F& function)
+            {
+                function();
+                state.setValue();
+            }
+
+            template<typename F, typename A>
+            static void Run(FutureState<void>& state, F& function, const A& argument)
+            {
+                function(argument);
+                state.setValue();
+            }
+        };
+
+        /**
+         * Value of a completed future which is passed on to its continuation
+         */
+        template<typename T>
+        class ContinuationArgument
+        {
+        public:
+            ContinuationArgument()
+                : mValue()
+            {
+            }
+
+            void take(const FutureState<T>& antecedent)
+            {
+                mValue = antecedent.getValue();
+            }
+
+            template<typename R, typename F>
+            void call(FutureState<R>& state, F& function) const
+            {
+                FutureInvoker<R>::Run(state, function, mValue);
+            }
+
+        private:
+            Atomic<uint32_t> mValueClaimed;
+            T mValue;
+        };
+
+        template<>
+        class ContinuationArgument<void>
+        {
+        public:
+            void take(const FutureState<void>&)
+            {
+            }
+
+            template<typename R, typename F>
+            void call(FutureState<R>& state, F& function) const
+            {
+                FutureInvoker<R>::Run(state, function);
+            }
+        };
+
+        template<typename T>
+        struct FutureValue
+        {
+            typedef const T& ConstReference;
+        };
+
+        template<>
+        struct FutureValue<void>
+        {
+            typedef void ConstReference;
+        };
+
+        template<typename F>
+        struct FunctionResult
+        {
+            typedef decltype(std::declval<F&>()()) Type;
+        };
+
+        template<typename F, typename T>
+        struct ContinuationResult
+        {
+            typedef decltype(std::declval<F&>()(std::declval<const T&>())) Type;
+        };
+
+        template<typename F>
+        struct ContinuationResult<F, void>
+        {
+            typedef decltype(std::declval<F&>()()) Type;
+        };
+
+        /**
+         * Runnable which calls a function and is the state of the future for its result at the same time,
+         * so both take a single allocation
+         */
+        template<typename F, typename R>
+        class FutureTask : public Runnable, public FutureState<R>
+        {
+        public:
+            FutureTask(ThreadPool* pool, const F& function)
+                : FutureState<R>(pool)
+                , mFunction(function)
+            {
+            }
+
+            void run() override
+            {
+                FutureInvoker<R>::Run(*this, mFunction);
+            }
+
+        private:
+            F mFunction;
+        };
+
+        /**
+         * Continuation which calls a function with the value of the previous future
+         */
+        template<typename F, typename T, typename R>
+        class ContinuationTask : public FutureContinuation, public FutureState<R>
+        {
+        public:
+            ContinuationTask(ThreadPool* pool, const F& function)
+                : FutureState<R>(pool)
+                , mFunction(function)
+            {
+            }
+
+            void takeArgument(const FutureStateBase& antecedent) override
+            {
+                mArgument.take(static_cast<const FutureState<T>&>(antecedent));
+            }
+
+            void run() override
+            {
+                mArgument.call(*this, mFunction);
+            }
+
+        private:
+            F mFunction;
+            ContinuationArgument<T> mArgument;
+        };
+    }
+
+    /**
+     * Result of work which completes asynchronously, e.g. a function submitted to a ThreadPool.
+     * Copies of a future share the same result.
+     *
+     * T must be default constructible and copyable or void.
+     * Waiting for a future inside a pool thread blocks the thread, chain dependent work with then() instead.
+     */
+    template<typename T>
+    class Future
+    {
+    public:
+        /**
+         * Creates an invalid future which never gets a value
+         */
+        Future();
+
+        explicit Future(const shared_ptr<internal::FutureState<T> >& state);
+
+        /**
+         * @return true if the future is connected to a result, false e.g. if submitting the work failed
+         */
+        bool isValid() const;
+
+        /**
+         * @return true if the result is available
+         */
+        bool isReady() const;
+
+        /**
+         * Waits until the result is available
+         * @return CAPU_OK if the result is available, CAPU_EINVAL if the future is invalid
+         */
+        status_t wait() const;
+
+        /**
+         * Waits until the result is available or the timeout elapsed
+         * @param timeoutMillis maximum time to wait, 0 only checks
+         * @return CAPU_OK if the result is available, CAPU_ETIMEOUT if not, CAPU_EINVAL if the future is invalid
+         */
+        status_t waitFor(uint32_t timeoutMillis) const;
+
+        /**
+         * Waits for the result and returns it. The future must be valid.
+         * @return the result
+         */
+        typename internal::FutureValue<T>::ConstReference get() const;
+
+        /**
+         * Chains a function which gets called with the result as soon as it is available. The function runs
+         * on the pool which computes this future. Futures without pool, e.g. from a Promise without pool,
+         * run it in the thread which provides the result.
+         * @param function function which is called with the result, or without arguments for Future<void>
+         * @return future for the result of the function
+         */
+        template<typename F>
+        Future<typename internal::ContinuationResult<F, T>::Type> then(const F& function) const;
+
+    private:
+        shared_ptr<internal::FutureState<T> > mState;
+    };
+
+    /**
+     * Provides the value for a Future from any thread. The value can only be set once.
+     */
+    template<typename T>
+    class Promise
+    {
+    public:
+        /**
+         * @param pool the pool which runs the continuations of the future, 0 to run them in the thread which sets the value
+         */
+        explicit Promise(ThreadPool* pool = 0);
+
+        /**
+         * @return the future which receives the value
+         */
+        Future<T> getFuture() const;
+
+        /**
+         * Sets the value and wakes up all waiting threads. Takes no argument for Promise<void>.
+         * @return CAPU_OK if the value was set, CAPU_ERROR if a value was already set
+         */
+        template<typename... Args>
+        status_t setValue(Args&&... args);
+
+    private:
+        shared_ptr<internal::FutureState<T> > mState;
+    };
+
+    template<typename T>
+    inline Future<T>::Future()
+    {
+    }
+
+    template<typename T>
+    inline Future<T>::Future(const shared_ptr<internal::FutureState<T> >& state)
+        : mState(state)
+    {
+    }
+
+    template<typename T>
+    inline bool Future<T>::isValid() const
+    {
+        return mState;
+    }
+
+    template<typename T>
+    inline bool Future<T>::isReady() const
+    {
+        return mState && mState->isReady();
+    }
+
+    template<typename T>
+    inline status_t Future<T>::wait() const
+    {
+        if (!mState)
+        {
+            return CAPU_EINVAL;
+        }
+        return mState->wait(0);
+    }
+
+    template<typename T>
+    inline status_t Future<T>::waitFor(uint32_t timeoutMillis) const
+    {
+        if (!mState)
+        {
+            return CAPU_EINVAL;
+        }
+        if (timeoutMillis == 0)
+        {
+            return mState->isReady() ? CAPU_OK : CAPU_ETIMEOUT;
+        }
+        return mState->wait(timeoutMillis);
+    }
+
+    template<typename T>
+    inline typename internal::FutureValue<T>::ConstReference Future<T>::get() const
+    {
+        mState->wait(0);
+        return mState->getValue();
+    }
+
+    template<typename T>
+    template<typename F>
+    inline Future<typename internal::ContinuationResult<F, T>::Type> Future<T>::then(const F& function) const
+    {
+        typedef typename internal::ContinuationResult<F, T>::Type R;
+        if (!mState)
+        {
+            return Future<R>();
+        }
+        shared_ptr<internal::ContinuationTask<F, T, R> > task = capu::make_shared<internal::ContinuationTask<F, T, R> >(mState->getPool(), function);
+        mState->addContinuation(task);
+        return Future<R>(task);
+    }
+
+    template<typename T>
+    inline Promise<T>::Promise(ThreadPool* pool)
+        : mState(capu::make_shared<internal::FutureState<T> >(pool))
+    {
+    }
+
+    template<typename T>
+    inline Future<T> Promise<T>::getFuture() const
+    {
+        return Future<T>(mState);
+    }
+
+    template<typename T>
+    template<typename... Args>
+    inline status_t Promise<T>::setValue(Args&&... args)
+    {
+        return mState->setValue(std::forward<Args>(args)...);
+    }
+}
+
+#endif // CAPU_FUTURE_H
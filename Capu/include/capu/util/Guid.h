@@ -309,5 +309,17 @@ namespace capu
             return HashCalculator<uint_t>::Hash(&key.getGuidData(), sizeof(generic_uuid_t), bitsize);
         }
     };
+
+    /**
+     * Specialization of FastHasher which hashes the uuid data of the Guid
+     */
+    template<>
+    struct FastHasher<capu::Guid, CAPU_TYPE_CLASS>
+    {
+        static uint64_t Hash(const Guid& key)
+        {
+            return internal::FastHashBytes(&key.getGuidData(), sizeof(generic_uuid_t));
+        }
+    };
 }
 #endif //CAPU_GUID_H
@@ -25,21 +25,26 @@ namespace capu
     /**
     * Allocator class that has a defined amount of static memory. If the memory is exhausted, dynamic memory is allocated, which is the
     * hybrid approach. As soon as static memory is available after a deallocation, it will get reused.
+    * The static part can be exchanged, e.g. use a ConcurrentStaticAllocator to get a thread-safe HybridAllocator.
+    * The static memory only holds single elements, arrays are always allocated dynamically.
     */
-    template<class T, uint32_t COUNT>
+    template<class T, uint32_t COUNT, class STATIC_ALLOCATOR = StaticAllocator<T, COUNT> >
     class HybridAllocator
     {
     public:
         T* allocate();
         void deallocate(T*& ptr);
 
+        T* allocateArray(uint_t count);
+        void deallocateArray(T* memory, uint_t count);
+
     private:
-        StaticAllocator<T, COUNT> m_staticMemory;
+        STATIC_ALLOCATOR m_staticMemory;
         Allocator<T> m_dynamicMemory;
     };
 
-    template<class T, uint32_t COUNT>
-    inline T* HybridAllocator<T, COUNT>::allocate()
+    template<class T, uint32_t COUNT, class STATIC_ALLOCATOR>
+    inline T* HybridAllocator<T, COUNT, STATIC_ALLOCATOR>::allocate()
     {
         T* element = m_staticMemory.allocate();
         if (!element)
@@ -51,8 +56,8 @@ namespace capu
         return element;
     }
 
-    template<class T, uint32_t COUNT>
-    inline void HybridAllocator<T, COUNT>::deallocate(T*& ptr)
+    template<class T, uint32_t COUNT, class STATIC_ALLOCATOR>
+    inline void HybridAllocator<T, COUNT, STATIC_ALLOCATOR>::deallocate(T*& ptr)
     {
         // call correct deallocator
         if (m_staticMemory.isManagedMemory(ptr))
@@ -64,6 +69,18 @@ namespace capu
             m_dynamicMemory.deallocate(ptr);
         }
     }
+
+    template<class T, uint32_t COUNT, class STATIC_ALLOCATOR>
+    inline T* HybridAllocator<T, COUNT, STATIC_ALLOCATOR>::allocateArray(uint_t count)
+    {
+        return m_dynamicMemory.allocateArray(count);
+    }
+
+    template<class T, uint32_t COUNT, class STATIC_ALLOCATOR>
+    inline void HybridAllocator<T, COUNT, STATIC_ALLOCATOR>::deallocateArray(T* memory, uint_t count)
+    {
+        m_dynamicMemory.deallocateArray(memory, count);
+    }
 }
 
 #endif // CAPU_HYBRIDALLOCATOR_H
@@ -18,12 +18,11 @@
 #define CAPU_ILOGAPPENDER_H
 
 #include "capu/util/LogLevel.h"
+#include "capu/util/LogMessage.h"
 #include "capu/os/Atomic.h"
 
 namespace capu
 {
-    class LogMessage;
-
     /**
      * Base class for LogAppenders. Can be used to implement additional appenders
      */
@@ -37,6 +36,14 @@ namespace capu
          */
         virtual void log(const LogMessage& logMessage) = 0;
 
+        /**
+         * Logs several messages at once, appenders can override this to
+         * write them with fewer calls. The default logs them one by one.
+         * @param logMessages array of messages to log
+         * @param count number of messages
+         */
+        virtual void logBatch(const LogMessage* logMessages, uint_t count);
+
         /**
          * Query for the log level of the appender
          * @returns the log level
@@ -59,6 +66,16 @@ namespace capu
         Atomic<int32_t> m_logLevel;
     };
 
+    inline
+    void
+    ILogAppender::logBatch(const LogMessage* logMessages, uint_t count)
+    {
+        for(uint_t i = 0; i < count; ++i)
+        {
+            log(logMessages[i]);
+        }
+    }
+
 }
 
 
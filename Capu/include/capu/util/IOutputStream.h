@@ -23,7 +23,9 @@
 namespace capu
 {
     class Guid;
-    class String;
+    template<typename T> class Allocator;
+    template<class ALLOCATOR> class BasicString;
+    typedef BasicString<Allocator<char> > String;
 
     /**
      * Interface for writing data to a stream
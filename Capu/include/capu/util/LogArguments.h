@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_LOGARGUMENTS_H
+#define CAPU_LOGARGUMENTS_H
+
+#include "capu/Config.h"
+#include "capu/os/Memory.h"
+#include "capu/container/ConstString.h"
+#include "capu/container/String.h"
+#include "capu/util/StringOutputStream.h"
+
+namespace capu
+{
+    /**
+     * Format of a deferred log statement, defined once per call site
+     * Its address identifies the statement, so records only refer to it instead of
+     * carrying the text. Every {} in the format is replaced by the next argument.
+     */
+    struct LogFormat
+    {
+        const char* format;
+        const char* file;
+        uint32_t line;
+    };
+
+    /**
+     * Arguments of a deferred log statement in binary form
+     * Each argument is stored as type tag followed by its value, strings are copied.
+     * Arguments which do not fit anymore are dropped, their placeholders stay in the text.
+     */
+    class LogArguments
+    {
+    public:
+
+        /**
+         * Maximum size of the encoded arguments in bytes
+         */
+        static const uint32_t MaxSize = 256;
+
+        LogArguments();
+
+        /**
+         * @name Appends an argument
+         * @{
+         */
+        LogArguments& operator<<(const float value);
+        LogArguments& operator<<(const double value);
+        LogArguments& operator<<(const int32_t value);
+        LogArguments& operator<<(const uint32_t value);
+        LogArguments& operator<<(const int64_t value);
+        LogArguments& operator<<(const uint64_t value);
+        LogArguments& operator<<(const int16_t value);
+        LogArguments& operator<<(const uint16_t value);
+        LogArguments& operator<<(const bool value);
+        LogArguments& operator<<(const char value);
+        LogArguments& operator<<(const char* value);
+        LogArguments& operator<<(const String& value);
+        /**
+         * @}
+         */
+
+        /**
+         * Returns the encoded arguments
+         */
+        const char* getData() const;
+
+        /**
+         * Returns the size of the encoded arguments in bytes
+         */
+        uint32_t getSize() const;
+
+        /**
+         * Writes the format with its placeholders replaced by the encoded arguments
+         * Decoding stops at the end of the data, so truncated data is safe to format.
+         * @param format with {} placeholders
+         * @param data encoded arguments
+         * @param size of data in bytes
+         * @param stream to write the text to
+         */
+        static void Format(const char* format, const char* data, uint32_t size, StringOutputStream& stream);
+
+    private:
+
+        enum ArgumentType
+        {
+            ARGUMENT_FLOAT,
+            ARGUMENT_INT32,
+            ARGUMENT_UINT32,
+            ARGUMENT_INT64,
+            ARGUMENT_UINT64,
+            ARGUMENT_INT16,
+            ARGUMENT_UINT16,
+            ARGUMENT_BOOL,
+            ARGUMENT_CHAR,
+            ARGUMENT_STRING
+        };
+
+        /**
+         * Appends the type tag and the bytes of a value if both fit
+         */
+        template<typename T>
+        void append(ArgumentType type, const T& value);
+
+        /**
+         * Appends the type tag, the length and as much of the string as fits
+         */
+        void appendString(const char* value, uint_t length);
+
+        /**
+         * Decodes the argument at data and writes it to the stream
+         * @return the size of the argument, 0 if it is incomplete
+         */
+        static uint32_t FormatArgument(const char* data, uint32_t size, StringOutputStream& stream);
+
+        char m_data[MaxSize];
+        uint32_t m_size;
+
+        /**
+         * True once an argument was dropped, later ones are dropped too
+         */
+        bool m_full;
+    };
+
+    /**
+     * Appends all arguments of a deferred log statement
+     * @{
+     */
+    inline void AppendLogArguments(LogArguments&)
+    {
+    }
+
+    template<typename T, typename... Args>
+    inline void AppendLogArguments(LogArguments& arguments, const T& first, const Args&... rest)
+    {
+        arguments << first;
+        AppendLogArguments(arguments, rest...);
+    }
+    /**
+     * @}
+     */
+
+    inline
+    LogArguments::LogArguments()
+        : m_size(0)
+        , m_full(false)
+    {
+    }
+
+    template<typename T>
+    inline
+    void
+    LogArguments::append(ArgumentType type, const T& value)
+    {
+        if(m_full || MaxSize - m_size < 1 + sizeof(T))
+        {
+            m_full = true;
+            return;
+        }
+        m_data[m_size] = static_cast<char>(type);
+        // the data is not aligned
+        Memory::Copy(m_data + m_size + 1, &value, sizeof(T));
+        m_size += static_cast<uint32_t>(1 + sizeof(T));
+    }
+
+    inline
+    void
+    LogArguments::appendString(const char* value, uint_t length)
+    {
+        const uint32_t headerSize = 1 + sizeof(uint16_t);
+        if(m_full || MaxSize - m_size < headerSize)
+        {
+            m_full = true;
+            return;
+        }
+        const uint32_t available = MaxSize - m_size - headerSize;
+        const uint16_t storedLength = static_cast<uint16_t>(length < available ? length : available);
+        m_data[m_size] = static_cast<char>(ARGUMENT_STRING);
+        Memory::Copy(m_data + m_size + 1, &storedLength, sizeof(uint16_t));
+        Memory::Copy(m_data + m_size + headerSize, value, storedLength);
+        m_size += headerSize + storedLength;
+        m_full = storedLength < length;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const float value)
+    {
+        append(ARGUMENT_FLOAT, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const double value)
+    {
+        // StringOutputStream formats floats only, so the precision of a double would not show anyway
+        append(ARGUMENT_FLOAT, static_cast<float>(value));
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const int32_t value)
+    {
+        append(ARGUMENT_INT32, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const uint32_t value)
+    {
+        append(ARGUMENT_UINT32, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const int64_t value)
+    {
+        append(ARGUMENT_INT64, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const uint64_t value)
+    {
+        append(ARGUMENT_UINT64, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const int16_t value)
+    {
+        append(ARGUMENT_INT16, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const uint16_t value)
+    {
+        append(ARGUMENT_UINT16, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const bool value)
+    {
+        append(ARGUMENT_BOOL, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const char value)
+    {
+        append(ARGUMENT_CHAR, value);
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const char* value)
+    {
+        appendString(value, ConstString(value).length());
+        return *this;
+    }
+
+    inline
+    LogArguments&
+    LogArguments::operator<<(const String& value)
+    {
+        appendString(value.c_str(), value.getLength());
+        return *this;
+    }
+
+    inline
+    const char*
+    LogArguments::getData() const
+    {
+        return m_data;
+    }
+
+    inline
+    uint32_t
+    LogArguments::getSize() const
+    {
+        return m_size;
+    }
+}
+
+#endif // CAPU_LOGARGUMENTS_H
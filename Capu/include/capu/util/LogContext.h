@@ -76,6 +76,15 @@ namespace capu
          */
         ELogLevel getLogLevel() const;
 
+        /**
+         * Returns if a statement with the given level is logged, i.e. the context
+         * is enabled and the level is at least the level of the context
+         * Reads a single word without ordering, so it is cheap enough for every log statement.
+         * @param logLevel of the statement
+         * @return true if the statement is logged
+         */
+        bool isLogLevelEnabled(ELogLevel logLevel) const;
+
         /**
          * Set the general purpose pointer
          * @param dataPtr pointer to the data being stored
@@ -101,14 +110,20 @@ namespace capu
         const String m_contextId;
 
         /**
-         * Enabled state of the LogContext
+         * Set in m_state while the context is disabled, above all log levels
          */
-        bool m_enabled;
+        static const int32_t DisabledFlag = 0x8000;
 
         /**
-         * LogLevel of context
+         * LogLevel of the context, combined with DisabledFlag
+         * A statement is logged if its level is at least the whole word.
          */
-        Atomic<int32_t> m_logLevel;
+        Atomic<int32_t> m_state;
+
+        /**
+         * Replaces the bits of m_state in mask by value
+         */
+        void updateState(int32_t mask, int32_t value);
 
         /**
          * Private assignment operator prevents misuse
@@ -121,16 +136,31 @@ namespace capu
         void* m_data;
     };
 
+    inline
+    void LogContext::updateState(int32_t mask, int32_t value)
+    {
+        int32_t state = m_state.load();
+        while(!m_state.compareExchange(state, (state & ~mask) | value))
+        {
+        }
+    }
+
     inline
     void LogContext::setLogLevel(const ELogLevel logLevel)
     {
-        m_logLevel = static_cast<int32_t>(logLevel);
+        updateState(~DisabledFlag, static_cast<int32_t>(logLevel));
     }
 
     inline
     ELogLevel LogContext::getLogLevel() const
     {
-        return static_cast<ELogLevel>(m_logLevel.load());
+        return static_cast<ELogLevel>(m_state.load() & ~DisabledFlag);
+    }
+
+    inline
+    bool LogContext::isLogLevelEnabled(ELogLevel logLevel) const
+    {
+        return static_cast<int32_t>(logLevel) >= m_state.loadRelaxed();
     }
 
     inline
@@ -151,14 +181,14 @@ namespace capu
     void 
     LogContext::setEnabled(bool enabled)
     {
-        m_enabled = enabled;
+        updateState(DisabledFlag, enabled ? 0 : DisabledFlag);
     }
 
     inline
     bool
     LogContext::isEnabled() const
     {
-        return m_enabled;
+        return (m_state.load() & DisabledFlag) == 0;
     }
 
     inline
@@ -69,6 +69,38 @@ namespace capu
          */
         ELogLevel getLogLevel() const;
 
+        /**
+         * Returns the time when the message was created
+         * @return microseconds since the epoch
+         */
+        uint64_t getTimestamp() const;
+
+        /**
+         * Sets the time of the message, e.g. when it is restored from a record
+         * @param timestamp microseconds since the epoch
+         */
+        void setTimestamp(uint64_t timestamp);
+
+        /**
+         * Prepares the message for reuse with another context and logLevel
+         * Keeps the memory of the stream and resets its formatting options
+         * @param context of the LogMessage
+         * @param logLevel of the LogMessage
+         */
+        void reset(const LogContext& context, ELogLevel logLevel);
+
+        /**
+         * Exchanges all data with another message without copying the text
+         * @param other message to swap with
+         */
+        void swap(LogMessage& other);
+
+        /**
+         * Copy constructor for LogMessage
+         * @param other LogMessage to copy
+         */
+        LogMessage(const LogMessage& other);
+
         /**
          * Assignment operator for LogMessage
          * @param other LogMessage to assign to this message
@@ -87,6 +119,11 @@ namespace capu
          */
         ELogLevel m_logLevel;
 
+        /**
+         * Creation time in microseconds since the epoch
+         */
+        uint64_t m_timestamp;
+
         /**
          * StringOutputStream for formatting the message
          */
@@ -114,6 +151,20 @@ namespace capu
     {
         return m_logLevel;
     }
+
+    inline
+    uint64_t
+    LogMessage::getTimestamp() const
+    {
+        return m_timestamp;
+    }
+
+    inline
+    void
+    LogMessage::setTimestamp(uint64_t timestamp)
+    {
+        m_timestamp = timestamp;
+    }
 }
 
 #endif // CAPU_LOGMESSAGE_H
@@ -18,26 +18,35 @@
 #define CAPU_LOGGER_H
 
 #include "capu/container/HashSet.h"
+#include "capu/container/HashTable.h"
 #include "capu/util/StringOutputStream.h"
 #include "capu/os/LightweightMutex.h"
 #include "capu/util/LogLevel.h"
 #include "capu/util/LogMessage.h"
+#include "capu/util/LogArguments.h"
 #include "capu/util/ScopedLock.h"
 #include "capu/container/vector.h"
+#include <new>
+#include <type_traits>
 
 namespace capu
 {
     class ILogAppender;
-    class String;
+    template<typename T> class Allocator;
+    template<class ALLOCATOR> class BasicString;
+    typedef BasicString<Allocator<char> > String;
     class LogContext;
     
 
 #define LOG_EXT(logger, context, logLevel, message)                     \
-        if(logLevel >= context.getLogLevel() && context.isEnabled())    \
+        if(context.isLogLevelEnabled(logLevel))                         \
         {                                                               \
-            capu::LogMessage logMessage(context, logLevel);             \
-            (logMessage.getStream() << message).flush();                \
-            logger.log(logMessage);                                     \
+            capu::LogStatement logStatement(logger, context, logLevel); \
+            if(logStatement.isActive())                                 \
+            {                                                           \
+                (logStatement.getStream() << message).flush();          \
+                logStatement.commit();                                  \
+            }                                                           \
         }
 
 #define LOG(context, logLevel, message)           \
@@ -82,6 +91,65 @@ namespace capu
 #define LOG_FATAL(context, message) \
     LOG((context), capu::LL_FATAL, message)
 
+/**
+ * Deferred log statements capture their arguments in binary form, the logger formats
+ * the text later, e.g. ThreadBufferedLogger on its sink thread. Every {} in the format
+ * is replaced by the next argument, e.g.
+ * LOG_INFO_DEFERRED(context, "frame {} took {} ms", frame, duration);
+ * Arguments can be float, double (formatted as float), the 16, 32 and 64 bit integers,
+ * bool, char, const char* and String. Strings are copied.
+ */
+#define LOG_DEFERRED_EXT(logger, context, logLevel, format, ...)                            \
+        if(context.isLogLevelEnabled(logLevel))                                             \
+        {                                                                                   \
+            static const capu::LogFormat logFormat = { format, __FILE__, __LINE__ };        \
+            capu::LogArguments logArguments;                                                \
+            capu::AppendLogArguments(logArguments, ##__VA_ARGS__);                          \
+            (logger).logDeferred(context, logLevel, logFormat, logArguments);               \
+        }
+
+#define LOG_DEFERRED(context, logLevel, format, ...)                                        \
+    {                                                                                       \
+        LOG_DEFERRED_EXT((*capu::Logger::GetDefaultLogger()), context, logLevel, format, ##__VA_ARGS__) \
+    }
+
+#define LOG_TRACE_DEFERRED_EXT(logger, context, format, ...) \
+    LOG_DEFERRED_EXT(logger, (context), capu::LL_TRACE, format, ##__VA_ARGS__)
+
+#define LOG_INFO_DEFERRED_EXT(logger, context, format, ...) \
+    LOG_DEFERRED_EXT(logger, (context), capu::LL_INFO, format, ##__VA_ARGS__)
+
+#define LOG_DEBUG_DEFERRED_EXT(logger, context, format, ...) \
+    LOG_DEFERRED_EXT(logger, (context), capu::LL_DEBUG, format, ##__VA_ARGS__)
+
+#define LOG_WARN_DEFERRED_EXT(logger, context, format, ...) \
+    LOG_DEFERRED_EXT(logger, (context), capu::LL_WARN, format, ##__VA_ARGS__)
+
+#define LOG_ERROR_DEFERRED_EXT(logger, context, format, ...) \
+    LOG_DEFERRED_EXT(logger, (context), capu::LL_ERROR, format, ##__VA_ARGS__)
+
+#define LOG_FATAL_DEFERRED_EXT(logger, context, format, ...) \
+    LOG_DEFERRED_EXT(logger, (context), capu::LL_FATAL, format, ##__VA_ARGS__)
+
+
+#define LOG_TRACE_DEFERRED(context, format, ...) \
+    LOG_DEFERRED((context), capu::LL_TRACE, format, ##__VA_ARGS__)
+
+#define LOG_INFO_DEFERRED(context, format, ...) \
+    LOG_DEFERRED((context), capu::LL_INFO, format, ##__VA_ARGS__)
+
+#define LOG_DEBUG_DEFERRED(context, format, ...) \
+    LOG_DEFERRED((context), capu::LL_DEBUG, format, ##__VA_ARGS__)
+
+#define LOG_WARN_DEFERRED(context, format, ...) \
+    LOG_DEFERRED((context), capu::LL_WARN, format, ##__VA_ARGS__)
+
+#define LOG_ERROR_DEFERRED(context, format, ...) \
+    LOG_DEFERRED((context), capu::LL_ERROR, format, ##__VA_ARGS__)
+
+#define LOG_FATAL_DEFERRED(context, format, ...) \
+    LOG_DEFERRED((context), capu::LL_FATAL, format, ##__VA_ARGS__)
+
     /**
      * Logs messages to a given ILogAppender
      * There are two ways of logging available.
@@ -108,6 +176,28 @@ namespace capu
          *@}
          */
 
+        /**
+         * Log level for all contexts whose name starts with a prefix
+         */
+        struct LogLevelRule
+        {
+            String namePrefix;
+            ELogLevel logLevel;
+        };
+
+        /**
+         * Applies several log level rules at once, later rules override earlier ones
+         * Each context changes at most once, directly to its final level. Logging threads
+         * only read the level of their context, so they keep logging meanwhile.
+         * @param rules to apply in order
+         * @{
+         */
+        static void SetLogLevels(const vector<LogLevelRule>& rules);
+        void setLogLevels(const vector<LogLevelRule>& rules);
+        /**
+         *@}
+         */
+
 
         /**
          * Get log level of a given context id
@@ -177,6 +267,32 @@ namespace capu
          * @}
          */
 
+        /**
+         * Provides the message which a log statement formats its text into
+         * The default lets the statement use a message of its own
+         * @param context of the log statement
+         * @param logLevel of the log statement
+         * @param message receives a message owned by the logger, which must be passed to
+         *        commitMessage() afterwards, stays 0 if the statement uses a message of its own
+         * @return false if the log statement is dropped without formatting it
+         */
+        virtual bool claimMessage(const LogContext& context, ELogLevel logLevel, LogMessage*& message);
+
+        /**
+         * Logs a message which was provided by claimMessage()
+         * @param message formatted message
+         */
+        virtual void commitMessage(LogMessage& message);
+
+        /**
+         * Logs a deferred log statement, the default formats and logs it immediately
+         * @param context of the log statement
+         * @param logLevel of the log statement
+         * @param format of the log statement, lives as long as the program
+         * @param arguments binary arguments of the log statement
+         */
+        virtual void logDeferred(const LogContext& context, ELogLevel logLevel, const LogFormat& format, const LogArguments& arguments);
+
         /**
          * Constructor of the logger
          * @param appender to use for logging
@@ -227,16 +343,40 @@ namespace capu
 
     protected:
 
+        /**
+         * Logs several messages with all registered LogAppenders, every appender gets them with one call
+         * @param messages array of messages to log
+         * @param count number of messages
+         */
+        void logBatch(const LogMessage* messages, uint_t count);
+
         static Logger* DefaultLogger;
 
     private:
-        typedef HashSet<LogContext*> ContextSet;
+        typedef vector<LogContext*> ContextVector;
+        typedef HashTable<String, LogContext*> ContextTable;
         typedef HashSet<ILogAppender*> AppenderSet;
 
         /**
-         * HashSet with all LogContexts
+         * Returns the index of the first context in m_contextsByName whose name is not less than name
+         */
+        uint_t findContextByName(const String& name) const;
+
+        /**
+         * All LogContexts sorted by name, contexts with a common name prefix are adjacent
+         */
+        ContextVector m_contextsByName;
+
+        /**
+         * First created LogContext of each id
+         */
+        ContextTable m_contextsById;
+
+        /**
+         * Guards the contexts against concurrent creation and configuration,
+         * log statements do not take it
          */
-        ContextSet m_logContexts;
+        LightweightMutex m_contextLock;
 
         /**
          * Set with all log appenders
@@ -248,97 +388,150 @@ namespace capu
 
     };
 
+    /**
+     * Message of a single log statement. The message is provided by the logger
+     * or lives on the stack of the statement.
+     */
+    class LogStatement
+    {
+    public:
+
+        /**
+         * Claims the message from the logger
+         * @param logger which logs the statement
+         * @param context of the statement
+         * @param logLevel of the statement
+         */
+        LogStatement(Logger& logger, const LogContext& context, ELogLevel logLevel);
+
+        /**
+         * Destructor of LogStatement
+         */
+        ~LogStatement();
+
+        /**
+         * Returns if the statement has to be formatted and committed
+         * @return false if the logger drops the statement
+         */
+        bool isActive() const;
+
+        /**
+         * Returns the stream to format the statement into
+         * @return the stream of the message
+         */
+        StringOutputStream& getStream();
+
+        /**
+         * Hands the formatted message to the logger
+         */
+        void commit();
+
+    private:
+
+        Logger& m_logger;
+
+        /**
+         * Message to format into, 0 if the statement is dropped
+         */
+        LogMessage* m_message;
+
+        /**
+         * True if m_message lives in m_localMessage
+         */
+        bool m_isLocal;
+
+        /**
+         * Storage for the message if the logger does not provide one
+         */
+        std::aligned_storage<sizeof(LogMessage), std::alignment_of<LogMessage>::value>::type m_localMessage;
+
+        LogStatement(const LogStatement&);
+        LogStatement& operator=(const LogStatement&);
+    };
+
     inline
-    Logger* Logger::GetDefaultLogger()
+    LogStatement::LogStatement(Logger& logger, const LogContext& context, ELogLevel logLevel)
+        : m_logger(logger)
+        , m_message(0)
+        , m_isLocal(false)
     {
-        return Logger::DefaultLogger;
+        if(logger.claimMessage(context, logLevel, m_message) && 0 == m_message)
+        {
+            m_message = new (&m_localMessage) LogMessage(context, logLevel);
+            m_isLocal = true;
+        }
     }
 
-    inline 
-    void 
-    Logger::SetLogLevel(const ELogLevel logLevel, const String& filterContext)
+    inline
+    LogStatement::~LogStatement()
     {
-        if(0 != DefaultLogger)
+        if(m_isLocal)
         {
-            DefaultLogger->setLogLevel(logLevel, filterContext);
+            m_message->~LogMessage();
         }
     }
 
-    inline 
-    void 
-    Logger::setLogLevel(const ELogLevel logLevel, const String& filterContext)
+    inline
+    bool
+    LogStatement::isActive() const
     {
-        ContextSet::Iterator current = m_logContexts.begin();
-        const ContextSet::Iterator end = m_logContexts.end();
+        return 0 != m_message;
+    }
 
-        for(; current != end; ++current)
-        {
-            LogContext* lc = *current;
-
-            if (filterContext == "" ||
-                lc->getContextName().find(filterContext) >= 0 ||
-                lc->getContextId().find(filterContext) >= 0)
-            {
-                lc->setLogLevel(logLevel);
-            }
-        }
+    inline
+    StringOutputStream&
+    LogStatement::getStream()
+    {
+        return m_message->getStream();
     }
 
     inline
     void
-    Logger::GetLogLevel(const String& filterContext, ELogLevel& logLevel)
+    LogStatement::commit()
     {
-        if(0 != DefaultLogger)
+        if(m_isLocal)
         {
-            DefaultLogger->getLogLevel(filterContext,logLevel);
+            m_logger.log(*m_message);
+        }
+        else
+        {
+            m_logger.commitMessage(*m_message);
         }
     }
 
     inline
-    void
-    Logger::getLogLevel(const String& contextId, ELogLevel& logLevel)
+    Logger* Logger::GetDefaultLogger()
     {
-        ContextSet::Iterator current = m_logContexts.begin();
-        const ContextSet::Iterator end = m_logContexts.end();
+        return Logger::DefaultLogger;
+    }
 
-        for(; current != end; ++current)
+    inline 
+    void 
+    Logger::SetLogLevel(const ELogLevel logLevel, const String& filterContext)
+    {
+        if(0 != DefaultLogger)
         {
-            LogContext* lc = *current;
-
-            if (lc->getContextId() == contextId)
-            {
-                logLevel = lc->getLogLevel();
-                break;
-            }
+            DefaultLogger->setLogLevel(logLevel, filterContext);
         }
     }
 
     inline
     void
-    Logger::GetContextNameByContextId(const String& contextId, String& contextName)
+    Logger::GetLogLevel(const String& filterContext, ELogLevel& logLevel)
     {
         if(0 != DefaultLogger)
         {
-            DefaultLogger->getContextName(contextId, contextName);
+            DefaultLogger->getLogLevel(filterContext,logLevel);
         }
     }
 
     inline
     void
-    Logger::getContextName(const String& contextId, String& contextName)
+    Logger::GetContextNameByContextId(const String& contextId, String& contextName)
     {
-        ContextSet::Iterator current = m_logContexts.begin();
-        const ContextSet::Iterator end = m_logContexts.end();
-
-        for(; current != end; ++current)
+        if(0 != DefaultLogger)
         {
-            LogContext* lc = *current;
-
-            if (lc->getContextId() == contextId)
-            {
-                contextName = lc->getContextName();
-                break;
-            }
+            DefaultLogger->getContextName(contextId, contextName);
         }
     }
 
@@ -354,16 +547,11 @@ namespace capu
 
     inline
     void
-    Logger::getContextIds(vector<String>& contextIds)
+    Logger::SetLogLevels(const vector<LogLevelRule>& rules)
     {
-        ContextSet::Iterator current = m_logContexts.begin();
-        const ContextSet::Iterator end = m_logContexts.end();
-
-        for(; current != end; ++current)
+        if(0 != DefaultLogger)
         {
-            LogContext* lc = *current;
-
-            contextIds.push_back(lc->getContextId());
+            DefaultLogger->setLogLevels(rules);
         }
     }
 
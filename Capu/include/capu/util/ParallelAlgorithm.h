@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_PARALLELALGORITHM_H
+#define CAPU_PARALLELALGORITHM_H
+
+#include "capu/Config.h"
+#include "capu/container/vector.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/LightweightMutex.h"
+#include "capu/util/Future.h"
+#include "capu/util/Iterator.h"
+#include "capu/util/Runnable.h"
+#include "capu/util/ScopedLock.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/util/shared_ptr.h"
+#include <algorithm>
+#include <functional>
+
+namespace capu
+{
+    /**
+     * Options for the parallel algorithms
+     */
+    struct ParallelOptions
+    {
+        ParallelOptions()
+            : grainSize(0)
+            , deterministic(false)
+        {
+        }
+
+        /// minimum number of elements which are processed as one piece of work, 0 chooses automatically
+        uint_t grainSize;
+
+        /// parallel_reduce combines the partial results in the same order regardless of the number of threads
+        bool deterministic;
+    };
+
+    namespace internal
+    {
+        /// grain size which is used if none is given
+        static const uint_t DefaultParallelGrainSize = 1024u;
+
+        /**
+         * Hands out the index ranges of a parallel loop to the participating threads and tracks their completion.
+         *
+         * With fixed chunks every range has the grain size, so the ranges only depend on the number of elements.
+         * Otherwise the ranges start big and get smaller towards the end, so the threads run out of work at
+         * about the same time while the number of claims stays low.
+         */
+        class ParallelLoop
+        {
+        public:
+            ParallelLoop(uint_t count, uint_t grainSize, uint_t participants, bool fixedChunks)
+                : mCount(count)
+                , mGrainSize(grainSize)
+                , mParticipants(participants)
+                , mFixedChunks(fixedChunks)
+                , mNext(0)
+                , mCompleted(0)
+            {
+            }
+
+            bool claim(uint_t& begin, uint_t& end)
+            {
+                uint_t next = mNext.load();
+                do
+                {
+                    if (next >= mCount)
+                    {
+                        return false;
+                    }
+                    uint_t size = mGrainSize;
+                    if (!mFixedChunks)
+                    {
+                        size = std::max(mGrainSize, (mCount - next) / (2 * mParticipants));
+                    }
+                    begin = next;
+                    end = std::min(mCount, next + size);
+                }
+                while (!mNext.compareExchange(next, end));
+                return true;
+            }
+
+            void complete(uint_t count)
+            {
+                if ((mCompleted += count) == mCount)
+                {
+                    mDone.setValue();
+                }
+            }
+
+            void wait()
+            {
+                mDone.getFuture().wait();
+            }
+
+        private:
+            const uint_t mCount;
+            const uint_t mGrainSize;
+            const uint_t mParticipants;
+            const bool mFixedChunks;
+            Atomic<uint_t> mNext;
+            Atomic<uint_t> mCompleted;
+            Promise<void> mDone;
+        };
+
+        template<typename F>
+        void RunParallelLoop(ParallelLoop& loop, F& function)
+        {
+            uint_t begin = 0;
+            uint_t end = 0;
+            while (loop.claim(begin, end))
+            {
+                function(begin, end);
+                loop.complete(end - begin);
+            }
+        }
+
+        /**
+         * Pool runnable which helps with a parallel loop. It may start after the loop is finished and the
+         * function is gone, but then it cannot claim a range and never touches the function.
+         */
+        template<typename F>
+        class ParallelLoopRunnable : public Runnable
+        {
+        public:
+            ParallelLoopRunnable(const shared_ptr<ParallelLoop>& loop, F& function)
+                : mLoop(loop)
+                , mFunction(function)
+            {
+            }
+
+            void run() override
+            {
+                RunParallelLoop(*mLoop, mFunction);
+            }
+
+        private:
+            shared_ptr<ParallelLoop> mLoop;
+            F& mFunction;
+        };
+
+        /**
+         * Calls function(begin, end) for index ranges which cover [0, count) exactly once, spread over the
+         * calling thread and the threads of the pool. The calling thread works on the ranges as well, so it is
+         * safe to call from inside a pool thread. Small counts run in the calling thread only.
+         */
+        template<typename F>
+        void ParallelRange(ThreadPool& pool, uint_t count, uint_t grainSize, bool fixedChunks, F& function)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            if (grainSize == 0)
+            {
+                grainSize = DefaultParallelGrainSize;
+            }
+
+            const uint_t chunkCount = (count + grainSize - 1) / grainSize;
+            const uint_t helperCount = std::min(pool.getSize(), chunkCount - 1);
+            if (helperCount == 0 || count < 2 * grainSize)
+            {
+                if (fixedChunks)
+                {
+                    // keep the ranges of the parallel execution
+                    for (uint_t begin = 0; begin < count; begin += grainSize)
+                    {
+                        function(begin, std::min(count, begin + grainSize));
+                    }
+                }
+                else
+                {
+                    function(0, count);
+                }
+                return;
+            }
+
+            shared_ptr<ParallelLoop> loop = capu::make_shared<ParallelLoop>(count, grainSize, helperCount + 1, fixedChunks);
+            for (uint_t i = 0; i < helperCount; ++i)
+            {
+                if (pool.add(capu::make_shared<ParallelLoopRunnable<F> >(loop, function)) != CAPU_OK)
+                {
+                    // closed pool, the calling thread does the rest
+                    break;
+                }
+            }
+            RunParallelLoop(*loop, function);
+            loop->wait();
+        }
+
+        template<class RandomIt, class Function>
+        struct ParallelForEachChunk
+        {
+            void operator()(uint_t begin, uint_t end)
+            {
+                for (RandomIt it = first + begin, chunkEnd = first + end; it != chunkEnd; ++it)
+                {
+                    function(*it);
+                }
+            }
+
+            RandomIt first;
+            Function& function;
+        };
+
+        template<class Function>
+        struct ParallelForChunk
+        {
+            void operator()(uint_t begin, uint_t end)
+            {
+                for (uint_t i = begin; i < end; ++i)
+                {
+                    function(first + i);
+                }
+            }
+
+            uint_t first;
+            Function& function;
+        };
+
+        template<class RandomIt, class T, class BinaryOp>
+        struct ParallelReduceChunk
+        {
+            void operator()(uint_t begin, uint_t end)
+            {
+                RandomIt it = first + begin;
+                const RandomIt chunkEnd = first + end;
+                T partial = *it;
+                for (++it; it != chunkEnd; ++it)
+                {
+                    partial = op(partial, *it);
+                }
+
+                if (partials)
+                {
+                    (*partials)[begin / grainSize] = partial;
+                }
+                else
+                {
+                    ScopedLightweightMutexLock lock(mutex);
+                    result = op(result, partial);
+                }
+            }
+
+            RandomIt first;
+            BinaryOp& op;
+            uint_t grainSize;
+            vector<T>* partials;
+            LightweightMutex& mutex;
+            T& result;
+        };
+
+        template<class T, class Compare>
+        struct ParallelSortChunk
+        {
+            uint_t bound(uint_t chunk) const
+            {
+                return static_cast<uint_t>(static_cast<uint64_t>(count) * chunk / chunkCount);
+            }
+
+            void operator()(uint_t begin, uint_t end)
+            {
+                for (uint_t chunk = begin; chunk < end; ++chunk)
+                {
+                    std::sort(data + bound(chunk), data + bound(chunk + 1), compare);
+                }
+            }
+
+            T* data;
+            uint_t count;
+            uint_t chunkCount;
+            Compare& compare;
+        };
+
+        template<class T, class Compare>
+        struct ParallelMergeChunk
+        {
+            void operator()(uint_t begin, uint_t end)
+            {
+                for (uint_t pair = begin; pair < end; ++pair)
+                {
+                    const uint_t left = pair * 2 * width;
+                    const uint_t right = std::min(left + width, sorted.chunkCount);
+                    const uint_t last = std::min(left + 2 * width, sorted.chunkCount);
+                    std::inplace_merge(sorted.data + sorted.bound(left), sorted.data + sorted.bound(right), sorted.data + sorted.bound(last), sorted.compare);
+                }
+            }
+
+            ParallelSortChunk<T, Compare>& sorted;
+            uint_t width;
+        };
+    }
+
+    /**
+     * Calls function(index) for every index in [first, last) on the calling thread and the threads of the pool.
+     * Indices are processed in chunks of at least options.grainSize, small ranges run in the calling thread.
+     * @param pool the pool to use
+     * @param first first index
+     * @param last index after the last index
+     * @param function function to call, is called concurrently
+     * @param options chunking options
+     */
+    template<class Function>
+    void parallel_for(ThreadPool& pool, uint_t first, uint_t last, Function function, const ParallelOptions& options = ParallelOptions())
+    {
+        internal::ParallelForChunk<Function> chunk = { first, function };
+        internal::ParallelRange(pool, last > first ? last - first : 0, options.grainSize, false, chunk);
+    }
+
+    /**
+     * Calls function(element) for every element of a random access range on the calling thread and the
+     * threads of the pool.
+     * @param pool the pool to use
+     * @param first begin of the range
+     * @param last non-inclusive end of the range
+     * @param function function to call, is called concurrently
+     * @param options chunking options
+     */
+    template<class RandomIt, class Function>
+    void parallel_for_each(ThreadPool& pool, RandomIt first, RandomIt last, Function function, const ParallelOptions& options = ParallelOptions())
+    {
+        internal::ParallelForEachChunk<RandomIt, Function> chunk = { first, function };
+        internal::ParallelRange(pool, static_cast<uint_t>(last - first), options.grainSize, false, chunk);
+    }
+
+    /**
+     * Combines all elements of a random access range with a binary operation on the calling thread and the
+     * threads of the pool. The operation must be associative. Without options.deterministic it must be
+     * commutative as well, because the partial results are combined in the order they get ready. With
+     * options.deterministic the range is split into chunks of the grain size, which are combined from
+     * left to right, so e.g. floating point sums do not depend on the number of threads.
+     * @param pool the pool to use
+     * @param first begin of the range
+     * @param last non-inclusive end of the range
+     * @param init initial value which is combined with the elements
+     * @param op binary operation, is called concurrently
+     * @param options chunking and ordering options
+     * @return the combined value
+     */
+    template<class RandomIt, class T, class BinaryOp>
+    T parallel_reduce(ThreadPool& pool, RandomIt first, RandomIt last, T init, BinaryOp op, const ParallelOptions& options = ParallelOptions())
+    {
+        const uint_t count = static_cast<uint_t>(last - first);
+        const uint_t grainSize = options.grainSize > 0 ? options.grainSize : internal::DefaultParallelGrainSize;
+        LightweightMutex mutex;
+        T result = init;
+        if (!options.deterministic)
+        {
+            internal::ParallelReduceChunk<RandomIt, T, BinaryOp> chunk = { first, op, grainSize, 0, mutex, result };
+            internal::ParallelRange(pool, count, grainSize, false, chunk);
+            return result;
+        }
+
+        vector<T> partials((count + grainSize - 1) / grainSize, init);
+        internal::ParallelReduceChunk<RandomIt, T, BinaryOp> chunk = { first, op, grainSize, &partials, mutex, result };
+        internal::ParallelRange(pool, count, grainSize, true, chunk);
+        for (typename vector<T>::ConstIterator it = partials.cbegin(); it != partials.cend(); ++it)
+        {
+            result = op(result, *it);
+        }
+        return result;
+    }
+
+    /**
+     * Sorts a contiguous range, e.g. of a vector, on the calling thread and the threads of the pool.
+     * Parts of the range are sorted in parallel and then merged pairwise. The sort is not stable.
+     * @param pool the pool to use
+     * @param first begin of the range
+     * @param last non-inclusive end of the range
+     * @param compare strict weak ordering of the elements
+     * @param options chunking options, the grain size is the minimum size of the parts
+     */
+    template<class RandomIt, class Compare>
+    void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare compare, const ParallelOptions& options = ParallelOptions())
+    {
+        typedef typename iterator_traits<RandomIt>::value_type T;
+        const uint_t count = static_cast<uint_t>(last - first);
+        if (count < 2)
+        {
+            return;
+        }
+        const uint_t grainSize = options.grainSize > 0 ? options.grainSize : 16 * internal::DefaultParallelGrainSize;
+        const uint_t chunkCount = std::min(pool.getSize() + 1, count / grainSize);
+        T* data = &*first;
+        if (chunkCount < 2)
+        {
+            std::sort(data, data + count, compare);
+            return;
+        }
+
+        internal::ParallelSortChunk<T, Compare> sorted = { data, count, chunkCount, compare };
+        internal::ParallelRange(pool, chunkCount, 1, true, sorted);
+        for (uint_t width = 1; width < chunkCount; width *= 2)
+        {
+            internal::ParallelMergeChunk<T, Compare> merge = { sorted, width };
+            internal::ParallelRange(pool, (chunkCount + 2 * width - 1) / (2 * width), 1, true, merge);
+        }
+    }
+
+    /**
+     * Sorts a contiguous range in ascending order, see parallel_sort with compare
+     */
+    template<class RandomIt>
+    void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, const ParallelOptions& options = ParallelOptions())
+    {
+        parallel_sort(pool, first, last, std::less<typename iterator_traits<RandomIt>::value_type>(), options);
+    }
+}
+
+#endif // CAPU_PARALLELALGORITHM_H
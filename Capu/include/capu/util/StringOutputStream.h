@@ -18,7 +18,6 @@
 #define CAPU_STRINGOUTPUTSTREAM_H
 
 #include <capu/util/IOutputStream.h>
-#include <capu/container/vector.h>
 #include <capu/container/ConstString.h>
 #include <capu/container/String.h>
 #include <capu/util/Guid.h>
@@ -28,7 +27,8 @@ namespace capu
     /**
      * Streams data to a string
      * The result is only valid after a call of flush()
-     * The size of the internal buffer is doubled if the buffer is full
+     * Short content is kept in an inline buffer, longer content moves to the heap.
+     * The size of the buffer is doubled if the buffer is full
      */
     class StringOutputStream: public IOutputStream
     {
@@ -47,8 +47,31 @@ namespace capu
             HEXADECIMAL_LEADING_ZEROS
         };
 
+        /**
+         * Size of the inline buffer, including the terminating 0
+         */
+        static const uint32_t InlineCapacity = 256;
+
         StringOutputStream();
 
+        /**
+         * Copies content and formatting options of another stream
+         * @param other stream to copy
+         */
+        StringOutputStream(const StringOutputStream& other);
+
+        /**
+         * Releases the heap buffer, if any
+         */
+        virtual ~StringOutputStream();
+
+        /**
+         * Copies content and formatting options of another stream
+         * @param other stream to copy
+         * @return this stream
+         */
+        StringOutputStream& operator=(const StringOutputStream& other);
+
         /**
          * @name StringOuputStream implementation
          * @see  IOutputStream
@@ -106,6 +129,12 @@ namespace capu
          */
         void clear();
 
+        /**
+         * Exchanges content, memory and formatting options with another stream
+         * @param other stream to swap with
+         */
+        void swap(StringOutputStream& other);
+
         void setFloatingPointType(FloatingPointType type);
 
         /**
@@ -126,9 +155,21 @@ namespace capu
     private:
 
         /**
-         * The internal buffer of the stream
+         * Content of the stream, points to mInlineBuffer until the content outgrows it
+         */
+        char* mData;
+
+        /**
+         * Length of the content without terminating 0
+         */
+        uint32_t mLength;
+
+        /**
+         * Size of mData, including the terminating 0
          */
-        vector<char> mBuffer;
+        uint32_t mCapacity;
+
+        char mInlineBuffer[InlineCapacity];
 
         FloatingPointType mFloatingPointType;
 
@@ -139,7 +180,32 @@ namespace capu
 
         uint32_t mDecimalDigits;
 
-        void increaseSize(const uint32_t size);
+        /**
+         * Makes room for increment more characters and the terminating 0
+         */
+        void reserve(const uint32_t increment);
+
+        /**
+         * Moves the content to a heap buffer which holds at least capacity characters
+         */
+        void grow(const uint32_t capacity);
+
+        /**
+         * Writes the decimal digits of a value, with a preceding minus if negative is set
+         */
+        void writeDecimal(uint64_t value, bool negative);
+
+        /**
+         * Writes a value with 0x prefix and upper case hexadecimal digits
+         * @param value to write
+         * @param digits number of digits to pad with leading zeros, 0 for no padding
+         */
+        void writeHexadecimal(uint64_t value, uint32_t digits);
+
+        /**
+         * Writes a value with the given number of decimal digits, rounded like printf does
+         */
+        void writeFloat(float value, uint32_t decimalDigits);
 
     };
 
@@ -147,14 +213,14 @@ namespace capu
     const char*
     StringOutputStream::c_str()
     {
-        return mBuffer.data();
+        return mData;
     }
 
     inline
     const char*
     StringOutputStream::c_str() const
     {
-        return mBuffer.data();
+        return mData;
     }
 
 
@@ -162,46 +228,29 @@ namespace capu
     uint32_t
     StringOutputStream::length() const
     {
-        assert(mBuffer.size() > 0);
-        return static_cast<uint32_t>(mBuffer.size()) - 1;
+        return mLength;
     }
 
     inline
     StringOutputStream&
     StringOutputStream::operator<<(const float value)
     {
-        /* Maximum length float value
-           biggest/smallest: ~ +/-1e38
-           closest to zero:  ~ 1e-38
-
-           required maximum buffer length
-           - 1 sign
-           - 38 digits left of .
-           - 1 for .
-           - 38 digits right of dot + maximum 7 more relevant digits
-           - 1 for terminating \0
-           => 1+38+1+38+7+1 = 86
-        */
-        char buffer[86];
         switch(mFloatingPointType)
         {
         case NORMAL:
-            StringUtils::Sprintf(buffer, sizeof(buffer), "%.*f", mDecimalDigits, value);
+            writeFloat(value, mDecimalDigits);
             break;
         case FIXED:
-            StringUtils::Sprintf(buffer, sizeof(buffer), "%.4f", value);
+            writeFloat(value, 4);
             break;
         }
-
-        return operator<<(buffer);
+        return *this;
     }
 
     inline
     StringOutputStream&
     StringOutputStream::operator<<(const int32_t value)
     {
-        char buffer[12];
-
         if(mHexadecimalFormat != NO_HEXADECIMAL)
         {
             uint32_t conv = static_cast<uint32_t>(value);
@@ -209,8 +258,7 @@ namespace capu
         }
         else
         {
-            StringUtils::Sprintf(buffer, sizeof(buffer), "%d", value);
-            return operator<<(buffer);
+            return operator<<(static_cast<int64_t>(value));
         }
     }
 
@@ -218,31 +266,27 @@ namespace capu
     StringOutputStream&
     StringOutputStream::operator<<(const uint32_t value)
     {
-        char buffer[11];
-
         switch(mHexadecimalFormat)
         {
             case HEXADECIMAL_NO_LEADING_ZEROS:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "0x%X", value);
+                writeHexadecimal(value, 0);
                 break;
             case HEXADECIMAL_LEADING_ZEROS:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "0x%08X", value);
+                writeHexadecimal(value, 8);
                 break;
             case NO_HEXADECIMAL:
             default:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "%u", value);
+                writeDecimal(value, false);
                 break;
         }
 
-        return operator<<(buffer);
+        return *this;
     }
 
     inline
     StringOutputStream&
     StringOutputStream::operator<<(const int64_t value)
     {
-        char buffer[21];
-
         if(mHexadecimalFormat != NO_HEXADECIMAL)
         {
             uint64_t conv = static_cast<uint64_t>(value);
@@ -250,8 +294,10 @@ namespace capu
         }
         else
         {
-            StringUtils::Sprintf(buffer, sizeof(buffer), "%lld", value);
-            return operator<<(buffer);
+            // negate as unsigned, -value overflows for the minimum
+            const uint64_t magnitude = static_cast<uint64_t>(value);
+            writeDecimal(value < 0 ? 0 - magnitude : magnitude, value < 0);
+            return *this;
         }
     }
 
@@ -259,23 +305,21 @@ namespace capu
     StringOutputStream&
     StringOutputStream::operator<<(const uint64_t value)
     {
-        char buffer[21];
-
         switch(mHexadecimalFormat)
         {
             case HEXADECIMAL_NO_LEADING_ZEROS:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "0x%llX", value);
+                writeHexadecimal(value, 0);
                 break;
             case HEXADECIMAL_LEADING_ZEROS:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "0x%016llX", value);
+                writeHexadecimal(value, 16);
                 break;
             case NO_HEXADECIMAL:
             default:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "%llu", value);
+                writeDecimal(value, false);
                 break;
         }
 
-        return operator<<(buffer);
+        return *this;
     }
 
     inline
@@ -289,9 +333,7 @@ namespace capu
     StringOutputStream&
     StringOutputStream::operator<<(const bool  value)
     {
-        char buffer[2];
-        StringUtils::Sprintf(buffer, sizeof(buffer), "%u", value);
-        return operator<<(buffer);
+        return operator<<(value ? '1' : '0');
     }
 
     inline
@@ -314,30 +356,27 @@ namespace capu
     StringOutputStream&
     StringOutputStream::operator<<(const uint16_t value)
     {
-        char buffer[7];
         switch(mHexadecimalFormat)
         {
             case HEXADECIMAL_NO_LEADING_ZEROS:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "0x%hX", value);
+                writeHexadecimal(value, 0);
                 break;
             case HEXADECIMAL_LEADING_ZEROS:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "0x%04hX", value);
+                writeHexadecimal(value, 4);
                 break;
             case NO_HEXADECIMAL:
             default:
-                StringUtils::Sprintf(buffer, sizeof(buffer), "%u", value);
+                writeDecimal(value, false);
                 break;
         }
 
-        return operator<<(buffer);
+        return *this;
     }
 
     inline
     StringOutputStream&
     StringOutputStream::operator<<(const int16_t value)
     {
-        char buffer[7];
-
         if(mHexadecimalFormat != NO_HEXADECIMAL)
         {
             uint16_t conv = static_cast<uint16_t>(value);
@@ -345,8 +384,7 @@ namespace capu
         }
         else
         {
-            StringUtils::Sprintf(buffer, sizeof(buffer), "%d", value);
-            return operator<<(buffer);
+            return operator<<(static_cast<int64_t>(value));
         }
     }
 
@@ -361,9 +399,10 @@ namespace capu
     StringOutputStream&
     StringOutputStream::write(const void* data, const uint32_t size)
     {
-        const uint_t writeIdx = mBuffer.size() - 1;
-        increaseSize(size);
-        Memory::Copy(mBuffer.data() + writeIdx, data, size);
+        reserve(size);
+        Memory::Copy(mData + mLength, data, size);
+        mLength += size;
+        mData[mLength] = '\0';
         return *this;
     }
 
@@ -371,8 +410,9 @@ namespace capu
     void
     StringOutputStream::clear()
     {
-        mBuffer.resize(1);
-        mBuffer[0] = '\0';
+        // a heap buffer is kept for the next content
+        mLength = 0;
+        mData[0] = '\0';
     }
 
     inline
@@ -435,9 +475,12 @@ namespace capu
     }
 
     inline
-    void StringOutputStream::increaseSize(const uint32_t increment)
+    void StringOutputStream::reserve(const uint32_t increment)
     {
-        mBuffer.resize(mBuffer.size() + increment);
+        if(mCapacity - mLength <= increment)
+        {
+            grow(mLength + increment + 1);
+        }
     }
 }
 
@@ -19,9 +19,18 @@
 
 #include <capu/util/SocketInputStream.h>
 #include <capu/os/TcpSocket.h>
+#include <capu/os/NonBlockSocketChecker.h>
+#include <capu/os/Memory.h>
+#include <capu/container/vector.h>
 
 namespace capu
 {
+    /**
+     * Reads data from a tcp socket
+     * Each receive takes as much data as fits into the receive buffer, so values are
+     * read from memory until the buffer is empty.
+     */
+    template<uint16_t RCVBUFSIZE = 4096>
     class TcpSocketInputStream: public SocketInputStream
     {
     public:
@@ -30,14 +39,218 @@ namespace capu
 
         IInputStream& read(char* data, const uint32_t size) override;
 
+        /**
+         * Returns the number of bytes which can be read without blocking
+         * Receives the data the socket has available, but never waits for more.
+         * @return the number of buffered bytes
+         */
+        uint32_t available();
+
+        /**
+         * Copies data from the stream without removing it, e.g. to check the header of a message
+         * Never blocks, so framing code can poll for complete messages.
+         * @param data destination of the bytes
+         * @param size number of bytes to copy
+         * @return CAPU_OK if size bytes were available and copied
+         *         CAPU_ETIMEOUT if fewer bytes are available so far
+         *         CAPU_EINVAL if size is larger than the receive buffer
+         */
+        status_t peek(char* data, const uint32_t size);
+
     protected:
 
 
     private:
         TcpSocket& m_socket;
 
+        /**
+         * Descriptor of the socket and callback for checking it without blocking
+         */
+        vector<capu::os::SocketInfoPair> m_socketCheck;
+        bool m_socketReadable;
+
+        char*    m_readPosition;
+        uint32_t m_bufferedBytes;
+        char     m_receiveBuffer[RCVBUFSIZE];
+
+        /**
+         * Receives once into the free part of the receive buffer
+         * @return false if nothing could be received, mState tells why
+         */
+        bool receiveIntoBuffer();
+
+        /**
+         * Receives directly into data until size bytes arrived
+         */
+        void receiveDirectly(char* data, const uint32_t size);
+
+        void readDataFromInternalBuffer(char* data, const uint32_t size);
+
+        /**
+         * Records the result of a receive, closes the socket on errors
+         * @return false if nothing was received
+         */
+        bool checkReceive(const int32_t length);
+
+        void setSocketReadable(const capu::os::SocketDescription& socketDescription);
+
         TcpSocketInputStream operator=(const TcpSocketInputStream tsis);
     };
+
+    template<uint16_t RCVBUFSIZE>
+    inline
+    TcpSocketInputStream<RCVBUFSIZE>::TcpSocketInputStream(TcpSocket& socket)
+        : m_socket(socket)
+        , m_socketReadable(false)
+        , m_readPosition(m_receiveBuffer)
+        , m_bufferedBytes(0)
+    {
+        m_socketCheck.push_back(capu::os::SocketInfoPair(m_socket.getSocketDescription(),
+            capu::os::SocketDelegate::Create<TcpSocketInputStream, &TcpSocketInputStream::setSocketReadable>(*this)));
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    inline
+    TcpSocketInputStream<RCVBUFSIZE>::~TcpSocketInputStream()
+    {
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    IInputStream& TcpSocketInputStream<RCVBUFSIZE>::read(char* data, const uint32_t size)
+    {
+        if (size <= m_bufferedBytes)
+        {
+            readDataFromInternalBuffer(data, size);
+            return *this;
+        }
+
+        if (size >= RCVBUFSIZE)
+        {
+            // buffering would only add a copy
+            const uint32_t bufferedBytes = m_bufferedBytes;
+            readDataFromInternalBuffer(data, bufferedBytes);
+            receiveDirectly(data + bufferedBytes, size - bufferedBytes);
+            return *this;
+        }
+
+        // received bytes stay buffered if the value is incomplete, so a read after a timeout can continue
+        while (m_bufferedBytes < size)
+        {
+            if (!receiveIntoBuffer())
+            {
+                return *this;
+            }
+        }
+        readDataFromInternalBuffer(data, size);
+        return *this;
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    uint32_t TcpSocketInputStream<RCVBUFSIZE>::available()
+    {
+        if (m_bufferedBytes < RCVBUFSIZE && mState == CAPU_OK)
+        {
+            m_socketReadable = false;
+            m_socketCheck[0].first = m_socket.getSocketDescription();
+            NonBlockSocketChecker::CheckSocketsForIncomingData(m_socketCheck, 0);
+            if (m_socketReadable)
+            {
+                receiveIntoBuffer();
+            }
+        }
+        return m_bufferedBytes;
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    status_t TcpSocketInputStream<RCVBUFSIZE>::peek(char* data, const uint32_t size)
+    {
+        if (size > RCVBUFSIZE)
+        {
+            return CAPU_EINVAL;
+        }
+        if (size > m_bufferedBytes && size > available())
+        {
+            return CAPU_ETIMEOUT;
+        }
+        Memory::Copy(data, m_readPosition, size);
+        return CAPU_OK;
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    bool TcpSocketInputStream<RCVBUFSIZE>::receiveIntoBuffer()
+    {
+        if (m_readPosition != m_receiveBuffer)
+        {
+            Memory::Move(m_receiveBuffer, m_readPosition, m_bufferedBytes);
+            m_readPosition = m_receiveBuffer;
+        }
+
+        int32_t length = 0;
+        mState = m_socket.receive(m_receiveBuffer + m_bufferedBytes, RCVBUFSIZE - m_bufferedBytes, length);
+        if (!checkReceive(length))
+        {
+            return false;
+        }
+        m_bufferedBytes += length;
+        return true;
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    void TcpSocketInputStream<RCVBUFSIZE>::receiveDirectly(char* data, const uint32_t size)
+    {
+        uint32_t receivedBytes = 0;
+        while (receivedBytes < size)
+        {
+            int32_t length = 0;
+            mState = m_socket.receive(&data[receivedBytes], size - receivedBytes, length);
+            if (!checkReceive(length))
+            {
+                break;
+            }
+            receivedBytes += length;
+        }
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    inline
+    void TcpSocketInputStream<RCVBUFSIZE>::readDataFromInternalBuffer(char* data, const uint32_t size)
+    {
+        Memory::Copy(data, m_readPosition, size);
+        m_readPosition += size;
+        m_bufferedBytes -= size;
+        if (0 == m_bufferedBytes)
+        {
+            m_readPosition = m_receiveBuffer;
+        }
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    inline
+    bool TcpSocketInputStream<RCVBUFSIZE>::checkReceive(const int32_t length)
+    {
+        if (mState != CAPU_OK)
+        {
+            if (mState == CAPU_ERROR)
+            {
+                m_socket.close();
+            }
+            return false;
+        }
+
+        if (0 == length) // other side closed connection
+        {
+            mState = CAPU_ERROR;
+            return false;
+        }
+        return true;
+    }
+
+    template<uint16_t RCVBUFSIZE>
+    inline
+    void TcpSocketInputStream<RCVBUFSIZE>::setSocketReadable(const capu::os::SocketDescription&)
+    {
+        m_socketReadable = true;
+    }
 }
 
 #endif // CAPU_TCPSOCKETINPUTSTREAM_H
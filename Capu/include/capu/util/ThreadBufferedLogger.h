@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAPU_THREADBUFFEREDLOGGER_H
+#define CAPU_THREADBUFFEREDLOGGER_H
+
+#include "capu/util/Logger.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/CondVar.h"
+#include "capu/os/LightweightMutex.h"
+#include "capu/container/SpscRingBuffer.h"
+#include "capu/container/vector.h"
+#include "capu/util/ILogAppender.h"
+#include "capu/util/LogMessage.h"
+
+namespace capu
+{
+    /**
+     * Logger which lets every thread log into a buffer of its own
+     *
+     * A log statement formats into a message of its thread and appends it as binary
+     * record to the ring buffer of the thread, without taking a lock. A single sink
+     * thread collects the records of all threads, merges them by timestamp and passes
+     * them to the appenders in batches, see ILogAppender::logBatch().
+     *
+     * Deferred log statements append their binary arguments instead of the text, the
+     * sink formats them, see LOG_DEFERRED_EXT.
+     *
+     * Records which are collected in the same round are output in timestamp order.
+     * A statement waits if the buffer of its thread is full.
+     *
+     * Buffers are kept per thread id until the logger is destroyed, a thread which
+     * reuses the id of a finished thread reuses its buffer. Threads beyond the maximum
+     * number of buffers log synchronously.
+     */
+    class ThreadBufferedLogger: public Logger, private Runnable
+    {
+    public:
+
+        /**
+         * Maximum number of threads with buffers of their own
+         */
+        static const uint32_t MaxThreadBuffers = 128;
+
+        /**
+         * Constructor of ThreadBufferedLogger
+         * The sink thread is started immediately
+         * @param appender to use for logging
+         * @param bufferSize size of the record buffer of each thread in bytes
+         */
+        ThreadBufferedLogger(ILogAppender& appender, uint32_t bufferSize = 64 * 1024);
+
+        /**
+         * Destructor of ThreadBufferedLogger
+         * Outputs all buffered records before it returns
+         */
+        virtual ~ThreadBufferedLogger();
+
+        /**
+         * @name Appends a copy of the message to the buffer of the calling thread
+         * @see Logger
+         */
+        virtual void log(const LogMessage& message) override;
+
+        /**
+         * @name Provides the message of the calling thread
+         * @see Logger
+         */
+        virtual bool claimMessage(const LogContext& context, ELogLevel logLevel, LogMessage*& message) override;
+
+        /**
+         * @name Appends the message to the buffer of the calling thread
+         * @see Logger
+         */
+        virtual void commitMessage(LogMessage& message) override;
+
+        /**
+         * @name Appends the binary arguments to the buffer of the calling thread
+         * @see Logger
+         */
+        virtual void logDeferred(const LogContext& context, ELogLevel logLevel, const LogFormat& format, const LogArguments& arguments) override;
+
+        /**
+         * Returns the number of messages which were dropped, e.g. because an
+         * appender logged while the buffer of the sink thread was full
+         * @return the number of dropped messages
+         */
+        uint32_t getDroppedMessageCount() const;
+
+    private:
+
+        /**
+         * Fixed part of a record, followed by the text of the message or
+         * the binary arguments of a deferred statement
+         */
+        struct RecordHeader
+        {
+            uint64_t timestamp;
+            const LogContext* context;
+
+            /**
+             * Format of a deferred statement, 0 if the record holds text
+             */
+            const LogFormat* format;
+            uint32_t logLevel;
+            uint32_t length;
+        };
+
+        /**
+         * Buffer of a single thread
+         */
+        struct ThreadBuffer
+        {
+            explicit ThreadBuffer(uint32_t size);
+
+            /**
+             * Records, written by the owning thread and read by the sink
+             */
+            SpscRingBuffer<char> records;
+
+            /**
+             * Message the owning thread formats into
+             */
+            LogMessage message;
+
+            /**
+             * True while the owning thread formats into message, a statement
+             * which is logged while formatting uses a message of its own
+             */
+            bool messageInUse;
+
+            /**
+             * Bytes which the sink read from records but did not output yet
+             */
+            vector<char> pending;
+
+            /**
+             * Offset of the next record in pending while the sink merges
+             */
+            uint_t offset;
+        };
+
+        /**
+         * Number of merged messages which are passed to the appenders at once
+         */
+        static const uint32_t BatchSize = 256;
+
+        /**
+         * Returns the buffer of the calling thread, creates it on first use
+         * @return the buffer, 0 if all buffers are in use
+         */
+        ThreadBuffer* getThreadBuffer();
+
+        /**
+         * Appends the message as record to the buffer
+         */
+        void appendRecord(ThreadBuffer& buffer, const LogMessage& message);
+
+        /**
+         * Appends a record to the buffer, waits for space if the buffer is full
+         * @param buffer of the calling thread
+         * @param header of the record, its length is truncated if the data does not fit into the buffer
+         * @param data text or binary arguments
+         */
+        void appendRecord(ThreadBuffer& buffer, RecordHeader& header, const char* data);
+
+        /**
+         * Returns if the record at the merge offset of the buffer is complete
+         * @param buffer to check
+         * @param header receives the header of the record
+         */
+        static bool PeekRecord(const ThreadBuffer& buffer, RecordHeader& header);
+
+        /**
+         * Returns if any buffer holds records
+         */
+        bool hasRecords() const;
+
+        /**
+         * Reads the records of all threads and outputs them merged by timestamp
+         */
+        void collect();
+
+        /**
+         * Wakes up the sink if it waits for records
+         */
+        void wakeSink();
+
+        /**
+         * Thread which outputs the records
+         */
+        Thread m_sinkThread;
+
+        const uint32_t m_bufferSize;
+
+        /**
+         * Open addressed table of thread ids and their buffers
+         */
+        Atomic<uint_t> m_threadIds[MaxThreadBuffers];
+        Atomic<ThreadBuffer*> m_threadBuffers[MaxThreadBuffers];
+
+        /**
+         * Id of the sink thread, which drops statements instead of waiting for itself
+         */
+        Atomic<uint_t> m_sinkThreadId;
+
+        Atomic<uint32_t> m_droppedMessages;
+
+        /**
+         * Buffers the sink reads from, its own copy of m_threadBuffers
+         */
+        vector<ThreadBuffer*> m_sinkBuffers;
+
+        /**
+         * Merged messages which are passed to the appenders
+         */
+        vector<LogMessage> m_batch;
+
+        /**
+         * The sink waits on m_recordsAvailable while it sets m_sinkWaiting
+         */
+        Atomic<uint32_t> m_sinkWaiting;
+        LightweightMutex m_sinkMutex;
+        CondVar m_recordsAvailable;
+
+        /**
+         * Statements wait on m_spaceAvailable while the buffer of their thread is full
+         */
+        Atomic<uint32_t> m_waitingStatements;
+        LightweightMutex m_spaceMutex;
+        CondVar m_spaceAvailable;
+
+        /**
+         * Internal run method for the thread
+         */
+        virtual void run() override;
+
+        ThreadBufferedLogger(const ThreadBufferedLogger&);
+        ThreadBufferedLogger& operator=(const ThreadBufferedLogger&);
+    };
+}
+
+#endif // CAPU_THREADBUFFEREDLOGGER_H
@@ -20,9 +20,14 @@
 #include "capu/Config.h"
 #include "capu/container/List.h"
 #include "capu/container/Queue.h"
+#include "capu/container/WorkStealingDeque.h"
+#include "capu/os/Atomic.h"
 #include "capu/os/CondVar.h"
 #include "capu/os/LightweightMutex.h"
 #include "capu/os/Thread.h"
+#include "capu/util/ConcurrentStaticAllocator.h"
+#include "capu/util/Future.h"
+#include "capu/util/HybridAllocator.h"
 #include "capu/util/Runnable.h"
 #include "capu/util/shared_ptr.h"
 
@@ -30,11 +35,26 @@ namespace capu
 {
     /**
      * Represents a set of threads that can be used to run Runnables.
+     *
+     * In the default mode all threads take their work from one shared queue. In work-stealing mode
+     * every thread owns a WorkStealingDeque. Runnables added from inside a pool thread go to the deque
+     * of that thread, runnables added from other threads go to the shared queue. Threads run their own
+     * work first, then take from the shared queue and finally steal from the other threads.
+     * Work-stealing pays off for runnables which add further runnables, e.g. to split up work.
      */
     class ThreadPool
     {
     public:
 
+        /**
+         * How the threads of the pool distribute the work
+         */
+        enum Mode
+        {
+            SHARED_QUEUE,
+            WORK_STEALING
+        };
+
         /**
          * Maximum number of threads in a thread pool
          */
@@ -43,8 +63,9 @@ namespace capu
         /**
          * creates a new threadpool instance.
          * @param size amounts of threads. Default value is 5.
+         * @param mode how the work is distributed among the threads
          */
-        ThreadPool(const uint32_t size = 5);
+        ThreadPool(const uint32_t size = 5, const Mode mode = SHARED_QUEUE);
 
         /**
          * destructor.
@@ -57,6 +78,15 @@ namespace capu
          */
         status_t add(shared_ptr<Runnable> runnable);
 
+        /**
+         * Runs a function on the threadpool and returns a future for its result. The function and the
+         * state of the future share one allocation.
+         * @param function callable object without arguments, it is copied
+         * @return future for the return value of the function, invalid if the pool is closed
+         */
+        template<typename F>
+        Future<typename internal::FunctionResult<F>::Type> submit(const F& function);
+
         /**
          * Waits until every thread has been terminated.
          * @param cancelThreads set the cancel flag on all workers before waiting
@@ -75,18 +105,44 @@ namespace capu
          */
         uint_t getSize() const;
 
+        /**
+         * Returns how the work is distributed among the threads
+         * @return the mode of the pool
+         */
+        Mode getMode() const;
+
     private:
 
+        /**
+         * Runnable queued in a WorkStealingDeque
+         */
+        struct Task
+        {
+            shared_ptr<Runnable> runnable;
+        };
+
+        static const uint32_t TASK_DEQUE_CAPACITY = 1024;
+        static const uint32_t STATIC_TASK_COUNT = 1024;
+
+        typedef WorkStealingDeque<Task, TASK_DEQUE_CAPACITY> TaskDeque;
+        typedef HybridAllocator<Task, STATIC_TASK_COUNT, ConcurrentStaticAllocator<Task, STATIC_TASK_COUNT> > TaskAllocator;
+
         class PoolRunnable : public Runnable
         {
         public:
-            PoolRunnable(ThreadPool& pool);
+            PoolRunnable(ThreadPool& pool, uint32_t index);
             void run() override;
 
             void cancelCurrentRunnable();
 
         private:
+            void runSharedQueue();
+            void runWorkStealing();
+            void execute(Runnable* runnable);
+            bool takeRunnable(shared_ptr<Runnable>& runnable);
+
             ThreadPool& mPool;
+            const uint32_t mIndex;
             LightweightMutex mCurrentRunnableMutex;
             Runnable* mCurrentRunnable;
 
@@ -96,7 +152,7 @@ namespace capu
         class PoolWorker
         {
         public:
-            PoolWorker(ThreadPool& pool);
+            PoolWorker(ThreadPool& pool, uint32_t index);
             ~PoolWorker();
             status_t join();
             void cancel();
@@ -114,13 +170,37 @@ namespace capu
 
         typedef shared_ptr<PoolWorker> PoolWorkerPtr;
 
+        status_t addToDeque(const shared_ptr<Runnable>& runnable);
+        bool hasQueuedWork() const;
+
+        const Mode mMode;
         bool mClosed;
         bool mCloseRequested;
         Queue<shared_ptr<Runnable> > mRunnableQueue;
         CondVar mCV;
         LightweightMutex mMutex;
         List<PoolWorkerPtr> mWorkerList;
+
+        // work-stealing mode only
+        const uint32_t mDequeCount;
+        TaskDeque* mDeques;
+        Atomic<uint_t>* mWorkerThreadIds;
+        TaskAllocator mTaskAllocator;
+        Atomic<uint_t> mQueuedCount;
+        Atomic<uint32_t> mSleepingWorkers;
     };
+
+    template<typename F>
+    inline Future<typename internal::FunctionResult<F>::Type> ThreadPool::submit(const F& function)
+    {
+        typedef typename internal::FunctionResult<F>::Type R;
+        shared_ptr<internal::FutureTask<F, R> > task = capu::make_shared<internal::FutureTask<F, R> >(this, function);
+        if (add(task) != CAPU_OK)
+        {
+            return Future<R>();
+        }
+        return Future<R>(task);
+    }
 }
 
 #endif // CAPU_THREADPOOL_H
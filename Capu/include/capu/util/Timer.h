@@ -19,11 +19,10 @@
 
 #include "capu/util/Delegate.h"
 #include "capu/util/shared_ptr.h"
+#include "capu/util/TimerManager.h"
 
 namespace capu
 {
-    class TimerManager;
-
     /**
      * Utility class to call a delegate every 'timeoutMillis' milliseconds
      * Every Timer has to be initialized with a TimerManager to work.
@@ -32,6 +31,47 @@ namespace capu
     {
         friend class TimerManager;
     public:
+        /**
+         * How the next execution of a periodic timer is scheduled
+         */
+        enum Scheduling
+        {
+            /**
+             * The next execution is due 'timeoutMillis' after the current one was dispatched,
+             * delays add up over time
+             */
+            FIXED_DELAY,
+
+            /**
+             * The executions are due at fixed multiples of 'timeoutMillis' after the start. After a delay,
+             * the missed executions are caught up one after the other.
+             */
+            FIXED_RATE
+        };
+
+        /**
+         * How late the executions of a timer were called, measured from their due time
+         * to the call of the delegate
+         */
+        struct Statistics
+        {
+            Statistics();
+
+            /**
+             * Number of calls of the delegate
+             */
+            uint64_t executions;
+
+            /**
+             * Number of executions which were skipped because the previous one was still running
+             */
+            uint64_t skippedExecutions;
+
+            uint64_t lastLatenessMicros;
+            uint64_t maxLatenessMicros;
+            uint64_t totalLatenessMicros;
+        };
+
         /**
          * Constructor
          * @param timerManager Shared pointer on the TimerManager object which is responsible for executing the delegate
@@ -39,12 +79,15 @@ namespace capu
          * @param timeoutMillis The timeout interval in milliseconds. Must be positive.
          * @param maxExecution If the total number of executions reaches this number, the timer will not be executed again.
          * This number cannot be changed later. Zero means the timer is always executed while it is active.
+         * @param scheduling How the executions after the first one are scheduled
          */
-        Timer(shared_ptr<TimerManager> timerManager, const Delegate<>& delegate, uint64_t timeoutMillis, uint32_t maxExecution);
+        Timer(shared_ptr<TimerManager> timerManager, const Delegate<>& delegate, uint64_t timeoutMillis, uint32_t maxExecution,
+              Scheduling scheduling = FIXED_DELAY);
 
         /**
          * Destructor
-         * The timer will be stopped when deleted.
+         * The timer will be stopped when deleted. If the delegate is running in another thread,
+         * waits until it returned. The delegate may delete its own timer.
          */
         ~Timer();
 
@@ -61,7 +104,7 @@ namespace capu
         void start();
 
         /**
-         * Stops the timer.
+         * Stops the timer. If the delegate is running in another thread, waits until it returned.
          */
         void stop();
 
@@ -82,25 +125,40 @@ namespace capu
          */
         bool maxExecutionsReached() const;
 
-    private:
         /**
-         * A timer should never be copied
+         * Returns the lateness of the executions since the timer was constructed. A growing lateness
+         * indicates that the TimerManager or its pool cannot keep up.
+         * @return the statistics
          */
-        Timer(const Timer&);
+        Statistics getStatistics() const;
 
+    private:
         /**
-         * Executes the timer, in other words calls the stored delegate.
-         * If the timer is running, this function will be called every 'timeoutMillis' milliseconds.
-         * Calling this will count towards 'maxExecution'.
+         * A timer should never be copied
          */
-        void execute() const;
+        Timer(const Timer&);
 
         Delegate<> m_delegate;
         uint64_t m_timeoutMillis;
         uint32_t m_maxExecution;
-        mutable uint32_t m_numExecuted;
+        uint32_t m_numExecuted;
+        Scheduling m_scheduling;
+        Statistics m_statistics;
         bool m_registered;
         shared_ptr<TimerManager> m_currentTimerManager;
+
+        /**
+         * Position in the queue of the manager, NotQueued if no execution is queued
+         */
+        uint_t m_queueIndex;
+
+        /**
+         * Due time of the next execution in nanoseconds of Time::GetMonotonicNanoseconds()
+         */
+        uint64_t m_nextExecutionTime;
+        shared_ptr<TimerManager::Execution> m_execution;
+
+        static const uint_t NotQueued = static_cast<uint_t>(-1);
     };
 }
 
@@ -27,10 +27,17 @@
 namespace capu
 {
     class Timer;
+    class ThreadPool;
 
     /**
      * Class responsible for calling the execute() of the capu::Timer objects.
      * Every Timer has to be initialized with a responsible TimerManager object.
+     *
+     * The queued executions are kept in a 4-ary min-heap. Every timer knows its position in the heap,
+     * so starting and stopping a timer takes O(log n) without searching, even with many thousand active timers.
+     * The delegates are called without holding the lock of the manager, either by the timer thread
+     * or by a ThreadPool. Due times are taken from the monotonic clock, so changes of the system time
+     * do not affect the timers.
      */
     class TimerManager : private Runnable
     {
@@ -40,9 +47,12 @@ namespace capu
          * Constructs a new TimerManager, and returns a shared pointer on it.
          *
          * @param timerThreadName thread name to use for the internally created timer thread
+         * @param pool pool which calls the delegates of the timers, 0 to call them in the timer thread.
+         *             The pool must outlive all timers of the manager. An execution which becomes due while
+         *             the previous execution of the same timer is still running or queued on the pool is skipped.
          * @returns a shared pointer on a newly created TimerManager object.
          */
-        static shared_ptr<TimerManager> GetNewTimerManager(const String& timerThreadName = "");
+        static shared_ptr<TimerManager> GetNewTimerManager(const String& timerThreadName = "", ThreadPool* pool = 0);
 
         /**
          * Destructor
@@ -53,80 +63,119 @@ namespace capu
 
     private:
         /**
-         * Class to store the execution of the timer
+         * Execution of the delegate of a timer. Every timer owns one, it outlives the timer
+         * while the execution is running or queued on the pool.
          */
-        class Execution
+        class Execution : public Runnable
         {
         public:
+            explicit Execution(Timer& timer);
 
             /**
-             * Default constructor, only to be used by the container
+             * Executes the timer on the pool
              */
-            Execution();
+            virtual void run() override;
 
             /**
-             * The constructor creates an execution in 'timeout' milliseconds
-             * from now.
-             * @param timer The timer for which the execution is created
+             * The timer, 0 once the timer is deleted
              */
-            Execution(const Timer& timer);
+            Timer* m_timer;
 
-            //default copy-constructor, destructor, operator=
-            //Execution(const Execution&);
-            //~Execution();
-            //Execution& operator=(const Execution& other);
+            /**
+             * Keeps the manager alive while the execution is queued on the pool
+             */
+            shared_ptr<TimerManager> m_dispatchingManager;
 
             /**
-             * Returns the timer for the execution
+             * The execution was dispatched and has not finished yet
              */
-            const Timer& getTimer() const;
+            bool m_pending;
 
             /**
-             * Returns the timestamp when the execution should be performed
+             * The timer was stopped after the execution was dispatched, the delegate is not called
              */
-            uint64_t getExecutionTime() const;
+            bool m_withdrawn;
 
             /**
-             * Comparison to be used by set.
-             * Executions will be sorted by execution time
+             * The delegate is being called by the thread m_executingThread
              */
-            bool operator<(const Execution& other) const;
+            bool m_executing;
+            uint_t m_executingThread;
 
-        private:
-            const Timer* m_timer;
-            uint64_t m_executionTime;
+            /**
+             * Due time of the dispatched execution in monotonic nanoseconds
+             */
+            uint64_t m_dueTime;
         };
 
-        typedef vector< Execution > ExecutionsContainer;
+        typedef vector<Timer*> TimerQueue;
 
         /**
          * Constructor
          * The timer manager can only be constructed via the static function GetNewTimerManager.
          *
          * @param timerThreadName thread name to use for the internally created timer thread
+         * @param pool pool which calls the delegates, may be 0
+         */
+        TimerManager(const String& timerThreadName, ThreadPool* pool);
+
+        /**
+         * Inserts the next execution of a timer into the queue at the due time stored in the timer.
+         * @param timer The timer, must not be queued
+         */
+        void insertExecution(Timer& timer);
+
+        /**
+         * Removes the queued execution of a timer, does nothing if the timer is not queued.
+         * @param timer The timer
+         */
+        void removeExecution(Timer& timer);
+
+        /**
+         * Moves the timer at the given heap index towards the root until the heap is valid again.
+         */
+        void siftUp(uint_t index);
+
+        /**
+         * Moves the timer at the given heap index towards the leaves until the heap is valid again.
          */
-        TimerManager(const String& timerThreadName);
+        void siftDown(uint_t index);
 
         /**
-         * Inserts an execution into the executions' container.
-         * @param timer Reference of the timer for which the execution is inserted. The time of the execution
-         * is set to current time + timeout of the timer.
+         * Stores the timer at the given heap index
          */
-        void insertExecution(const Timer& timer);
+        void place(Timer* timer, uint_t index);
 
         /**
          * Every timer has to register itself with this function so that it is executed periodically.
          * If the maximal number of executions has already been reached, the timer will not be registered.
+         * The manager mutex must be held.
          * @param timer Reference of the timer to register
          * @returns true if the timer was registered
          */
         bool registerTimer(Timer& timer);
 
         /**
-         * When a timer is stopped, it has to unregister itself with this function.
+         * When a timer is stopped, it has to unregister itself with this function. Withdraws an execution which
+         * is queued on the pool and waits until a running execution finished, unless called from the delegate.
+         * The manager mutex must be held exactly once.
          * @param timer Reference of the timer to unregister
          */
-        void unregisterTimer(const Timer& timer);
+        void unregisterTimer(Timer& timer);
+
+        /**
+         * Hands the due execution of a timer to the pool or stores it for the timer thread.
+         * The manager mutex must be held.
+         * @param timer The timer, its due time is the time of the execution
+         * @return the execution which the timer thread has to run, empty if there is none
+         */
+        shared_ptr<Execution> dispatchExecution(Timer& timer);
+
+        /**
+         * Calls the delegate of the timer of the execution, the manager mutex must not be held.
+         * @param execution the execution
+         */
+        void execute(Execution& execution);
 
         /**
          * Function to implement the timer loop. The execute() functions of the active timers will
@@ -136,8 +185,10 @@ namespace capu
 
         Thread m_waitThread;
         CondVar m_sleepConditionVariable;
+        CondVar m_executionFinishedConditionVariable;
         Mutex m_managerMutex;
-        ExecutionsContainer m_queuedExecutions;
+        TimerQueue m_queuedTimers;
+        ThreadPool* m_pool;
         bool m_threadRunning;
     };
 }
@@ -22,6 +22,9 @@
 #include "capu/util/Traits.h"
 #include "capu/container/Hash.h"
 #include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace capu
 {
@@ -173,6 +176,11 @@ namespace capu
         template<class U>
         friend class shared_ptr;
 
+        template<class U, typename... Args>
+        friend shared_ptr<U> make_shared(Args&&... args);
+
+        shared_ptr(capu::internal::MetadataBase* metadata, T* ptr);
+
         void incRefCount();
         void decRefCount();
 
@@ -262,6 +270,44 @@ namespace capu
         private:
             Deleter mDeleter;
         };
+
+        template <typename T>
+        class MetadataInPlace : public capu::internal::MetadataBase
+        {
+        public:
+            template<typename... Args>
+            MetadataInPlace(Args&&... args)
+                : capu::internal::MetadataBase(1)
+            {
+                new (&mStorage) T(std::forward<Args>(args)...);
+            }
+
+            T* get()
+            {
+                return reinterpret_cast<T*>(&mStorage);
+            }
+
+            virtual void callDeleter() override
+            {
+                get()->~T();
+            }
+
+        private:
+            typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type mStorage;
+        };
+    }
+
+    /**
+     * Creates an object and a shared_ptr to it with a single allocation for both the object
+     * and the reference count.
+     * @param args arguments which are passed to the constructor of T
+     * @return shared_ptr to the new object
+     */
+    template<class T, typename... Args>
+    inline shared_ptr<T> make_shared(Args&&... args)
+    {
+        capu::internal::MetadataInPlace<T>* metadata = new capu::internal::MetadataInPlace<T>(std::forward<Args>(args)...);
+        return shared_ptr<T>(static_cast<capu::internal::MetadataBase*>(metadata), metadata->get());
     }
 
 
@@ -291,6 +337,14 @@ namespace capu
     {
     }
 
+    template<class T>
+    inline
+    shared_ptr<T>::shared_ptr(capu::internal::MetadataBase* metadata, T* ptr)
+        : mMetadata(metadata)
+        , mData(ptr)
+    {
+    }
+
     template<class T>
     inline
     shared_ptr<T>::shared_ptr(const shared_ptr& sharedPtr)
@@ -479,6 +533,18 @@ namespace capu
             return Hasher<T*, CAPU_TYPE_POINTER, INTRESULTTYPE>::Hash(key.get(), bitsize);
         }
     };
+
+    /**
+     * Specialization of FastHasher which hashes the managed pointer of the shared_ptr
+     */
+    template<class T>
+    struct FastHasher<shared_ptr<T>, CAPU_TYPE_CLASS>
+    {
+        static uint64_t Hash(const shared_ptr<T>& key)
+        {
+            return FastHasher<T*, CAPU_TYPE_POINTER>::Hash(key.get());
+        }
+    };
 }
 
 #endif // CAPU_SHAREDPTR_H
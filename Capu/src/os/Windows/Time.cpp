@@ -40,5 +40,20 @@ namespace capu
 
             return (ULONGLONG)t.QuadPart * microsecondsPerSecond / frequency.QuadPart;
         }
+
+        uint64_t Time::GetMonotonicNanoseconds()
+        {
+            const uint64_t nanosecondsPerSecond = 1000000000;
+            LARGE_INTEGER frequency;
+            LARGE_INTEGER t;
+
+            QueryPerformanceFrequency(&frequency);
+            QueryPerformanceCounter(&t);
+
+            // split up to avoid an overflow of the counter multiplied by 10^9
+            const uint64_t counter = t.QuadPart;
+            const uint64_t ticksPerSecond = frequency.QuadPart;
+            return (counter / ticksPerSecond) * nanosecondsPerSecond + (counter % ticksPerSecond) * nanosecondsPerSecond / ticksPerSecond;
+        }
     }
 }
@@ -15,45 +15,273 @@
  */
 
 #include "capu/util/AsynchronousLogger.h"
+#include "capu/util/ScopedLock.h"
 
 namespace capu
 {
-    AsynchronousLogger::AsynchronousLogger(ILogAppender& appender)
+    namespace
+    {
+        uint_t RoundUpToPowerOfTwo(uint_t value)
+        {
+            // a ring of one slot could not tell a free slot from a committed one
+            uint_t result = 2;
+            while(result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+    }
+
+    AsynchronousLogger::AsynchronousLogger(ILogAppender& appender, EOverflowPolicy overflowPolicy, uint32_t capacity)
         :  Logger(appender)
         , m_loggerThread("capu::AsynchronousLogger")
+        , m_overflowPolicy(overflowPolicy)
+        , m_capacity(RoundUpToPowerOfTwo(capacity))
+        , m_mask(m_capacity - 1)
+        , m_messages(m_capacity)
+        , m_sequences(m_capacity)
+        , m_slotOwners(m_capacity)
+        , m_claimPosition(0)
+        , m_outputPosition(0)
+        , m_outputThreadId(0)
+        , m_droppedMessages(0)
+        , m_blockedMessages(0)
+        , m_outputWaiting(0)
+        , m_waitingStatements(0)
     {
+        for(uint_t i = 0; i < m_capacity; ++i)
+        {
+            m_sequences[i].store(i);
+            m_slotOwners[i].store(0);
+        }
         m_loggerThread.start(*this);
     }
 
     AsynchronousLogger::~AsynchronousLogger()
     {
-        m_loggerThread.cancel();
+        {
+            ScopedLightweightMutexLock lock(m_outputMutex);
+            m_loggerThread.cancel();
+            m_committed.signal();
+        }
         m_loggerThread.join();
 
-        while(!m_logQueue.empty())
+        // the output thread drains before it finishes, this catches statements committed since
+        drain();
+    }
+
+    bool
+    AsynchronousLogger::claimSlot(uint_t& position)
+    {
+        position = m_claimPosition.load();
+        for(;;)
+        {
+            const int_t difference = static_cast<int_t>(m_sequences[position & m_mask].load() - position);
+            if(difference == 0)
+            {
+                // the slot is free in this round, claim it
+                if(m_claimPosition.compareExchange(position, position + 1))
+                {
+                    return true;
+                }
+                // another statement was faster, position holds the new value
+            }
+            else if(difference < 0)
+            {
+                // the slot still holds the message of the previous round
+                return false;
+            }
+            else
+            {
+                position = m_claimPosition.load();
+            }
+        }
+    }
+
+    bool
+    AsynchronousLogger::takeSlot(uint_t position)
+    {
+        if(m_sequences[position & m_mask].load() != position + 1)
+        {
+            return false;
+        }
+        // the output thread and statements which drop the oldest message compete for it
+        return m_outputPosition.compareExchange(position, position + 1);
+    }
+
+    void
+    AsynchronousLogger::freeSlot(uint_t position)
+    {
+        m_sequences[position & m_mask].store(position + m_capacity);
+    }
+
+    bool
+    AsynchronousLogger::hasUncommittedSlot(uint_t threadId) const
+    {
+        // a slot holds the id of a thread only while that thread formats into it, the thread stored the id itself
+        for(uint_t i = 0; i < m_capacity; ++i)
+        {
+            if(m_slotOwners[i].loadRelaxed() == threadId)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void
+    AsynchronousLogger::wakeWaitingStatements()
+    {
+        // a waiting statement registers before it claims again, so it sees the slots or is seen here
+        if(m_waitingStatements.load() > 0)
+        {
+            ScopedLightweightMutexLock lock(m_releaseMutex);
+            m_released.broadcast();
+        }
+    }
+
+    bool
+    AsynchronousLogger::hasCommittedSlot() const
+    {
+        const uint_t position = m_outputPosition.load();
+        return m_sequences[position & m_mask].load() == position + 1;
+    }
+
+    bool
+    AsynchronousLogger::claimMessage(const LogContext& context, ELogLevel logLevel, LogMessage*& message)
+    {
+        const uint_t threadId = Thread::CurrentThreadId();
+        uint_t position = 0;
+        if(!claimSlot(position))
         {
-            LogMessage message;
-            m_logQueue.pop(&message);
-            Logger::log(message);
+            // the output thread must not wait for itself, e.g. if an appender logs, and neither
+            // must a statement nested into another one, whose slot is only freed after it commits
+            if(m_overflowPolicy == OVERFLOW_DROP_NEWEST || threadId == m_outputThreadId.load() || hasUncommittedSlot(threadId))
+            {
+                ++m_droppedMessages;
+                return false;
+            }
+
+            bool blocked = false;
+            ScopedLightweightMutexLock lock(m_releaseMutex);
+            ++m_waitingStatements;
+            while(!claimSlot(position))
+            {
+                // the wanted slot holds the oldest message unless it is being formatted or output
+                if(m_overflowPolicy == OVERFLOW_DROP_OLDEST && takeSlot(position - m_capacity))
+                {
+                    // the lock is held already, other waiting statements compete for the same slot anyway
+                    ++m_droppedMessages;
+                    freeSlot(position - m_capacity);
+                    continue;
+                }
+                if(!blocked)
+                {
+                    ++m_blockedMessages;
+                    blocked = true;
+                }
+                m_released.wait(m_releaseMutex);
+            }
+            --m_waitingStatements;
+        }
+
+        m_slotOwners[position & m_mask].storeRelease(threadId);
+        message = &m_messages[position & m_mask];
+        message->reset(context, logLevel);
+        return true;
+    }
+
+    void
+    AsynchronousLogger::commitMessage(LogMessage& message)
+    {
+        const uint_t index = static_cast<uint_t>(&message - m_messages.get());
+        m_slotOwners[index].storeRelease(0);
+        Atomic<uint_t>& sequence = m_sequences[index];
+        sequence.store(sequence.load() + 1);
+
+        // the output thread registers before it checks for messages again, only one statement wakes it up
+        uint32_t outputWaiting = 1;
+        if(m_outputWaiting.load() != 0 && m_outputWaiting.compareExchange(outputWaiting, 0))
+        {
+            ScopedLightweightMutexLock lock(m_outputMutex);
+            m_committed.signal();
         }
     }
 
     void
     AsynchronousLogger::log(const LogMessage& message)
     {
-        m_logQueue.push(message);
+        LogMessage* slotMessage = 0;
+        if(claimMessage(message.getContext(), message.getLogLevel(), slotMessage))
+        {
+            *slotMessage = message;
+            commitMessage(*slotMessage);
+        }
+    }
+
+    uint32_t
+    AsynchronousLogger::getDroppedMessageCount() const
+    {
+        return m_droppedMessages.load();
+    }
+
+    uint32_t
+    AsynchronousLogger::getBlockedMessageCount() const
+    {
+        return m_blockedMessages.load();
+    }
+
+    void
+    AsynchronousLogger::drain()
+    {
+        // waiting statements are woken up in batches, waking them for every slot would switch threads all the time
+        uint_t freedSlots = 0;
+        for(;;)
+        {
+            const uint_t position = m_outputPosition.load();
+            if(!takeSlot(position))
+            {
+                break;
+            }
+            // the slot gets the memory of the previous output, it is free again before the appenders run
+            m_outputMessage.swap(m_messages[position & m_mask]);
+            freeSlot(position);
+            if(++freedSlots >= m_capacity / 2)
+            {
+                wakeWaitingStatements();
+                freedSlots = 0;
+            }
+            Logger::log(m_outputMessage);
+        }
+        wakeWaitingStatements();
     }
 
     void
     AsynchronousLogger::run()
     {
-        while(!isCancelRequested())
+        m_outputThreadId = Thread::CurrentThreadId();
+        for(;;)
         {
-            LogMessage message;
-            if(CAPU_OK == m_logQueue.pop(&message, 100))
+            drain();
+
+            ScopedLightweightMutexLock lock(m_outputMutex);
+            for(;;)
             {
-                Logger::log(message);
+                // register again after every wake up, the statement which woke us up deregistered us
+                m_outputWaiting = 1;
+                if(hasCommittedSlot())
+                {
+                    break;
+                }
+                if(isCancelRequested())
+                {
+                    m_outputWaiting = 0;
+                    return;
+                }
+                m_committed.wait(m_outputMutex);
             }
+            m_outputWaiting = 0;
         }
     }
 }
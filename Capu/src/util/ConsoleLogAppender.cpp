@@ -18,7 +18,6 @@
 #include "capu/util/LogMessage.h"
 #include "capu/util/ScopedLock.h"
 #include "capu/os/Console.h"
-#include "capu/os/Time.h"
 #include <stdio.h>
 
 namespace capu
@@ -32,8 +31,27 @@ namespace capu
     void ConsoleLogAppender::logMessage(const LogMessage& logMessage)
     {
         ScopedLightweightMutexLock lock(m_logMutex);
-        const uint64_t now = Time::GetMilliseconds();
-        Console::Print(Console::WHITE, "%.3f ", now/1000.0);
+        Print(logMessage);
+        Console::Flush();
+    }
+
+    void ConsoleLogAppender::logBatch(const LogMessage* logMessages, uint_t count)
+    {
+        const ELogLevel logLevel = getLogLevel();
+        ScopedLightweightMutexLock lock(m_logMutex);
+        for(uint_t i = 0; i < count; ++i)
+        {
+            if(logMessages[i].getLogLevel() >= logLevel)
+            {
+                Print(logMessages[i]);
+            }
+        }
+        Console::Flush();
+    }
+
+    void ConsoleLogAppender::Print(const LogMessage& logMessage)
+    {
+        Console::Print(Console::WHITE, "%.3f ", logMessage.getTimestamp() / 1000000.0);
 
         switch(logMessage.getLogLevel())
         {
@@ -60,6 +78,5 @@ namespace capu
 
         Console::Print(Console::AQUA, logMessage.getContext().getContextName().c_str());
         Console::Print(" | %s\n", logMessage.getLogMessage());
-        Console::Flush();
     }
 }
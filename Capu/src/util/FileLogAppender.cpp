@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "capu/util/FileLogAppender.h"
+#include "capu/util/ScopedLock.h"
+#include "capu/os/Memory.h"
+#include "capu/os/Time.h"
+
+namespace capu
+{
+    namespace
+    {
+        /**
+         * Large enough for every line prefix and the rotation index
+         */
+        const uint32_t MinimumBufferSize = 256;
+
+        /**
+         * Milliseconds of the monotonic clock, which does not jump when the wall clock is set
+         */
+        uint64_t GetMonotonicMilliseconds()
+        {
+            return Time::GetMonotonicNanoseconds() / 1000000;
+        }
+
+        /**
+         * Writes the decimal digits of value backwards, ending before end
+         * @return the first digit
+         */
+        char* WriteDigitsBackwards(char* end, uint64_t value, uint32_t minimumDigits)
+        {
+            uint32_t digits = 0;
+            do
+            {
+                *--end = static_cast<char>('0' + value % 10);
+                value /= 10;
+                ++digits;
+            } while(value != 0 || digits < minimumDigits);
+            return end;
+        }
+
+        /**
+         * Writes the timestamp in seconds with milliseconds and the log level, like the console does
+         * @return the length of the prefix
+         */
+        uint32_t FormatPrefix(const LogMessage& logMessage, char* prefix)
+        {
+            char digits[32];
+            char* const digitsEnd = digits + sizeof(digits);
+            const uint64_t milliseconds = (logMessage.getTimestamp() + 500) / 1000;
+            char* first = WriteDigitsBackwards(digitsEnd, milliseconds % 1000, 3);
+            *--first = '.';
+            first = WriteDigitsBackwards(first, milliseconds / 1000, 1);
+
+            uint32_t length = static_cast<uint32_t>(digitsEnd - first);
+            Memory::Copy(prefix, first, length);
+            prefix[length++] = ' ';
+
+            const char* level = 0;
+            switch(logMessage.getLogLevel())
+            {
+            case LL_TRACE:
+                level = "[ Trace ] ";
+                break;
+            default:
+            case LL_DEBUG:
+                level = "[ Debug ] ";
+                break;
+            case LL_INFO:
+                level = "[ Info  ] ";
+                break;
+            case LL_WARN:
+                level = "[ Warn  ] ";
+                break;
+            case LL_ERROR:
+                level = "[ Error ] ";
+                break;
+            case LL_FATAL:
+                level = "[ Fatal ] ";
+                break;
+            }
+            // all level names have the same length
+            Memory::Copy(prefix + length, level, 10);
+            return length + 10;
+        }
+    }
+
+    FileLogAppender::Configuration::Configuration()
+        : bufferSize(256 * 1024)
+        , flushIntervalMilliseconds(1000)
+        , maxFileSize(0)
+        , maxRotatedFiles(0)
+        , syncPolicy(SYNC_NEVER)
+        , compressor(0)
+    {
+    }
+
+    FileLogAppender::FileLogAppender(const String& path, const Configuration& configuration)
+        : m_path(path)
+        , m_configuration(configuration)
+        , m_file(path)
+        , m_isOpen(false)
+        , m_fileSize(0)
+        , m_buffer(configuration.bufferSize > MinimumBufferSize ? configuration.bufferSize : MinimumBufferSize)
+        , m_bufferSize(configuration.bufferSize > MinimumBufferSize ? configuration.bufferSize : MinimumBufferSize)
+        , m_bufferedBytes(0)
+        , m_bufferedSince(0)
+        , m_compressionPending(false)
+        , m_workerThread("capu::FileLogAppender")
+    {
+        openFile();
+        if(m_configuration.flushIntervalMilliseconds > 0 || 0 != m_configuration.compressor)
+        {
+            m_workerThread.start(*this);
+        }
+    }
+
+    FileLogAppender::~FileLogAppender()
+    {
+        {
+            ScopedLightweightMutexLock lock(m_mutex);
+            m_workerThread.cancel();
+            m_workAvailable.signal();
+        }
+        m_workerThread.join();
+
+        if(m_isOpen)
+        {
+            writeBuffer();
+            if(m_configuration.syncPolicy != SYNC_NEVER)
+            {
+                m_file.sync();
+            }
+            m_file.close();
+        }
+    }
+
+    void
+    FileLogAppender::logMessage(const LogMessage& logMessage)
+    {
+        ScopedLightweightMutexLock lock(m_mutex);
+        writeMessage(logMessage);
+    }
+
+    void
+    FileLogAppender::logBatch(const LogMessage* logMessages, uint_t count)
+    {
+        const ELogLevel logLevel = getLogLevel();
+        ScopedLightweightMutexLock lock(m_mutex);
+        for(uint_t i = 0; i < count; ++i)
+        {
+            if(logMessages[i].getLogLevel() >= logLevel)
+            {
+                writeMessage(logMessages[i]);
+            }
+        }
+    }
+
+    void
+    FileLogAppender::flush()
+    {
+        ScopedLightweightMutexLock lock(m_mutex);
+        writeBuffer();
+    }
+
+    bool
+    FileLogAppender::isOpen() const
+    {
+        return m_isOpen;
+    }
+
+    String
+    FileLogAppender::getRotatedPath(uint32_t index) const
+    {
+        char suffix[16];
+        char* const suffixEnd = suffix + sizeof(suffix) - 1;
+        *suffixEnd = '\0';
+        char* first = WriteDigitsBackwards(suffixEnd, index, 1);
+        *--first = '.';
+        return m_path + first;
+    }
+
+    void
+    FileLogAppender::writeMessage(const LogMessage& logMessage)
+    {
+        if(!m_isOpen)
+        {
+            return;
+        }
+
+        char prefix[64];
+        const uint32_t prefixLength = FormatPrefix(logMessage, prefix);
+        const String& contextName = logMessage.getContext().getContextName();
+        const uint32_t contextNameLength = static_cast<uint32_t>(contextName.getLength());
+        const uint32_t messageLength = logMessage.getLogMessageLength();
+
+        const uint64_t fileSize = m_fileSize + m_bufferedBytes;
+        const uint64_t lineLength = prefixLength + contextNameLength + 3 + messageLength + 1;
+        if(m_configuration.maxFileSize > 0 && fileSize > 0 && fileSize + lineLength > m_configuration.maxFileSize)
+        {
+            rotate();
+            if(!m_isOpen)
+            {
+                return;
+            }
+        }
+
+        append(prefix, prefixLength);
+        append(contextName.c_str(), contextNameLength);
+        append(" | ", 3);
+        append(logMessage.getLogMessage(), messageLength);
+        append("\n", 1);
+    }
+
+    void
+    FileLogAppender::append(const char* data, uint32_t length)
+    {
+        if(m_bufferSize - m_bufferedBytes < length)
+        {
+            writeBuffer();
+            if(length > m_bufferSize)
+            {
+                // copying would only split it into several writes
+                m_file.write(data, length);
+                m_fileSize += length;
+                return;
+            }
+        }
+
+        if(0 == m_bufferedBytes)
+        {
+            m_bufferedSince = GetMonotonicMilliseconds();
+            if(m_configuration.flushIntervalMilliseconds > 0)
+            {
+                // the worker waits without timeout while the buffer is empty
+                m_workAvailable.signal();
+            }
+        }
+        Memory::Copy(m_buffer.get() + m_bufferedBytes, data, length);
+        m_bufferedBytes += length;
+    }
+
+    void
+    FileLogAppender::writeBuffer()
+    {
+        if(0 == m_bufferedBytes || !m_isOpen)
+        {
+            return;
+        }
+        m_file.write(m_buffer.get(), m_bufferedBytes);
+        m_fileSize += m_bufferedBytes;
+        m_bufferedBytes = 0;
+
+        if(m_configuration.syncPolicy == SYNC_ON_FLUSH)
+        {
+            m_file.sync();
+        }
+        else
+        {
+            m_file.flush();
+        }
+    }
+
+    void
+    FileLogAppender::openFile()
+    {
+        m_fileSize = 0;
+        if(m_file.exists())
+        {
+            uint_t size = 0;
+            m_isOpen = m_file.open(READ_WRITE_EXISTING_BINARY) == CAPU_OK
+                && m_file.getSizeInBytes(size) == CAPU_OK
+                && m_file.seek(static_cast<int_t>(size), FROM_BEGINNING) == CAPU_OK;
+            m_fileSize = size;
+        }
+        else
+        {
+            m_isOpen = m_file.open(WRITE_NEW_BINARY) == CAPU_OK;
+        }
+    }
+
+    void
+    FileLogAppender::rotate()
+    {
+        writeBuffer();
+        if(m_configuration.syncPolicy != SYNC_NEVER)
+        {
+            m_file.sync();
+        }
+        m_file.close();
+        m_isOpen = false;
+
+        // the newest rotated file must not move while it is compressed
+        while(m_compressionPending)
+        {
+            m_compressionDone.wait(m_mutex);
+        }
+
+        if(0 == m_configuration.maxRotatedFiles)
+        {
+            File(m_path).remove();
+        }
+        else
+        {
+            removeRotatedFile(m_configuration.maxRotatedFiles);
+            for(uint32_t index = m_configuration.maxRotatedFiles - 1; index > 0; --index)
+            {
+                renameRotatedFile(index, index + 1);
+            }
+            if(File(m_path).renameTo(getRotatedPath(1)) == CAPU_OK && 0 != m_configuration.compressor)
+            {
+                m_compressionPending = true;
+                m_workAvailable.signal();
+            }
+        }
+
+        m_fileSize = 0;
+        m_isOpen = m_file.open(WRITE_NEW_BINARY) == CAPU_OK;
+    }
+
+    void
+    FileLogAppender::renameRotatedFile(uint32_t from, uint32_t to)
+    {
+        File rotatedFile(getRotatedPath(from));
+        if(rotatedFile.exists())
+        {
+            rotatedFile.renameTo(getRotatedPath(to));
+        }
+        if(0 != m_configuration.compressor)
+        {
+            const char* extension = m_configuration.compressor->getExtension();
+            File compressedFile(getRotatedPath(from) + extension);
+            if(compressedFile.exists())
+            {
+                compressedFile.renameTo(getRotatedPath(to) + extension);
+            }
+        }
+    }
+
+    void
+    FileLogAppender::removeRotatedFile(uint32_t index)
+    {
+        File(getRotatedPath(index)).remove();
+        if(0 != m_configuration.compressor)
+        {
+            File(getRotatedPath(index) + m_configuration.compressor->getExtension()).remove();
+        }
+    }
+
+    void
+    FileLogAppender::run()
+    {
+        ScopedLightweightMutexLock lock(m_mutex);
+        // a rotated file is compressed even when the appender is destroyed
+        while(!isCancelRequested() || m_compressionPending)
+        {
+            if(m_compressionPending)
+            {
+                const String sourcePath = getRotatedPath(1);
+                const String targetPath = sourcePath + m_configuration.compressor->getExtension();
+
+                // logging continues into the new file meanwhile
+                m_mutex.unlock();
+                if(m_configuration.compressor->compress(sourcePath, targetPath) == CAPU_OK)
+                {
+                    File(sourcePath).remove();
+                }
+                m_mutex.lock();
+
+                m_compressionPending = false;
+                m_compressionDone.broadcast();
+                continue;
+            }
+
+            uint32_t timeout = 0;
+            if(m_configuration.flushIntervalMilliseconds > 0 && m_bufferedBytes > 0)
+            {
+                const uint64_t age = GetMonotonicMilliseconds() - m_bufferedSince;
+                if(age >= m_configuration.flushIntervalMilliseconds)
+                {
+                    writeBuffer();
+                }
+                else
+                {
+                    timeout = static_cast<uint32_t>(m_configuration.flushIntervalMilliseconds - age);
+                }
+            }
+            m_workAvailable.wait(m_mutex, timeout);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "capu/util/Future.h"
+
+#include "capu/os/Time.h"
+#include "capu/util/ScopedLock.h"
+#include "capu/util/ThreadPool.h"
+
+capu::internal::FutureStateBase::FutureStateBase(ThreadPool* pool)
+    : mPool(pool)
+    , mReady(0)
+{
+}
+
+capu::internal::FutureStateBase::~FutureStateBase()
+{
+}
+
+bool capu::internal::FutureStateBase::isReady() const
+{
+    return mReady.load() != 0;
+}
+
+capu::status_t capu::internal::FutureStateBase::wait(uint32_t timeoutMillis) const
+{
+    if (isReady())
+    {
+        return CAPU_OK;
+    }
+
+    ScopedLightweightMutexLock lock(mMutex);
+    const uint64_t end = Time::GetMilliseconds() + timeoutMillis;
+    while (!isReady())
+    {
+        uint32_t remaining = 0;
+        if (timeoutMillis > 0)
+        {
+            const uint64_t now = Time::GetMilliseconds();
+            if (now >= end)
+            {
+                return CAPU_ETIMEOUT;
+            }
+            remaining = static_cast<uint32_t>(end - now);
+        }
+        const status_t result = mReadyCondition.wait(mMutex, remaining);
+        if (result != CAPU_OK && result != CAPU_ETIMEOUT)
+        {
+            return result;
+        }
+    }
+    return CAPU_OK;
+}
+
+void capu::internal::FutureStateBase::addContinuation(const shared_ptr<FutureContinuation>& continuation)
+{
+    {
+        ScopedLightweightMutexLock lock(mMutex);
+        if (!isReady())
+        {
+            mContinuations.push_back(continuation);
+            return;
+        }
+    }
+    continuation->takeArgument(*this);
+    schedule(continuation);
+}
+
+capu::ThreadPool* capu::internal::FutureStateBase::getPool() const
+{
+    return mPool;
+}
+
+capu::status_t capu::internal::FutureStateBase::setReady()
+{
+    vector<shared_ptr<FutureContinuation> > continuations;
+    {
+        ScopedLightweightMutexLock lock(mMutex);
+        if (isReady())
+        {
+            return CAPU_ERROR;
+        }
+        mReady = 1;
+        mReadyCondition.broadcast();
+        continuations.swap(mContinuations);
+    }
+
+    for (vector<shared_ptr<FutureContinuation> >::Iterator it = continuations.begin(); it != continuations.end(); ++it)
+    {
+        (*it)->takeArgument(*this);
+        schedule(*it);
+    }
+    return CAPU_OK;
+}
+
+void capu::internal::FutureStateBase::schedule(const shared_ptr<FutureContinuation>& continuation)
+{
+    // a closed pool does not take work anymore, then the continuation runs right here
+    if (mPool == 0 || mPool->add(continuation) != CAPU_OK)
+    {
+        continuation->run();
+    }
+}
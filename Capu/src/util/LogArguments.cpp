@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "capu/util/LogArguments.h"
+
+namespace capu
+{
+    namespace
+    {
+        /**
+         * Reads a value of the argument at data and writes it to the stream
+         * @return the size of the argument including its type tag, 0 if it is incomplete
+         */
+        template<typename T>
+        uint32_t FormatValue(const char* data, uint32_t size, StringOutputStream& stream)
+        {
+            if(size < 1 + sizeof(T))
+            {
+                return 0;
+            }
+            T value;
+            Memory::Copy(&value, data + 1, sizeof(T));
+            stream << value;
+            return static_cast<uint32_t>(1 + sizeof(T));
+        }
+    }
+
+    const uint32_t LogArguments::MaxSize;
+
+    uint32_t
+    LogArguments::FormatArgument(const char* data, uint32_t size, StringOutputStream& stream)
+    {
+        switch(static_cast<ArgumentType>(data[0]))
+        {
+        case ARGUMENT_FLOAT:
+            return FormatValue<float>(data, size, stream);
+        case ARGUMENT_INT32:
+            return FormatValue<int32_t>(data, size, stream);
+        case ARGUMENT_UINT32:
+            return FormatValue<uint32_t>(data, size, stream);
+        case ARGUMENT_INT64:
+            return FormatValue<int64_t>(data, size, stream);
+        case ARGUMENT_UINT64:
+            return FormatValue<uint64_t>(data, size, stream);
+        case ARGUMENT_INT16:
+            return FormatValue<int16_t>(data, size, stream);
+        case ARGUMENT_UINT16:
+            return FormatValue<uint16_t>(data, size, stream);
+        case ARGUMENT_BOOL:
+            return FormatValue<bool>(data, size, stream);
+        case ARGUMENT_CHAR:
+            return FormatValue<char>(data, size, stream);
+        case ARGUMENT_STRING:
+        {
+            const uint32_t headerSize = 1 + sizeof(uint16_t);
+            if(size < headerSize)
+            {
+                return 0;
+            }
+            uint16_t length = 0;
+            Memory::Copy(&length, data + 1, sizeof(uint16_t));
+            if(size - headerSize < length)
+            {
+                return 0;
+            }
+            stream.write(data + headerSize, length);
+            return headerSize + length;
+        }
+        }
+        return 0;
+    }
+
+    void
+    LogArguments::Format(const char* format, const char* data, uint32_t size, StringOutputStream& stream)
+    {
+        uint32_t offset = 0;
+        const char* text = format;
+        for(const char* current = format; *current != '\0'; ++current)
+        {
+            if(current[0] != '{' || current[1] != '}' || offset == size)
+            {
+                continue;
+            }
+            stream.write(text, static_cast<uint32_t>(current - text));
+            text = current;
+            const uint32_t argumentSize = FormatArgument(data + offset, size - offset, stream);
+            if(0 == argumentSize)
+            {
+                // keep the placeholder of an incomplete argument, later ones are missing too
+                offset = size;
+                continue;
+            }
+            offset += argumentSize;
+            ++current;
+            text = current + 1;
+        }
+        stream << text;
+    }
+}
@@ -18,11 +18,12 @@
 
 namespace capu
 {
+    const int32_t LogContext::DisabledFlag;
+
     LogContext::LogContext(const String& name, const String& id)
         : m_contextName(name)
         , m_contextId(id)
-        , m_enabled(true)
-        , m_logLevel(static_cast<int32_t>(LL_ERROR))
+        , m_state(static_cast<int32_t>(LL_ERROR))
         , m_data(0)
     {
     }
@@ -15,6 +15,7 @@
  */
 
 #include "capu/util/LogMessage.h"
+#include "capu/os/Time.h"
 
 namespace capu
 {
@@ -22,6 +23,7 @@ namespace capu
     LogMessage::LogMessage(const LogContext& context, ELogLevel logLevel)
         : m_context(&context)
         , m_logLevel(logLevel)
+        , m_timestamp(Time::GetMicroseconds())
     {
 
     }
@@ -29,6 +31,16 @@ namespace capu
     LogMessage::LogMessage()
         : m_context(0)
         , m_logLevel(LL_ERROR)
+        , m_timestamp(0)
+    {
+
+    }
+
+    LogMessage::LogMessage(const LogMessage& other)
+        : m_context(other.m_context)
+        , m_logLevel(other.m_logLevel)
+        , m_timestamp(other.m_timestamp)
+        , m_outputStream(other.m_outputStream)
     {
 
     }
@@ -43,12 +55,33 @@ namespace capu
         return m_outputStream.length();
     }
 
+    void LogMessage::reset(const LogContext& context, ELogLevel logLevel)
+    {
+        m_context = &context;
+        m_logLevel = logLevel;
+        m_timestamp = Time::GetMicroseconds();
+        m_outputStream.clear();
+        m_outputStream.setFloatingPointType(StringOutputStream::NORMAL);
+        m_outputStream.setDecimalDigits(6);
+        m_outputStream.setHexadecimalOutputFormat(StringOutputStream::NO_HEXADECIMAL);
+    }
+
+    void LogMessage::swap(LogMessage& other)
+    {
+        using std::swap;
+        swap(m_context, other.m_context);
+        swap(m_logLevel, other.m_logLevel);
+        swap(m_timestamp, other.m_timestamp);
+        m_outputStream.swap(other.m_outputStream);
+    }
+
     LogMessage& LogMessage::operator=(const LogMessage& other)
     {
         if(&other != this)
         {
             m_context = other.m_context;
             m_logLevel = other.m_logLevel;
+            m_timestamp = other.m_timestamp;
             m_outputStream = other.m_outputStream;
         }
         return *this;
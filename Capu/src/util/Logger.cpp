@@ -31,15 +31,16 @@ namespace capu
 
     Logger::~Logger()
     {
-        ContextSet::Iterator current = m_logContexts.begin();
-        const ContextSet::Iterator end = m_logContexts.end();
+        ContextVector::Iterator current = m_contextsByName.begin();
+        const ContextVector::Iterator end = m_contextsByName.end();
 
         for(;current != end; ++current)
         {
             delete (*current);
         }
 
-        m_logContexts.clear();
+        m_contextsByName.clear();
+        m_contextsById.clear();
     }
 
     void*
@@ -53,10 +54,126 @@ namespace capu
     Logger::createContext(const String& name, const String& id)
     {
         LogContext* context = new LogContext(name, id);
-        m_logContexts.put(context);
+
+        ScopedLightweightMutexLock lock(m_contextLock);
+        // behind contexts of the same name
+        uint_t index = findContextByName(name);
+        while(index < m_contextsByName.size() && m_contextsByName[index]->getContextName() == name)
+        {
+            ++index;
+        }
+        m_contextsByName.insert(m_contextsByName.begin() + index, context);
+        if(!m_contextsById.contains(id))
+        {
+            m_contextsById.put(id, context);
+        }
         return *context;
     }
 
+    uint_t
+    Logger::findContextByName(const String& name) const
+    {
+        uint_t first = 0;
+        uint_t count = m_contextsByName.size();
+        while(count > 0)
+        {
+            const uint_t half = count / 2;
+            if(m_contextsByName[first + half]->getContextName() < name)
+            {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else
+            {
+                count = half;
+            }
+        }
+        return first;
+    }
+
+    void
+    Logger::setLogLevel(const ELogLevel logLevel, const String& filterContext)
+    {
+        ScopedLightweightMutexLock lock(m_contextLock);
+        ContextVector::Iterator current = m_contextsByName.begin();
+        const ContextVector::Iterator end = m_contextsByName.end();
+
+        for(; current != end; ++current)
+        {
+            LogContext* lc = *current;
+
+            // substrings can not be looked up in an index
+            if (filterContext == "" ||
+                lc->getContextName().find(filterContext) >= 0 ||
+                lc->getContextId().find(filterContext) >= 0)
+            {
+                lc->setLogLevel(logLevel);
+            }
+        }
+    }
+
+    void
+    Logger::setLogLevels(const vector<LogLevelRule>& rules)
+    {
+        ScopedLightweightMutexLock lock(m_contextLock);
+        HashTable<LogContext*, ELogLevel> levels;
+        for(uint_t rule = 0; rule < rules.size(); ++rule)
+        {
+            const String& prefix = rules[rule].namePrefix;
+            for(uint_t index = findContextByName(prefix); index < m_contextsByName.size(); ++index)
+            {
+                LogContext* lc = m_contextsByName[index];
+                if(!lc->getContextName().startsWith(prefix))
+                {
+                    break;
+                }
+                levels.put(lc, rules[rule].logLevel);
+            }
+        }
+
+        HashTable<LogContext*, ELogLevel>::Iterator current = levels.begin();
+        const HashTable<LogContext*, ELogLevel>::Iterator end = levels.end();
+        for(; current != end; ++current)
+        {
+            current->key->setLogLevel(current->value);
+        }
+    }
+
+    void
+    Logger::getLogLevel(const String& contextId, ELogLevel& logLevel)
+    {
+        ScopedLightweightMutexLock lock(m_contextLock);
+        ContextTable::Iterator entry = m_contextsById.find(contextId);
+        if(entry != m_contextsById.end())
+        {
+            logLevel = entry->value->getLogLevel();
+        }
+    }
+
+    void
+    Logger::getContextName(const String& contextId, String& contextName)
+    {
+        ScopedLightweightMutexLock lock(m_contextLock);
+        ContextTable::Iterator entry = m_contextsById.find(contextId);
+        if(entry != m_contextsById.end())
+        {
+            contextName = entry->value->getContextName();
+        }
+    }
+
+    void
+    Logger::getContextIds(vector<String>& contextIds)
+    {
+        ScopedLightweightMutexLock lock(m_contextLock);
+        ContextVector::Iterator current = m_contextsByName.begin();
+        const ContextVector::Iterator end = m_contextsByName.end();
+
+        for(; current != end; ++current)
+        {
+            contextIds.push_back((*current)->getContextId());
+        }
+    }
+
     void
     Logger::Log(const LogMessage& message)
     {
@@ -81,17 +198,51 @@ namespace capu
     }
 
     void
-    Logger::setEnabled(bool enabled, const String& pattern)
+    Logger::logBatch(const LogMessage* messages, uint_t count)
     {
-        ContextSet::Iterator current = m_logContexts.begin();
-        const ContextSet::Iterator end = m_logContexts.end();
+        MutexLocker lock(m_appenderLock);
+
+        AppenderSet::Iterator current = m_appenders.begin();
+        const AppenderSet::Iterator end = m_appenders.end();
 
         for(; current != end; ++current)
         {
-            if((*current)->getContextName().startsWith(pattern))
+            (*current)->logBatch(messages, count);
+        }
+    }
+
+    bool
+    Logger::claimMessage(const LogContext&, ELogLevel, LogMessage*&)
+    {
+        return true;
+    }
+
+    void
+    Logger::commitMessage(LogMessage& message)
+    {
+        log(message);
+    }
+
+    void
+    Logger::logDeferred(const LogContext& context, ELogLevel logLevel, const LogFormat& format, const LogArguments& arguments)
+    {
+        LogMessage message(context, logLevel);
+        LogArguments::Format(format.format, arguments.getData(), arguments.getSize(), message.getStream());
+        log(message);
+    }
+
+    void
+    Logger::setEnabled(bool enabled, const String& pattern)
+    {
+        ScopedLightweightMutexLock lock(m_contextLock);
+        for(uint_t index = findContextByName(pattern); index < m_contextsByName.size(); ++index)
+        {
+            LogContext* lc = m_contextsByName[index];
+            if(!lc->getContextName().startsWith(pattern))
             {
-                (*current)->setEnabled(enabled);
+                break;
             }
+            lc->setEnabled(enabled);
         }
     }
 
@@ -15,16 +15,272 @@
  */
 
 #include <capu/util/StringOutputStream.h>
+#include <capu/os/StringUtils.h>
+#include <capu/os/Memory.h>
 
 namespace capu
 {
+    namespace
+    {
+        const char DigitPairs[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        const char HexadecimalDigits[] = "0123456789ABCDEF";
+
+        /**
+         * Writes the decimal digits of value backwards, starting before end
+         * @return pointer to the first digit
+         */
+        char* FormatDecimal(uint64_t value, char* end)
+        {
+            char* position = end;
+            while(value >= 100)
+            {
+                const uint32_t pair = static_cast<uint32_t>(value % 100) * 2;
+                value /= 100;
+                position -= 2;
+                position[0] = DigitPairs[pair];
+                position[1] = DigitPairs[pair + 1];
+            }
+            if(value >= 10)
+            {
+                const uint32_t pair = static_cast<uint32_t>(value) * 2;
+                position -= 2;
+                position[0] = DigitPairs[pair];
+                position[1] = DigitPairs[pair + 1];
+            }
+            else
+            {
+                *--position = static_cast<char>('0' + value);
+            }
+            return position;
+        }
+
+        /**
+         * Float values with at most this many decimal digits are formatted without printf,
+         * multiplied with the power of ten they still fit exactly into a double
+         */
+        const uint32_t MaxExactDecimalDigits = 12;
+
+        const uint64_t PowersOfTen[MaxExactDecimalDigits + 1] =
+        {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+            1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull
+        };
+    }
+
     StringOutputStream::StringOutputStream()
-        : mBuffer()
+        : mData(mInlineBuffer)
+        , mLength(0)
+        , mCapacity(InlineCapacity)
         , mFloatingPointType(NORMAL)
         , mHexadecimalFormat(NO_HEXADECIMAL)
         , mDecimalDigits(6)
     {
-        mBuffer.reserve(16);
-        mBuffer.push_back('\0'); // initial terminating 0
+        mInlineBuffer[0] = '\0'; // initial terminating 0
+    }
+
+    StringOutputStream::StringOutputStream(const StringOutputStream& other)
+        : IOutputStream()
+        , mData(mInlineBuffer)
+        , mLength(0)
+        , mCapacity(InlineCapacity)
+        , mFloatingPointType(other.mFloatingPointType)
+        , mHexadecimalFormat(other.mHexadecimalFormat)
+        , mDecimalDigits(other.mDecimalDigits)
+    {
+        mInlineBuffer[0] = '\0';
+        write(other.mData, other.mLength);
+    }
+
+    StringOutputStream::~StringOutputStream()
+    {
+        if(mData != mInlineBuffer)
+        {
+            delete[] mData;
+        }
+    }
+
+    StringOutputStream&
+    StringOutputStream::operator=(const StringOutputStream& other)
+    {
+        if(&other != this)
+        {
+            clear();
+            write(other.mData, other.mLength);
+            mFloatingPointType = other.mFloatingPointType;
+            mHexadecimalFormat = other.mHexadecimalFormat;
+            mDecimalDigits = other.mDecimalDigits;
+        }
+        return *this;
+    }
+
+    void
+    StringOutputStream::swap(StringOutputStream& other)
+    {
+        using std::swap;
+        const bool isInline = mData == mInlineBuffer;
+        const bool otherIsInline = other.mData == other.mInlineBuffer;
+        if(isInline && otherIsInline)
+        {
+            char buffer[InlineCapacity];
+            Memory::Copy(buffer, mInlineBuffer, mLength + 1);
+            Memory::Copy(mInlineBuffer, other.mInlineBuffer, other.mLength + 1);
+            Memory::Copy(other.mInlineBuffer, buffer, mLength + 1);
+        }
+        else if(isInline)
+        {
+            Memory::Copy(other.mInlineBuffer, mInlineBuffer, mLength + 1);
+            mData = other.mData;
+            other.mData = other.mInlineBuffer;
+        }
+        else if(otherIsInline)
+        {
+            Memory::Copy(mInlineBuffer, other.mInlineBuffer, other.mLength + 1);
+            other.mData = mData;
+            mData = mInlineBuffer;
+        }
+        else
+        {
+            swap(mData, other.mData);
+        }
+        swap(mLength, other.mLength);
+        swap(mCapacity, other.mCapacity);
+        swap(mFloatingPointType, other.mFloatingPointType);
+        swap(mHexadecimalFormat, other.mHexadecimalFormat);
+        swap(mDecimalDigits, other.mDecimalDigits);
+    }
+
+    void
+    StringOutputStream::grow(const uint32_t capacity)
+    {
+        uint32_t newCapacity = mCapacity * 2;
+        if(newCapacity < capacity)
+        {
+            newCapacity = capacity;
+        }
+        char* data = new char[newCapacity];
+        Memory::Copy(data, mData, mLength + 1);
+        if(mData != mInlineBuffer)
+        {
+            delete[] mData;
+        }
+        mData = data;
+        mCapacity = newCapacity;
+    }
+
+    void
+    StringOutputStream::writeDecimal(uint64_t value, bool negative)
+    {
+        // 20 digits of the maximum uint64_t and the sign
+        char buffer[21];
+        char* const end = buffer + sizeof(buffer);
+        char* begin = FormatDecimal(value, end);
+        if(negative)
+        {
+            *--begin = '-';
+        }
+        write(begin, static_cast<uint32_t>(end - begin));
+    }
+
+    void
+    StringOutputStream::writeHexadecimal(uint64_t value, uint32_t digits)
+    {
+        // 0x and 16 digits of the maximum uint64_t
+        char buffer[18];
+        char* const end = buffer + sizeof(buffer);
+        char* begin = end;
+        do
+        {
+            *--begin = HexadecimalDigits[value & 0xF];
+            value >>= 4;
+        } while(value != 0);
+        while(static_cast<uint32_t>(end - begin) < digits)
+        {
+            *--begin = '0';
+        }
+        *--begin = 'x';
+        *--begin = '0';
+        write(begin, static_cast<uint32_t>(end - begin));
+    }
+
+    void
+    StringOutputStream::writeFloat(float value, uint32_t decimalDigits)
+    {
+        uint32_t bits = 0;
+        Memory::Copy(&bits, &value, sizeof(bits));
+        const bool negative = (bits >> 31) != 0;
+        const bool finite = ((bits >> 23) & 0xFF) != 0xFF;
+
+        // the product is exact, below 2^53 the integral and fractional part of it are exact too
+        const double maxExactValue = 9007199254740992.0;
+        double scaled = 0;
+        if(finite && decimalDigits <= MaxExactDecimalDigits)
+        {
+            scaled = static_cast<double>(value) * static_cast<double>(PowersOfTen[decimalDigits]);
+            if(negative)
+            {
+                scaled = -scaled;
+            }
+        }
+
+        if(!finite || decimalDigits > MaxExactDecimalDigits || scaled >= maxExactValue)
+        {
+            /* Maximum length float value
+               biggest/smallest: ~ +/-1e38
+               closest to zero:  ~ 1e-38
+
+               required maximum buffer length
+               - 1 sign
+               - 38 digits left of .
+               - 1 for .
+               - 38 digits right of dot + maximum 7 more relevant digits
+               - 1 for terminating \0
+               => 1+38+1+38+7+1 = 86
+            */
+            char buffer[86];
+            StringUtils::Sprintf(buffer, sizeof(buffer), "%.*f", decimalDigits, value);
+            operator<<(buffer);
+            return;
+        }
+
+        // round half to even like printf
+        uint64_t rounded = static_cast<uint64_t>(scaled);
+        const double remainder = scaled - static_cast<double>(rounded);
+        if(remainder > 0.5 || (remainder == 0.5 && (rounded & 1) != 0))
+        {
+            ++rounded;
+        }
+
+        // sign, 16 digits below 2^53 and the decimal separator
+        char buffer[18];
+        char* const end = buffer + sizeof(buffer);
+        char* begin = end;
+        if(decimalDigits > 0)
+        {
+            const uint64_t power = PowersOfTen[decimalDigits];
+            begin = FormatDecimal(rounded % power, end);
+            while(static_cast<uint32_t>(end - begin) < decimalDigits)
+            {
+                *--begin = '0';
+            }
+            *--begin = '.';
+            rounded /= power;
+        }
+        begin = FormatDecimal(rounded, begin);
+        if(negative)
+        {
+            *--begin = '-';
+        }
+        write(begin, static_cast<uint32_t>(end - begin));
     }
 }
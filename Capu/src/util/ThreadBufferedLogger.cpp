@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "capu/util/ThreadBufferedLogger.h"
+#include "capu/util/ScopedLock.h"
+#include "capu/os/Memory.h"
+#include "capu/os/Time.h"
+#include <atomic>
+
+namespace capu
+{
+    namespace
+    {
+        uint_t HashThreadId(uint_t id)
+        {
+            // thread ids are often addresses of page aligned thread control blocks
+            return id ^ (id >> 12) ^ (id >> 20);
+        }
+    }
+
+    ThreadBufferedLogger::ThreadBuffer::ThreadBuffer(uint32_t size)
+        : records(size)
+        , messageInUse(false)
+        , offset(0)
+    {
+    }
+
+    ThreadBufferedLogger::ThreadBufferedLogger(ILogAppender& appender, uint32_t bufferSize)
+        : Logger(appender)
+        , m_sinkThread("capu::ThreadBufferedLogger")
+        , m_bufferSize(bufferSize)
+        , m_sinkThreadId(0)
+        , m_droppedMessages(0)
+        , m_batch(BatchSize)
+        , m_sinkWaiting(0)
+        , m_waitingStatements(0)
+    {
+        for(uint32_t i = 0; i < MaxThreadBuffers; ++i)
+        {
+            m_threadIds[i].store(0);
+            m_threadBuffers[i].store(0);
+        }
+        m_sinkThread.start(*this);
+    }
+
+    ThreadBufferedLogger::~ThreadBufferedLogger()
+    {
+        {
+            ScopedLightweightMutexLock lock(m_sinkMutex);
+            m_sinkThread.cancel();
+            m_recordsAvailable.signal();
+        }
+        m_sinkThread.join();
+
+        // the sink collects before it finishes, this catches records appended since
+        collect();
+
+        for(uint32_t i = 0; i < MaxThreadBuffers; ++i)
+        {
+            delete m_threadBuffers[i].load();
+        }
+    }
+
+    ThreadBufferedLogger::ThreadBuffer*
+    ThreadBufferedLogger::getThreadBuffer()
+    {
+        const uint_t id = Thread::CurrentThreadId();
+        if(0 == id)
+        {
+            // 0 marks an unused entry
+            return 0;
+        }
+
+        uint_t index = HashThreadId(id);
+        for(uint32_t probe = 0; probe < MaxThreadBuffers; ++probe, ++index)
+        {
+            index &= MaxThreadBuffers - 1;
+            const uint_t entryId = m_threadIds[index].load();
+            if(entryId == id)
+            {
+                // only this thread creates its buffer, so it is set already
+                return m_threadBuffers[index].load();
+            }
+            uint_t expected = 0;
+            if(entryId == 0 && m_threadIds[index].compareExchange(expected, id))
+            {
+                ThreadBuffer* buffer = new ThreadBuffer(m_bufferSize);
+                m_threadBuffers[index] = buffer;
+                return buffer;
+            }
+        }
+        return 0;
+    }
+
+    bool
+    ThreadBufferedLogger::claimMessage(const LogContext& context, ELogLevel logLevel, LogMessage*& message)
+    {
+        ThreadBuffer* buffer = getThreadBuffer();
+        if(0 != buffer && !buffer->messageInUse)
+        {
+            buffer->messageInUse = true;
+            buffer->message.reset(context, logLevel);
+            message = &buffer->message;
+        }
+        return true;
+    }
+
+    void
+    ThreadBufferedLogger::commitMessage(LogMessage& message)
+    {
+        ThreadBuffer* buffer = getThreadBuffer();
+        appendRecord(*buffer, message);
+        buffer->messageInUse = false;
+    }
+
+    void
+    ThreadBufferedLogger::log(const LogMessage& message)
+    {
+        ThreadBuffer* buffer = getThreadBuffer();
+        if(0 == buffer)
+        {
+            Logger::log(message);
+            return;
+        }
+        appendRecord(*buffer, message);
+    }
+
+    void
+    ThreadBufferedLogger::logDeferred(const LogContext& context, ELogLevel logLevel, const LogFormat& format, const LogArguments& arguments)
+    {
+        ThreadBuffer* buffer = getThreadBuffer();
+        if(0 == buffer)
+        {
+            Logger::logDeferred(context, logLevel, format, arguments);
+            return;
+        }
+
+        RecordHeader header;
+        header.timestamp = Time::GetMicroseconds();
+        header.context = &context;
+        header.format = &format;
+        header.logLevel = static_cast<uint32_t>(logLevel);
+        header.length = arguments.getSize();
+        appendRecord(*buffer, header, arguments.getData());
+    }
+
+    uint32_t
+    ThreadBufferedLogger::getDroppedMessageCount() const
+    {
+        return m_droppedMessages.load();
+    }
+
+    void
+    ThreadBufferedLogger::appendRecord(ThreadBuffer& buffer, const LogMessage& message)
+    {
+        RecordHeader header;
+        header.timestamp = message.getTimestamp();
+        header.context = &message.getContext();
+        header.format = 0;
+        header.logLevel = static_cast<uint32_t>(message.getLogLevel());
+        header.length = message.getLogMessageLength();
+        appendRecord(buffer, header, message.getLogMessage());
+    }
+
+    void
+    ThreadBufferedLogger::appendRecord(ThreadBuffer& buffer, RecordHeader& header, const char* data)
+    {
+        // a record which does not fit into an empty buffer is truncated
+        const uint_t maxLength = buffer.records.capacity() - sizeof(RecordHeader);
+        if(header.length > maxLength)
+        {
+            header.length = static_cast<uint32_t>(maxLength);
+        }
+        const uint_t recordSize = sizeof(RecordHeader) + header.length;
+
+        // only the sink makes space, so there is still enough once the check succeeded
+        if(buffer.records.capacity() - buffer.records.size() < recordSize)
+        {
+            if(Thread::CurrentThreadId() == m_sinkThreadId.load())
+            {
+                // the sink must not wait for itself, e.g. if an appender logs
+                ++m_droppedMessages;
+                return;
+            }
+
+            wakeSink();
+            ScopedLightweightMutexLock lock(m_spaceMutex);
+            ++m_waitingStatements;
+            while(buffer.records.capacity() - buffer.records.size() < recordSize)
+            {
+                m_spaceAvailable.wait(m_spaceMutex);
+            }
+            --m_waitingStatements;
+        }
+
+        char* span = 0;
+        if(buffer.records.claimWrite(span, recordSize) == recordSize)
+        {
+            Memory::Copy(span, &header, sizeof(RecordHeader));
+            Memory::Copy(span + sizeof(RecordHeader), data, header.length);
+            buffer.records.commitWrite(recordSize);
+        }
+        else
+        {
+            // the sink only takes complete records, so header and data may be published separately
+            buffer.records.write(reinterpret_cast<const char*>(&header), sizeof(RecordHeader));
+            buffer.records.write(data, header.length);
+        }
+        wakeSink();
+    }
+
+    void
+    ThreadBufferedLogger::wakeSink()
+    {
+        // orders the release store of the write position before the check, the sink registers before it checks for records
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint32_t sinkWaiting = 1;
+        if(m_sinkWaiting.load() != 0 && m_sinkWaiting.compareExchange(sinkWaiting, 0))
+        {
+            ScopedLightweightMutexLock lock(m_sinkMutex);
+            m_recordsAvailable.signal();
+        }
+    }
+
+    bool
+    ThreadBufferedLogger::PeekRecord(const ThreadBuffer& buffer, RecordHeader& header)
+    {
+        const uint_t available = buffer.pending.size() - buffer.offset;
+        if(available < sizeof(RecordHeader))
+        {
+            return false;
+        }
+        // records are not aligned in pending
+        Memory::Copy(&header, buffer.pending.data() + buffer.offset, sizeof(RecordHeader));
+        return available - sizeof(RecordHeader) >= header.length;
+    }
+
+    bool
+    ThreadBufferedLogger::hasRecords() const
+    {
+        for(uint32_t i = 0; i < MaxThreadBuffers; ++i)
+        {
+            const ThreadBuffer* buffer = m_threadBuffers[i].load();
+            if(0 != buffer && !buffer->records.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void
+    ThreadBufferedLogger::collect()
+    {
+        // take everything the threads have written so far, which frees their buffers at once
+        m_sinkBuffers.clear();
+        for(uint32_t i = 0; i < MaxThreadBuffers; ++i)
+        {
+            ThreadBuffer* buffer = m_threadBuffers[i].load();
+            if(0 == buffer)
+            {
+                continue;
+            }
+            m_sinkBuffers.push_back(buffer);
+            const uint_t available = buffer->records.size();
+            if(available > 0)
+            {
+                const uint_t previousSize = buffer->pending.size();
+                buffer->pending.resize(previousSize + available);
+                buffer->records.read(buffer->pending.data() + previousSize, available);
+            }
+            buffer->offset = 0;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(m_waitingStatements.load() > 0)
+        {
+            ScopedLightweightMutexLock lock(m_spaceMutex);
+            m_spaceAvailable.broadcast();
+        }
+
+        // merge the records of all threads by timestamp
+        uint_t count = 0;
+        for(;;)
+        {
+            ThreadBuffer* next = 0;
+            RecordHeader nextHeader;
+            for(uint_t i = 0; i < m_sinkBuffers.size(); ++i)
+            {
+                RecordHeader header;
+                if(PeekRecord(*m_sinkBuffers[i], header) && (0 == next || header.timestamp < nextHeader.timestamp))
+                {
+                    next = m_sinkBuffers[i];
+                    nextHeader = header;
+                }
+            }
+            if(0 == next)
+            {
+                break;
+            }
+
+            LogMessage& message = m_batch[count];
+            message.reset(*nextHeader.context, static_cast<ELogLevel>(nextHeader.logLevel));
+            message.setTimestamp(nextHeader.timestamp);
+            const char* data = next->pending.data() + next->offset + sizeof(RecordHeader);
+            if(0 == nextHeader.format)
+            {
+                message.getStream().write(data, nextHeader.length);
+            }
+            else
+            {
+                LogArguments::Format(nextHeader.format->format, data, nextHeader.length, message.getStream());
+            }
+            next->offset += sizeof(RecordHeader) + nextHeader.length;
+
+            if(++count == BatchSize)
+            {
+                logBatch(m_batch.data(), count);
+                count = 0;
+            }
+        }
+        if(count > 0)
+        {
+            logBatch(m_batch.data(), count);
+        }
+
+        // keep incomplete records for the next round
+        for(uint_t i = 0; i < m_sinkBuffers.size(); ++i)
+        {
+            ThreadBuffer& buffer = *m_sinkBuffers[i];
+            const uint_t remaining = buffer.pending.size() - buffer.offset;
+            if(buffer.offset > 0 && remaining > 0)
+            {
+                Memory::Move(buffer.pending.data(), buffer.pending.data() + buffer.offset, remaining);
+            }
+            buffer.pending.resize(remaining);
+        }
+    }
+
+    void
+    ThreadBufferedLogger::run()
+    {
+        m_sinkThreadId = Thread::CurrentThreadId();
+        for(;;)
+        {
+            collect();
+
+            ScopedLightweightMutexLock lock(m_sinkMutex);
+            for(;;)
+            {
+                // register again after every wake up, the statement which woke us up deregistered us
+                m_sinkWaiting = 1;
+                if(hasRecords())
+                {
+                    break;
+                }
+                if(isCancelRequested())
+                {
+                    m_sinkWaiting = 0;
+                    return;
+                }
+                m_recordsAvailable.wait(m_sinkMutex);
+            }
+            m_sinkWaiting = 0;
+        }
+    }
+}
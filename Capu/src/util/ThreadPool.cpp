@@ -20,16 +20,33 @@
 
 const uint32_t capu::ThreadPool::MAX_THREAD_POOL_THREADS = 64;
 
-capu::ThreadPool::ThreadPool(const uint32_t size)
-    : mClosed(false)
+capu::ThreadPool::ThreadPool(const uint32_t size, const Mode mode)
+    : mMode(mode)
+    , mClosed(false)
     , mCloseRequested(false)
+    , mDequeCount(mode == WORK_STEALING ? (size < MAX_THREAD_POOL_THREADS ? size : MAX_THREAD_POOL_THREADS) : 0)
+    , mDeques(0)
+    , mWorkerThreadIds(0)
+    , mQueuedCount(0)
+    , mSleepingWorkers(0)
 {
     const uint32_t poolSize = size < MAX_THREAD_POOL_THREADS ? size : MAX_THREAD_POOL_THREADS;
 
+    if (mDequeCount > 0)
+    {
+        // every worker registers its thread id when it starts
+        mDeques = new TaskDeque[mDequeCount];
+        mWorkerThreadIds = new Atomic<uint_t>[mDequeCount];
+        for (uint32_t i = 0; i < mDequeCount; i++)
+        {
+            mWorkerThreadIds[i] = 0;
+        }
+    }
+
     // create the workers
     for (uint32_t i = 0; i < poolSize; i++)
     {
-        capu::ThreadPool::PoolWorkerPtr t(new capu::ThreadPool::PoolWorker(*this));
+        capu::ThreadPool::PoolWorkerPtr t(new capu::ThreadPool::PoolWorker(*this, i));
         if (t->isValid())
         {
             mWorkerList.insert(t);
@@ -46,6 +63,18 @@ capu::ThreadPool::~ThreadPool()
 {
     // wait for all jobs to be finished
     close();
+
+    // release tasks which were left behind by canceled workers
+    for (uint32_t i = 0; i < mDequeCount; i++)
+    {
+        Task* task = 0;
+        while ((task = mDeques[i].pop()) != 0)
+        {
+            mTaskAllocator.deallocate(task);
+        }
+    }
+    delete[] mDeques;
+    delete[] mWorkerThreadIds;
 }
 
 capu::status_t capu::ThreadPool::add(capu::shared_ptr<capu::Runnable> runnable)
@@ -56,12 +85,70 @@ capu::status_t capu::ThreadPool::add(capu::shared_ptr<capu::Runnable> runnable)
         return CAPU_ERROR;
     }
 
+    if (mMode == WORK_STEALING && addToDeque(runnable) == CAPU_OK)
+    {
+        return CAPU_OK;
+    }
+
     ScopedLightweightMutexLock lock(mMutex);
     status_t result = mRunnableQueue.push(runnable);
+    if (result == CAPU_OK && mMode == WORK_STEALING)
+    {
+        ++mQueuedCount;
+    }
     mCV.signal();
     return result;
 }
 
+capu::status_t capu::ThreadPool::addToDeque(const capu::shared_ptr<capu::Runnable>& runnable)
+{
+    // only pool threads own a deque
+    const uint_t threadId = Thread::CurrentThreadId();
+    uint32_t index = 0;
+    while (index < mDequeCount && mWorkerThreadIds[index].load() != threadId)
+    {
+        ++index;
+    }
+    if (index == mDequeCount)
+    {
+        return CAPU_ENOT_EXIST;
+    }
+
+    Task* task = mTaskAllocator.allocate();
+    task->runnable = runnable;
+    if (!mDeques[index].push(task))
+    {
+        // deque is full
+        mTaskAllocator.deallocate(task);
+        return CAPU_ENO_MEMORY;
+    }
+
+    // the deque is pushed before the sleeping workers are checked and a worker registers as sleeping
+    // before it checks the deques, so either the sleeper sees the task or the task gets signaled
+    if (mSleepingWorkers.load() > 0)
+    {
+        ScopedLightweightMutexLock lock(mMutex);
+        mCV.signal();
+    }
+    return CAPU_OK;
+}
+
+bool capu::ThreadPool::hasQueuedWork() const
+{
+    if (mQueuedCount.load() > 0)
+    {
+        return true;
+    }
+    for (uint32_t i = 0; i < mDequeCount; i++)
+    {
+        if (!mDeques[i].empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 capu::status_t capu::ThreadPool::close(bool cancelThreads)
 {
     {
@@ -108,13 +195,18 @@ capu::uint_t capu::ThreadPool::getSize() const
     return mWorkerList.size();
 }
 
+capu::ThreadPool::Mode capu::ThreadPool::getMode() const
+{
+    return mMode;
+}
+
 bool capu::ThreadPool::isClosed() const
 {
     return mClosed;
 }
 
-capu::ThreadPool::PoolRunnable::PoolRunnable(ThreadPool& pool)
-    : mPool(pool), mCurrentRunnable(NULL)
+capu::ThreadPool::PoolRunnable::PoolRunnable(ThreadPool& pool, uint32_t index)
+    : mPool(pool), mIndex(index), mCurrentRunnable(NULL)
 {
 }
 
@@ -135,6 +227,18 @@ void capu::ThreadPool::PoolRunnable::cancelCurrentRunnable()
 }
 
 void capu::ThreadPool::PoolRunnable::run()
+{
+    if (mPool.mMode == WORK_STEALING)
+    {
+        runWorkStealing();
+    }
+    else
+    {
+        runSharedQueue();
+    }
+}
+
+void capu::ThreadPool::PoolRunnable::runSharedQueue()
 {
     while (!isCancelRequested())
     {
@@ -161,23 +265,87 @@ void capu::ThreadPool::PoolRunnable::run()
         }
         if (result == CAPU_OK)
         {
-            mCurrentRunnableMutex.lock();
-            mCurrentRunnable = r.get();
-            mCurrentRunnableMutex.unlock();
-            if (mCurrentRunnable != NULL)
-            {
-                mCurrentRunnable->run();
-                mCurrentRunnableMutex.lock();
-                mCurrentRunnable = NULL;
-                mCurrentRunnableMutex.unlock();
-            }
+            execute(r.get());
+        }
+    }
+}
+
+void capu::ThreadPool::PoolRunnable::runWorkStealing()
+{
+    mPool.mWorkerThreadIds[mIndex] = Thread::CurrentThreadId();
+
+    while (!isCancelRequested())
+    {
+        shared_ptr<Runnable> r;
+        if (takeRunnable(r))
+        {
+            execute(r.get());
+            continue;
         }
+
+        ScopedLightweightMutexLock lock(mPool.mMutex);
+        ++mPool.mSleepingWorkers;
+        while (!mPool.hasQueuedWork() && !mPool.mCloseRequested && !isCancelRequested())
+        {
+            mPool.mCV.wait(mPool.mMutex); // block until a job is available
+        }
+        --mPool.mSleepingWorkers;
+        if (mPool.mCloseRequested && !mPool.hasQueuedWork())
+        {
+            break;
+        }
+    }
+}
+
+bool capu::ThreadPool::PoolRunnable::takeRunnable(shared_ptr<Runnable>& runnable)
+{
+    // own work first, newest first
+    Task* task = mPool.mDeques[mIndex].pop();
+
+    // then work added from outside of the pool
+    if (task == NULL && mPool.mQueuedCount.load() > 0)
+    {
+        ScopedLightweightMutexLock lock(mPool.mMutex);
+        if (mPool.mRunnableQueue.pop(&runnable) == CAPU_OK)
+        {
+            --mPool.mQueuedCount;
+            return true;
+        }
+    }
+
+    // finally the oldest work of the other workers
+    for (uint32_t i = 1; task == NULL && i < mPool.mDequeCount; i++)
+    {
+        task = mPool.mDeques[(mIndex + i) % mPool.mDequeCount].steal();
+    }
+
+    if (task == NULL)
+    {
+        return false;
+    }
+    runnable = task->runnable;
+    task->runnable = shared_ptr<Runnable>();
+    mPool.mTaskAllocator.deallocate(task);
+    return true;
+}
+
+void capu::ThreadPool::PoolRunnable::execute(Runnable* runnable)
+{
+    mCurrentRunnableMutex.lock();
+    mCurrentRunnable = runnable;
+    mCurrentRunnableMutex.unlock();
+    if (mCurrentRunnable != NULL)
+    {
+        mCurrentRunnable->run();
+        mCurrentRunnableMutex.lock();
+        mCurrentRunnable = NULL;
+        mCurrentRunnableMutex.unlock();
     }
 }
 
-capu::ThreadPool::PoolWorker::PoolWorker(capu::ThreadPool& pool)
+capu::ThreadPool::PoolWorker::PoolWorker(capu::ThreadPool& pool, uint32_t index)
     : mPool(pool)
-    , mPoolRunnable(mPool)
+    , mPoolRunnable(mPool, index)
     , mThread("capu::Threadpool worker")
 {
     mValid = mThread.start(mPoolRunnable) == CAPU_OK;
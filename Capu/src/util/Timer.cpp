@@ -18,13 +18,28 @@
 #include "capu/util/Timer.h"
 #include "capu/util/ScopedLock.h"
 
-capu::Timer::Timer(shared_ptr<TimerManager> timerManager, const Delegate<>& delegate, uint64_t timeoutMillis, uint32_t maxExecution)
+capu::Timer::Statistics::Statistics()
+    : executions(0)
+    , skippedExecutions(0)
+    , lastLatenessMicros(0)
+    , maxLatenessMicros(0)
+    , totalLatenessMicros(0)
+{
+
+}
+
+capu::Timer::Timer(shared_ptr<TimerManager> timerManager, const Delegate<>& delegate, uint64_t timeoutMillis, uint32_t maxExecution,
+                   Scheduling scheduling)
     : m_delegate(delegate)
     , m_timeoutMillis(timeoutMillis)
     , m_maxExecution(maxExecution)
     , m_numExecuted(0)
+    , m_scheduling(scheduling)
     , m_registered(false)
     , m_currentTimerManager(timerManager)
+    , m_queueIndex(NotQueued)
+    , m_nextExecutionTime(0)
+    , m_execution(new TimerManager::Execution(*this))
 {
 
 }
@@ -33,6 +48,8 @@ capu::Timer::~Timer()
 {
     ScopedLock<Mutex> mutexGuard(m_currentTimerManager->m_managerMutex);
     m_currentTimerManager->unregisterTimer(*this);
+    //a withdrawn execution may still be queued on the pool
+    m_execution->m_timer = NULL;
 }
 
 uint64_t capu::Timer::getTimeout() const
@@ -60,8 +77,8 @@ void capu::Timer::stop()
 void capu::Timer::restart()
 {
     ScopedLock<Mutex> mutexGuard(m_currentTimerManager->m_managerMutex);
-    stop();
-    start();
+    m_currentTimerManager->unregisterTimer(*this);
+    m_registered = m_currentTimerManager->registerTimer(*this);
 }
 
 uint32_t capu::Timer::executionsRemaining() const
@@ -83,16 +100,8 @@ bool capu::Timer::maxExecutionsReached() const
     return executionsRemaining() == 0;
 }
 
-void capu::Timer::execute() const
+capu::Timer::Statistics capu::Timer::getStatistics() const
 {
     ScopedLock<Mutex> mutexGuard(m_currentTimerManager->m_managerMutex);
-    if (!maxExecutionsReached())
-    {
-        ++m_numExecuted;
-        if (!(m_delegate == Delegate<>()))
-        {
-            //note: the 'this' object might be deleted in the call
-            m_delegate();
-        }
-    }
+    return m_statistics;
 }
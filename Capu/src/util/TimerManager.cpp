@@ -16,13 +16,21 @@
 
 #include "capu/util/TimerManager.h"
 #include "capu/util/Timer.h"
+#include "capu/util/ThreadPool.h"
 #include "capu/util/ScopedLock.h"
 #include "capu/os/Time.h"
 
+namespace
+{
+    // arity of the heap, a wider heap is flatter and touches fewer cache lines on the way down
+    const capu::uint_t HeapArity = 4;
+
+    const uint64_t NanosecondsPerMillisecond = 1000000;
+}
 
-capu::shared_ptr<capu::TimerManager> capu::TimerManager::GetNewTimerManager(const String& timerThreadName)
+capu::shared_ptr<capu::TimerManager> capu::TimerManager::GetNewTimerManager(const String& timerThreadName, ThreadPool* pool)
 {
-    return shared_ptr<TimerManager>(new TimerManager(timerThreadName));
+    return shared_ptr<TimerManager>(new TimerManager(timerThreadName, pool));
 }
 
 capu::TimerManager::~TimerManager()
@@ -37,7 +45,11 @@ capu::TimerManager::~TimerManager()
         if (m_threadRunning)
         {
             //clear all executions just to be safe
-            m_queuedExecutions.clear();
+            for (TimerQueue::Iterator it = m_queuedTimers.begin(); it != m_queuedTimers.end(); ++it)
+            {
+                (*it)->m_queueIndex = Timer::NotQueued;
+            }
+            m_queuedTimers.clear();
             wakeThread = true;
         }
     }
@@ -48,145 +60,272 @@ capu::TimerManager::~TimerManager()
     }
 }
 
-capu::TimerManager::Execution::Execution()
-    : m_timer(NULL)
-    , m_executionTime(0)
+capu::TimerManager::Execution::Execution(Timer& timer)
+    : m_timer(&timer)
+    , m_pending(false)
+    , m_withdrawn(false)
+    , m_executing(false)
+    , m_executingThread(0)
+    , m_dueTime(0)
 {
 
 }
 
-capu::TimerManager::Execution::Execution(const Timer& timer)
-    : m_timer(&timer)
-    , m_executionTime(0)
+void capu::TimerManager::Execution::run()
 {
-    m_executionTime = Time::GetMilliseconds() + timer.getTimeout();
+    // no other dispatch touches the reference while the execution is pending
+    shared_ptr<TimerManager> manager = m_dispatchingManager;
+    m_dispatchingManager.reset();
+    manager->execute(*this);
 }
 
-const capu::Timer& capu::TimerManager::Execution::getTimer() const
+capu::TimerManager::TimerManager(const String& timerThreadName, ThreadPool* pool)
+    : m_waitThread(timerThreadName)
+    , m_pool(pool)
+    , m_threadRunning(false)
 {
-    return *m_timer;
+
 }
 
-uint64_t capu::TimerManager::Execution::getExecutionTime() const
+void capu::TimerManager::place(Timer* timer, uint_t index)
 {
-    return m_executionTime;
+    m_queuedTimers[index] = timer;
+    timer->m_queueIndex = index;
 }
 
-bool capu::TimerManager::Execution::operator<(const TimerManager::Execution& other) const
+void capu::TimerManager::siftUp(uint_t index)
 {
-    return getExecutionTime() < other.getExecutionTime();
+    Timer* timer = m_queuedTimers[index];
+    while (index > 0)
+    {
+        const uint_t parent = (index - 1) / HeapArity;
+        if (m_queuedTimers[parent]->m_nextExecutionTime <= timer->m_nextExecutionTime)
+        {
+            break;
+        }
+        place(m_queuedTimers[parent], index);
+        index = parent;
+    }
+    place(timer, index);
 }
 
-capu::TimerManager::TimerManager(const String& timerThreadName)
-    : m_waitThread(timerThreadName)
-    , m_threadRunning(false)
+void capu::TimerManager::siftDown(uint_t index)
 {
+    const uint_t size = m_queuedTimers.size();
+    Timer* timer = m_queuedTimers[index];
+    for (;;)
+    {
+        const uint_t firstChild = index * HeapArity + 1;
+        if (firstChild >= size)
+        {
+            break;
+        }
+        const uint_t lastChild = (firstChild + HeapArity < size) ? firstChild + HeapArity : size;
+        uint_t earliest = firstChild;
+        for (uint_t child = firstChild + 1; child < lastChild; ++child)
+        {
+            if (m_queuedTimers[child]->m_nextExecutionTime < m_queuedTimers[earliest]->m_nextExecutionTime)
+            {
+                earliest = child;
+            }
+        }
+        if (timer->m_nextExecutionTime <= m_queuedTimers[earliest]->m_nextExecutionTime)
+        {
+            break;
+        }
+        place(m_queuedTimers[earliest], index);
+        index = earliest;
+    }
+    place(timer, index);
+}
 
+void capu::TimerManager::insertExecution(Timer& timer)
+{
+    m_queuedTimers.push_back(&timer);
+    siftUp(m_queuedTimers.size() - 1);
 }
 
-void capu::TimerManager::insertExecution(const Timer& timer)
+void capu::TimerManager::removeExecution(Timer& timer)
 {
-    Execution newExecution(timer);
-    ExecutionsContainer::iterator begin = m_queuedExecutions.begin();
-    ExecutionsContainer::iterator end = m_queuedExecutions.end();
-    while (begin != end)
+    const uint_t index = timer.m_queueIndex;
+    if (index == Timer::NotQueued)
     {
-        ExecutionsContainer::iterator center = begin + ((end - begin) / 2);
-        if (*center < newExecution)
+        return;
+    }
+    timer.m_queueIndex = Timer::NotQueued;
+
+    // fill the gap with the last timer and restore the heap around it
+    Timer* last = m_queuedTimers[m_queuedTimers.size() - 1];
+    m_queuedTimers.pop_back();
+    if (last != &timer)
+    {
+        place(last, index);
+        if (index > 0 && last->m_nextExecutionTime < m_queuedTimers[(index - 1) / HeapArity]->m_nextExecutionTime)
         {
-            begin = center + 1;
+            siftUp(index);
         }
         else
         {
-            end = center;
+            siftDown(index);
         }
     }
-    m_queuedExecutions.insert(begin, newExecution);
 }
 
 bool capu::TimerManager::registerTimer(Timer& timer)
 {
-    bool bRegistered = false;
-    if (!timer.maxExecutionsReached())
+    if (timer.maxExecutionsReached())
+    {
+        return false;
+    }
+
+    //add the next execution of the timer to the queue
+    timer.m_nextExecutionTime = Time::GetMonotonicNanoseconds() + timer.m_timeoutMillis * NanosecondsPerMillisecond;
+    insertExecution(timer);
+    if (!m_threadRunning)
     {
-        bool wakeThread = true;
+        m_threadRunning = true;
+        if (m_waitThread.getState() != TS_NEW)
         {
-            //add the next execution of the timer to the queue
-            ScopedLock<Mutex> mutexGuard(m_managerMutex);
-            bRegistered = true;
-            insertExecution(timer);
-            if (!m_threadRunning)
-            {
-                m_threadRunning = true;
-                wakeThread = false;
-                if (m_waitThread.getState() != TS_NEW)
-                {
-                    m_waitThread.join();
-                }
-                m_waitThread.start(*this);
-            }
+            m_waitThread.join();
         }
-        if (wakeThread)
+        m_waitThread.start(*this);
+    }
+    else if (timer.m_queueIndex == 0)
+    {
+        //wake thread to handle the new earliest execution
+        m_sleepConditionVariable.signal();
+    }
+    return true;
+}
+
+void capu::TimerManager::unregisterTimer(Timer& timer)
+{
+    //delete future executions of the timer, a later first execution only lets the thread wake up in vain
+    removeExecution(timer);
+
+    Execution& execution = *timer.m_execution;
+    if (execution.m_pending && !execution.m_executing && !execution.m_withdrawn)
+    {
+        execution.m_withdrawn = true;
+        --timer.m_numExecuted;
+    }
+    const uint_t currentThread = Thread::CurrentThreadId();
+    while (execution.m_executing && execution.m_executingThread != currentThread)
+    {
+        m_executionFinishedConditionVariable.wait(m_managerMutex);
+    }
+}
+
+capu::shared_ptr<capu::TimerManager::Execution> capu::TimerManager::dispatchExecution(Timer& timer)
+{
+    shared_ptr<Execution> execution = timer.m_execution;
+    if (execution->m_pending)
+    {
+        //the previous execution did not finish yet, skip this one
+        ++timer.m_statistics.skippedExecutions;
+        return shared_ptr<Execution>();
+    }
+    execution->m_pending = true;
+    execution->m_dueTime = timer.m_nextExecutionTime;
+    ++timer.m_numExecuted;
+
+    if (m_pool != NULL)
+    {
+        execution->m_dispatchingManager = timer.m_currentTimerManager;
+        if (m_pool->add(execution) == CAPU_OK)
         {
-            //wake thread to handle the modified queue
-            m_sleepConditionVariable.signal();
+            return shared_ptr<Execution>();
         }
+        //the pool is closed, execute in the timer thread instead
+        execution->m_dispatchingManager.reset();
     }
-    return bRegistered;
+    return execution;
 }
 
-void capu::TimerManager::unregisterTimer(const Timer& timer)
+void capu::TimerManager::execute(Execution& execution)
 {
+    Delegate<> delegate;
     {
-        //delete future executions of the timer
         ScopedLock<Mutex> mutexGuard(m_managerMutex);
-        for (ExecutionsContainer::Iterator it = m_queuedExecutions.begin(); it != m_queuedExecutions.end();)
+        if (execution.m_timer == NULL || execution.m_withdrawn)
         {
-            if (&it->getTimer() == &timer)
-            {
-                m_queuedExecutions.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
+            execution.m_pending = false;
+            execution.m_withdrawn = false;
+            return;
+        }
+        execution.m_executing = true;
+        execution.m_executingThread = Thread::CurrentThreadId();
+
+        Timer& timer = *execution.m_timer;
+        const uint64_t now = Time::GetMonotonicNanoseconds();
+        const uint64_t latenessMicros = now > execution.m_dueTime ? (now - execution.m_dueTime) / 1000 : 0;
+        Timer::Statistics& statistics = timer.m_statistics;
+        ++statistics.executions;
+        statistics.lastLatenessMicros = latenessMicros;
+        statistics.totalLatenessMicros += latenessMicros;
+        if (latenessMicros > statistics.maxLatenessMicros)
+        {
+            statistics.maxLatenessMicros = latenessMicros;
         }
+        delegate = timer.m_delegate;
     }
-    //wake thread to handle the modified queue
-    m_sleepConditionVariable.signal();
+
+    if (!(delegate == Delegate<>()))
+    {
+        //note: the timer might be deleted in the call
+        delegate();
+    }
+
+    ScopedLock<Mutex> mutexGuard(m_managerMutex);
+    execution.m_executing = false;
+    execution.m_pending = false;
+    m_executionFinishedConditionVariable.broadcast();
 }
 
 void capu::TimerManager::run()
 {
+    m_managerMutex.lock();
     while (!isCancelRequested())
     {
-        ScopedLock<Mutex> mutexGuard(m_managerMutex);
-        if (m_queuedExecutions.empty())
+        if (m_queuedTimers.empty())
         {
             //no more execution queued, stop the thread
             m_threadRunning = false;
             break;
         }
-        uint64_t currentTime = Time::GetMilliseconds();
-        ExecutionsContainer::Iterator nextExecutionIt = m_queuedExecutions.begin();
-        if (nextExecutionIt->getExecutionTime() <= currentTime)
+        const uint64_t currentTime = Time::GetMonotonicNanoseconds();
+        Timer& nextTimer = *m_queuedTimers[0];
+        if (nextTimer.m_nextExecutionTime <= currentTime)
         {
-            //it is time to execute
-            const Timer& timerToExecute = nextExecutionIt->getTimer();
-            //replace the old execution with a new one
-            m_queuedExecutions.erase(nextExecutionIt);
-            if (timerToExecute.executionsRemaining() > 1)
+            //it is time to execute, replace the old execution with a new one
+            removeExecution(nextTimer);
+            shared_ptr<Execution> execution = dispatchExecution(nextTimer);
+            if (!nextTimer.maxExecutionsReached())
             {
-                //do not add a new execution if less then 2 executions remain
-                insertExecution(timerToExecute);
+                //a fixed rate keeps the grid of due times, missed executions are due immediately
+                const uint64_t base = (nextTimer.m_scheduling == Timer::FIXED_RATE) ? nextTimer.m_nextExecutionTime : currentTime;
+                nextTimer.m_nextExecutionTime = base + nextTimer.m_timeoutMillis * NanosecondsPerMillisecond;
+                insertExecution(nextTimer);
+            }
+            if (execution)
+            {
+                m_managerMutex.unlock();
+                execute(*execution);
+                m_managerMutex.lock();
             }
-            timerToExecute.execute();
         }
         else
         {
-            //sleep until the next execution, or until  a timer is (un)registered
-            const uint64_t sleepTime = nextExecutionIt->getExecutionTime() - currentTime;
-            m_sleepConditionVariable.wait(m_managerMutex, static_cast<const uint32_t>(sleepTime));
+            //sleep until the next execution, or until a timer is registered
+            //round up, waking up too early would only cause another wait
+            uint64_t sleepTime = (nextTimer.m_nextExecutionTime - currentTime + NanosecondsPerMillisecond - 1) / NanosecondsPerMillisecond;
+            if (sleepTime > 0xFFFFFFFFu)
+            {
+                //a wait of 0 would not return at all
+                sleepTime = 0xFFFFFFFFu;
+            }
+            m_sleepConditionVariable.wait(m_managerMutex, static_cast<uint32_t>(sleepTime));
         }
     }
+    m_managerMutex.unlock();
 }
@@ -20,6 +20,8 @@
 #include "capu/container/BlockingQueue.h"
 #include "capu/util/ThreadPool.h"
 #include "capu/os/Atomic.h"
+#include "capu/os/Time.h"
+#include "capu/container/vector.h"
 
 using namespace capu;
 
@@ -149,3 +151,132 @@ TEST(BlockingQueue, PushPopMultiThread)
 
     EXPECT_EQ(Producer::mSum.load(), Consumer::mSum.load());
 }
+
+TEST(BlockingQueue, PushBatchKeepsOrder)
+{
+    capu::BlockingQueue<int32_t> queue;
+    const int32_t values[] = { 1, 2, 3 };
+    queue.pushBatch(values, values + 3);
+    queue.push(4);
+
+    for (int32_t i = 1; i <= 4; ++i)
+    {
+        int32_t val = 0;
+        EXPECT_EQ(capu::CAPU_OK, queue.pop(&val, 10));
+        EXPECT_EQ(i, val);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BlockingQueue, PopBatchTakesAtMostMaxCount)
+{
+    capu::BlockingQueue<int32_t> queue;
+    capu::vector<int32_t> values;
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        values.push_back(i);
+    }
+    queue.pushBatch(values.begin(), values.end());
+
+    capu::List<int32_t> popped;
+    EXPECT_EQ(capu::CAPU_OK, queue.popBatch(popped, 3, 10));
+    ASSERT_EQ(3u, popped.size());
+    EXPECT_EQ(0, popped.get(0));
+    EXPECT_EQ(2, popped.get(2));
+
+    EXPECT_EQ(capu::CAPU_OK, queue.popBatch(popped, 3, 10));
+    ASSERT_EQ(5u, popped.size());
+    EXPECT_EQ(4, popped.get(4));
+
+    EXPECT_EQ(capu::CAPU_ETIMEOUT, queue.popBatch(popped, 3, 10));
+    EXPECT_EQ(capu::CAPU_EINVAL, queue.popBatch(popped, 0, 10));
+    EXPECT_EQ(5u, popped.size());
+}
+
+TEST(BlockingQueue, DrainToTakesAllElementsWithoutWaiting)
+{
+    capu::BlockingQueue<int32_t> queue;
+    capu::List<int32_t> drained;
+    EXPECT_EQ(0u, queue.drainTo(drained));
+
+    queue.push(1);
+    queue.push(2);
+    EXPECT_EQ(2u, queue.drainTo(drained));
+    ASSERT_EQ(2u, drained.size());
+    EXPECT_EQ(1, drained.get(0));
+    EXPECT_EQ(2, drained.get(1));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BlockingQueue, PushBatchWakesUpAllWaitingConsumers)
+{
+    capu::BlockingQueue<int32_t> queue;
+    capu::ThreadPool pool(3);
+    capu::vector<capu::Future<capu::status_t> > consumers;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        consumers.push_back(pool.submit([&queue]()
+        {
+            capu::List<int32_t> popped;
+            return queue.popBatch(popped, 1, 1000);
+        }));
+    }
+    capu::Thread::Sleep(20);
+
+    const int32_t values[] = { 1, 2, 3 };
+    queue.pushBatch(values, values + 3);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(capu::CAPU_OK, consumers[i].get());
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BlockingQueuePerformanceTest, DISABLED_BatchForwarding)
+{
+    const uint32_t elementCount = 1000000;
+    const uint32_t batchSize = 256;
+    capu::ThreadPool pool(1);
+
+    capu::BlockingQueue<uint32_t> singleQueue;
+    uint64_t start = capu::Time::GetMicroseconds();
+    capu::Future<void> singleConsumer = pool.submit([&singleQueue, elementCount]()
+    {
+        uint32_t val = 0;
+        for (uint32_t i = 0; i < elementCount; ++i)
+        {
+            singleQueue.pop(&val);
+        }
+    });
+    for (uint32_t i = 0; i < elementCount; ++i)
+    {
+        singleQueue.push(i);
+    }
+    singleConsumer.wait();
+    const uint64_t singleTime = capu::Time::GetMicroseconds() - start;
+
+    capu::BlockingQueue<uint32_t> batchQueue;
+    start = capu::Time::GetMicroseconds();
+    capu::Future<void> batchConsumer = pool.submit([&batchQueue, elementCount, batchSize]()
+    {
+        uint32_t received = 0;
+        capu::List<uint32_t> batch;
+        while (received < elementCount)
+        {
+            batchQueue.popBatch(batch, batchSize);
+            received += static_cast<uint32_t>(batch.size());
+            batch.clear();
+        }
+    });
+    capu::vector<uint32_t> batch(batchSize);
+    for (uint32_t i = 0; i < elementCount; i += batchSize)
+    {
+        const uint32_t count = (elementCount - i < batchSize) ? elementCount - i : batchSize;
+        batchQueue.pushBatch(batch.begin(), batch.begin() + count);
+    }
+    batchConsumer.wait();
+    const uint64_t batchTime = capu::Time::GetMicroseconds() - start;
+
+    printf("%u elements: single push/pop %.2f M/s, batches of %u %.2f M/s\n", elementCount,
+        static_cast<double>(elementCount) / singleTime, batchSize, static_cast<double>(elementCount) / batchTime);
+}
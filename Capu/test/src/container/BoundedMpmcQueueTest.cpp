@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/container/BoundedMpmcQueue.h"
+#include "capu/container/BlockingQueue.h"
+#include "capu/container/vector.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Time.h"
+
+TEST(BoundedMpmcQueue, IsEmptyAfterConstruction)
+{
+    capu::BoundedMpmcQueue<uint32_t, 4> queue;
+    uint32_t value = 0;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0u, queue.size());
+    EXPECT_EQ(4u, queue.capacity());
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedMpmcQueue, PopsInOrderOfPush)
+{
+    capu::BoundedMpmcQueue<uint32_t, 4> queue;
+    EXPECT_TRUE(queue.tryPush(1));
+    EXPECT_TRUE(queue.tryPush(2));
+    EXPECT_TRUE(queue.tryPush(3));
+    EXPECT_EQ(3u, queue.size());
+
+    uint32_t value = 0;
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(1u, value);
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(2u, value);
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(3u, value);
+    EXPECT_FALSE(queue.tryPop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedMpmcQueue, TryPushFailsIfFull)
+{
+    capu::BoundedMpmcQueue<uint32_t, 4> queue;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(4));
+    EXPECT_EQ(4u, queue.size());
+
+    // popping makes room again and the slots are reused for many rounds
+    uint32_t value = 0;
+    for (uint32_t i = 4; i < 100; ++i)
+    {
+        EXPECT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(i - 4, value);
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+}
+
+TEST(BoundedMpmcQueue, BlockingCallsTimeOut)
+{
+    capu::BoundedMpmcQueue<uint32_t, 2> queue;
+    uint32_t value = 0;
+    EXPECT_EQ(capu::CAPU_ETIMEOUT, queue.pop(&value, 10));
+
+    EXPECT_EQ(capu::CAPU_OK, queue.push(1, 10));
+    EXPECT_EQ(capu::CAPU_OK, queue.push(2, 10));
+    EXPECT_EQ(capu::CAPU_ETIMEOUT, queue.push(3, 10));
+
+    EXPECT_EQ(capu::CAPU_OK, queue.pop(&value, 10));
+    EXPECT_EQ(1u, value);
+    EXPECT_EQ(capu::CAPU_OK, queue.pop(0, 10));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedMpmcQueue, PopWakesUpOnPush)
+{
+    capu::BoundedMpmcQueue<uint32_t, 2> queue;
+    capu::ThreadPool pool(1);
+    capu::Future<uint32_t> popped = pool.submit([&queue]()
+    {
+        uint32_t value = 0;
+        queue.pop(&value);
+        return value;
+    });
+    capu::Thread::Sleep(20);
+    EXPECT_TRUE(queue.tryPush(42));
+    EXPECT_EQ(42u, popped.get());
+}
+
+TEST(BoundedMpmcQueue, PushWakesUpOnPop)
+{
+    capu::BoundedMpmcQueue<uint32_t, 2> queue;
+    EXPECT_TRUE(queue.tryPush(1));
+    EXPECT_TRUE(queue.tryPush(2));
+    capu::ThreadPool pool(1);
+    capu::Future<capu::status_t> pushed = pool.submit([&queue]()
+    {
+        return queue.push(3);
+    });
+    capu::Thread::Sleep(20);
+    EXPECT_FALSE(pushed.isReady());
+
+    uint32_t value = 0;
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(capu::CAPU_OK, pushed.get());
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(3u, value);
+}
+
+TEST(BoundedMpmcQueue, ManyProducersAndConsumersTransferEveryElementOnce)
+{
+    const uint32_t producerCount = 4;
+    const uint32_t consumerCount = 4;
+    const uint32_t elementsPerProducer = 20000;
+    capu::BoundedMpmcQueue<uint32_t, 64> queue;
+    capu::Atomic<uint32_t> received[producerCount * elementsPerProducer / 32];
+    for (uint32_t i = 0; i < producerCount * elementsPerProducer / 32; ++i)
+    {
+        received[i].store(0);
+    }
+    capu::Atomic<uint32_t> duplicates(0);
+
+    capu::ThreadPool pool(producerCount + consumerCount);
+    capu::vector<capu::Future<void> > workers;
+    for (uint32_t c = 0; c < consumerCount; ++c)
+    {
+        workers.push_back(pool.submit([&]()
+        {
+            for (uint32_t i = 0; i < producerCount * elementsPerProducer / consumerCount; ++i)
+            {
+                uint32_t value = 0;
+                queue.pop(&value);
+                const uint32_t bit = 1u << (value % 32);
+                // mark the element as received, count it if it was received before
+                uint32_t expected = received[value / 32].load();
+                while (!received[value / 32].compareExchange(expected, expected | bit))
+                {
+                }
+                if ((expected & bit) != 0)
+                {
+                    ++duplicates;
+                }
+            }
+        }));
+    }
+    for (uint32_t p = 0; p < producerCount; ++p)
+    {
+        workers.push_back(pool.submit([&queue, p]()
+        {
+            for (uint32_t i = 0; i < elementsPerProducer; ++i)
+            {
+                queue.push(p * elementsPerProducer + i);
+            }
+        }));
+    }
+    for (uint32_t i = 0; i < workers.size(); ++i)
+    {
+        EXPECT_EQ(capu::CAPU_OK, workers[i].wait());
+    }
+
+    EXPECT_EQ(0u, duplicates.load());
+    for (uint32_t i = 0; i < producerCount * elementsPerProducer / 32; ++i)
+    {
+        EXPECT_EQ(0xFFFFFFFFu, received[i].load());
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+namespace
+{
+    /**
+     * Moves elements from producers to consumers through a queue and returns the elapsed microseconds
+     */
+    template<typename Queue>
+    uint64_t MeasureThroughput(Queue& queue, uint32_t producerCount, uint32_t consumerCount, uint32_t elementCount)
+    {
+        capu::ThreadPool pool(producerCount + consumerCount);
+        capu::vector<capu::Future<void> > workers;
+        const uint64_t start = capu::Time::GetMicroseconds();
+        for (uint32_t c = 0; c < consumerCount; ++c)
+        {
+            workers.push_back(pool.submit([&queue, elementCount, consumerCount]()
+            {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < elementCount / consumerCount; ++i)
+                {
+                    queue.pop(&value);
+                }
+            }));
+        }
+        for (uint32_t p = 0; p < producerCount; ++p)
+        {
+            workers.push_back(pool.submit([&queue, elementCount, producerCount]()
+            {
+                for (uint32_t i = 0; i < elementCount / producerCount; ++i)
+                {
+                    queue.push(i);
+                }
+            }));
+        }
+        for (uint32_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i].wait();
+        }
+        return capu::Time::GetMicroseconds() - start;
+    }
+
+    /**
+     * Sends an element back and forth between two threads and returns the average round trip in microseconds
+     */
+    template<typename Queue>
+    double MeasureRoundTrip(Queue& request, Queue& response, uint32_t roundTrips)
+    {
+        capu::ThreadPool pool(1);
+        capu::Future<void> echo = pool.submit([&request, &response, roundTrips]()
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < roundTrips; ++i)
+            {
+                request.pop(&value);
+                response.push(value);
+            }
+        });
+        const uint64_t start = capu::Time::GetMicroseconds();
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < roundTrips; ++i)
+        {
+            request.push(i);
+            response.pop(&value);
+        }
+        const uint64_t elapsed = capu::Time::GetMicroseconds() - start;
+        echo.wait();
+        return static_cast<double>(elapsed) / roundTrips;
+    }
+
+    void PrintThroughput(const char* name, uint32_t elementCount, uint64_t boundedMicros, uint64_t blockingMicros)
+    {
+        printf("%s: BoundedMpmcQueue %.2f M/s, BlockingQueue %.2f M/s\n", name,
+            static_cast<double>(elementCount) / boundedMicros, static_cast<double>(elementCount) / blockingMicros);
+    }
+}
+
+TEST(BoundedMpmcQueuePerformanceTest, DISABLED_ThroughputAndLatency)
+{
+    const uint32_t elementCount = 1200000;
+    const uint32_t configurations[3][2] = { { 1, 1 }, { 4, 1 }, { 4, 4 } };
+    const char* names[3] = { "SPSC", "MPSC", "MPMC" };
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        capu::BoundedMpmcQueue<uint32_t, 1024>* bounded = new capu::BoundedMpmcQueue<uint32_t, 1024>();
+        const uint64_t boundedMicros = MeasureThroughput(*bounded, configurations[i][0], configurations[i][1], elementCount);
+        delete bounded;
+
+        capu::BlockingQueue<uint32_t> blocking;
+        const uint64_t blockingMicros = MeasureThroughput(blocking, configurations[i][0], configurations[i][1], elementCount);
+        PrintThroughput(names[i], elementCount, boundedMicros, blockingMicros);
+    }
+
+    const uint32_t roundTrips = 20000;
+    capu::BoundedMpmcQueue<uint32_t, 1024>* boundedRequest = new capu::BoundedMpmcQueue<uint32_t, 1024>();
+    capu::BoundedMpmcQueue<uint32_t, 1024>* boundedResponse = new capu::BoundedMpmcQueue<uint32_t, 1024>();
+    const double boundedRoundTrip = MeasureRoundTrip(*boundedRequest, *boundedResponse, roundTrips);
+    delete boundedRequest;
+    delete boundedResponse;
+
+    capu::BlockingQueue<uint32_t> blockingRequest;
+    capu::BlockingQueue<uint32_t> blockingResponse;
+    const double blockingRoundTrip = MeasureRoundTrip(blockingRequest, blockingResponse, roundTrips);
+    printf("round trip: BoundedMpmcQueue %.2f us, BlockingQueue %.2f us\n", boundedRoundTrip, blockingRoundTrip);
+}
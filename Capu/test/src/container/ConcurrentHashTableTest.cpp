@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/container/ConcurrentHashTable.h"
+#include "capu/container/String.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Time.h"
+#include "capu/util/ReadWriteLock.h"
+#include "capu/util/Runnable.h"
+
+namespace
+{
+    typedef capu::ConcurrentHashTable<uint32_t, uint32_t> UInt32ConcurrentHashTable;
+
+    class ConcurrentHashTableTest : public ::testing::TestWithParam<bool>
+    {
+    };
+
+    INSTANTIATE_TEST_CASE_P(LockedAndLockFreeReads, ConcurrentHashTableTest, ::testing::Values(false, true));
+}
+
+TEST_P(ConcurrentHashTableTest, PutAndGet)
+{
+    UInt32ConcurrentHashTable table(4, GetParam());
+    EXPECT_EQ(0u, table.count());
+
+    EXPECT_EQ(capu::CAPU_OK, table.put(1, 10));
+    EXPECT_EQ(capu::CAPU_OK, table.put(2, 20));
+    EXPECT_EQ(2u, table.count());
+
+    uint32_t value = 0;
+    EXPECT_EQ(capu::CAPU_OK, table.get(1, value));
+    EXPECT_EQ(10u, value);
+    EXPECT_EQ(capu::CAPU_OK, table.get(2, value));
+    EXPECT_EQ(20u, value);
+    EXPECT_EQ(capu::CAPU_ENOT_EXIST, table.get(3, value));
+    EXPECT_EQ(20u, value);
+}
+
+TEST_P(ConcurrentHashTableTest, PutReturnsOldValue)
+{
+    UInt32ConcurrentHashTable table(4, GetParam());
+    table.put(1, 10);
+
+    uint32_t oldValue = 0;
+    EXPECT_EQ(capu::CAPU_OK, table.put(1, 11, &oldValue));
+    EXPECT_EQ(10u, oldValue);
+    EXPECT_EQ(1u, table.count());
+}
+
+TEST_P(ConcurrentHashTableTest, ContainsAndRemove)
+{
+    UInt32ConcurrentHashTable table(4, GetParam());
+    table.put(1, 10);
+    EXPECT_TRUE(table.contains(1));
+    EXPECT_FALSE(table.contains(2));
+
+    uint32_t oldValue = 0;
+    EXPECT_EQ(capu::CAPU_OK, table.remove(1, &oldValue));
+    EXPECT_EQ(10u, oldValue);
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_EQ(capu::CAPU_ERANGE, table.remove(1));
+    EXPECT_EQ(0u, table.count());
+}
+
+TEST_P(ConcurrentHashTableTest, Clear)
+{
+    UInt32ConcurrentHashTable table(4, GetParam());
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        table.put(i, i);
+    }
+    EXPECT_EQ(100u, table.count());
+
+    table.clear();
+    EXPECT_EQ(0u, table.count());
+    EXPECT_FALSE(table.contains(5));
+}
+
+TEST_P(ConcurrentHashTableTest, WorksWithStringKeys)
+{
+    capu::ConcurrentHashTable<capu::String, capu::String> table(2, GetParam());
+    table.put("key", "value");
+
+    capu::String value;
+    EXPECT_EQ(capu::CAPU_OK, table.get("key", value));
+    EXPECT_STREQ("value", value.c_str());
+}
+
+TEST_P(ConcurrentHashTableTest, SingleShard)
+{
+    UInt32ConcurrentHashTable table(0, GetParam());
+    EXPECT_EQ(1u, table.getShardCount());
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        table.put(i, i);
+    }
+    EXPECT_EQ(100u, table.getShardStatistics(0).count);
+}
+
+TEST_P(ConcurrentHashTableTest, KeysAreSpreadOverShards)
+{
+    UInt32ConcurrentHashTable table(3, GetParam());
+    EXPECT_EQ(8u, table.getShardCount());
+    for (uint32_t i = 0; i < 8000; ++i)
+    {
+        table.put(i, i);
+    }
+
+    capu::uint_t total = 0;
+    for (uint32_t i = 0; i < table.getShardCount(); ++i)
+    {
+        const UInt32ConcurrentHashTable::ShardStatistics statistics = table.getShardStatistics(i);
+        EXPECT_GT(statistics.count, 800u);
+        EXPECT_LT(statistics.count, 1200u);
+        total += statistics.count;
+    }
+    EXPECT_EQ(8000u, total);
+}
+
+TEST_P(ConcurrentHashTableTest, StatisticsCountLocks)
+{
+    UInt32ConcurrentHashTable table(0, GetParam());
+    table.put(1, 1);
+    table.put(2, 2);
+    table.remove(2);
+
+    const UInt32ConcurrentHashTable::ShardStatistics statistics = table.getShardStatistics(0);
+    EXPECT_EQ(1u, statistics.count);
+    EXPECT_EQ(3u, statistics.lockCount);
+    EXPECT_EQ(0u, statistics.contendedLockCount);
+    EXPECT_EQ(0u, statistics.lockWaitTime);
+}
+
+TEST(ConcurrentHashTableLockFreeTest, ReadsDoNotLock)
+{
+    UInt32ConcurrentHashTable table(0, true);
+    table.put(1, 1);
+
+    uint32_t value = 0;
+    table.get(1, value);
+    table.contains(1);
+
+    EXPECT_EQ(1u, table.getShardStatistics(0).lockCount);
+}
+
+namespace
+{
+    template<typename TABLE>
+    class ReadWriteRunnable : public capu::Runnable
+    {
+    public:
+        ReadWriteRunnable(TABLE& table, uint32_t id, uint32_t rounds, uint32_t writePercentage)
+            : m_table(table)
+            , m_id(id)
+            , m_rounds(rounds)
+            , m_writePercentage(writePercentage)
+            , m_errors(0)
+        {
+        }
+
+        void run()
+        {
+            // every thread owns the keys with its id in the upper bits and reads the keys of all threads
+            const uint32_t keyCount = 256;
+            for (uint32_t round = 0; round < m_rounds; ++round)
+            {
+                const uint32_t index = round % keyCount;
+                if (round % 100 < m_writePercentage)
+                {
+                    const uint32_t ownKey = (m_id << 16) | index;
+                    if (round % 3 == 0)
+                    {
+                        m_table.remove(ownKey);
+                    }
+                    else
+                    {
+                        m_table.put(ownKey, ownKey);
+                    }
+                }
+                else
+                {
+                    const uint32_t key = (((round / keyCount) % 8) << 16) | index;
+                    uint32_t value = 0;
+                    if (capu::CAPU_OK == m_table.get(key, value) && value != key)
+                    {
+                        ++m_errors;
+                    }
+                }
+            }
+        }
+
+        uint32_t getErrors() const
+        {
+            return m_errors;
+        }
+
+    private:
+        TABLE& m_table;
+        const uint32_t m_id;
+        const uint32_t m_rounds;
+        const uint32_t m_writePercentage;
+        uint32_t m_errors;
+    };
+}
+
+TEST_P(ConcurrentHashTableTest, ConcurrentReadersAndWriters)
+{
+    const uint32_t threadCount = 8;
+    UInt32ConcurrentHashTable table(2, GetParam());
+
+    ReadWriteRunnable<UInt32ConcurrentHashTable>* runnables[threadCount];
+    capu::Thread* threads[threadCount];
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        runnables[i] = new ReadWriteRunnable<UInt32ConcurrentHashTable>(table, i, 20000, 20);
+        threads[i] = new capu::Thread();
+        threads[i]->start(*runnables[i]);
+    }
+
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        threads[i]->join();
+        EXPECT_EQ(0u, runnables[i]->getErrors());
+        delete threads[i];
+        delete runnables[i];
+    }
+
+    // each thread leaves its own keys in a defined state
+    for (uint32_t id = 0; id < threadCount; ++id)
+    {
+        for (uint32_t index = 0; index < 256; ++index)
+        {
+            const uint32_t key = (id << 16) | index;
+            uint32_t value = 0;
+            if (capu::CAPU_OK == table.get(key, value))
+            {
+                EXPECT_EQ(key, value);
+            }
+        }
+    }
+
+    uint64_t lockCount = 0;
+    for (uint32_t i = 0; i < table.getShardCount(); ++i)
+    {
+        lockCount += table.getShardStatistics(i).lockCount;
+    }
+    EXPECT_GT(lockCount, 0u);
+}
+
+namespace
+{
+    /**
+     * Wraps a HashTable with a ReadWriteLock like it is done without ConcurrentHashTable
+     */
+    class ReadWriteLockedHashTable
+    {
+    public:
+        capu::status_t put(uint32_t key, uint32_t value)
+        {
+            m_lock.lockWrite();
+            const capu::status_t result = m_table.put(key, value);
+            m_lock.unlockWrite();
+            return result;
+        }
+
+        capu::status_t remove(uint32_t key)
+        {
+            m_lock.lockWrite();
+            const capu::status_t result = m_table.remove(key);
+            m_lock.unlockWrite();
+            return result;
+        }
+
+        capu::status_t get(uint32_t key, uint32_t& value)
+        {
+            m_lock.lockRead();
+            capu::status_t result = capu::CAPU_OK;
+            const uint32_t& found = m_table.at(key, &result);
+            if (capu::CAPU_OK == result)
+            {
+                value = found;
+            }
+            m_lock.unlockRead();
+            return result;
+        }
+
+    private:
+        capu::ReadWriteLock m_lock;
+        capu::HashTable<uint32_t, uint32_t> m_table;
+    };
+
+    template<typename TABLE>
+    uint64_t MeasureReadWriteMix(TABLE& table, uint32_t threadCount, uint32_t writePercentage)
+    {
+        const uint32_t rounds = 200000;
+        ReadWriteRunnable<TABLE>* runnables[16];
+        capu::Thread* threads[16];
+
+        const uint64_t start = capu::Time::GetMicroseconds();
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            runnables[i] = new ReadWriteRunnable<TABLE>(table, i, rounds, writePercentage);
+            threads[i] = new capu::Thread();
+            threads[i]->start(*runnables[i]);
+        }
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            threads[i]->join();
+            delete threads[i];
+            delete runnables[i];
+        }
+        return capu::Time::GetMicroseconds() - start;
+    }
+}
+
+TEST(ConcurrentHashTablePerformanceTest, DISABLED_ReadWriteMix)
+{
+    const uint32_t writePercentages[] = { 1, 10, 50 };
+    for (uint32_t w = 0; w < sizeof(writePercentages) / sizeof(writePercentages[0]); ++w)
+    {
+        for (uint32_t threadCount = 1; threadCount <= 16; threadCount *= 2)
+        {
+            ReadWriteLockedHashTable rwLocked;
+            UInt32ConcurrentHashTable sharded(4, false);
+            UInt32ConcurrentHashTable lockFree(4, true);
+
+            const uint64_t rwLockedTime = MeasureReadWriteMix(rwLocked, threadCount, writePercentages[w]);
+            const uint64_t shardedTime = MeasureReadWriteMix(sharded, threadCount, writePercentages[w]);
+            const uint64_t lockFreeTime = MeasureReadWriteMix(lockFree, threadCount, writePercentages[w]);
+
+            uint64_t lockWaitTime = 0;
+            for (uint32_t i = 0; i < sharded.getShardCount(); ++i)
+            {
+                lockWaitTime += sharded.getShardStatistics(i).lockWaitTime;
+            }
+
+            printf("%2u%% writes, %2u threads: ReadWriteLock %7u us, sharded %7u us (lock wait %7u us), lock-free reads %7u us\n",
+                writePercentages[w], threadCount, static_cast<uint32_t>(rwLockedTime), static_cast<uint32_t>(shardedTime),
+                static_cast<uint32_t>(lockWaitTime), static_cast<uint32_t>(lockFreeTime));
+        }
+    }
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "capu/container/Hash.h"
+#include "capu/container/HashSet.h"
+#include "capu/container/HashTable.h"
+#include "capu/container/String.h"
+#include "capu/container/vector.h"
+#include "capu/os/Time.h"
+#include "capu/util/Guid.h"
+#include "capu/util/shared_ptr.h"
+#include "capu/os/StringUtils.h"
+
+namespace capu
+{
+    namespace
+    {
+        uint32_t CountBits(uint64_t value)
+        {
+            uint32_t count = 0;
+            while (value)
+            {
+                value &= value - 1;
+                ++count;
+            }
+            return count;
+        }
+
+        /**
+         * Puts count hashes into 2^bitsize buckets and returns the size of the fullest bucket
+         */
+        template<typename T>
+        uint32_t MaxBucketLoad(const vector<T>& keys, uint8_t bitsize)
+        {
+            vector<uint32_t> buckets(static_cast<uint_t>(1) << bitsize, 0);
+            uint32_t maxLoad = 0;
+            for (uint_t i = 0; i < keys.size(); ++i)
+            {
+                uint32_t& load = buckets[FastHashFunction::Digest(keys[i], bitsize)];
+                ++load;
+                maxLoad = std::max(maxLoad, load);
+            }
+            return maxLoad;
+        }
+
+        template<typename T>
+        bool HasFullCollisions(const vector<T>& keys)
+        {
+            HashSet<uint_t> hashes;
+            for (uint_t i = 0; i < keys.size(); ++i)
+            {
+                const uint_t hash = FastHashFunction::Digest(keys[i]);
+                if (hashes.hasElement(hash))
+                {
+                    return true;
+                }
+                hashes.put(hash);
+            }
+            return false;
+        }
+    }
+
+    TEST(FastHashFunctionTest, SameKeyGivesSameHash)
+    {
+        EXPECT_EQ(FastHashFunction::Digest(42), FastHashFunction::Digest(42));
+        EXPECT_EQ(FastHashFunction::Digest(String("someKey")), FastHashFunction::Digest(String("someKey")));
+        EXPECT_NE(FastHashFunction::Digest(42), FastHashFunction::Digest(43));
+        EXPECT_NE(FastHashFunction::Digest(String("someKey")), FastHashFunction::Digest(String("someKez")));
+    }
+
+    TEST(FastHashFunctionTest, StringHashesCharacters)
+    {
+        const String key("a string with more than sixteen characters");
+        EXPECT_EQ(static_cast<uint_t>(internal::FastHashBytes(key.c_str(), key.getLength())), FastHashFunction::Digest(key));
+    }
+
+    TEST(FastHashFunctionTest, ResultFitsIntoRequestedBitSize)
+    {
+        for (uint8_t bitsize = 1; bitsize < 32; ++bitsize)
+        {
+            EXPECT_GT(static_cast<uint_t>(1) << bitsize, FastHashFunction::Digest(String("key"), bitsize));
+            EXPECT_GT(static_cast<uint_t>(1) << bitsize, FastHashFunction::Digest(123456789u, bitsize));
+        }
+    }
+
+    TEST(FastHashFunctionTest, SupportsAllKeyTypes)
+    {
+        enum SomeEnum
+        {
+            SomeEnum_A,
+            SomeEnum_B
+        };
+        struct SomeStruct
+        {
+            uint32_t a;
+            uint32_t b;
+        };
+        const SomeStruct someStruct = { 1, 2 };
+        shared_ptr<int32_t> ptr(new int32_t(5));
+        shared_ptr<int32_t> samePtr = ptr;
+        Guid guid;
+        Guid sameGuid(guid);
+
+        EXPECT_NE(FastHashFunction::Digest(SomeEnum_A), FastHashFunction::Digest(SomeEnum_B));
+        EXPECT_EQ(FastHashFunction::Digest(someStruct), FastHashFunction::Digest(someStruct));
+        EXPECT_EQ(FastHashFunction::Digest(ptr.get()), FastHashFunction::Digest(samePtr.get()));
+        EXPECT_EQ(FastHashFunction::Digest(ptr), FastHashFunction::Digest(samePtr));
+        EXPECT_EQ(FastHashFunction::Digest(guid), FastHashFunction::Digest(sameGuid));
+        EXPECT_NE(FastHashFunction::Digest(guid), FastHashFunction::Digest(Guid()));
+        EXPECT_NE(FastHashFunction::Digest(1.5), FastHashFunction::Digest(2.5));
+        EXPECT_NE(FastHashFunction::Digest(1.5f), FastHashFunction::Digest(2.5f));
+        EXPECT_NE(FastHashFunction::Digest(true), FastHashFunction::Digest(false));
+    }
+
+    TEST(FastHashFunctionTest, AllLengthsAndPrefixesGiveDifferentHashes)
+    {
+        uint8_t data[256];
+        for (uint32_t i = 0; i < sizeof(data); ++i)
+        {
+            data[i] = 0;
+        }
+
+        // even keys which only differ in their length of zeros must not collide
+        HashSet<uint64_t> hashes;
+        for (uint32_t len = 0; len <= sizeof(data); ++len)
+        {
+            const uint64_t hash = internal::FastHashBytes(data, len);
+            EXPECT_FALSE(hashes.hasElement(hash)) << "length " << len;
+            hashes.put(hash);
+        }
+    }
+
+    TEST(FastHashFunctionTest, EveryInputBitChangesTheHash)
+    {
+        uint8_t data[100];
+        for (uint32_t i = 0; i < sizeof(data); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+
+        uint64_t changedBits = 0;
+        uint64_t flips = 0;
+        for (uint32_t len = 1; len <= sizeof(data); ++len)
+        {
+            const uint64_t original = internal::FastHashBytes(data, len);
+            for (uint32_t bit = 0; bit < len * 8; ++bit)
+            {
+                data[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+                const uint64_t flipped = internal::FastHashBytes(data, len);
+                data[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+
+                ASSERT_NE(original, flipped) << "length " << len << " bit " << bit;
+                changedBits += CountBits(original ^ flipped);
+                ++flips;
+            }
+        }
+
+        // avalanche: on average half of the output bits change
+        const double averageChangedBits = static_cast<double>(changedBits) / static_cast<double>(flips);
+        EXPECT_NEAR(32.0, averageChangedBits, 1.0);
+    }
+
+    TEST(FastHashFunctionTest, NoCollisionsForSequentialIntegers)
+    {
+        vector<uint32_t> keys;
+        for (uint32_t i = 0; i < 100000; ++i)
+        {
+            keys.push_back(i);
+        }
+        EXPECT_FALSE(HasFullCollisions(keys));
+
+        // 100000 keys in 1024 buckets are about 98 per bucket
+        EXPECT_LT(MaxBucketLoad(keys, 10), 150u);
+    }
+
+    TEST(FastHashFunctionTest, NoCollisionsForIntegersWithSameLowerBits)
+    {
+        vector<uint64_t> keys;
+        for (uint64_t i = 0; i < 100000; ++i)
+        {
+            keys.push_back(i << 32);
+        }
+        EXPECT_FALSE(HasFullCollisions(keys));
+        EXPECT_LT(MaxBucketLoad(keys, 10), 150u);
+    }
+
+    TEST(FastHashFunctionTest, NoCollisionsForSimilarStrings)
+    {
+        vector<String> keys;
+        char buffer[64];
+        for (uint32_t i = 0; i < 100000; ++i)
+        {
+            StringUtils::Sprintf(buffer, sizeof(buffer), "component/%u/value", i);
+            keys.push_back(String(buffer));
+        }
+        EXPECT_FALSE(HasFullCollisions(keys));
+        EXPECT_LT(MaxBucketLoad(keys, 10), 150u);
+    }
+
+    TEST(FastHashFunctionTest, NoCollisionsForGuids)
+    {
+        // guids which differ in few bits only
+        vector<Guid> keys;
+        for (uint32_t i = 0; i < 100000; ++i)
+        {
+            generic_uuid_t id = { 0x12345678u, static_cast<uint16_t>(i & 0xFF), 0x4000, { 0, 0, 0, 0, 0, 0, 0, 0 } };
+            id.Data4[7] = static_cast<uint8_t>(i >> 8);
+            id.Data4[3] = static_cast<uint8_t>(i >> 16);
+            keys.push_back(Guid(id));
+        }
+        EXPECT_FALSE(HasFullCollisions(keys));
+        EXPECT_LT(MaxBucketLoad(keys, 10), 150u);
+    }
+
+    TEST(FastHashFunctionTest, UsableInHashTableAndHashSet)
+    {
+        HashTable<String, uint32_t, Comparator, FastHashFunction> table;
+        HashSet<uint32_t, Comparator, FastHashFunction> set;
+        char buffer[32];
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            StringUtils::Sprintf(buffer, sizeof(buffer), "key%u", i);
+            EXPECT_EQ(CAPU_OK, table.put(buffer, i));
+            EXPECT_EQ(CAPU_OK, set.put(i));
+        }
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            StringUtils::Sprintf(buffer, sizeof(buffer), "key%u", i);
+            EXPECT_EQ(i, table.at(buffer));
+            EXPECT_TRUE(set.hasElement(i));
+        }
+    }
+
+    TEST(FastHashFunctionTest, FoldedMultiply)
+    {
+        EXPECT_EQ(0u, internal::FoldedMultiply(0, 0xFFFFFFFFFFFFFFFFULL));
+        EXPECT_EQ(6u, internal::FoldedMultiply(2, 3));
+        // (2^64 - 1)^2 = 2^128 - 2^65 + 1: upper half 0xFFFFFFFFFFFFFFFE, lower half 1
+        EXPECT_EQ(0xFFFFFFFFFFFFFFFFULL, internal::FoldedMultiply(0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL));
+        // 2^32 * 2^32 = 2^64: upper half 1, lower half 0
+        EXPECT_EQ(1u, internal::FoldedMultiply(0x100000000ULL, 0x100000000ULL));
+    }
+
+    TEST(FastHashFunctionPerformanceTest, DISABLED_Throughput)
+    {
+        const uint32_t totalBytes = 256 * 1024 * 1024;
+        vector<uint8_t> data(4096, 0);
+        for (uint32_t i = 0; i < data.size(); ++i)
+        {
+            data[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+
+        const uint32_t lengths[] = { 4, 8, 16, 32, 64, 256, 4096 };
+        for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+        {
+            const uint32_t len = lengths[l];
+            const uint32_t iterations = totalBytes / len;
+            uint64_t sink = 0;
+
+            uint64_t start = Time::GetMicroseconds();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                data[0] = static_cast<uint8_t>(i);
+                sink += HashCalculator<uint64_t>::Hash(data.data(), len, 64);
+            }
+            const uint64_t fnvTime = Time::GetMicroseconds() - start;
+
+            start = Time::GetMicroseconds();
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                data[0] = static_cast<uint8_t>(i);
+                sink += internal::FastHashBytes(data.data(), len);
+            }
+            const uint64_t fastTime = Time::GetMicroseconds() - start;
+
+            printf("%4u byte keys: FNV %7.1f MB/s, fast hash %7.1f MB/s (%u)\n", len,
+                totalBytes / static_cast<double>(fnvTime + 1), totalBytes / static_cast<double>(fastTime + 1),
+                static_cast<uint32_t>(sink & 1));
+        }
+    }
+}
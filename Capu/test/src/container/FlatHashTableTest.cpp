@@ -0,0 +1,465 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/container/FlatHashTable.h"
+#include "capu/container/HashTable.h"
+#include "capu/container/String.h"
+#include "capu/container/vector.h"
+#include "capu/os/Time.h"
+#include "capu/util/Guid.h"
+
+namespace
+{
+    struct RefCounted
+    {
+        RefCounted()
+            : value(-1)
+        {
+            ++refCnt;
+        }
+
+        RefCounted(int32_t value_)
+            : value(value_)
+        {
+            ++refCnt;
+        }
+
+        RefCounted(const RefCounted& other)
+            : value(other.value)
+        {
+            ++refCnt;
+        }
+
+        RefCounted& operator=(const RefCounted& other)
+        {
+            value = other.value;
+            return *this;
+        }
+
+        ~RefCounted()
+        {
+            --refCnt;
+        }
+
+        bool operator==(const RefCounted& other) const
+        {
+            return value == other.value;
+        }
+
+        int32_t value;
+        static int32_t refCnt;
+    };
+
+    int32_t RefCounted::refCnt = 0;
+
+    typedef capu::FlatHashTable<int32_t, int32_t> Int32FlatHashTable;
+}
+
+TEST(FlatHashTableTest, PutAndGet)
+{
+    Int32FlatHashTable table;
+    EXPECT_EQ(0u, table.count());
+
+    EXPECT_EQ(capu::CAPU_OK, table.put(1, 10));
+    EXPECT_EQ(capu::CAPU_OK, table.put(2, 20));
+    EXPECT_EQ(2u, table.count());
+
+    capu::status_t returnCode = capu::CAPU_ERROR;
+    EXPECT_EQ(10, table.at(1, &returnCode));
+    EXPECT_EQ(capu::CAPU_OK, returnCode);
+    EXPECT_EQ(20, table.at(2));
+
+    table.at(3, &returnCode);
+    EXPECT_EQ(capu::CAPU_ENOT_EXIST, returnCode);
+}
+
+TEST(FlatHashTableTest, PutOverwritesExistingValue)
+{
+    Int32FlatHashTable table;
+    table.put(1, 10);
+
+    int32_t oldValue = 0;
+    EXPECT_EQ(capu::CAPU_OK, table.put(1, 11, &oldValue));
+    EXPECT_EQ(10, oldValue);
+    EXPECT_EQ(11, table.at(1));
+    EXPECT_EQ(1u, table.count());
+}
+
+TEST(FlatHashTableTest, ConstAt)
+{
+    Int32FlatHashTable table;
+    table.put(5, 50);
+    const Int32FlatHashTable& constTable = table;
+
+    capu::status_t returnCode = capu::CAPU_ERROR;
+    EXPECT_EQ(50, constTable.at(5, &returnCode));
+    EXPECT_EQ(capu::CAPU_OK, returnCode);
+    constTable.at(6, &returnCode);
+    EXPECT_EQ(capu::CAPU_ENOT_EXIST, returnCode);
+}
+
+TEST(FlatHashTableTest, Contains)
+{
+    Int32FlatHashTable table;
+    table.put(1, 10);
+    EXPECT_TRUE(table.contains(1));
+    EXPECT_FALSE(table.contains(2));
+}
+
+TEST(FlatHashTableTest, Remove)
+{
+    Int32FlatHashTable table;
+    table.put(1, 10);
+    table.put(2, 20);
+
+    int32_t oldValue = 0;
+    EXPECT_EQ(capu::CAPU_OK, table.remove(1, &oldValue));
+    EXPECT_EQ(10, oldValue);
+    EXPECT_EQ(1u, table.count());
+    EXPECT_FALSE(table.contains(1));
+    EXPECT_TRUE(table.contains(2));
+
+    EXPECT_EQ(capu::CAPU_ERANGE, table.remove(1));
+}
+
+TEST(FlatHashTableTest, Find)
+{
+    Int32FlatHashTable table;
+    table.put(1, 10);
+
+    Int32FlatHashTable::Iterator iter = table.find(1);
+    EXPECT_TRUE(iter != table.end());
+    EXPECT_EQ(1, iter->key);
+    EXPECT_EQ(10, iter->value);
+    iter->value = 11;
+    EXPECT_EQ(11, table.at(1));
+
+    EXPECT_TRUE(table.find(2) == table.end());
+
+    const Int32FlatHashTable& constTable = table;
+    EXPECT_TRUE(constTable.find(1) != constTable.end());
+    EXPECT_TRUE(constTable.find(2) == constTable.end());
+}
+
+TEST(FlatHashTableTest, SubscriptOperator)
+{
+    Int32FlatHashTable table;
+    table[1] = 10;
+    EXPECT_EQ(10, table[1]);
+    EXPECT_EQ(0, table[2]);
+    EXPECT_EQ(2u, table.count());
+}
+
+TEST(FlatHashTableTest, IterateOverAllElements)
+{
+    Int32FlatHashTable table;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        table.put(i, i * 2);
+    }
+
+    int32_t keySum = 0;
+    uint32_t count = 0;
+    for (Int32FlatHashTable::Iterator iter = table.begin(); iter != table.end(); ++iter)
+    {
+        EXPECT_EQ(iter->key * 2, iter->value);
+        keySum += iter->key;
+        ++count;
+    }
+    EXPECT_EQ(100u, count);
+    EXPECT_EQ(4950, keySum);
+
+    const Int32FlatHashTable& constTable = table;
+    count = 0;
+    for (Int32FlatHashTable::ConstIterator iter = constTable.begin(); iter != constTable.end(); iter++)
+    {
+        ++count;
+    }
+    EXPECT_EQ(100u, count);
+}
+
+TEST(FlatHashTableTest, RangeBasedFor)
+{
+    Int32FlatHashTable table;
+    table.put(1, 10);
+    table.put(2, 20);
+
+    int32_t sum = 0;
+    for (auto& pair : table)
+    {
+        sum += pair.value;
+    }
+    EXPECT_EQ(30, sum);
+}
+
+TEST(FlatHashTableTest, IteratorRemove)
+{
+    Int32FlatHashTable table;
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        table.put(i, i);
+    }
+
+    Int32FlatHashTable::Iterator iter = table.begin();
+    while (iter != table.end())
+    {
+        if (iter->key % 2 == 0)
+        {
+            int32_t oldValue = -1;
+            const int32_t key = iter->key;
+            EXPECT_EQ(capu::CAPU_OK, table.remove(iter, &oldValue));
+            EXPECT_EQ(key, oldValue);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    EXPECT_EQ(25u, table.count());
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(i % 2 != 0, table.contains(i));
+    }
+}
+
+TEST(FlatHashTableTest, Clear)
+{
+    Int32FlatHashTable table;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        table.put(i, i);
+    }
+    table.clear();
+    EXPECT_EQ(0u, table.count());
+    EXPECT_FALSE(table.contains(5));
+    EXPECT_TRUE(table.begin() == table.end());
+
+    table.put(5, 5);
+    EXPECT_TRUE(table.contains(5));
+}
+
+TEST(FlatHashTableTest, Rehashing)
+{
+    Int32FlatHashTable table(4);
+    for (int32_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ(capu::CAPU_OK, table.put(i, i + 1));
+    }
+    EXPECT_EQ(10000u, table.count());
+    for (int32_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ(i + 1, table.at(i));
+    }
+}
+
+TEST(FlatHashTableTest, ForbidRehashing)
+{
+    Int32FlatHashTable table(4, false);
+    uint32_t inserted = 0;
+    while (table.put(static_cast<int32_t>(inserted), 0) == capu::CAPU_OK)
+    {
+        ++inserted;
+        ASSERT_LT(inserted, 100u);
+    }
+    EXPECT_EQ(inserted, table.count());
+    EXPECT_GT(inserted, 0u);
+
+    // existing keys can still be overwritten
+    EXPECT_EQ(capu::CAPU_OK, table.put(0, 1));
+
+    // space of removed entries gets reused
+    EXPECT_EQ(capu::CAPU_OK, table.remove(0));
+    EXPECT_EQ(capu::CAPU_OK, table.put(1000, 1));
+}
+
+TEST(FlatHashTableTest, ManyInsertRemoveCyclesKeepWorking)
+{
+    Int32FlatHashTable table(4, false);
+    for (int32_t i = 0; i < 100000; ++i)
+    {
+        ASSERT_EQ(capu::CAPU_OK, table.put(i, i));
+        if (i >= 8)
+        {
+            ASSERT_EQ(capu::CAPU_OK, table.remove(i - 8));
+        }
+    }
+    EXPECT_EQ(8u, table.count());
+    for (int32_t i = 100000 - 8; i < 100000; ++i)
+    {
+        EXPECT_TRUE(table.contains(i));
+    }
+}
+
+TEST(FlatHashTableTest, Reserve)
+{
+    Int32FlatHashTable table;
+    table.put(1, 1);
+    table.reserve(10);
+    EXPECT_EQ(1, table.at(1));
+    for (int32_t i = 0; i < 800; ++i)
+    {
+        table.put(i, i);
+    }
+    EXPECT_EQ(800u, table.count());
+}
+
+TEST(FlatHashTableTest, CopyConstructor)
+{
+    Int32FlatHashTable table;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        table.put(i, i);
+    }
+
+    Int32FlatHashTable copy(table);
+    EXPECT_EQ(100u, copy.count());
+    table.put(1, 1000);
+    EXPECT_EQ(1, copy.at(1));
+}
+
+TEST(FlatHashTableTest, AssignmentOperator)
+{
+    Int32FlatHashTable table;
+    table.put(1, 1);
+    Int32FlatHashTable other;
+    other.put(2, 2);
+
+    other = table;
+    EXPECT_EQ(1u, other.count());
+    EXPECT_EQ(1, other.at(1));
+    EXPECT_FALSE(other.contains(2));
+}
+
+TEST(FlatHashTableTest, Swap)
+{
+    Int32FlatHashTable table;
+    table.put(1, 1);
+    Int32FlatHashTable other;
+    other.put(2, 2);
+    other.put(3, 3);
+
+    swap(table, other);
+    EXPECT_EQ(2u, table.count());
+    EXPECT_EQ(1u, other.count());
+    EXPECT_TRUE(table.contains(3));
+    EXPECT_TRUE(other.contains(1));
+}
+
+TEST(FlatHashTableTest, StringKeys)
+{
+    capu::FlatHashTable<capu::String, int32_t> table;
+    table.put("abc", 1);
+    table.put("def", 2);
+    EXPECT_EQ(1, table.at("abc"));
+    EXPECT_EQ(2, table.at("def"));
+    EXPECT_FALSE(table.contains("ghi"));
+}
+
+TEST(FlatHashTableTest, GuidKeys)
+{
+    capu::FlatHashTable<capu::Guid, int32_t> table;
+    capu::vector<capu::Guid> guids;
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        guids.push_back(capu::Guid());
+        table.put(guids[i], i);
+    }
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, table.at(guids[i]));
+    }
+}
+
+TEST(FlatHashTableTest, ConstructsAndDestructsAllElements)
+{
+    RefCounted::refCnt = 0;
+    {
+        capu::FlatHashTable<int32_t, RefCounted> table;
+        const int32_t defaultValueCount = RefCounted::refCnt;
+
+        for (int32_t i = 0; i < 100; ++i)
+        {
+            table.put(i, RefCounted(i));
+        }
+        EXPECT_EQ(defaultValueCount + 100, RefCounted::refCnt);
+
+        for (int32_t i = 0; i < 50; ++i)
+        {
+            table.remove(i);
+        }
+        EXPECT_EQ(defaultValueCount + 50, RefCounted::refCnt);
+
+        capu::FlatHashTable<int32_t, RefCounted> copy(table);
+        EXPECT_EQ(2 * defaultValueCount + 100, RefCounted::refCnt);
+        copy.clear();
+        EXPECT_EQ(2 * defaultValueCount + 50, RefCounted::refCnt);
+    }
+    EXPECT_EQ(0, RefCounted::refCnt);
+}
+
+namespace
+{
+    template<typename TABLE>
+    void MeasureHashTablePerformance(const char* name, uint32_t size)
+    {
+        TABLE* table = new TABLE();
+
+        uint64_t start = capu::Time::GetMicroseconds();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            table->put(i * 7u, i);
+        }
+        const uint64_t insert = capu::Time::GetMicroseconds() - start;
+
+        uint32_t found = 0;
+        start = capu::Time::GetMicroseconds();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            found += table->contains(i * 7u) ? 1 : 0;
+        }
+        const uint64_t hit = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            found += table->contains(i * 7u + 1u) ? 1 : 0;
+        }
+        const uint64_t miss = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            table->remove(i * 7u);
+        }
+        const uint64_t erase = capu::Time::GetMicroseconds() - start;
+
+        EXPECT_EQ(size, found);
+        printf("%-14s %9u entries: insert %8u us, hit %8u us, miss %8u us, erase %8u us\n", name, size,
+            static_cast<uint32_t>(insert), static_cast<uint32_t>(hit), static_cast<uint32_t>(miss), static_cast<uint32_t>(erase));
+        delete table;
+    }
+}
+
+TEST(FlatHashTablePerformanceTest, DISABLED_CompareWithHashTable)
+{
+    for (uint32_t size = 1000u; size <= 10000000u; size *= 10)
+    {
+        MeasureHashTablePerformance<capu::HashTable<uint32_t, uint32_t> >("HashTable", size);
+        MeasureHashTablePerformance<capu::FlatHashTable<uint32_t, uint32_t> >("FlatHashTable", size);
+    }
+}
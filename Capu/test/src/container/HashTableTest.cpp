@@ -1005,3 +1005,256 @@ TEST_F(HashTableTest, swapKeepsNumberOfObjectsUnchanged)
     first.swap(second);
     expectRefCnt(5);
 }
+
+TEST_F(HashTableTest, IncrementalRehashKeepsAllEntries)
+{
+    Int32HashMap newmap(2, true, true);
+
+    for (int32_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ(capu::CAPU_OK, newmap.put(i, i * 10));
+
+        // entries of old and new buckets must be found while migration is ongoing
+        EXPECT_EQ(i * 10, newmap.at(i));
+        EXPECT_EQ(i / 2 * 10, newmap.at(i / 2));
+    }
+    EXPECT_EQ(10000u, newmap.count());
+
+    for (int32_t i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ(i * 10, newmap.at(i));
+    }
+
+    uint32_t iterated = 0;
+    for (Int32HashMap::Iterator iter = newmap.begin(); iter != newmap.end(); ++iter)
+    {
+        EXPECT_EQ(iter->key * 10, iter->value);
+        ++iterated;
+    }
+    EXPECT_EQ(10000u, iterated);
+}
+
+TEST_F(HashTableTest, IncrementalRehashOverwriteAndRemoveDuringMigration)
+{
+    Int32HashMap newmap(4, true, true);
+
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        EXPECT_EQ(capu::CAPU_OK, newmap.put(i, i));
+        if (i >= 2 && (i - 2) % 5 != 3)
+        {
+            int32_t oldValue = 0;
+            EXPECT_EQ(capu::CAPU_OK, newmap.put(i - 2, -(i - 2), &oldValue));
+            EXPECT_EQ(i - 2, oldValue);
+        }
+        if (i % 5 == 4)
+        {
+            EXPECT_EQ(capu::CAPU_OK, newmap.remove(i - 1));
+            EXPECT_FALSE(newmap.contains(i - 1));
+        }
+    }
+
+    uint32_t expectedCount = 0;
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        if (i % 5 == 3)
+        {
+            EXPECT_FALSE(newmap.contains(i));
+        }
+        else
+        {
+            ++expectedCount;
+            EXPECT_EQ(i < 1998 ? -i : i, newmap.at(i));
+        }
+    }
+    EXPECT_EQ(expectedCount, newmap.count());
+}
+
+TEST_F(HashTableTest, IncrementalRehashIteratorRemove)
+{
+    Int32HashMap newmap(2, true, true);
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        newmap.put(i, i);
+    }
+
+    Int32HashMap::Iterator iter = newmap.begin();
+    while (iter != newmap.end())
+    {
+        if (iter->key % 2 == 0)
+        {
+            EXPECT_EQ(capu::CAPU_OK, newmap.remove(iter));
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    EXPECT_EQ(500u, newmap.count());
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(i % 2 != 0, newmap.contains(i));
+    }
+}
+
+TEST_F(HashTableTest, IncrementalRehashKeepsEntryAddresses)
+{
+    Int32HashMap newmap(2, true, true);
+    newmap.put(0, 1);
+    const int32_t* address = &newmap.at(0);
+
+    for (int32_t i = 1; i < 1000; ++i)
+    {
+        newmap.put(i, i + 1);
+    }
+    EXPECT_EQ(address, &newmap.at(0));
+}
+
+TEST_F(HashTableTest, IncrementalRehashClearReusesAllEntries)
+{
+    RCHashTable newmap(2, true, true);
+    for (int32_t i = 0; i < 1000; ++i)
+    {
+        newmap.put(RCKey(i), RCValue(i));
+    }
+    newmap.clear();
+    expectRefCnt(1); // the default entry
+    EXPECT_EQ(0u, newmap.count());
+    EXPECT_TRUE(newmap.begin() == newmap.end());
+
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        EXPECT_EQ(capu::CAPU_OK, newmap.put(RCKey(i), RCValue(i)));
+    }
+    EXPECT_EQ(2000u, newmap.count());
+    EXPECT_EQ(1999, newmap.at(RCKey(1999)).value);
+}
+
+TEST_F(HashTableTest, IncrementalRehashCopyAssignAndSwap)
+{
+    RCHashTable source(2, true, true);
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        source.put(RCKey(i), RCValue(i));
+    }
+
+    {
+        RCHashTable copy(source);
+        EXPECT_EQ(100u, copy.count());
+        EXPECT_EQ(42, copy.at(RCKey(42)).value);
+
+        RCHashTable assigned;
+        assigned = source;
+        EXPECT_EQ(100u, assigned.count());
+        EXPECT_EQ(42, assigned.at(RCKey(42)).value);
+
+        RCHashTable swapped;
+        swapped.swap(source);
+        EXPECT_EQ(0u, source.count());
+        EXPECT_EQ(100u, swapped.count());
+        EXPECT_EQ(42, swapped.at(RCKey(42)).value);
+        source.swap(swapped);
+    }
+    EXPECT_EQ(42, source.at(RCKey(42)).value);
+}
+
+TEST_F(HashTableTest, IncrementalRehashDestructsAllElements)
+{
+    {
+        RCHashTable newmap(2, true, true);
+        for (int32_t i = 0; i < 1000; ++i)
+        {
+            newmap.put(RCKey(i), RCValue(i));
+        }
+        expectRefCnt(1001);
+    }
+    expectRefCnt(0);
+}
+
+namespace
+{
+    class PutLatencyHistogram
+    {
+    public:
+        PutLatencyHistogram()
+            : mCount(0)
+        {
+            capu::Memory::Set(mBuckets, 0, sizeof(mBuckets));
+        }
+
+        void add(uint64_t latencyNs)
+        {
+            // bucket i holds latencies below 2^(i+1) ns
+            uint32_t bucket = 0;
+            while (latencyNs > 1 && bucket < BucketCount - 1)
+            {
+                latencyNs >>= 1;
+                ++bucket;
+            }
+            ++mBuckets[bucket];
+            ++mCount;
+        }
+
+        uint64_t percentile(double fraction) const
+        {
+            const uint64_t rank = std::min(static_cast<uint64_t>(mCount * fraction), mCount - 1);
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < BucketCount; ++i)
+            {
+                seen += mBuckets[i];
+                if (seen > rank)
+                {
+                    return static_cast<uint64_t>(1) << (i + 1);
+                }
+            }
+            return static_cast<uint64_t>(1) << BucketCount;
+        }
+
+        void print(const char* name) const
+        {
+            printf("%s: p50 < %u ns, p99 < %u ns, p99.99 < %u ns, max < %u ns\n", name,
+                static_cast<uint32_t>(percentile(0.5)), static_cast<uint32_t>(percentile(0.99)),
+                static_cast<uint32_t>(percentile(0.9999)), static_cast<uint32_t>(percentile(1.0)));
+            for (uint32_t i = 0; i < BucketCount; ++i)
+            {
+                if (mBuckets[i] > 0)
+                {
+                    printf("  < %10u ns: %u\n", 1u << (i + 1), static_cast<uint32_t>(mBuckets[i]));
+                }
+            }
+        }
+
+    private:
+        static const uint32_t BucketCount = 31;
+        uint64_t mBuckets[BucketCount];
+        uint64_t mCount;
+    };
+
+    void MeasurePutLatency(const char* name, bool incrementalRehash)
+    {
+        HashTableTest::Int32HashMap map(HashTableTest::Int32HashMap::DefaultHashTableBitSize, true, incrementalRehash);
+        PutLatencyHistogram histogram;
+
+        // the clock resolution is too coarse for single puts, so the latency of a few puts is measured
+        const uint32_t putsPerSample = 32;
+        for (uint32_t i = 0; i < HashTableTest::PERFORMANCE_MAP_SIZE; i += putsPerSample)
+        {
+            const uint64_t start = capu::Time::GetMicroseconds();
+            for (uint32_t j = i; j < i + putsPerSample; ++j)
+            {
+                map.put(j, j);
+            }
+            const uint64_t end = capu::Time::GetMicroseconds();
+            histogram.add(end > start ? (end - start) * 1000 : 0);
+        }
+        histogram.print(name);
+    }
+}
+
+TEST_F(HashTableTest, DISABLED_PutLatencyHistogram)
+{
+    printf("latency of %u puts\n", 32u);
+    MeasurePutLatency("rehash at once", false);
+    MeasurePutLatency("incremental rehash", true);
+}
@@ -17,7 +17,10 @@
 #include "capu/util/Guid.h"
 #include "capu/util/shared_ptr.h"
 #include "capu/container/Hash.h"
+#include "capu/container/HashTable.h"
+#include "capu/container/vector.h"
 #include "gtest/gtest.h"
+#include <limits>
 
 namespace capu
 {
@@ -132,5 +135,108 @@ namespace capu
         EXPECT_EQ(0u, shouldBeZero);
         EXPECT_NE(0u, hashValue);
     }
-}
 
+    namespace
+    {
+        /**
+         * Hashes count floating point values from the given generator into 2^bitsize buckets and
+         * returns the load of the fullest bucket
+         */
+        template<typename HASH, typename T, typename GENERATOR>
+        uint32_t MaxBucketLoad(GENERATOR generator, uint32_t count, uint8_t bitsize)
+        {
+            vector<uint32_t> buckets(static_cast<uint_t>(1) << bitsize, 0);
+            uint32_t maxLoad = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                uint32_t& load = buckets[static_cast<uint_t>(HASH::Digest(static_cast<T>(generator(i)), bitsize))];
+                ++load;
+                maxLoad = std::max(maxLoad, load);
+            }
+            return maxLoad;
+        }
+
+        double UnitInterval(uint32_t i)
+        {
+            return i / 16384.0;
+        }
+
+        double SensorValue(uint32_t i)
+        {
+            return -40.0 + i * 0.125;
+        }
+
+        double WholeNumber(uint32_t i)
+        {
+            return static_cast<double>(i);
+        }
+
+        template<typename HASH, typename T>
+        void ExpectEvenDistribution()
+        {
+            // 16384 values in 256 buckets are 64 per bucket, clustering gives several times that
+            const uint32_t count = 16384;
+            const uint8_t bitsize = 8;
+            EXPECT_LT((MaxBucketLoad<HASH, T>(UnitInterval, count, bitsize)), 128u);
+            EXPECT_LT((MaxBucketLoad<HASH, T>(SensorValue, count, bitsize)), 128u);
+            EXPECT_LT((MaxBucketLoad<HASH, T>(WholeNumber, count, bitsize)), 128u);
+        }
+    }
+
+    TEST(HashTest, FloatingPointValuesAreDistributedOverAllBuckets)
+    {
+        ExpectEvenDistribution<CapuDefaultHashFunction<32>, float>();
+        ExpectEvenDistribution<CapuDefaultHashFunction<32>, double>();
+        ExpectEvenDistribution<CapuDefaultHashFunction<64>, float>();
+        ExpectEvenDistribution<CapuDefaultHashFunction<64>, double>();
+        ExpectEvenDistribution<FastHashFunction, float>();
+        ExpectEvenDistribution<FastHashFunction, double>();
+    }
+
+    TEST(HashTest, FloatingPointValuesInUnitIntervalDoNotCollide)
+    {
+        EXPECT_NE(CapuDefaultHashFunction<>::Digest(0.25f), CapuDefaultHashFunction<>::Digest(0.5f));
+        EXPECT_NE(CapuDefaultHashFunction<>::Digest(0.25), CapuDefaultHashFunction<>::Digest(0.5));
+        EXPECT_NE(CapuDefaultHashFunction<32>::Digest(0.1f, 32), CapuDefaultHashFunction<32>::Digest(0.2f, 32));
+        EXPECT_NE(CapuDefaultHashFunction<32>::Digest(0.1, 32), CapuDefaultHashFunction<32>::Digest(0.2, 32));
+    }
+
+    TEST(HashTest, PositiveAndNegativeZeroHaveSameHash)
+    {
+        EXPECT_EQ(CapuDefaultHashFunction<32>::Digest(0.0f, 32), CapuDefaultHashFunction<32>::Digest(-0.0f, 32));
+        EXPECT_EQ(CapuDefaultHashFunction<32>::Digest(0.0, 32), CapuDefaultHashFunction<32>::Digest(-0.0, 32));
+        EXPECT_EQ(CapuDefaultHashFunction<64>::Digest(0.0f), CapuDefaultHashFunction<64>::Digest(-0.0f));
+        EXPECT_EQ(CapuDefaultHashFunction<64>::Digest(0.0), CapuDefaultHashFunction<64>::Digest(-0.0));
+        EXPECT_EQ(FastHashFunction::Digest(0.0f), FastHashFunction::Digest(-0.0f));
+        EXPECT_EQ(FastHashFunction::Digest(0.0), FastHashFunction::Digest(-0.0));
+    }
+
+    TEST(HashTest, AllNaNsHaveSameHash)
+    {
+        const float quietNaN = std::numeric_limits<float>::quiet_NaN();
+        const float negativeNaN = -quietNaN;
+        uint32_t payloadBits = 0x7FC01234u;
+        float payloadNaN;
+        Memory::Copy(&payloadNaN, &payloadBits, sizeof(payloadNaN));
+
+        EXPECT_EQ(CapuDefaultHashFunction<>::Digest(quietNaN), CapuDefaultHashFunction<>::Digest(negativeNaN));
+        EXPECT_EQ(CapuDefaultHashFunction<>::Digest(quietNaN), CapuDefaultHashFunction<>::Digest(payloadNaN));
+        EXPECT_EQ(CapuDefaultHashFunction<>::Digest(std::numeric_limits<double>::quiet_NaN()),
+                  CapuDefaultHashFunction<>::Digest(-std::numeric_limits<double>::quiet_NaN()));
+        EXPECT_NE(CapuDefaultHashFunction<>::Digest(quietNaN), CapuDefaultHashFunction<>::Digest(std::numeric_limits<float>::infinity()));
+    }
+
+    TEST(HashTest, HashTableWithFloatKeys)
+    {
+        HashTable<float, uint32_t> table;
+        for (uint32_t i = 0; i < 1000; ++i)
+        {
+            table.put(i / 1000.0f, i);
+        }
+        table.put(-0.0f, 1000);
+
+        EXPECT_EQ(1000u, table.count());
+        EXPECT_EQ(1000u, table.at(0.0f));
+        EXPECT_EQ(500u, table.at(0.5f));
+    }
+}
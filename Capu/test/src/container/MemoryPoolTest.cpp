@@ -17,6 +17,7 @@
 #include <gtest/gtest.h>
 #include "capu/container/MemoryPool.h"
 #include "capu/Config.h"
+#include "capu/os/Time.h"
 
 TEST(MemoryPoolTest, GetElementsUntilFull)
 {
@@ -81,3 +82,160 @@ TEST(MemoryPoolTest, FillPoolAndRelease)
 
 }
 
+TEST(MemoryPoolTest, ReleaseReturnsOk)
+{
+    capu::MemoryPool<uint32_t, 3> m_pool;
+
+    uint32_t* first = m_pool.getEntry();
+    uint32_t* second = m_pool.getEntry();
+
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(first));
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(second));
+}
+
+TEST(MemoryPoolTest, ReleaseTwiceIsDetected)
+{
+    capu::MemoryPool<uint32_t, 3> m_pool;
+
+    uint32_t* first = m_pool.getEntry();
+    uint32_t* second = m_pool.getEntry();
+
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(first));
+    EXPECT_EQ(capu::CAPU_ERROR, m_pool.releaseEntry(first));
+    EXPECT_EQ(1u, m_pool.getUsedCount());
+
+    // free list is still intact
+    EXPECT_EQ(first, m_pool.getEntry());
+    EXPECT_TRUE(0 != m_pool.getEntry());
+    EXPECT_TRUE(0 == m_pool.getEntry());
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(second));
+}
+
+TEST(MemoryPoolTest, ReleaseOfUnusedEntryIsDetected)
+{
+    capu::MemoryPool<uint32_t, 3> m_pool;
+
+    uint32_t* first = m_pool.getEntry();
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(first));
+
+    uint32_t* second = m_pool.getEntry();
+    uint32_t* third = m_pool.getEntry();
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(second));
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(third));
+    EXPECT_EQ(capu::CAPU_ERROR, m_pool.releaseEntry(third));
+}
+
+TEST(MemoryPoolTest, ReleaseOfForeignPointerIsDetected)
+{
+    capu::MemoryPool<uint32_t, 3> m_pool;
+    capu::MemoryPool<uint32_t, 3> otherPool;
+
+    uint32_t* first = m_pool.getEntry();
+    uint32_t* foreign = otherPool.getEntry();
+    uint32_t onStack = 0;
+
+    EXPECT_EQ(capu::CAPU_EINVAL, m_pool.releaseEntry(foreign));
+    EXPECT_EQ(capu::CAPU_EINVAL, m_pool.releaseEntry(&onStack));
+    EXPECT_EQ(capu::CAPU_EINVAL, m_pool.releaseEntry(0));
+    EXPECT_EQ(1u, m_pool.getUsedCount());
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(first));
+}
+
+TEST(MemoryPoolTest, ReleaseOfPointerIntoEntryIsDetected)
+{
+    struct TwoValues
+    {
+        uint32_t a;
+        uint32_t b;
+    };
+    capu::MemoryPool<TwoValues, 3> m_pool;
+
+    TwoValues* first = m_pool.getEntry();
+    const TwoValues* inside = reinterpret_cast<const TwoValues*>(&first->b);
+
+    EXPECT_EQ(capu::CAPU_EINVAL, m_pool.releaseEntry(inside));
+    EXPECT_EQ(capu::CAPU_OK, m_pool.releaseEntry(first));
+}
+
+TEST(MemoryPoolTest, UsedCountAndHighWaterMark)
+{
+    capu::MemoryPool<uint32_t, 3> m_pool;
+    EXPECT_EQ(0u, m_pool.getUsedCount());
+    EXPECT_EQ(0u, m_pool.getHighWaterMark());
+
+    uint32_t* first = m_pool.getEntry();
+    uint32_t* second = m_pool.getEntry();
+    EXPECT_EQ(2u, m_pool.getUsedCount());
+    EXPECT_EQ(2u, m_pool.getHighWaterMark());
+
+    m_pool.releaseEntry(first);
+    EXPECT_EQ(1u, m_pool.getUsedCount());
+    EXPECT_EQ(2u, m_pool.getHighWaterMark());
+
+    uint32_t* third = m_pool.getEntry();
+    uint32_t* fourth = m_pool.getEntry();
+    m_pool.getEntry(); // pool is full, does not count
+    EXPECT_EQ(3u, m_pool.getUsedCount());
+    EXPECT_EQ(3u, m_pool.getHighWaterMark());
+
+    m_pool.releaseEntry(second);
+    m_pool.releaseEntry(third);
+    m_pool.releaseEntry(fourth);
+    EXPECT_EQ(0u, m_pool.getUsedCount());
+    EXPECT_EQ(3u, m_pool.getHighWaterMark());
+}
+
+class MemoryPoolPerformanceTest : public ::testing::Test
+{
+public:
+    static const uint32_t PoolSize = 4096;
+    static const uint32_t Rounds = 1000;
+
+    struct Message
+    {
+        uint64_t data[8];
+    };
+};
+
+TEST_F(MemoryPoolPerformanceTest, DISABLED_PoolAllocateReleaseLots)
+{
+    capu::MemoryPool<Message, PoolSize>* pool = new capu::MemoryPool<Message, PoolSize>();
+    Message* messages[PoolSize];
+
+    const uint64_t start = capu::Time::GetMicroseconds();
+    for (uint32_t round = 0; round < Rounds; ++round)
+    {
+        for (uint32_t i = 0; i < PoolSize; ++i)
+        {
+            messages[i] = pool->getEntry();
+        }
+        for (uint32_t i = 0; i < PoolSize; ++i)
+        {
+            pool->releaseEntry(messages[i]);
+        }
+    }
+    const uint64_t duration = capu::Time::GetMicroseconds() - start;
+    printf("MemoryPool: %u allocate/release pairs take %u us\n", PoolSize * Rounds, static_cast<uint32_t>(duration));
+
+    delete pool;
+}
+
+TEST_F(MemoryPoolPerformanceTest, DISABLED_NewDeleteLots)
+{
+    Message* messages[PoolSize];
+
+    const uint64_t start = capu::Time::GetMicroseconds();
+    for (uint32_t round = 0; round < Rounds; ++round)
+    {
+        for (uint32_t i = 0; i < PoolSize; ++i)
+        {
+            messages[i] = new Message;
+        }
+        for (uint32_t i = 0; i < PoolSize; ++i)
+        {
+            delete messages[i];
+        }
+    }
+    const uint64_t duration = capu::Time::GetMicroseconds() - start;
+    printf("new/delete: %u allocate/release pairs take %u us\n", PoolSize * Rounds, static_cast<uint32_t>(duration));
+}
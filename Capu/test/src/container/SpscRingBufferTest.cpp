@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/container/SpscRingBuffer.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Time.h"
+
+namespace
+{
+    // let the other side run if it shares the core
+    void BackOff(capu::uint_t transferred)
+    {
+        if (transferred == 0)
+        {
+            capu::Thread::Sleep(0);
+        }
+    }
+}
+
+TEST(SpscRingBuffer, RoundsCapacityUpToPowerOfTwo)
+{
+    capu::SpscRingBuffer<uint32_t> buffer(5);
+    EXPECT_EQ(8u, buffer.capacity());
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(0u, buffer.size());
+
+    capu::SpscRingBuffer<uint32_t> exact(16);
+    EXPECT_EQ(16u, exact.capacity());
+}
+
+TEST(SpscRingBuffer, PushFailsIfFullInsteadOfOverwriting)
+{
+    capu::SpscRingBuffer<uint32_t> buffer(4);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(buffer.push(i));
+    }
+    EXPECT_FALSE(buffer.push(4));
+    EXPECT_EQ(4u, buffer.size());
+
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(buffer.pop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(buffer.pop(value));
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SpscRingBuffer, WriteAndReadWrapAround)
+{
+    capu::SpscRingBuffer<uint32_t> buffer(8);
+    const uint32_t input[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    uint32_t output[12] = { 0 };
+
+    EXPECT_EQ(5u, buffer.write(input, 5));
+    EXPECT_EQ(3u, buffer.read(output, 3));
+    // only 6 of 7 elements fit, the last 3 of them go to the beginning of the array
+    EXPECT_EQ(6u, buffer.write(input + 5, 7));
+    EXPECT_EQ(8u, buffer.size());
+    EXPECT_EQ(0u, buffer.write(input, 1));
+
+    EXPECT_EQ(8u, buffer.read(output + 3, 9));
+    for (uint32_t i = 0; i < 11; ++i)
+    {
+        EXPECT_EQ(i, output[i]);
+    }
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(0u, buffer.read(output, 12));
+}
+
+TEST(SpscRingBuffer, ClaimedSpansAreContiguous)
+{
+    capu::SpscRingBuffer<uint32_t> buffer(8);
+    uint32_t* writeSpan = 0;
+    const uint32_t* readSpan = 0;
+
+    ASSERT_EQ(6u, buffer.claimWrite(writeSpan, 6));
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        writeSpan[i] = i;
+    }
+    // nothing is visible before the commit
+    EXPECT_EQ(0u, buffer.claimRead(readSpan, 8));
+    buffer.commitWrite(6);
+
+    ASSERT_EQ(4u, buffer.claimRead(readSpan, 4));
+    EXPECT_EQ(0u, readSpan[0]);
+    EXPECT_EQ(3u, readSpan[3]);
+    buffer.commitRead(4);
+
+    // the free space wraps around, the first span ends at the end of the array
+    EXPECT_EQ(2u, buffer.claimWrite(writeSpan, 8));
+    writeSpan[0] = 6;
+    writeSpan[1] = 7;
+    buffer.commitWrite(2);
+    EXPECT_EQ(4u, buffer.claimWrite(writeSpan, 8));
+    writeSpan[0] = 8;
+    buffer.commitWrite(1);
+
+    ASSERT_EQ(4u, buffer.claimRead(readSpan, 8));
+    EXPECT_EQ(4u, readSpan[0]);
+    EXPECT_EQ(7u, readSpan[3]);
+    buffer.commitRead(4);
+    ASSERT_EQ(1u, buffer.claimRead(readSpan, 8));
+    EXPECT_EQ(8u, readSpan[0]);
+    buffer.commitRead(1);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SpscRingBuffer, TransfersElementsInOrderBetweenThreads)
+{
+    const uint32_t elementCount = 200000;
+    capu::SpscRingBuffer<uint32_t> buffer(64);
+    capu::ThreadPool pool(1);
+    capu::Future<void> producer = pool.submit([&buffer, elementCount]()
+    {
+        uint32_t next = 0;
+        uint32_t chunk[7];
+        while (next < elementCount)
+        {
+            // alternate single and bulk writes
+            if (next % 2 == 0)
+            {
+                const bool pushed = buffer.push(next);
+                next += pushed ? 1 : 0;
+                BackOff(pushed ? 1 : 0);
+                continue;
+            }
+            uint32_t count = 0;
+            for (; count < 7 && next + count < elementCount; ++count)
+            {
+                chunk[count] = next + count;
+            }
+            const capu::uint_t written = buffer.write(chunk, count);
+            next += static_cast<uint32_t>(written);
+            BackOff(written);
+        }
+    });
+
+    uint32_t expected = 0;
+    bool inOrder = true;
+    uint32_t chunk[5];
+    while (expected < elementCount)
+    {
+        const capu::uint_t count = buffer.read(chunk, 5);
+        BackOff(count);
+        for (capu::uint_t i = 0; i < count; ++i)
+        {
+            inOrder = inOrder && chunk[i] == expected;
+            ++expected;
+        }
+    }
+    EXPECT_EQ(capu::CAPU_OK, producer.wait());
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SpscRingBufferPerformanceTest, DISABLED_Throughput)
+{
+    const uint32_t elementCount = 200000000;
+    const uint32_t chunkSize = 256;
+    capu::SpscRingBuffer<uint32_t> buffer(64 * 1024);
+    capu::ThreadPool pool(1);
+
+    uint64_t start = capu::Time::GetMicroseconds();
+    capu::Future<void> producer = pool.submit([&buffer, elementCount, chunkSize]()
+    {
+        uint32_t chunk[chunkSize];
+        for (uint32_t i = 0; i < chunkSize; ++i)
+        {
+            chunk[i] = i;
+        }
+        uint32_t written = 0;
+        while (written < elementCount)
+        {
+            const capu::uint_t count = buffer.write(chunk, chunkSize);
+            written += static_cast<uint32_t>(count);
+            BackOff(count);
+        }
+    });
+    uint32_t chunk[chunkSize];
+    uint32_t received = 0;
+    while (received < elementCount)
+    {
+        const capu::uint_t count = buffer.read(chunk, chunkSize);
+        received += static_cast<uint32_t>(count);
+        BackOff(count);
+    }
+    producer.wait();
+    const uint64_t bulkTime = capu::Time::GetMicroseconds() - start;
+
+    const uint32_t singleCount = elementCount / 10;
+    start = capu::Time::GetMicroseconds();
+    producer = pool.submit([&buffer, singleCount]()
+    {
+        for (uint32_t i = 0; i < singleCount;)
+        {
+            const bool pushed = buffer.push(i);
+            i += pushed ? 1 : 0;
+            BackOff(pushed ? 1 : 0);
+        }
+    });
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < singleCount;)
+    {
+        const bool popped = buffer.pop(value);
+        i += popped ? 1 : 0;
+        BackOff(popped ? 1 : 0);
+    }
+    producer.wait();
+    const uint64_t singleTime = capu::Time::GetMicroseconds() - start;
+
+    printf("bulk write/read of %u: %.1f M elements/s, single push/pop: %.1f M elements/s\n", chunkSize,
+        static_cast<double>(elementCount) / bulkTime, static_cast<double>(singleCount) / singleTime);
+}
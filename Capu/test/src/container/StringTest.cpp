@@ -15,6 +15,9 @@
  */
 #include <gtest/gtest.h>
 #include "capu/container/String.h"
+#include "capu/container/vector.h"
+#include "capu/util/ArenaAllocator.h"
+#include "capu/os/Time.h"
 #include "capu/Error.h"
 #include "capu/Config.h"
 
@@ -796,3 +799,214 @@ TEST(String, ResizeReallyAllocatesEnough)
 
     EXPECT_STREQ("12345", s.data());
 }
+
+TEST(String, UsesGivenAllocator)
+{
+    typedef capu::BasicString<capu::ArenaAllocator<char> > ArenaString;
+    capu::Arena arena(1024);
+    capu::ArenaAllocator<char> allocator(arena);
+
+    // short strings are stored inline and take nothing from the arena
+    ArenaString str("hello", allocator);
+    EXPECT_STREQ("hello", str.c_str());
+    EXPECT_EQ(0u, arena.getUsedSize());
+
+    str.append(" world, this string is too long to be stored inline");
+    EXPECT_LE(str.getLength() + 1, arena.getUsedSize());
+    const ArenaString sub = str.substr(6, 5);
+    const ArenaString concatenated = sub + "!";
+    EXPECT_STREQ("hello world, this string is too long to be stored inline", str.c_str());
+    EXPECT_STREQ("world", sub.c_str());
+    EXPECT_STREQ("world!", concatenated.c_str());
+    EXPECT_EQ(&arena, &concatenated.get_allocator().getArena());
+    EXPECT_EQ(0u, arena.getOverflowBlockCount());
+}
+
+TEST(String, StringsWithAllocatorCanBeHashed)
+{
+    typedef capu::BasicString<capu::ArenaAllocator<char> > ArenaString;
+    capu::Arena arena(1024);
+    capu::ArenaAllocator<char> allocator(arena);
+
+    const ArenaString key("key", allocator);
+    EXPECT_EQ(capu::CapuDefaultHashFunction<>::Digest(capu::String("key")), capu::CapuDefaultHashFunction<>::Digest(key));
+    EXPECT_EQ(capu::FastHashFunction::Digest(capu::String("key")), capu::FastHashFunction::Digest(key));
+}
+
+TEST(String, ShortStringsAreStoredInline)
+{
+    capu::String str("short");
+    EXPECT_EQ(capu::String::InlineCapacity, str.getCapacity());
+    EXPECT_GE(reinterpret_cast<const char*>(&str + 1), str.c_str());
+    EXPECT_LE(reinterpret_cast<const char*>(&str), str.c_str());
+
+    const capu::String full(capu::String::InlineCapacity, 'x');
+    EXPECT_EQ(capu::String::InlineCapacity, full.getCapacity());
+    EXPECT_EQ(capu::String::InlineCapacity, full.getLength());
+}
+
+TEST(String, GrowsFromInlineToAllocatedStorage)
+{
+    capu::String str(capu::String::InlineCapacity, 'a');
+    str += 'b';
+    EXPECT_LT(capu::String::InlineCapacity, str.getCapacity());
+    EXPECT_EQ(capu::String::InlineCapacity + 1, str.getLength());
+    EXPECT_EQ('b', str[capu::String::InlineCapacity]);
+    EXPECT_EQ('\0', str.c_str()[capu::String::InlineCapacity + 1]);
+
+    // shrinking keeps the allocated storage
+    str.truncate(2);
+    EXPECT_STREQ("aa", str.c_str());
+    EXPECT_LT(capu::String::InlineCapacity, str.getCapacity());
+}
+
+TEST(String, AppendOwnDataWhileLeavingInlineStorage)
+{
+    capu::String str("0123456789abcdef");
+    str.append(str);
+    EXPECT_STREQ("0123456789abcdef0123456789abcdef", str.c_str());
+    EXPECT_EQ(32u, str.getLength());
+}
+
+TEST(String, MoveInlineString)
+{
+    capu::String source("inline");
+    capu::String target(std::move(source));
+    EXPECT_STREQ("inline", target.c_str());
+    EXPECT_EQ(6u, target.getLength());
+    EXPECT_STREQ("", source.c_str());
+    EXPECT_EQ(0u, source.getLength());
+
+    source = "reused";
+    EXPECT_STREQ("reused", source.c_str());
+}
+
+TEST(String, MoveAllocatedStringTakesOverMemory)
+{
+    capu::String source("a string which is too long to be stored inline");
+    const char* chars = source.c_str();
+    capu::String target;
+    target = std::move(source);
+    EXPECT_EQ(chars, target.c_str());
+    EXPECT_STREQ("a string which is too long to be stored inline", target.c_str());
+    EXPECT_STREQ("", source.c_str());
+    EXPECT_EQ(capu::String::InlineCapacity, source.getCapacity());
+}
+
+TEST(String, SwapInlineAndAllocatedStrings)
+{
+    capu::String shortString("short");
+    capu::String longString("a string which is too long to be stored inline");
+    shortString.swap(longString);
+    EXPECT_STREQ("a string which is too long to be stored inline", shortString.c_str());
+    EXPECT_STREQ("short", longString.c_str());
+    EXPECT_EQ(5u, longString.getLength());
+    EXPECT_EQ(capu::String::InlineCapacity, longString.getCapacity());
+}
+
+namespace
+{
+    /**
+     * Allocator which counts the bytes it hands out
+     */
+    template<typename T>
+    class CountingAllocator
+    {
+    public:
+        explicit CountingAllocator(capu::uint_t& allocatedBytes)
+            : m_allocatedBytes(&allocatedBytes)
+        {
+        }
+
+        T* allocateArray(capu::uint_t count)
+        {
+            *m_allocatedBytes += count * sizeof(T);
+            return m_allocator.allocateArray(count);
+        }
+
+        void deallocateArray(T* memory, capu::uint_t count)
+        {
+            m_allocator.deallocateArray(memory, count);
+        }
+
+    private:
+        capu::Allocator<T> m_allocator;
+        capu::uint_t* m_allocatedBytes;
+    };
+}
+
+TEST(String, ShortStringsDoNotAllocate)
+{
+    capu::uint_t allocatedBytes = 0;
+    CountingAllocator<char> allocator(allocatedBytes);
+    typedef capu::BasicString<CountingAllocator<char> > CountingString;
+
+    CountingString empty(allocator);
+    CountingString name("ContextName", allocator);
+    CountingString copy(name);
+    copy.append(".txt");
+    EXPECT_EQ(0u, allocatedBytes);
+
+    copy.append(" now exceeds the inline capacity");
+    EXPECT_LT(0u, allocatedBytes);
+}
+
+TEST(StringPerformanceTest, DISABLED_ShortStrings)
+{
+    const capu::uint_t count = 1000000;
+    const char* const names[] = { "RAMS", "Renderer", "file.ext", "ContextName_12345678" };
+    const capu::uint_t nameCount = sizeof(names) / sizeof(names[0]);
+
+    uint64_t start = capu::Time::GetMicroseconds();
+    capu::uint_t totalLength = 0;
+    for (capu::uint_t i = 0; i < count; ++i)
+    {
+        const capu::String str(names[i % nameCount]);
+        totalLength += str.getLength();
+    }
+    const uint64_t constructTime = capu::Time::GetMicroseconds() - start;
+
+    capu::String strings[nameCount];
+    for (capu::uint_t i = 0; i < nameCount; ++i)
+    {
+        strings[i] = names[i];
+    }
+    start = capu::Time::GetMicroseconds();
+    for (capu::uint_t i = 0; i < count; ++i)
+    {
+        const capu::String copy(strings[i % nameCount]);
+        totalLength += copy.getLength();
+    }
+    const uint64_t copyTime = capu::Time::GetMicroseconds() - start;
+
+    start = capu::Time::GetMicroseconds();
+    capu::uint_t hashSum = 0;
+    for (capu::uint_t i = 0; i < count; ++i)
+    {
+        hashSum += capu::CapuDefaultHashFunction<>::Digest(strings[i % nameCount]);
+    }
+    const uint64_t hashTime = capu::Time::GetMicroseconds() - start;
+
+    printf("%u short strings: construct %u us, copy %u us, hash %u us (%u, %u)\n", static_cast<uint32_t>(count),
+        static_cast<uint32_t>(constructTime), static_cast<uint32_t>(copyTime), static_cast<uint32_t>(hashTime),
+        static_cast<uint32_t>(totalLength), static_cast<uint32_t>(hashSum));
+
+    // memory of the inline layout compared to keeping the characters in a vector like before
+    for (capu::uint_t i = 0; i < nameCount; ++i)
+    {
+        capu::uint_t stringBytes = 0;
+        const capu::BasicString<CountingAllocator<char> > str(names[i], CountingAllocator<char>(stringBytes));
+
+        capu::uint_t vectorBytes = 0;
+        capu::vector<char, CountingAllocator<char> > chars((CountingAllocator<char>(vectorBytes)));
+        for (const char* c = names[i]; *c != '\0'; ++c)
+        {
+            chars.push_back(*c);
+        }
+        chars.push_back('\0');
+
+        printf("%-22s String: %u + %u heap bytes, vector<char> layout: %u + %u heap bytes\n", names[i],
+            static_cast<uint32_t>(sizeof(str)), static_cast<uint32_t>(stringBytes),
+            static_cast<uint32_t>(sizeof(chars) + sizeof(capu::uint_t)), static_cast<uint32_t>(vectorBytes));
+    }
+}
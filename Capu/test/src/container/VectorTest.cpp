@@ -24,6 +24,9 @@
 #include "gmock/gmock.h"
 #include "capu/container/vector.h"
 #include "capu/container/String.h"
+#include "capu/os/Time.h"
+#include "capu/os/StringUtils.h"
+#include "capu/util/ArenaAllocator.h"
 #include "util/BidirectionalTestContainer.h"
 #include "util/ComplexTestType.h"
 #include "util/IteratorTestHelper.h"
@@ -1427,3 +1430,279 @@
         EXPECT_EQ(0u, MoveableComplexTestType::copyctor_count);
         EXPECT_EQ(3u, MoveableComplexTestType::movector_count);
     }
+
+    TEST(VectorTest, PushBackRvalueMoves)
+    {
+        capu::vector<MoveableComplexTestType> v;
+        v.reserve(1);
+
+        MoveableComplexTestType::Reset();
+        v.push_back(MoveableComplexTestType(5u));
+        ASSERT_EQ(1u, v.size());
+        EXPECT_EQ(5u, v[0].value);
+        EXPECT_EQ(0u, MoveableComplexTestType::copyctor_count);
+        EXPECT_EQ(1u, MoveableComplexTestType::movector_count);
+    }
+
+    TEST(VectorTest, PushBackRvalueWhileNeedingToGrowDoesNotCopy)
+    {
+        capu::vector<MoveableComplexTestType> v;
+
+        MoveableComplexTestType::Reset();
+        for (capu::uint_t i = 0; i < 100; ++i)
+        {
+            v.push_back(MoveableComplexTestType(i));
+        }
+        ASSERT_EQ(100u, v.size());
+        EXPECT_EQ(99u, v[99].value);
+        EXPECT_EQ(0u, MoveableComplexTestType::copyctor_count);
+    }
+
+    TEST(VectorTest, PushBackLvalueCopies)
+    {
+        capu::vector<MoveableComplexTestType> v;
+        v.reserve(1);
+        const MoveableComplexTestType value(7u);
+
+        MoveableComplexTestType::Reset();
+        v.push_back(value);
+        EXPECT_EQ(7u, v[0].value);
+        EXPECT_EQ(1u, MoveableComplexTestType::copyctor_count);
+        EXPECT_EQ(0u, MoveableComplexTestType::movector_count);
+    }
+
+    TEST(VectorTest, PushBackOwnElementWhileNeedingToGrow)
+    {
+        capu::vector<capu::String> v;
+        v.push_back("first");
+        v.shrink_to_fit();
+        ASSERT_EQ(v.size(), v.capacity());
+
+        v.push_back(v[0]);
+        ASSERT_EQ(2u, v.size());
+        EXPECT_STREQ("first", v[0].c_str());
+        EXPECT_STREQ("first", v[1].c_str());
+    }
+
+    TEST(VectorTest, EmplaceBackConstructsInPlace)
+    {
+        capu::vector<MoveableComplexTestType> v;
+        v.reserve(1);
+
+        MoveableComplexTestType::Reset();
+        v.emplace_back(42u);
+        ASSERT_EQ(1u, v.size());
+        EXPECT_EQ(42u, v[0].value);
+        EXPECT_EQ(1u, MoveableComplexTestType::ctor_count);
+        EXPECT_EQ(0u, MoveableComplexTestType::copyctor_count);
+        EXPECT_EQ(0u, MoveableComplexTestType::movector_count);
+    }
+
+    TEST(VectorTest, EmplaceBackWithMultipleArguments)
+    {
+        capu::vector<capu::String> v;
+        v.emplace_back("abcdef", 1, 3);
+        v.emplace_back();
+        ASSERT_EQ(2u, v.size());
+        EXPECT_STREQ("bcd", v[0].c_str());
+        EXPECT_EQ(0u, v[1].getLength());
+    }
+
+    TEST(VectorTest, EmplaceIntoMiddle)
+    {
+        capu::vector<capu::String> v = { "a", "c" };
+        v.emplace(v.begin() + 1u, "b");
+        v.emplace(v.begin(), "0");
+        v.emplace(v.end(), "d");
+
+        ASSERT_EQ(5u, v.size());
+        EXPECT_STREQ("0", v[0].c_str());
+        EXPECT_STREQ("a", v[1].c_str());
+        EXPECT_STREQ("b", v[2].c_str());
+        EXPECT_STREQ("c", v[3].c_str());
+        EXPECT_STREQ("d", v[4].c_str());
+    }
+
+    TEST(VectorTest, EmplaceOwnElementIntoMiddle)
+    {
+        capu::vector<capu::String> v = { "a", "b", "c" };
+        v.reserve(10);
+        v.emplace(v.begin(), v[2]);
+
+        ASSERT_EQ(4u, v.size());
+        EXPECT_STREQ("c", v[0].c_str());
+        EXPECT_STREQ("a", v[1].c_str());
+        EXPECT_STREQ("b", v[2].c_str());
+        EXPECT_STREQ("c", v[3].c_str());
+    }
+
+    TEST(VectorTest, InsertRvalueMovesExistingElements)
+    {
+        capu::vector<MoveableComplexTestType> v;
+        v.reserve(4);
+        v.emplace_back(1u);
+        v.emplace_back(2u);
+
+        MoveableComplexTestType::Reset();
+        v.insert(v.begin(), MoveableComplexTestType(0u));
+
+        ASSERT_EQ(3u, v.size());
+        EXPECT_EQ(0u, v[0].value);
+        EXPECT_EQ(1u, v[1].value);
+        EXPECT_EQ(2u, v[2].value);
+        EXPECT_EQ(0u, MoveableComplexTestType::copyctor_count);
+    }
+
+    TEST(VectorTest, ReserveRelocatesTriviallyCopyableElements)
+    {
+        struct Trivial
+        {
+            uint32_t a;
+            double b;
+        };
+        capu::vector<Trivial> v;
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            Trivial t = { i, i * 0.5 };
+            v.push_back(t);
+        }
+        v.reserve(1000);
+        ASSERT_EQ(100u, v.size());
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(i, v[i].a);
+            EXPECT_EQ(i * 0.5, v[i].b);
+        }
+    }
+
+    namespace
+    {
+        /**
+         * Allocator which counts the memory it hands out
+         */
+        template<typename T>
+        class CountingAllocator
+        {
+        public:
+            explicit CountingAllocator(capu::int_t& allocatedElements)
+                : m_allocatedElements(&allocatedElements)
+            {
+            }
+
+            T* allocateArray(capu::uint_t count)
+            {
+                *m_allocatedElements += count;
+                return m_allocator.allocateArray(count);
+            }
+
+            void deallocateArray(T* memory, capu::uint_t count)
+            {
+                *m_allocatedElements -= count;
+                m_allocator.deallocateArray(memory, count);
+            }
+
+        private:
+            capu::Allocator<T> m_allocator;
+            capu::int_t* m_allocatedElements;
+        };
+    }
+
+    TEST(VectorTest, UsesGivenAllocator)
+    {
+        capu::int_t allocatedElements = 0;
+        {
+            CountingAllocator<capu::String> allocator(allocatedElements);
+            capu::vector<capu::String, CountingAllocator<capu::String> > v(allocator);
+            v.push_back("a");
+            v.reserve(10);
+            EXPECT_EQ(10, allocatedElements);
+
+            // the copy has the same capacity
+            capu::vector<capu::String, CountingAllocator<capu::String> > copy(v);
+            EXPECT_EQ(20, allocatedElements);
+
+            capu::vector<capu::String, CountingAllocator<capu::String> > moved(std::move(copy));
+            EXPECT_EQ(20, allocatedElements);
+
+            v.shrink_to_fit();
+            EXPECT_EQ(11, allocatedElements);
+            EXPECT_STREQ("a", v[0].c_str());
+        }
+        EXPECT_EQ(0, allocatedElements);
+    }
+
+    TEST(VectorTest, DefaultAllocatorTakesNoSpace)
+    {
+        EXPECT_EQ(3 * sizeof(int*), sizeof(capu::vector<int>));
+    }
+
+    TEST(VectorTest, SwapExchangesAllocators)
+    {
+        capu::Arena arena1(1024);
+        capu::Arena arena2(1024);
+        capu::vector<int, capu::ArenaAllocator<int> > v1(3, 1, capu::ArenaAllocator<int>(arena1));
+        capu::vector<int, capu::ArenaAllocator<int> > v2(2, 2, capu::ArenaAllocator<int>(arena2));
+
+        v1.swap(v2);
+        EXPECT_EQ(&arena2, &v1.get_allocator().getArena());
+        EXPECT_EQ(&arena1, &v2.get_allocator().getArena());
+
+        // growing takes memory from the swapped arena
+        const capu::uint_t usedBefore = arena2.getUsedSize();
+        v1.reserve(100);
+        EXPECT_LT(usedBefore, arena2.getUsedSize());
+    }
+
+    TEST(VectorPerformanceTest, DISABLED_BuildVectorOfStrings)
+    {
+        const capu::uint_t count = 1000000;
+        char buffer[64];
+
+        uint64_t start = capu::Time::GetMicroseconds();
+        {
+            capu::vector<capu::String> v;
+            for (capu::uint_t i = 0; i < count; ++i)
+            {
+                capu::StringUtils::Sprintf(buffer, sizeof(buffer), "a string which is not too short %u", static_cast<uint32_t>(i));
+                const capu::String value(buffer);
+                v.push_back(value);
+            }
+        }
+        const uint64_t copyTime = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        {
+            capu::vector<capu::String> v;
+            for (capu::uint_t i = 0; i < count; ++i)
+            {
+                capu::StringUtils::Sprintf(buffer, sizeof(buffer), "a string which is not too short %u", static_cast<uint32_t>(i));
+                v.push_back(capu::String(buffer));
+            }
+        }
+        const uint64_t moveTime = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        {
+            capu::vector<capu::String> v;
+            for (capu::uint_t i = 0; i < count; ++i)
+            {
+                capu::StringUtils::Sprintf(buffer, sizeof(buffer), "a string which is not too short %u", static_cast<uint32_t>(i));
+                v.emplace_back(buffer);
+            }
+        }
+        const uint64_t emplaceTime = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        {
+            capu::vector<capu::String> v;
+            for (capu::uint_t i = 0; i < count / 100; ++i)
+            {
+                v.insert(v.begin(), capu::String("a string which is not too short"));
+            }
+        }
+        const uint64_t insertTime = capu::Time::GetMicroseconds() - start;
+
+        printf("%u strings: push_back copy %u us, push_back move %u us, emplace_back %u us, %u inserts at front %u us\n",
+            static_cast<uint32_t>(count), static_cast<uint32_t>(copyTime), static_cast<uint32_t>(moveTime),
+            static_cast<uint32_t>(emplaceTime), static_cast<uint32_t>(count / 100), static_cast<uint32_t>(insertTime));
+    }
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/container/WorkStealingDeque.h"
+#include "capu/os/Thread.h"
+#include "capu/util/Runnable.h"
+
+TEST(WorkStealingDeque, IsEmptyAfterConstruction)
+{
+    capu::WorkStealingDeque<uint32_t, 4> deque;
+    EXPECT_TRUE(deque.empty());
+    EXPECT_EQ(0u, deque.size());
+    EXPECT_TRUE(deque.pop() == 0);
+    EXPECT_TRUE(deque.steal() == 0);
+}
+
+TEST(WorkStealingDeque, PopReturnsNewestElement)
+{
+    uint32_t values[3] = { 1, 2, 3 };
+    capu::WorkStealingDeque<uint32_t, 4> deque;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(deque.push(&values[i]));
+    }
+    EXPECT_EQ(3u, deque.size());
+
+    EXPECT_EQ(&values[2], deque.pop());
+    EXPECT_EQ(&values[1], deque.pop());
+    EXPECT_EQ(&values[0], deque.pop());
+    EXPECT_TRUE(deque.pop() == 0);
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDeque, StealReturnsOldestElement)
+{
+    uint32_t values[3] = { 1, 2, 3 };
+    capu::WorkStealingDeque<uint32_t, 4> deque;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        deque.push(&values[i]);
+    }
+
+    EXPECT_EQ(&values[0], deque.steal());
+    EXPECT_EQ(&values[2], deque.pop());
+    EXPECT_EQ(&values[1], deque.steal());
+    EXPECT_TRUE(deque.steal() == 0);
+    EXPECT_TRUE(deque.pop() == 0);
+}
+
+TEST(WorkStealingDeque, PushFailsIfFull)
+{
+    uint32_t values[5] = { 1, 2, 3, 4, 5 };
+    capu::WorkStealingDeque<uint32_t, 4> deque;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        EXPECT_TRUE(deque.push(&values[i]));
+    }
+    EXPECT_FALSE(deque.push(&values[4]));
+
+    // stealing makes room again and the slots are reused
+    EXPECT_EQ(&values[0], deque.steal());
+    EXPECT_TRUE(deque.push(&values[4]));
+    EXPECT_EQ(&values[4], deque.pop());
+    EXPECT_EQ(&values[3], deque.pop());
+}
+
+namespace
+{
+    const uint32_t ElementCount = 100000;
+
+    class Thief : public capu::Runnable
+    {
+    public:
+        Thief(capu::WorkStealingDeque<uint32_t, 64>& deque, capu::Atomic<uint32_t>& taken, uint8_t* seen)
+            : m_deque(deque)
+            , m_taken(taken)
+            , m_seen(seen)
+        {
+        }
+
+        void run() override
+        {
+            while (m_taken.load() < ElementCount)
+            {
+                uint32_t* element = m_deque.steal();
+                if (element)
+                {
+                    ++m_seen[*element];
+                    ++m_taken;
+                }
+            }
+        }
+
+    private:
+        capu::WorkStealingDeque<uint32_t, 64>& m_deque;
+        capu::Atomic<uint32_t>& m_taken;
+        uint8_t* m_seen;
+    };
+}
+
+TEST(WorkStealingDeque, EveryElementIsTakenExactlyOnceWithConcurrentThieves)
+{
+    capu::WorkStealingDeque<uint32_t, 64> deque;
+    capu::Atomic<uint32_t> taken(0);
+    uint32_t* values = new uint32_t[ElementCount];
+    uint8_t* seen = new uint8_t[ElementCount];
+    for (uint32_t i = 0; i < ElementCount; ++i)
+    {
+        values[i] = i;
+        seen[i] = 0;
+    }
+
+    const uint32_t thiefCount = 3;
+    Thief thief(deque, taken, seen);
+    capu::Thread threads[thiefCount];
+    for (uint32_t i = 0; i < thiefCount; ++i)
+    {
+        threads[i].start(thief);
+    }
+
+    // the owner pushes and pops in turns, so thieves and owner compete for the last elements
+    for (uint32_t i = 0; i < ElementCount; ++i)
+    {
+        while (!deque.push(&values[i]))
+        {
+            uint32_t* element = deque.pop();
+            if (element)
+            {
+                ++seen[*element];
+                ++taken;
+            }
+        }
+        if (i % 3 == 0)
+        {
+            uint32_t* element = deque.pop();
+            if (element)
+            {
+                ++seen[*element];
+                ++taken;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < thiefCount; ++i)
+    {
+        threads[i].join();
+    }
+
+    EXPECT_EQ(ElementCount, taken.load());
+    for (uint32_t i = 0; i < ElementCount; ++i)
+    {
+        EXPECT_EQ(1u, seen[i]);
+    }
+    delete[] values;
+    delete[] seen;
+}
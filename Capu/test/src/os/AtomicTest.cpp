@@ -123,6 +123,22 @@ TYPED_TEST(AtomicTest, CanStoreValue)
     EXPECT_EQ(this->second, a);
 }
 
+TYPED_TEST(AtomicTest, CanStoreReleaseAndLoadAcquire)
+{
+    capu::Atomic<TypeParam> a(this->first);
+    EXPECT_EQ(this->first, a.loadAcquire());
+    a.storeRelease(this->second);
+    EXPECT_EQ(this->second, a.loadAcquire());
+}
+
+TYPED_TEST(AtomicTest, CanLoadRelaxed)
+{
+    capu::Atomic<TypeParam> a(this->first);
+    EXPECT_EQ(this->first, a.loadRelaxed());
+    a = this->second;
+    EXPECT_EQ(this->second, a.loadRelaxed());
+}
+
 TYPED_TEST(AtomicTest, CanAssignValue)
 {
     capu::Atomic<TypeParam> a(this->first);
@@ -130,6 +146,15 @@ TYPED_TEST(AtomicTest, CanAssignValue)
     EXPECT_EQ(this->second, a);
 }
 
+TYPED_TEST(AtomicTest, CompareExchangeReplacesEqualValue)
+{
+    capu::Atomic<TypeParam> a(this->first);
+    TypeParam expected = this->first;
+    EXPECT_TRUE(a.compareExchange(expected, this->second));
+    EXPECT_EQ(this->first, expected);
+    EXPECT_EQ(this->second, a);
+}
+
 
 template <typename T>
 class AtomicTestIntegral : public AtomicTestBase<T>
@@ -186,6 +211,15 @@ TYPED_TEST(AtomicTestIntegral, CanAssignSub)
     EXPECT_EQ(this->first - 1, a);
 }
 
+TYPED_TEST(AtomicTestIntegral, CompareExchangeReturnsCurrentValueOnMismatch)
+{
+    capu::Atomic<TypeParam> a(this->second);
+    TypeParam expected = this->first;
+    EXPECT_FALSE(a.compareExchange(expected, this->first));
+    EXPECT_EQ(this->second, expected);
+    EXPECT_EQ(this->second, a);
+}
+
 template <typename T>
 class AtomicTestUnsignedIntegral : public AtomicTestBase<T>
 {
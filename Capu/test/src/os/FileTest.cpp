@@ -465,6 +465,23 @@ TEST(File, TestGetFileSize)
     EXPECT_EQ(14u, byteSize);
 }
 
+TEST(File, SyncWritesBufferedData)
+{
+    char buf1[15] = "This is a test";
+    capu::File file("synctest.txt");
+    EXPECT_EQ(capu::CAPU_ERROR, file.sync());
+    file.open(capu::WRITE_NEW_BINARY);
+    ASSERT_TRUE(file.isOpen());
+
+    EXPECT_EQ(capu::CAPU_OK, file.write(buf1, strlen(buf1)));
+    EXPECT_EQ(capu::CAPU_OK, file.sync());
+    capu::uint_t byteSize = 0;
+    EXPECT_EQ(capu::CAPU_OK, file.getSizeInBytes(byteSize));
+    EXPECT_EQ(14u, byteSize);
+    file.close();
+    EXPECT_EQ(capu::CAPU_OK, file.remove());
+}
+
 TEST(File, TestIsDirectory)
 {
     capu::File tempFile("temp.txt");
@@ -50,3 +50,23 @@ TEST(Time, getMicrosecondsTestLongTime)
     EXPECT_GE(diff, 2000000u - 50000u);
     EXPECT_LE(diff, 2000000u + 50000u);
 }
+
+TEST(Time, getMonotonicNanosecondsTest)
+{
+    uint64_t nanoSeconds = capu::Time::GetMonotonicNanoseconds();
+    capu::Thread::Sleep(50);
+    uint64_t nanoSeconds2 = capu::Time::GetMonotonicNanoseconds();
+    EXPECT_GT(nanoSeconds2 - nanoSeconds, 40000000u);
+    EXPECT_LT(nanoSeconds2 - nanoSeconds, 1000000000u);
+}
+
+TEST(Time, monotonicNanosecondsNeverDecrease)
+{
+    uint64_t previous = capu::Time::GetMonotonicNanoseconds();
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        const uint64_t current = capu::Time::GetMonotonicNanoseconds();
+        EXPECT_GE(current, previous);
+        previous = current;
+    }
+}
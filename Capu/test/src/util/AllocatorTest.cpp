@@ -148,4 +148,23 @@ namespace capu
         allocator.deallocate(first);
         allocator.deallocate(second);
     }
+
+    TEST_F(AllocatorTest, AllocateArrayGivesUninitializedMemoryForAllElements)
+    {
+        Allocator<StaticAllocatorTestClass> allocator;
+
+        StaticAllocatorTestClass* array = allocator.allocateArray(100);
+        ASSERT_TRUE(array != 0);
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            array[i].value1 = i;
+        }
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(i, array[i].value1);
+        }
+
+        allocator.deallocateArray(array, 100);
+        allocator.deallocateArray(0, 0);
+    }
 }
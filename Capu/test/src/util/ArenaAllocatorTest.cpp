@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gmock/gmock.h"
+#include "capu/util/ArenaAllocator.h"
+#include "capu/container/vector.h"
+
+using namespace capu;
+
+TEST(Arena, AllocatesAlignedMemory)
+{
+    Arena arena(256);
+    void* first = arena.allocate(1, 1);
+    void* second = arena.allocate(8, 8);
+    void* third = arena.allocate(16, 16);
+
+    EXPECT_TRUE(first != 0);
+    EXPECT_EQ(0u, reinterpret_cast<uint_t>(second) % 8);
+    EXPECT_EQ(0u, reinterpret_cast<uint_t>(third) % 16);
+    EXPECT_NE(first, second);
+    EXPECT_NE(second, third);
+    EXPECT_EQ(0u, arena.getOverflowBlockCount());
+}
+
+TEST(Arena, ResetMakesMemoryAvailableAgain)
+{
+    Arena arena(64);
+    void* first = arena.allocate(32, 8);
+    arena.allocate(16, 8);
+    EXPECT_LE(48u, arena.getUsedSize());
+
+    arena.reset();
+    EXPECT_EQ(0u, arena.getUsedSize());
+    EXPECT_EQ(first, arena.allocate(32, 8));
+}
+
+TEST(Arena, TakesAdditionalBlocksWhenExhausted)
+{
+    Arena arena(64);
+    uint8_t* first = static_cast<uint8_t*>(arena.allocate(48, 1));
+    uint8_t* second = static_cast<uint8_t*>(arena.allocate(48, 1));
+    uint8_t* large = static_cast<uint8_t*>(arena.allocate(1000, 1));
+    EXPECT_EQ(2u, arena.getOverflowBlockCount());
+
+    // all memory is usable
+    for (uint32_t i = 0; i < 48; ++i)
+    {
+        first[i] = 1;
+        second[i] = 2;
+    }
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        large[i] = 3;
+    }
+    EXPECT_EQ(1u, first[47]);
+    EXPECT_EQ(2u, second[47]);
+
+    arena.reset();
+    EXPECT_EQ(0u, arena.getOverflowBlockCount());
+    EXPECT_EQ(first, arena.allocate(48, 1));
+}
+
+TEST(Arena, DeallocatingLastAllocationReusesMemory)
+{
+    Arena arena(256);
+    void* first = arena.allocate(32, 8);
+    void* second = arena.allocate(32, 8);
+
+    // not the last allocation: kept until reset
+    arena.deallocate(first, 32);
+    EXPECT_NE(first, arena.allocate(32, 8));
+
+    arena.reset();
+    first = arena.allocate(32, 8);
+    second = arena.allocate(32, 8);
+    arena.deallocate(second, 32);
+    EXPECT_EQ(second, arena.allocate(32, 8));
+}
+
+TEST(ArenaAllocator, AllocatesSingleElements)
+{
+    Arena arena(256);
+    ArenaAllocator<uint32_t> allocator(arena);
+
+    uint32_t* element = allocator.allocate();
+    ASSERT_TRUE(element != 0);
+    EXPECT_EQ(0u, *element);
+    *element = 5u;
+    allocator.deallocate(element);
+    EXPECT_TRUE(element == 0);
+}
+
+TEST(ArenaAllocator, CanBeUsedInVector)
+{
+    Arena arena(64 * 1024);
+    vector<uint32_t, ArenaAllocator<uint32_t> > v((ArenaAllocator<uint32_t>(arena)));
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        v.push_back(i);
+    }
+    ASSERT_EQ(1000u, v.size());
+    EXPECT_EQ(999u, v[999]);
+    EXPECT_EQ(0u, arena.getOverflowBlockCount());
+    EXPECT_LE(1000u * sizeof(uint32_t), arena.getUsedSize());
+}
@@ -19,6 +19,12 @@
 #include "capu/util/Logger.h"
 #include "capu/container/String.h"
 #include "capu/util/LogMessage.h"
+#include "capu/util/CountDownLatch.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/util/ScopedLock.h"
+#include "capu/container/vector.h"
+#include "capu/os/Time.h"
+#include <cstdlib>
 
 namespace capu
 {
@@ -60,4 +66,306 @@ namespace capu
 
         logWithDefaultLogger();
     }
+
+    namespace
+    {
+        /**
+         * Records the text of all messages, the first message blocks the output thread until it is released
+         */
+        class BlockingLogAppender : public LogAppenderBase
+        {
+        public:
+            BlockingLogAppender()
+                : entered(1)
+                , released(1)
+            {
+            }
+
+            virtual void logMessage(const LogMessage& message) override
+            {
+                bool first = false;
+                {
+                    ScopedLightweightMutexLock lock(mutex);
+                    first = texts.empty();
+                    texts.push_back(message.getLogMessage());
+                }
+                if(first)
+                {
+                    entered.countDown();
+                    released.await();
+                }
+            }
+
+            vector<String> getTexts()
+            {
+                ScopedLightweightMutexLock lock(mutex);
+                return texts;
+            }
+
+            CountDownLatch entered;
+            CountDownLatch released;
+
+        private:
+            LightweightMutex mutex;
+            vector<String> texts;
+        };
+
+        /**
+         * Logs "0", waits until the output thread blocks on it and fills the slots with "1" to "capacity"
+         */
+        void BlockOutputAndFillSlots(AsynchronousLogger& logger, BlockingLogAppender& appender, LogContext& context, uint32_t capacity)
+        {
+            LOG_INFO_EXT(logger, context, 0u);
+            appender.entered.await();
+            for(uint32_t i = 1; i <= capacity; ++i)
+            {
+                LOG_INFO_EXT(logger, context, i);
+            }
+        }
+
+        /**
+         * Logs while it is written to a log statement
+         */
+        struct SelfLoggingValue
+        {
+            AsynchronousLogger& logger;
+            LogContext& context;
+            uint32_t nestedStatements;
+        };
+
+        StringOutputStream& operator<<(StringOutputStream& stream, const SelfLoggingValue& value)
+        {
+            for(uint32_t i = 0; i < value.nestedStatements; ++i)
+            {
+                LOG_INFO_EXT(value.logger, value.context, "nested");
+            }
+            return stream << "outer";
+        }
+
+        vector<String> ToTexts(std::initializer_list<const char*> texts)
+        {
+            vector<String> result;
+            for(const char* text : texts)
+            {
+                result.push_back(text);
+            }
+            return result;
+        }
+    }
+
+    TEST_F(AsynchronousLoggerTest, FormattingOptionsDoNotLeakIntoLaterMessages)
+    {
+        testing::InSequence seq;
+        EXPECT_CALL(appender, logMessage(testing::Property(&LogMessage::getLogMessage, testing::StrEq("1.5000"))));
+        EXPECT_CALL(appender, logMessage(testing::Property(&LogMessage::getLogMessage, testing::StrEq("1.500000"))));
+
+        LOG_INFO(CAPU_CONTEXT, fixed << 1.5f);
+        LOG_INFO(CAPU_CONTEXT, 1.5f);
+    }
+
+    TEST(AsynchronousLogger, OutputsAllMessagesWhenDestroyed)
+    {
+        BlockingLogAppender appender;
+        appender.released.countDown();
+        vector<String> expected;
+        {
+            AsynchronousLogger logger(appender, OVERFLOW_BLOCK, 4);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            for(uint32_t i = 0; i < 100; ++i)
+            {
+                LOG_INFO_EXT(logger, context, i);
+                StringOutputStream text;
+                text << i;
+                expected.push_back(text.c_str());
+            }
+        }
+        EXPECT_TRUE(expected == appender.getTexts());
+    }
+
+    TEST(AsynchronousLogger, BlockWaitsForFreeSlot)
+    {
+        BlockingLogAppender appender;
+        AsynchronousLogger logger(appender, OVERFLOW_BLOCK, 4);
+        LogContext& context = logger.createContext("capu.Test");
+        context.setLogLevel(LL_ALL);
+        BlockOutputAndFillSlots(logger, appender, context, 4);
+
+        ThreadPool pool(1);
+        Future<void> blockedStatement = pool.submit([&logger, &context]()
+        {
+            LOG_INFO_EXT(logger, context, 5u);
+        });
+        Thread::Sleep(20);
+        EXPECT_FALSE(blockedStatement.isReady());
+
+        appender.released.countDown();
+        EXPECT_EQ(CAPU_OK, blockedStatement.wait());
+        EXPECT_EQ(1u, logger.getBlockedMessageCount());
+        EXPECT_EQ(0u, logger.getDroppedMessageCount());
+
+        LOG_INFO_EXT(logger, context, 6u);
+        pool.close();
+        while(appender.getTexts().size() < 7)
+        {
+            Thread::Sleep(1);
+        }
+        EXPECT_TRUE(ToTexts({ "0", "1", "2", "3", "4", "5", "6" }) == appender.getTexts());
+    }
+
+    TEST(AsynchronousLogger, NestedStatementsDoNotWaitForTheirOuterStatement)
+    {
+        BlockingLogAppender appender;
+        appender.released.countDown();
+        uint32_t droppedMessages = 0;
+        {
+            AsynchronousLogger logger(appender, OVERFLOW_BLOCK, 2);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            const SelfLoggingValue value = { logger, context, 4 };
+            LOG_INFO_EXT(logger, context, value);
+            droppedMessages = logger.getDroppedMessageCount();
+        }
+
+        // the outer statement holds one of the two slots, so nested ones are dropped once the other is in use
+        const vector<String> texts = appender.getTexts();
+        EXPECT_GT(droppedMessages, 0u);
+        EXPECT_EQ(5u, texts.size() + droppedMessages);
+        // messages are output in the order their statements started
+        EXPECT_EQ(String("outer"), texts[0]);
+    }
+
+    TEST(AsynchronousLogger, DropNewestDropsStatementsWhileFull)
+    {
+        BlockingLogAppender appender;
+        AsynchronousLogger logger(appender, OVERFLOW_DROP_NEWEST, 4);
+        LogContext& context = logger.createContext("capu.Test");
+        context.setLogLevel(LL_ALL);
+        BlockOutputAndFillSlots(logger, appender, context, 4);
+
+        LOG_INFO_EXT(logger, context, 5u);
+        LOG_INFO_EXT(logger, context, 6u);
+        EXPECT_EQ(2u, logger.getDroppedMessageCount());
+
+        appender.released.countDown();
+        while(appender.getTexts().size() < 5)
+        {
+            Thread::Sleep(1);
+        }
+        EXPECT_TRUE(ToTexts({ "0", "1", "2", "3", "4" }) == appender.getTexts());
+        EXPECT_EQ(0u, logger.getBlockedMessageCount());
+    }
+
+    TEST(AsynchronousLogger, DropOldestReplacesPendingMessages)
+    {
+        BlockingLogAppender appender;
+        AsynchronousLogger logger(appender, OVERFLOW_DROP_OLDEST, 4);
+        LogContext& context = logger.createContext("capu.Test");
+        context.setLogLevel(LL_ALL);
+        BlockOutputAndFillSlots(logger, appender, context, 4);
+
+        LOG_INFO_EXT(logger, context, 5u);
+        LOG_INFO_EXT(logger, context, 6u);
+        EXPECT_EQ(2u, logger.getDroppedMessageCount());
+
+        appender.released.countDown();
+        while(appender.getTexts().size() < 5)
+        {
+            Thread::Sleep(1);
+        }
+        EXPECT_TRUE(ToTexts({ "0", "3", "4", "5", "6" }) == appender.getTexts());
+        EXPECT_EQ(0u, logger.getBlockedMessageCount());
+    }
+
+    TEST(AsynchronousLogger, ManyThreadsLogEveryMessageOnce)
+    {
+        const uint32_t threadCount = 8;
+        const uint32_t messagesPerThread = 2000;
+        BlockingLogAppender appender;
+        appender.released.countDown();
+        {
+            AsynchronousLogger logger(appender, OVERFLOW_BLOCK, 16);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            ThreadPool pool(threadCount);
+            for(uint32_t t = 0; t < threadCount; ++t)
+            {
+                pool.submit([&logger, &context, t, messagesPerThread]()
+                {
+                    for(uint32_t i = 0; i < messagesPerThread; ++i)
+                    {
+                        LOG_INFO_EXT(logger, context, t * messagesPerThread + i);
+                    }
+                });
+            }
+            pool.close();
+        }
+
+        const vector<String> texts = appender.getTexts();
+        ASSERT_EQ(threadCount * messagesPerThread, texts.size());
+        vector<bool> received(threadCount * messagesPerThread, false);
+        for(uint32_t i = 0; i < texts.size(); ++i)
+        {
+            const uint32_t value = static_cast<uint32_t>(strtoul(texts[i].c_str(), 0, 10));
+            EXPECT_FALSE(received[value]);
+            received[value] = true;
+        }
+    }
+
+    namespace
+    {
+        class CountingLogAppender : public LogAppenderBase
+        {
+        public:
+            CountingLogAppender()
+                : count(0)
+            {
+            }
+
+            virtual void logMessage(const LogMessage&) override
+            {
+                ++count;
+            }
+
+            Atomic<uint32_t> count;
+        };
+    }
+
+    TEST(AsynchronousLoggerPerformanceTest, DISABLED_LogCallsFromEightThreads)
+    {
+        const uint32_t threadCount = 8;
+        const uint32_t messagesPerThread = 200000;
+        const EOverflowPolicy policies[3] = { OVERFLOW_BLOCK, OVERFLOW_DROP_NEWEST, OVERFLOW_DROP_OLDEST };
+        const char* names[3] = { "block", "drop newest", "drop oldest" };
+
+        for(uint32_t p = 0; p < 3; ++p)
+        {
+            CountingLogAppender appender;
+            AsynchronousLogger* logger = new AsynchronousLogger(appender, policies[p]);
+            LogContext& context = logger->createContext("capu.Performance");
+            context.setLogLevel(LL_ALL);
+
+            const uint64_t start = Time::GetMicroseconds();
+            ThreadPool pool(threadCount);
+            for(uint32_t t = 0; t < threadCount; ++t)
+            {
+                pool.submit([logger, &context, messagesPerThread]()
+                {
+                    for(uint32_t i = 0; i < messagesPerThread; ++i)
+                    {
+                        LOG_INFO_EXT((*logger), context, "message " << i << " of " << messagesPerThread);
+                    }
+                });
+            }
+            pool.close();
+            const uint64_t callMicros = Time::GetMicroseconds() - start;
+            const uint32_t dropped = logger->getDroppedMessageCount();
+            delete logger;
+            const uint64_t outputMicros = Time::GetMicroseconds() - start;
+
+            printf("%s: %.2f M log calls/s, all output after %.2f s, %u output, %u dropped\n", names[p],
+                static_cast<double>(threadCount * messagesPerThread) / callMicros, outputMicros / 1000000.0,
+                appender.count.load(), dropped);
+        }
+    }
 }
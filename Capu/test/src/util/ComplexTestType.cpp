@@ -23,4 +23,5 @@ capu::uint_t ComplexTestType::dtor_count = 0u;
 capu::uint_t MoveableComplexTestType::ctor_count = 0u;
 capu::uint_t MoveableComplexTestType::copyctor_count = 0u;
 capu::uint_t MoveableComplexTestType::movector_count = 0u;
+capu::uint_t MoveableComplexTestType::moveassign_count = 0u;
 capu::uint_t MoveableComplexTestType::dtor_count = 0u;
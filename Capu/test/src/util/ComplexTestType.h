@@ -85,6 +85,13 @@ public:
         ++movector_count;
     }
 
+    MoveableComplexTestType& operator=(MoveableComplexTestType&& other)
+    {
+        value = other.value;
+        ++moveassign_count;
+        return *this;
+    }
+
     bool operator==(const MoveableComplexTestType& other) const
     {
         return value == other.value;
@@ -105,6 +112,7 @@ public:
         ctor_count = 0;
         copyctor_count = 0;
         movector_count = 0;
+        moveassign_count = 0;
         dtor_count = 0;
     }
 
@@ -113,6 +121,7 @@ public:
     static capu::uint_t ctor_count;
     static capu::uint_t copyctor_count;
     static capu::uint_t movector_count;
+    static capu::uint_t moveassign_count;
     static capu::uint_t dtor_count;
 };
 
@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gmock/gmock.h"
+#include "capu/util/ConcurrentStaticAllocator.h"
+#include "capu/util/HybridAllocator.h"
+#include "capu/util/ScopedPointer.h"
+#include "capu/container/List.h"
+#include "capu/container/vector.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Time.h"
+
+namespace capu
+{
+    namespace
+    {
+        struct ConcurrentAllocatorTestClass
+        {
+            uint32_t value;
+            static Atomic<int32_t> counter;
+
+            ConcurrentAllocatorTestClass()
+                : value(0)
+            {
+                ++counter;
+            }
+
+            ~ConcurrentAllocatorTestClass()
+            {
+                --counter;
+            }
+        };
+
+        Atomic<int32_t> ConcurrentAllocatorTestClass::counter(0);
+
+        typedef ConcurrentStaticAllocator<ConcurrentAllocatorTestClass, 256> StressAllocator;
+
+        template<typename ALLOCATOR>
+        class AllocatingRunnable : public Runnable
+        {
+        public:
+            AllocatingRunnable(ALLOCATOR& allocator, uint32_t id, uint32_t rounds)
+                : m_allocator(allocator)
+                , m_id(id)
+                , m_rounds(rounds)
+                , m_errors(0)
+            {
+            }
+
+            void run()
+            {
+                ConcurrentAllocatorTestClass* held[8];
+                for (uint32_t round = 0; round < m_rounds; ++round)
+                {
+                    for (uint32_t i = 0; i < 8; ++i)
+                    {
+                        held[i] = m_allocator.allocate();
+                        if (held[i])
+                        {
+                            held[i]->value = m_id;
+                        }
+                    }
+                    for (uint32_t i = 0; i < 8; ++i)
+                    {
+                        if (held[i])
+                        {
+                            // nobody else must have got the same entry
+                            if (held[i]->value != m_id)
+                            {
+                                ++m_errors;
+                            }
+                            m_allocator.deallocate(held[i]);
+                        }
+                    }
+                }
+            }
+
+            ALLOCATOR& m_allocator;
+            const uint32_t m_id;
+            const uint32_t m_rounds;
+            uint32_t m_errors;
+        };
+
+        class CachingRunnable : public Runnable
+        {
+        public:
+            CachingRunnable(StressAllocator& allocator, uint32_t id, uint32_t rounds)
+                : m_allocator(allocator)
+                , m_id(id)
+                , m_rounds(rounds)
+                , m_errors(0)
+            {
+            }
+
+            void run()
+            {
+                StressAllocator::LocalCache cache(m_allocator, 4);
+                AllocatingRunnable<StressAllocator::LocalCache> worker(cache, m_id, m_rounds);
+                worker.run();
+                m_errors = worker.m_errors;
+            }
+
+            StressAllocator& m_allocator;
+            const uint32_t m_id;
+            const uint32_t m_rounds;
+            uint32_t m_errors;
+        };
+
+        template<typename RUNNABLE>
+        void RunConcurrently(StressAllocator& allocator, uint32_t threadCount, uint32_t rounds, uint32_t& errors)
+        {
+            vector<RUNNABLE*> runnables;
+            vector<Thread*> threads;
+            for (uint32_t i = 0; i < threadCount; ++i)
+            {
+                runnables.push_back(new RUNNABLE(allocator, i + 1, rounds));
+                threads.push_back(new Thread());
+            }
+            for (uint32_t i = 0; i < threadCount; ++i)
+            {
+                threads[i]->start(*runnables[i]);
+            }
+            errors = 0;
+            for (uint32_t i = 0; i < threadCount; ++i)
+            {
+                threads[i]->join();
+                errors += runnables[i]->m_errors;
+                delete threads[i];
+                delete runnables[i];
+            }
+        }
+
+        void ExpectAllEntriesFree(StressAllocator& allocator)
+        {
+            vector<ConcurrentAllocatorTestClass*> entries;
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                entries.push_back(allocator.allocate());
+                EXPECT_TRUE(0 != entries[i]);
+            }
+            EXPECT_TRUE(0 == allocator.allocate());
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                allocator.deallocate(entries[i]);
+            }
+        }
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, AllocateUntilExhausted)
+    {
+        ConcurrentStaticAllocator<uint32_t, 2> allocator;
+
+        uint32_t* first  = allocator.allocate();
+        uint32_t* second = allocator.allocate();
+        uint32_t* third  = allocator.allocate();
+
+        (*first)  = 10u;
+        (*second) = 20u;
+
+        EXPECT_EQ(10u, *first);
+        EXPECT_EQ(20u, *second);
+        EXPECT_TRUE(0 == third);
+
+        allocator.deallocate(first);
+        allocator.deallocate(second);
+        EXPECT_TRUE(0 == first);
+        EXPECT_TRUE(0 == second);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, DeallocatedMemoryIsReused)
+    {
+        ConcurrentStaticAllocator<uint32_t, 2> allocator;
+
+        uint32_t* first  = allocator.allocate();
+        uint32_t* second = allocator.allocate();
+        uint32_t* firstAddress = first;
+
+        allocator.deallocate(first);
+        first = allocator.allocate();
+        EXPECT_EQ(firstAddress, first);
+        EXPECT_TRUE(0 == allocator.allocate());
+
+        allocator.deallocate(first);
+        allocator.deallocate(second);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, ConstructsAndDestructsObjects)
+    {
+        ConcurrentAllocatorTestClass::counter = 0;
+        ConcurrentStaticAllocator<ConcurrentAllocatorTestClass, 2> allocator;
+        EXPECT_EQ(0, ConcurrentAllocatorTestClass::counter);
+
+        ConcurrentAllocatorTestClass* first = allocator.allocate();
+        EXPECT_EQ(1, ConcurrentAllocatorTestClass::counter);
+
+        allocator.deallocate(first);
+        EXPECT_EQ(0, ConcurrentAllocatorTestClass::counter);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, IsManagedMemory)
+    {
+        ConcurrentStaticAllocator<uint32_t, 2> allocator1;
+        ConcurrentStaticAllocator<uint32_t, 2> allocator2;
+        uint32_t* val1 = allocator1.allocate();
+        uint32_t* val2 = allocator1.allocate();
+        uint32_t* val3 = allocator2.allocate();
+
+        EXPECT_TRUE(allocator1.isManagedMemory(val1));
+        EXPECT_TRUE(allocator1.isManagedMemory(val2));
+        EXPECT_FALSE(allocator1.isManagedMemory(val3));
+        EXPECT_TRUE(allocator2.isManagedMemory(val3));
+
+        allocator1.deallocate(val1);
+        allocator1.deallocate(val2);
+        allocator2.deallocate(val3);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, LocalCacheRefillsInBatches)
+    {
+        ConcurrentStaticAllocator<uint32_t, 10> allocator;
+        {
+            ConcurrentStaticAllocator<uint32_t, 10>::LocalCache cache(allocator, 4);
+            EXPECT_EQ(0u, cache.getCachedCount());
+
+            uint32_t* first = cache.allocate();
+            EXPECT_TRUE(0 != first);
+            EXPECT_EQ(3u, cache.getCachedCount());
+
+            // remaining 6 entries are still available from the allocator
+            uint32_t* direct[6];
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                direct[i] = allocator.allocate();
+                EXPECT_TRUE(0 != direct[i]);
+            }
+            EXPECT_TRUE(0 == allocator.allocate());
+
+            // cache still serves its entries
+            uint32_t* cached[3];
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                cached[i] = cache.allocate();
+                EXPECT_TRUE(0 != cached[i]);
+            }
+            EXPECT_TRUE(0 == cache.allocate());
+
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                allocator.deallocate(direct[i]);
+            }
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                cache.deallocate(cached[i]);
+            }
+            cache.deallocate(first);
+            EXPECT_EQ(4u, cache.getCachedCount());
+        }
+
+        // destruction of the cache returned everything
+        uint32_t* all[10];
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            all[i] = allocator.allocate();
+            EXPECT_TRUE(0 != all[i]);
+        }
+        EXPECT_TRUE(0 == allocator.allocate());
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            allocator.deallocate(all[i]);
+        }
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, LocalCacheSpillsInBatches)
+    {
+        ConcurrentStaticAllocator<uint32_t, 10> allocator;
+        ConcurrentStaticAllocator<uint32_t, 10>::LocalCache cache(allocator, 2);
+
+        uint32_t* direct[4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            direct[i] = allocator.allocate();
+        }
+
+        cache.deallocate(direct[0]);
+        EXPECT_EQ(1u, cache.getCachedCount());
+        cache.deallocate(direct[1]);
+        cache.deallocate(direct[2]);
+        EXPECT_EQ(3u, cache.getCachedCount());
+        cache.deallocate(direct[3]);
+        EXPECT_EQ(2u, cache.getCachedCount());
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, UsableInHybridAllocator)
+    {
+        HybridAllocator<uint32_t, 2, ConcurrentStaticAllocator<uint32_t, 2> > hybridAlloc;
+        uint32_t* int1 = hybridAlloc.allocate(); // static
+        uint32_t* int2 = hybridAlloc.allocate(); // static
+        uint32_t* int3 = hybridAlloc.allocate(); // heap
+        EXPECT_TRUE(int1 != 0);
+        EXPECT_TRUE(int2 != 0);
+        EXPECT_TRUE(int3 != 0);
+        hybridAlloc.deallocate(int1);
+        hybridAlloc.deallocate(int2);
+        hybridAlloc.deallocate(int3);
+        EXPECT_TRUE(int1 == 0);
+        EXPECT_TRUE(int2 == 0);
+        EXPECT_TRUE(int3 == 0);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, UsableInList)
+    {
+        List<uint32_t, ConcurrentStaticAllocator<GenericListNode<uint32_t>, 4> > list;
+        list.push_back(1);
+        list.push_back(2);
+        list.push_back(3);
+        EXPECT_EQ(3u, list.size());
+        EXPECT_EQ(2u, *(++list.begin()));
+        list.clear();
+        EXPECT_EQ(0u, list.size());
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, ConcurrentAllocateAndDeallocate)
+    {
+        ConcurrentAllocatorTestClass::counter = 0;
+        ScopedPointer<StressAllocator> allocator(new StressAllocator());
+
+        uint32_t errors = 0;
+        RunConcurrently<AllocatingRunnable<StressAllocator> >(*allocator, 8, 20000, errors);
+        EXPECT_EQ(0u, errors);
+        EXPECT_EQ(0, ConcurrentAllocatorTestClass::counter);
+
+        ExpectAllEntriesFree(*allocator);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, ConcurrentAllocateAndDeallocateWithLocalCaches)
+    {
+        ConcurrentAllocatorTestClass::counter = 0;
+        ScopedPointer<StressAllocator> allocator(new StressAllocator());
+
+        uint32_t errors = 0;
+        RunConcurrently<CachingRunnable>(*allocator, 8, 20000, errors);
+        EXPECT_EQ(0u, errors);
+        EXPECT_EQ(0, ConcurrentAllocatorTestClass::counter);
+
+        ExpectAllEntriesFree(*allocator);
+    }
+
+    TEST(ConcurrentStaticAllocatorTest, DISABLED_ScalingWithThreadCount)
+    {
+        ScopedPointer<StressAllocator> allocator(new StressAllocator());
+        const uint32_t rounds = 200000;
+
+        for (uint32_t threadCount = 1; threadCount <= 16; threadCount *= 2)
+        {
+            uint32_t errors = 0;
+            uint64_t start = Time::GetMicroseconds();
+            RunConcurrently<AllocatingRunnable<StressAllocator> >(*allocator, threadCount, rounds, errors);
+            const uint64_t shared = Time::GetMicroseconds() - start;
+
+            start = Time::GetMicroseconds();
+            RunConcurrently<CachingRunnable>(*allocator, threadCount, rounds, errors);
+            const uint64_t cached = Time::GetMicroseconds() - start;
+
+            printf("%2u threads: %u allocate/deallocate pairs per thread take %u us shared, %u us with local cache\n",
+                threadCount, rounds * 8, static_cast<uint32_t>(shared), static_cast<uint32_t>(cached));
+        }
+    }
+}
@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/util/FileLogAppender.h"
+#include "capu/util/AsynchronousLogger.h"
+#include "capu/util/ConsoleLogAppender.h"
+#include "capu/util/FileUtils.h"
+#include "capu/util/Logger.h"
+#include "capu/os/Thread.h"
+#include "capu/os/Time.h"
+#include <stdio.h>
+
+namespace capu
+{
+    namespace
+    {
+        const char* const LogFilePath = "FileLogAppenderTest.log";
+
+        /**
+         * Compresses by copying, which is enough to check the file handling
+         */
+        class CopyingCompressor : public FileLogAppender::ICompressor
+        {
+        public:
+            CopyingCompressor()
+                : compressedFiles(0)
+            {
+            }
+
+            virtual status_t compress(const String& sourcePath, const String& targetPath) override
+            {
+                ++compressedFiles;
+                return File(sourcePath).copyTo(targetPath);
+            }
+
+            virtual const char* getExtension() const override
+            {
+                return ".copy";
+            }
+
+            uint32_t compressedFiles;
+        };
+
+        uint32_t CountLines(const String& text)
+        {
+            uint32_t lines = 0;
+            for(uint_t i = 0; i < text.getLength(); ++i)
+            {
+                if(text[i] == '\n')
+                {
+                    ++lines;
+                }
+            }
+            return lines;
+        }
+
+        String ReadAllText(const String& path)
+        {
+            File file(path);
+            return FileUtils::readAllText(file);
+        }
+
+        uint_t GetFileSize(const String& path)
+        {
+            uint_t size = 0;
+            File(path).getSizeInBytes(size);
+            return size;
+        }
+
+        FileLogAppender::Configuration WithoutFlushInterval()
+        {
+            FileLogAppender::Configuration configuration;
+            configuration.flushIntervalMilliseconds = 0;
+            return configuration;
+        }
+    }
+
+    class FileLogAppenderTest : public testing::Test
+    {
+    public:
+        FileLogAppenderTest()
+        {
+            removeLogFiles();
+        }
+
+        ~FileLogAppenderTest()
+        {
+            removeLogFiles();
+        }
+
+        void removeLogFiles()
+        {
+            File(LogFilePath).remove();
+            for(uint32_t i = 1; i <= 4; ++i)
+            {
+                StringOutputStream rotatedPath;
+                rotatedPath << LogFilePath << "." << i;
+                File(rotatedPath.c_str()).remove();
+                rotatedPath << ".copy";
+                File(rotatedPath.c_str()).remove();
+            }
+        }
+
+        void logMessages(ILogAppender& appender, uint32_t count)
+        {
+            Logger logger(appender);
+            LogContext& context = logger.createContext("test.File");
+            context.setLogLevel(LL_ALL);
+            for(uint32_t i = 0; i < count; ++i)
+            {
+                LOG_INFO_EXT(logger, context, "message " << i);
+            }
+        }
+    };
+
+    TEST_F(FileLogAppenderTest, WritesLinesLikeTheConsole)
+    {
+        FileLogAppender appender(LogFilePath, WithoutFlushInterval());
+        EXPECT_TRUE(appender.isOpen());
+
+        Logger logger(appender);
+        LogContext& context = logger.createContext("test.File");
+        context.setLogLevel(LL_ALL);
+        LOG_INFO_EXT(logger, context, "hello " << 42);
+        LOG_ERROR_EXT(logger, context, "failed");
+        appender.flush();
+
+        const String text = ReadAllText(LogFilePath);
+        EXPECT_EQ(2u, CountLines(text));
+        EXPECT_NE(-1, text.find("[ Info  ] test.File | hello 42\n"));
+        EXPECT_TRUE(text.endsWith("[ Error ] test.File | failed\n"));
+        // timestamp in seconds with milliseconds
+        EXPECT_EQ('.', text[text.find(' ') - 4]);
+    }
+
+    TEST_F(FileLogAppenderTest, BuffersMessagesUntilFlushed)
+    {
+        FileLogAppender appender(LogFilePath, WithoutFlushInterval());
+        logMessages(appender, 10);
+        EXPECT_EQ(0u, GetFileSize(LogFilePath));
+
+        appender.flush();
+        EXPECT_EQ(10u, CountLines(ReadAllText(LogFilePath)));
+    }
+
+    TEST_F(FileLogAppenderTest, WritesBufferedMessagesWhenDestroyed)
+    {
+        {
+            FileLogAppender appender(LogFilePath, WithoutFlushInterval());
+            logMessages(appender, 10);
+        }
+        EXPECT_EQ(10u, CountLines(ReadAllText(LogFilePath)));
+    }
+
+    TEST_F(FileLogAppenderTest, WritesWhenBufferIsFull)
+    {
+        FileLogAppender::Configuration configuration = WithoutFlushInterval();
+        configuration.bufferSize = 1024;
+        FileLogAppender appender(LogFilePath, configuration);
+        logMessages(appender, 100);
+
+        const uint_t size = GetFileSize(LogFilePath);
+        EXPECT_GT(size, 0u);
+        appender.flush();
+        EXPECT_GT(GetFileSize(LogFilePath), size);
+        EXPECT_LE(GetFileSize(LogFilePath) - size, 1024u);
+    }
+
+    TEST_F(FileLogAppenderTest, AppendsToExistingFile)
+    {
+        File file(LogFilePath);
+        FileUtils::writeAllText(file, "existing\n");
+        {
+            FileLogAppender appender(LogFilePath, WithoutFlushInterval());
+            logMessages(appender, 3);
+        }
+
+        const String text = ReadAllText(LogFilePath);
+        EXPECT_TRUE(text.startsWith("existing\n"));
+        EXPECT_EQ(4u, CountLines(text));
+    }
+
+    TEST_F(FileLogAppenderTest, FlushesAfterInterval)
+    {
+        FileLogAppender::Configuration configuration;
+        configuration.flushIntervalMilliseconds = 10;
+        FileLogAppender appender(LogFilePath, configuration);
+        logMessages(appender, 1);
+
+        const uint64_t start = Time::GetMilliseconds();
+        while(GetFileSize(LogFilePath) == 0 && Time::GetMilliseconds() - start < 5000)
+        {
+            Thread::Sleep(5);
+        }
+        EXPECT_EQ(1u, CountLines(ReadAllText(LogFilePath)));
+    }
+
+    TEST_F(FileLogAppenderTest, RotatesBySizeAndKeepsMaximumFileCount)
+    {
+        FileLogAppender::Configuration configuration = WithoutFlushInterval();
+        configuration.maxFileSize = 200;
+        configuration.maxRotatedFiles = 2;
+        {
+            FileLogAppender appender(LogFilePath, configuration);
+            EXPECT_EQ(String(LogFilePath) + ".1", appender.getRotatedPath(1));
+            logMessages(appender, 30);
+        }
+
+        EXPECT_TRUE(File(LogFilePath).exists());
+        EXPECT_TRUE(File(String(LogFilePath) + ".1").exists());
+        EXPECT_TRUE(File(String(LogFilePath) + ".2").exists());
+        EXPECT_FALSE(File(String(LogFilePath) + ".3").exists());
+
+        EXPECT_LE(GetFileSize(LogFilePath), 200u);
+        EXPECT_LE(GetFileSize(String(LogFilePath) + ".1"), 200u);
+        EXPECT_TRUE(ReadAllText(LogFilePath).endsWith("message 29\n"));
+        EXPECT_EQ(-1, ReadAllText(String(LogFilePath) + ".1").find("message 29\n"));
+    }
+
+    TEST_F(FileLogAppenderTest, RemovesFullFileWithoutRotatedFiles)
+    {
+        FileLogAppender::Configuration configuration = WithoutFlushInterval();
+        configuration.maxFileSize = 200;
+        {
+            FileLogAppender appender(LogFilePath, configuration);
+            logMessages(appender, 30);
+        }
+
+        EXPECT_FALSE(File(String(LogFilePath) + ".1").exists());
+        EXPECT_LE(GetFileSize(LogFilePath), 200u);
+        EXPECT_TRUE(ReadAllText(LogFilePath).endsWith("message 29\n"));
+    }
+
+    TEST_F(FileLogAppenderTest, CompressesRotatedFiles)
+    {
+        CopyingCompressor compressor;
+        FileLogAppender::Configuration configuration = WithoutFlushInterval();
+        configuration.maxFileSize = 200;
+        configuration.maxRotatedFiles = 2;
+        configuration.compressor = &compressor;
+        {
+            FileLogAppender appender(LogFilePath, configuration);
+            logMessages(appender, 30);
+        }
+
+        EXPECT_GT(compressor.compressedFiles, 2u);
+        EXPECT_FALSE(File(String(LogFilePath) + ".1").exists());
+        EXPECT_TRUE(File(String(LogFilePath) + ".1.copy").exists());
+        EXPECT_TRUE(File(String(LogFilePath) + ".2.copy").exists());
+        EXPECT_FALSE(File(String(LogFilePath) + ".3.copy").exists());
+    }
+
+    TEST_F(FileLogAppenderTest, SyncsOnFlush)
+    {
+        FileLogAppender::Configuration configuration = WithoutFlushInterval();
+        configuration.syncPolicy = FileLogAppender::SYNC_ON_FLUSH;
+        FileLogAppender appender(LogFilePath, configuration);
+        logMessages(appender, 5);
+        appender.flush();
+
+        EXPECT_EQ(5u, CountLines(ReadAllText(LogFilePath)));
+    }
+
+    TEST_F(FileLogAppenderTest, FiltersBatchesByLogLevel)
+    {
+        FileLogAppender appender(LogFilePath, WithoutFlushInterval());
+        appender.setLogLevel(LL_WARN);
+
+        Logger logger(appender);
+        LogContext& context = logger.createContext("test.File");
+        LogMessage messages[2] = { LogMessage(context, LL_INFO), LogMessage(context, LL_WARN) };
+        appender.logBatch(messages, 2);
+        appender.flush();
+
+        const String text = ReadAllText(LogFilePath);
+        EXPECT_EQ(1u, CountLines(text));
+        EXPECT_NE(-1, text.find("[ Warn  ]"));
+    }
+
+    TEST_F(FileLogAppenderTest, WritesMessagesOfAsynchronousLogger)
+    {
+        FileLogAppender appender(LogFilePath, WithoutFlushInterval());
+        {
+            AsynchronousLogger logger(appender);
+            LogContext& context = logger.createContext("test.File");
+            context.setLogLevel(LL_ALL);
+            for(uint32_t i = 0; i < 1000; ++i)
+            {
+                LOG_INFO_EXT(logger, context, "message " << i);
+            }
+        }
+        appender.flush();
+
+        const String text = ReadAllText(LogFilePath);
+        EXPECT_EQ(1000u, CountLines(text));
+        EXPECT_TRUE(text.endsWith("message 999\n"));
+    }
+
+    TEST_F(FileLogAppenderTest, DropsMessagesIfFileCannotBeOpened)
+    {
+        FileLogAppender appender("FileLogAppenderTestMissingDirectory/test.log", WithoutFlushInterval());
+        EXPECT_FALSE(appender.isOpen());
+        logMessages(appender, 3);
+        appender.flush();
+    }
+
+    namespace
+    {
+        double MeasureMessagesPerMicrosecond(ILogAppender& appender, uint32_t messageCount)
+        {
+            Logger logger(appender);
+            LogContext& context = logger.createContext("capu.Performance");
+            context.setLogLevel(LL_ALL);
+
+            const char* name = "frame";
+            const uint64_t start = Time::GetMonotonicNanoseconds();
+            for(uint32_t i = 0; i < messageCount; ++i)
+            {
+                LOG_INFO_EXT(logger, context, name << " " << i << " took " << 0.001f * i << " ms");
+            }
+            const uint64_t nanos = Time::GetMonotonicNanoseconds() - start;
+            return 0 == nanos ? 0.0 : 1000.0 * messageCount / nanos;
+        }
+    }
+
+    TEST(FileLogAppenderPerformanceTest, DISABLED_SustainedThroughputComparedToConsole)
+    {
+        const uint32_t fileMessageCount = 1000000;
+        const uint32_t consoleMessageCount = 100000;
+
+        File(LogFilePath).remove();
+        double fileMessagesPerMicrosecond = 0.0;
+        {
+            FileLogAppender appender(LogFilePath);
+            fileMessagesPerMicrosecond = MeasureMessagesPerMicrosecond(appender, fileMessageCount);
+        }
+        const uint_t fileSize = GetFileSize(LogFilePath);
+        File(LogFilePath).remove();
+
+        ConsoleLogAppender consoleAppender;
+        const double consoleMessagesPerMicrosecond = MeasureMessagesPerMicrosecond(consoleAppender, consoleMessageCount);
+
+        // the console messages go to stdout
+        const double averageLineLength = static_cast<double>(fileSize) / fileMessageCount;
+        fprintf(stderr, "FileLogAppender: %.0f ns/message, %.1f MB/s\n", 1000.0 / fileMessagesPerMicrosecond,
+            fileMessagesPerMicrosecond * averageLineLength);
+        fprintf(stderr, "ConsoleLogAppender: %.0f ns/message, %.1f MB/s\n", 1000.0 / consoleMessagesPerMicrosecond,
+            consoleMessagesPerMicrosecond * averageLineLength);
+    }
+}
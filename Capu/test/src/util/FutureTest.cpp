@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/util/Future.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/container/String.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/Thread.h"
+
+namespace
+{
+    uint32_t ReturnAnswer()
+    {
+        return 42u;
+    }
+
+    /**
+     * Takes a while to assign, so racing setters overlap
+     */
+    struct SlowValue
+    {
+        SlowValue()
+            : id(0)
+        {
+        }
+
+        explicit SlowValue(uint32_t id_)
+            : id(id_)
+        {
+        }
+
+        SlowValue(const SlowValue& other)
+            : id(other.id)
+        {
+        }
+
+        SlowValue& operator=(const SlowValue& other)
+        {
+            capu::Thread::Sleep(1);
+            id = other.id;
+            return *this;
+        }
+
+        uint32_t id;
+    };
+
+    class ValueSetter : public capu::Runnable
+    {
+    public:
+        ValueSetter(capu::Promise<SlowValue>& promise, uint32_t id, capu::Atomic<uint32_t>& startFlag)
+            : mPromise(promise)
+            , mId(id)
+            , mStartFlag(startFlag)
+            , mResult(capu::CAPU_ERROR)
+        {
+        }
+
+        void run() override
+        {
+            while (mStartFlag.load() == 0)
+            {
+            }
+            mResult = mPromise.setValue(SlowValue(mId));
+        }
+
+        capu::Promise<SlowValue>& mPromise;
+        const uint32_t mId;
+        capu::Atomic<uint32_t>& mStartFlag;
+        capu::status_t mResult;
+    };
+
+    class FutureTest : public ::testing::TestWithParam<capu::ThreadPool::Mode>
+    {
+    };
+
+    INSTANTIATE_TEST_CASE_P(SharedQueueAndWorkStealing, FutureTest,
+        ::testing::Values(capu::ThreadPool::SHARED_QUEUE, capu::ThreadPool::WORK_STEALING));
+}
+
+TEST_P(FutureTest, SubmitReturnsResult)
+{
+    capu::ThreadPool pool(2, GetParam());
+    capu::Future<uint32_t> future = pool.submit(&ReturnAnswer);
+    EXPECT_TRUE(future.isValid());
+    EXPECT_EQ(capu::CAPU_OK, future.wait());
+    EXPECT_TRUE(future.isReady());
+    EXPECT_EQ(42u, future.get());
+}
+
+TEST_P(FutureTest, SubmitLambdaWithoutResult)
+{
+    capu::ThreadPool pool(2, GetParam());
+    capu::Atomic<uint32_t> counter(0);
+    capu::Future<void> future = pool.submit([&counter]() { ++counter; });
+    future.get();
+    EXPECT_EQ(1u, counter.load());
+}
+
+TEST_P(FutureTest, SubmitToClosedPoolGivesInvalidFuture)
+{
+    capu::ThreadPool pool(1, GetParam());
+    pool.close();
+    capu::Future<uint32_t> future = pool.submit(&ReturnAnswer);
+    EXPECT_FALSE(future.isValid());
+    EXPECT_FALSE(future.isReady());
+    EXPECT_EQ(capu::CAPU_EINVAL, future.wait());
+    EXPECT_EQ(capu::CAPU_EINVAL, future.waitFor(10));
+}
+
+TEST_P(FutureTest, ThenRunsOnPoolWithResult)
+{
+    capu::ThreadPool pool(2, GetParam());
+    const capu::uint_t mainThread = capu::Thread::CurrentThreadId();
+    capu::Promise<uint32_t> promise(&pool);
+
+    capu::Atomic<capu::uint_t> continuationThread(0);
+    capu::Future<capu::String> future = promise.getFuture().then([&continuationThread](uint32_t value)
+    {
+        continuationThread = capu::Thread::CurrentThreadId();
+        return capu::String(value == 42u ? "answer" : "wrong");
+    });
+    EXPECT_FALSE(future.isReady());
+
+    EXPECT_EQ(capu::CAPU_OK, promise.setValue(42u));
+    EXPECT_STREQ("answer", future.get().c_str());
+    EXPECT_NE(mainThread, continuationThread.load());
+}
+
+TEST_P(FutureTest, ChainedContinuations)
+{
+    capu::ThreadPool pool(2, GetParam());
+    capu::Future<uint32_t> future = pool.submit(&ReturnAnswer)
+        .then([](uint32_t value) { return value + 1u; })
+        .then([](uint32_t value) { return value * 2u; });
+    EXPECT_EQ(86u, future.get());
+
+    capu::Atomic<uint32_t> counter(0);
+    capu::Future<void> last = future
+        .then([&counter](uint32_t value) { counter += value; })
+        .then([&counter]() { ++counter; });
+    last.get();
+    EXPECT_EQ(87u, counter.load());
+}
+
+TEST_P(FutureTest, ThenOnReadyFutureRunsImmediately)
+{
+    capu::ThreadPool pool(2, GetParam());
+    capu::Future<uint32_t> first = pool.submit(&ReturnAnswer);
+    first.wait();
+    capu::Future<uint32_t> second = first.then([](uint32_t value) { return value + 1u; });
+    EXPECT_EQ(43u, second.get());
+    EXPECT_EQ(42u, first.get());
+}
+
+TEST_P(FutureTest, ManyFuturesFromInsidePool)
+{
+    capu::ThreadPool pool(4, GetParam());
+    capu::Atomic<uint32_t> counter(0);
+    const uint32_t count = 1000;
+    capu::Future<void> outer = pool.submit([&pool, &counter, count]()
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            pool.submit([&counter]() { ++counter; });
+        }
+    });
+    outer.get();
+    pool.close();
+    EXPECT_EQ(count, counter.load());
+}
+
+TEST(Future, DefaultConstructedFutureIsInvalid)
+{
+    capu::Future<uint32_t> future;
+    EXPECT_FALSE(future.isValid());
+    EXPECT_EQ(capu::CAPU_EINVAL, future.wait());
+    EXPECT_FALSE(future.then([](uint32_t value) { return value; }).isValid());
+}
+
+TEST(Future, WaitForTimesOut)
+{
+    capu::Promise<uint32_t> promise;
+    capu::Future<uint32_t> future = promise.getFuture();
+    EXPECT_EQ(capu::CAPU_ETIMEOUT, future.waitFor(0));
+    EXPECT_EQ(capu::CAPU_ETIMEOUT, future.waitFor(20));
+
+    promise.setValue(7u);
+    EXPECT_EQ(capu::CAPU_OK, future.waitFor(0));
+    EXPECT_EQ(capu::CAPU_OK, future.waitFor(20));
+    EXPECT_EQ(7u, future.get());
+}
+
+TEST(Future, PromiseValueCanOnlyBeSetOnce)
+{
+    capu::Promise<uint32_t> promise;
+    EXPECT_EQ(capu::CAPU_OK, promise.setValue(1u));
+    EXPECT_EQ(capu::CAPU_ERROR, promise.setValue(2u));
+    EXPECT_EQ(1u, promise.getFuture().get());
+
+    capu::Promise<void> voidPromise;
+    EXPECT_EQ(capu::CAPU_OK, voidPromise.setValue());
+    EXPECT_EQ(capu::CAPU_ERROR, voidPromise.setValue());
+    EXPECT_TRUE(voidPromise.getFuture().isReady());
+}
+
+TEST(Future, RacingSettersDeliverTheValueOfTheWinner)
+{
+    for (uint32_t i = 0; i < 50; ++i)
+    {
+        capu::Promise<SlowValue> promise;
+        capu::Atomic<uint32_t> startFlag(0);
+        ValueSetter firstSetter(promise, 1u, startFlag);
+        ValueSetter secondSetter(promise, 2u, startFlag);
+        capu::Thread firstThread;
+        capu::Thread secondThread;
+        firstThread.start(firstSetter);
+        secondThread.start(secondSetter);
+        startFlag = 1;
+        firstThread.join();
+        secondThread.join();
+
+        ASSERT_NE(firstSetter.mResult, secondSetter.mResult);
+        const uint32_t winner = firstSetter.mResult == capu::CAPU_OK ? 1u : 2u;
+        EXPECT_EQ(winner, promise.getFuture().get().id);
+    }
+}
+
+TEST(Future, ContinuationWithoutPoolRunsInCompletingThread)
+{
+    capu::Promise<uint32_t> promise;
+    capu::uint_t continuationThread = 0;
+    capu::Future<void> future = promise.getFuture().then([&continuationThread](uint32_t)
+    {
+        continuationThread = capu::Thread::CurrentThreadId();
+    });
+    promise.setValue(1u);
+    EXPECT_TRUE(future.isReady());
+    EXPECT_EQ(capu::Thread::CurrentThreadId(), continuationThread);
+}
+
+TEST(Future, WaitingThreadIsWokenUp)
+{
+    capu::ThreadPool pool(1);
+    capu::Promise<uint32_t> promise;
+    capu::Future<uint32_t> future = promise.getFuture();
+    pool.submit([promise]() mutable
+    {
+        capu::Thread::Sleep(20);
+        promise.setValue(5u);
+    });
+    EXPECT_EQ(capu::CAPU_OK, future.waitFor(60000));
+    EXPECT_EQ(5u, future.get());
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/util/LogArguments.h"
+
+namespace capu
+{
+    namespace
+    {
+        String Format(const char* format, const LogArguments& arguments)
+        {
+            StringOutputStream stream;
+            LogArguments::Format(format, arguments.getData(), arguments.getSize(), stream);
+            return stream.c_str();
+        }
+    }
+
+    TEST(LogArguments, FormatsArgumentsLikeTheStream)
+    {
+        LogArguments arguments;
+        AppendLogArguments(arguments, static_cast<int32_t>(-42), 42u, -(static_cast<int64_t>(1) << 40), static_cast<uint64_t>(1) << 40,
+            static_cast<int16_t>(-7), static_cast<uint16_t>(7), true, 'c', 1.5f, "text", String("string"));
+        EXPECT_STREQ("-42 42 -1099511627776 1099511627776 -7 7 1 c 1.500000 text string",
+            Format("{} {} {} {} {} {} {} {} {} {} {}", arguments).c_str());
+    }
+
+    TEST(LogArguments, FormatsDoubleAsFloat)
+    {
+        LogArguments arguments;
+        AppendLogArguments(arguments, 2.25, 1.5f);
+        EXPECT_STREQ("2.250000 1.500000", Format("{} {}", arguments).c_str());
+    }
+
+    TEST(LogArguments, KeepsTextAroundPlaceholders)
+    {
+        LogArguments arguments;
+        AppendLogArguments(arguments, 1u, 2u);
+        EXPECT_STREQ("{}", Format("{}", LogArguments()).c_str());
+        EXPECT_STREQ("no placeholder", Format("no placeholder", arguments).c_str());
+        EXPECT_STREQ("a 1 b {2 c 2 d", Format("a {} b {2 c {} d", arguments).c_str());
+        EXPECT_STREQ("1 2 {}", Format("{} {} {}", arguments).c_str());
+    }
+
+    TEST(LogArguments, DropsArgumentsWhichDoNotFit)
+    {
+        String longText;
+        for(uint32_t i = 0; i < 30; ++i)
+        {
+            longText.append("0123456789");
+        }
+        LogArguments arguments;
+        AppendLogArguments(arguments, 1u, longText.c_str(), 2u);
+        EXPECT_EQ(LogArguments::MaxSize, arguments.getSize());
+
+        const String text = Format("{} {} {}", arguments);
+        EXPECT_TRUE(text.startsWith("1 0123456789"));
+        EXPECT_TRUE(text.endsWith(" {}"));
+        EXPECT_GT(longText.getLength(), text.getLength());
+    }
+
+    TEST(LogArguments, FormatsTruncatedDataSafely)
+    {
+        LogArguments arguments;
+        AppendLogArguments(arguments, 1u, "text", 2u);
+        for(uint32_t size = 0; size < arguments.getSize(); ++size)
+        {
+            StringOutputStream stream;
+            LogArguments::Format("{} {} {}", arguments.getData(), size, stream);
+            EXPECT_TRUE(String(stream.c_str()).endsWith("{}"));
+        }
+    }
+}
@@ -19,6 +19,8 @@
 #include "capu/util/Logger.h"
 #include "capu/container/String.h"
 #include "capu/util/LogMessage.h"
+#include "capu/util/LogAppenderBase.h"
+#include "capu/os/Time.h"
 
 namespace capu
 {
@@ -335,6 +337,117 @@ namespace capu
         EXPECT_EQ(capu::LL_WARN,read_level);
     }
 
+    TEST(LogContextTest, DisablingKeepsLogLevel)
+    {
+        LogContext context("LogContext name", "LOCO");
+        context.setLogLevel(LL_INFO);
+        EXPECT_TRUE(context.isLogLevelEnabled(LL_INFO));
+        EXPECT_FALSE(context.isLogLevelEnabled(LL_DEBUG));
+
+        context.setEnabled(false);
+        EXPECT_FALSE(context.isEnabled());
+        EXPECT_EQ(LL_INFO, context.getLogLevel());
+        EXPECT_FALSE(context.isLogLevelEnabled(LL_FATAL));
+
+        context.setLogLevel(LL_ALL);
+        EXPECT_FALSE(context.isLogLevelEnabled(LL_FATAL));
+        context.setEnabled(true);
+        EXPECT_TRUE(context.isEnabled());
+        EXPECT_EQ(LL_ALL, context.getLogLevel());
+        EXPECT_TRUE(context.isLogLevelEnabled(LL_TRACE));
+
+        context.setLogLevel(LL_OFF);
+        EXPECT_FALSE(context.isLogLevelEnabled(LL_FATAL));
+    }
+
+    TEST(LoggerContextIndexTest, SetEnabledOnlyAffectsNamesWithThePrefix)
+    {
+        MockLogAppender appender;
+        Logger logger(appender);
+        LogContext& capu = logger.createContext("capu", "C");
+        LogContext& capuLogger = logger.createContext("capu.Logger", "CL");
+        LogContext& capuOther = logger.createContext("capuOther", "CO");
+        LogContext& cap = logger.createContext("cap", "CA");
+        LogContext& hello = logger.createContext("Hello.capu", "HC");
+
+        logger.setEnabled(false, "capu");
+        EXPECT_FALSE(capu.isEnabled());
+        EXPECT_FALSE(capuLogger.isEnabled());
+        EXPECT_FALSE(capuOther.isEnabled());
+        EXPECT_TRUE(cap.isEnabled());
+        EXPECT_TRUE(hello.isEnabled());
+
+        logger.setEnabled(true, "capu.");
+        EXPECT_FALSE(capu.isEnabled());
+        EXPECT_TRUE(capuLogger.isEnabled());
+        EXPECT_FALSE(capuOther.isEnabled());
+
+        logger.setEnabled(true, "");
+        EXPECT_TRUE(capu.isEnabled());
+        EXPECT_TRUE(capuOther.isEnabled());
+    }
+
+    TEST(LoggerContextIndexTest, SetLogLevelsAppliesRulesInOrder)
+    {
+        MockLogAppender appender;
+        Logger logger(appender);
+        LogContext& renderer = logger.createContext("ramses.renderer", "RR");
+        LogContext& rendererTexture = logger.createContext("ramses.renderer.texture", "RT");
+        LogContext& client = logger.createContext("ramses.client", "RC");
+        LogContext& other = logger.createContext("other", "OT");
+        other.setLogLevel(LL_WARN);
+
+        vector<Logger::LogLevelRule> rules;
+        Logger::LogLevelRule rule;
+        rule.namePrefix = "ramses";
+        rule.logLevel = LL_INFO;
+        rules.push_back(rule);
+        rule.namePrefix = "ramses.renderer";
+        rule.logLevel = LL_TRACE;
+        rules.push_back(rule);
+        rule.namePrefix = "ramses.renderer.texture";
+        rule.logLevel = LL_OFF;
+        rules.push_back(rule);
+        logger.setLogLevels(rules);
+
+        EXPECT_EQ(LL_TRACE, renderer.getLogLevel());
+        EXPECT_EQ(LL_OFF, rendererTexture.getLogLevel());
+        EXPECT_EQ(LL_INFO, client.getLogLevel());
+        EXPECT_EQ(LL_WARN, other.getLogLevel());
+    }
+
+    TEST(LoggerContextIndexTest, LooksUpContextsById)
+    {
+        MockLogAppender appender;
+        Logger logger(appender);
+        for(uint32_t i = 0; i < 1000; ++i)
+        {
+            StringOutputStream name;
+            StringOutputStream id;
+            name << "context." << (i * 7919) % 1000;
+            id << "ID" << i;
+            logger.createContext(name.c_str(), id.c_str()).setLogLevel(i % 2 == 0 ? LL_DEBUG : LL_WARN);
+        }
+
+        String name;
+        ELogLevel logLevel = LL_ALL;
+        logger.getContextName("ID3", name);
+        logger.getLogLevel("ID3", logLevel);
+        EXPECT_STREQ("context.757", name.c_str());
+        EXPECT_EQ(LL_WARN, logLevel);
+
+        logger.getLogLevel("ID998", logLevel);
+        EXPECT_EQ(LL_DEBUG, logLevel);
+
+        name = "unchanged";
+        logger.getContextName("unknown", name);
+        EXPECT_STREQ("unchanged", name.c_str());
+
+        vector<String> ids;
+        logger.getContextIds(ids);
+        EXPECT_EQ(1000u, ids.size());
+    }
+
     TEST_F(LoggerTest,GetContextIdsAndNames)
     {
         capu::vector<capu::String> contextIds;
@@ -370,4 +483,76 @@ namespace capu
          }
     }
 
+    namespace
+    {
+        class NullLogAppender : public LogAppenderBase
+        {
+        public:
+            NullLogAppender()
+                : length(0)
+            {
+            }
+
+            virtual void logMessage(const LogMessage& message) override
+            {
+                length += message.getLogMessageLength();
+            }
+
+            uint64_t length;
+        };
+    }
+
+    TEST(LoggerPerformanceTest, DISABLED_LogInfoWithFiveArguments)
+    {
+        const uint32_t messageCount = 2000000;
+        NullLogAppender appender;
+        Logger logger(appender);
+        LogContext& context = logger.createContext("capu.Performance");
+        context.setLogLevel(LL_ALL);
+
+        const char* name = "frame";
+        const uint64_t start = Time::GetMicroseconds();
+        for(uint32_t i = 0; i < messageCount; ++i)
+        {
+            LOG_INFO_EXT(logger, context, name << " " << i << " took " << 0.001f * i << " ms, " << static_cast<int64_t>(i) * -4096 << " bytes");
+        }
+        const uint64_t micros = Time::GetMicroseconds() - start;
+
+        printf("LOG_INFO with 5 arguments: %.1f ns/call (%llu bytes)\n", 1000.0 * micros / messageCount,
+            static_cast<unsigned long long>(appender.length));
+    }
+
+    TEST(LoggerPerformanceTest, DISABLED_ConfigureThousandsOfContexts)
+    {
+        const uint32_t contextCount = 10000;
+        const uint32_t callCount = 1000;
+        NullLogAppender appender;
+        Logger logger(appender);
+        for(uint32_t i = 0; i < contextCount; ++i)
+        {
+            StringOutputStream name;
+            StringOutputStream id;
+            name << "component" << i % 100 << ".context" << i;
+            id << "C" << i;
+            logger.createContext(name.c_str(), id.c_str());
+        }
+
+        uint64_t start = Time::GetMonotonicNanoseconds();
+        for(uint32_t i = 0; i < callCount; ++i)
+        {
+            logger.setEnabled(i % 2 == 0, "component42.");
+        }
+        const uint64_t setEnabledNanos = Time::GetMonotonicNanoseconds() - start;
+
+        ELogLevel logLevel = LL_ALL;
+        start = Time::GetMonotonicNanoseconds();
+        for(uint32_t i = 0; i < callCount; ++i)
+        {
+            logger.getLogLevel("C4711", logLevel);
+        }
+        const uint64_t getLogLevelNanos = Time::GetMonotonicNanoseconds() - start;
+
+        printf("%u contexts: setEnabled by prefix %.0f ns, getLogLevel by id %.0f ns\n", contextCount,
+            static_cast<double>(setEnabledNanos) / callCount, static_cast<double>(getLogLevelNanos) / callCount);
+    }
 }
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/util/ParallelAlgorithm.h"
+#include "capu/container/vector.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/Random.h"
+#include "capu/os/Time.h"
+#include <functional>
+
+namespace
+{
+    class ParallelAlgorithmTest : public ::testing::TestWithParam<capu::ThreadPool::Mode>
+    {
+    public:
+        ParallelAlgorithmTest()
+            : pool(4, GetParam())
+        {
+        }
+
+        capu::ThreadPool pool;
+    };
+
+    INSTANTIATE_TEST_CASE_P(SharedQueueAndWorkStealing, ParallelAlgorithmTest,
+        ::testing::Values(capu::ThreadPool::SHARED_QUEUE, capu::ThreadPool::WORK_STEALING));
+
+    void FillRandom(capu::vector<uint32_t>& values, uint32_t count)
+    {
+        capu::Random random;
+        values.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            values.push_back(random.nextUInt32());
+        }
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, ParallelForVisitsEveryIndexOnce)
+{
+    const uint32_t count = 100000;
+    capu::vector<uint32_t> visits(count, 0u);
+    capu::parallel_for(pool, 0u, count, [&visits](capu::uint_t i) { ++visits[i]; });
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(1u, visits[i]);
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, ParallelForWithOffsetAndEmptyRange)
+{
+    capu::vector<uint32_t> visits(100, 0u);
+    capu::parallel_for(pool, 10u, 20u, [&visits](capu::uint_t i) { ++visits[i]; });
+    capu::parallel_for(pool, 50u, 50u, [&visits](capu::uint_t i) { ++visits[i]; });
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i >= 10 && i < 20 ? 1u : 0u, visits[i]);
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, ParallelForEachUsesPoolThreads)
+{
+    const uint32_t count = 100000;
+    capu::vector<uint32_t> values(count, 1u);
+    capu::Atomic<uint32_t> sum(0);
+    capu::ParallelOptions options;
+    options.grainSize = 100;
+    capu::parallel_for_each(pool, values.begin(), values.end(), [&sum](uint32_t& value)
+    {
+        value *= 2;
+        sum += value;
+    }, options);
+    EXPECT_EQ(2 * count, sum.load());
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(2u, values[i]);
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, ParallelReduceSums)
+{
+    const uint32_t count = 100000;
+    capu::vector<uint64_t> values;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values.push_back(i);
+    }
+    const uint64_t expected = static_cast<uint64_t>(count) * (count - 1) / 2;
+    EXPECT_EQ(expected + 5, capu::parallel_reduce(pool, values.begin(), values.end(), uint64_t(5), std::plus<uint64_t>()));
+
+    capu::ParallelOptions options;
+    options.deterministic = true;
+    EXPECT_EQ(expected + 5, capu::parallel_reduce(pool, values.begin(), values.end(), uint64_t(5), std::plus<uint64_t>(), options));
+
+    EXPECT_EQ(7u, capu::parallel_reduce(pool, values.begin(), values.begin(), uint64_t(7), std::plus<uint64_t>()));
+}
+
+TEST_P(ParallelAlgorithmTest, DeterministicReduceDoesNotDependOnThreadCount)
+{
+    const uint32_t count = 100000;
+    capu::vector<double> values;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values.push_back(1.0 / (i + 1));
+    }
+
+    capu::ParallelOptions options;
+    options.deterministic = true;
+    options.grainSize = 100;
+
+    capu::ThreadPool singleThread(1, GetParam());
+    const double expected = capu::parallel_reduce(singleThread, values.begin(), values.end(), 0.0, std::plus<double>(), options);
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(expected, capu::parallel_reduce(pool, values.begin(), values.end(), 0.0, std::plus<double>(), options));
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, ParallelSortSmallAndLargeRanges)
+{
+    const uint32_t sizes[] = { 0, 1, 2, 100, 40000, 100000, 200001 };
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        capu::vector<uint32_t> values;
+        FillRandom(values, sizes[s]);
+        capu::parallel_sort(pool, values.begin(), values.end());
+        for (uint32_t i = 1; i < sizes[s]; ++i)
+        {
+            ASSERT_LE(values[i - 1], values[i]);
+        }
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, ParallelSortWithComparatorKeepsElements)
+{
+    const uint32_t count = 50000;
+    capu::vector<uint32_t> values;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        values.push_back(i % 1000);
+    }
+    capu::ParallelOptions options;
+    options.grainSize = 1000;
+    capu::parallel_sort(pool, values.begin(), values.end(), std::greater<uint32_t>(), options);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(999u - i / 50, values[i]);
+    }
+}
+
+TEST_P(ParallelAlgorithmTest, NestedInsidePoolThread)
+{
+    capu::ThreadPool singleThread(1, GetParam());
+    capu::Future<uint64_t> result = singleThread.submit([&singleThread]()
+    {
+        capu::vector<uint64_t> values(100000, 1u);
+        capu::ParallelOptions options;
+        options.grainSize = 10;
+        return capu::parallel_reduce(singleThread, values.begin(), values.end(), uint64_t(0), std::plus<uint64_t>(), options);
+    });
+    EXPECT_EQ(100000u, result.get());
+}
+
+TEST(ParallelAlgorithm, ClosedPoolRunsInCallingThread)
+{
+    capu::ThreadPool pool(2);
+    pool.close();
+    capu::vector<uint32_t> values;
+    FillRandom(values, 100000);
+    capu::parallel_sort(pool, values.begin(), values.end());
+    for (uint32_t i = 1; i < values.size(); ++i)
+    {
+        ASSERT_LE(values[i - 1], values[i]);
+    }
+
+    capu::vector<capu::uint_t> ones(100000, 1u);
+    EXPECT_EQ(100000u, capu::parallel_reduce(pool, ones.begin(), ones.end(), capu::uint_t(0), std::plus<capu::uint_t>()));
+}
+
+TEST(ParallelAlgorithmPerformanceTest, DISABLED_SortAndReduceScaling)
+{
+    const uint32_t count = 10000000;
+    capu::vector<uint32_t> input;
+    FillRandom(input, count);
+    capu::vector<double> doubles;
+    doubles.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        doubles.push_back(input[i] * 0.5);
+    }
+
+    capu::ParallelOptions deterministic;
+    deterministic.deterministic = true;
+
+    for (uint32_t threadCount = 0; threadCount <= capu::ThreadPool::MAX_THREAD_POOL_THREADS; threadCount = threadCount == 0 ? 1 : threadCount * 2)
+    {
+        capu::ThreadPool pool(threadCount, capu::ThreadPool::WORK_STEALING);
+
+        capu::vector<uint32_t> values(input);
+        uint64_t start = capu::Time::GetMicroseconds();
+        capu::parallel_sort(pool, values.begin(), values.end());
+        const uint64_t sortTime = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        const double sum = capu::parallel_reduce(pool, doubles.begin(), doubles.end(), 0.0, std::plus<double>());
+        const uint64_t reduceTime = capu::Time::GetMicroseconds() - start;
+
+        start = capu::Time::GetMicroseconds();
+        const double deterministicSum = capu::parallel_reduce(pool, doubles.begin(), doubles.end(), 0.0, std::plus<double>(), deterministic);
+        const uint64_t deterministicReduceTime = capu::Time::GetMicroseconds() - start;
+
+        printf("%2u pool threads, %u elements: sort %7u us, reduce %6u us, deterministic reduce %6u us (%.17g, %.17g)\n",
+            threadCount, count, static_cast<uint32_t>(sortTime), static_cast<uint32_t>(reduceTime),
+            static_cast<uint32_t>(deterministicReduceTime), sum, deterministicSum);
+    }
+}
@@ -413,3 +413,20 @@ TEST_F(SharedPtrTest, EqualUnequalOperators)
     EXPECT_TRUE(sp != different);
     EXPECT_TRUE(sp != differentOtherType);
 }
+
+TEST_F(SharedPtrTest, MakeShared)
+{
+    {
+        capu::shared_ptr<DerivedClass> sp = capu::make_shared<DerivedClass>(123u);
+        EXPECT_EQ(123u, sp->mValue);
+        EXPECT_EQ(1u, sp.use_count());
+        EXPECT_EQ(1u, BaseClass::mReferences);
+
+        capu::shared_ptr<BaseClass> base(sp);
+        EXPECT_EQ(2u, sp.use_count());
+        EXPECT_EQ(123u, base->mValue);
+        sp.reset();
+        EXPECT_EQ(1u, BaseClass::mReferences);
+    }
+    EXPECT_EQ(0u, BaseClass::mReferences);
+}
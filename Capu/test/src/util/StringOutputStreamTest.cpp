@@ -239,6 +239,109 @@ namespace capu
         EXPECT_STREQ("a", constStream.c_str());
     }
 
+    TEST_F(StringOutputStreamTest, ContentLongerThanInlineBufferMovesToHeap)
+    {
+        String expected;
+        for(uint32_t i = 0; i < 100; ++i)
+        {
+            outputStream << "0123456789";
+            expected.append("0123456789");
+        }
+        EXPECT_STREQ(expected.c_str(), outputStream.c_str());
+        EXPECT_EQ(1000U, outputStream.length());
+
+        outputStream.clear();
+        outputStream << "a";
+        EXPECT_STREQ("a", outputStream.c_str());
+    }
+
+    TEST_F(StringOutputStreamTest, CopyAndAssign)
+    {
+        StringOutputStream longStream;
+        for(uint32_t i = 0; i < 30; ++i)
+        {
+            longStream << "0123456789";
+        }
+        outputStream.setHexadecimalOutputFormat(StringOutputStream::HEXADECIMAL_NO_LEADING_ZEROS);
+        outputStream << "short";
+
+        StringOutputStream copy(outputStream);
+        EXPECT_STREQ("short", copy.c_str());
+        copy << 255u;
+        EXPECT_STREQ("short0xFF", copy.c_str());
+
+        copy = longStream;
+        EXPECT_STREQ(longStream.c_str(), copy.c_str());
+        copy << 255u;
+        EXPECT_EQ(303U, copy.length());
+        EXPECT_EQ(300U, longStream.length());
+    }
+
+    TEST_F(StringOutputStreamTest, SwapInlineAndHeapContent)
+    {
+        String longText;
+        for(uint32_t i = 0; i < 30; ++i)
+        {
+            longText.append("0123456789");
+        }
+        StringOutputStream first;
+        StringOutputStream second;
+        first << "first";
+        second << "second";
+        first.swap(second);
+        EXPECT_STREQ("second", first.c_str());
+        EXPECT_STREQ("first", second.c_str());
+
+        second << longText;
+        first.swap(second);
+        EXPECT_EQ(longText.getLength() + 5, first.length());
+        EXPECT_STREQ("second", second.c_str());
+
+        second << longText;
+        first.swap(second);
+        EXPECT_EQ(longText.getLength() + 6, first.length());
+        EXPECT_EQ(longText.getLength() + 5, second.length());
+
+        first.clear();
+        first << "inline";
+        second.swap(first);
+        EXPECT_STREQ("inline", second.c_str());
+        EXPECT_EQ(longText.getLength() + 5, first.length());
+    }
+
+    TEST_F(StringOutputStreamTest, WriteIntegerLimits)
+    {
+        outputStream << NumericLimits<int64_t>::Min() << " " << NumericLimits<uint64_t>::Max() << " "
+                     << NumericLimits<int32_t>::Min() << " " << NumericLimits<int16_t>::Min() << " "
+                     << NumericLimits<uint16_t>::Max() << " " << 0u << " " << false;
+        EXPECT_STREQ("-9223372036854775808 18446744073709551615 -2147483648 -32768 65535 0 0", outputStream.c_str());
+    }
+
+    TEST_F(StringOutputStreamTest, WriteHexadecimalZero)
+    {
+        outputStream.setHexadecimalOutputFormat(StringOutputStream::HEXADECIMAL_NO_LEADING_ZEROS);
+        outputStream << 0u << " " << static_cast<uint64_t>(0u);
+        EXPECT_STREQ("0x0 0x0", outputStream.c_str());
+    }
+
+    TEST_F(StringOutputStreamTest, WriteFloatRoundsLikePrintf)
+    {
+        const float values[] = { 0.f, -0.f, 0.5f, 1.5f, 2.5f, -2.5f, 0.125f, 0.375f, 1e-7f, -1e-7f, 47.11f, 1234.5678f,
+            -98765.4321f, 16777216.f, 1e10f, 3e12f, 1e20f, -NumericLimits<float>::Max(), NumericLimits<float>::Min() };
+        for(uint32_t digits = 0; digits <= 16; ++digits)
+        {
+            for(uint32_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+            {
+                char expected[86];
+                StringUtils::Sprintf(expected, sizeof(expected), "%.*f", digits, values[i]);
+                StringOutputStream stream;
+                stream.setDecimalDigits(digits);
+                stream << values[i];
+                EXPECT_STREQ(expected, stream.c_str()) << digits << " digits of value " << i;
+            }
+        }
+    }
+
     TEST_F(StringOutputStreamTest, WriteUInt32HexNoLeadingZero)
     {
         outputStream.setHexadecimalOutputFormat(StringOutputStream::HEXADECIMAL_NO_LEADING_ZEROS);
@@ -21,6 +21,7 @@
 #include <capu/os/Math.h>
 #include <capu/os/NumericLimits.h>
 #include <capu/os/Console.h>
+#include <capu/os/Time.h>
 #include <capu/util/TestUtils.h>
 #include <capu/util/SocketOutputStream.h>
 #include <capu/util/TcpSocketOutputStream.h>
@@ -211,7 +212,7 @@ namespace capu
 
             TcpSocket* socket = serverSocket.accept();
 
-            TcpSocketInputStream inStream(*socket);
+            TcpSocketInputStream<> inStream(*socket);
 
             typename T::VALUE_TYPE resultValue;
             inStream >> resultValue;
@@ -289,7 +290,7 @@ namespace capu
 
         TcpSocket* socket = serverSocket.accept();
 
-        TcpSocketInputStream inStream(*socket);
+        TcpSocketInputStream<> inStream(*socket);
 
         int32_t intResult;
         String  stringResult;
@@ -310,6 +311,165 @@ namespace capu
     }
 
 
+    namespace
+    {
+        /**
+         * Connected client and server side socket, both in the test thread
+         */
+        struct ConnectedTcpSockets
+        {
+            ConnectedTcpSockets()
+                : serverSideSocket(0)
+            {
+                serverSocket.bind(0);
+                serverSocket.listen(10);
+                clientSocket.connect("127.0.0.1", serverSocket.port());
+                serverSideSocket = serverSocket.accept();
+            }
+
+            ~ConnectedTcpSockets()
+            {
+                delete serverSideSocket;
+                serverSocket.close();
+            }
+
+            TcpServerSocket serverSocket;
+            TcpSocket clientSocket;
+            TcpSocket* serverSideSocket;
+        };
+
+        template<uint16_t RCVBUFSIZE>
+        uint32_t WaitForAvailableBytes(TcpSocketInputStream<RCVBUFSIZE>& inStream, const uint32_t size)
+        {
+            for (uint32_t i = 0; i < 500 && inStream.available() < size; ++i)
+            {
+                Thread::Sleep(10);
+            }
+            return inStream.available();
+        }
+    }
+
+    TEST_F(TcpSocketInputStreamTest, ReceiveSomeDataWithSmallBuffer)
+    {
+        ConnectedTcpSockets sockets;
+        TcpInt32TestSender::Send(sockets.clientSocket, 5);
+        TcpStringTestSender::Send(sockets.clientSocket, "Hello World, this is longer than the buffer");
+        TcpFloatTestSender::Send(sockets.clientSocket, Math::LN2_f);
+        TcpBoolTestSender::Send(sockets.clientSocket, true);
+
+        TcpSocketInputStream<8> inStream(*sockets.serverSideSocket);
+        int32_t intResult;
+        String  stringResult;
+        float floatResult;
+        bool  boolResult;
+        inStream >> intResult >> stringResult >> floatResult >> boolResult;
+
+        EXPECT_EQ(CAPU_OK, inStream.getState());
+        EXPECT_EQ(5, intResult);
+        EXPECT_STREQ("Hello World, this is longer than the buffer", stringResult.c_str());
+        EXPECT_FLOAT_EQ(Math::LN2_f, floatResult);
+        EXPECT_EQ(true, boolResult);
+    }
+
+    TEST_F(TcpSocketInputStreamTest, AvailableAndPeekDoNotBlock)
+    {
+        ConnectedTcpSockets sockets;
+        TcpSocketInputStream<> inStream(*sockets.serverSideSocket);
+
+        char header[4];
+        EXPECT_EQ(0u, inStream.available());
+        EXPECT_EQ(CAPU_ETIMEOUT, inStream.peek(header, sizeof(header)));
+
+        TcpStringTestSender::Send(sockets.clientSocket, "Hello");
+        EXPECT_EQ(10u, WaitForAvailableBytes(inStream, 10));
+
+        uint32_t length = 0;
+        EXPECT_EQ(CAPU_OK, inStream.peek(reinterpret_cast<char*>(&length), sizeof(length)));
+        EXPECT_EQ(6u, ntohl(length));
+        EXPECT_EQ(10u, inStream.available());
+
+        String value;
+        inStream >> value;
+        EXPECT_STREQ("Hello", value.c_str());
+        EXPECT_EQ(0u, inStream.available());
+        EXPECT_EQ(CAPU_OK, inStream.getState());
+    }
+
+    TEST_F(TcpSocketInputStreamTest, PeekLargerThanBufferIsInvalid)
+    {
+        ConnectedTcpSockets sockets;
+        TcpSocketInputStream<8> inStream(*sockets.serverSideSocket);
+
+        char data[9];
+        EXPECT_EQ(CAPU_EINVAL, inStream.peek(data, sizeof(data)));
+    }
+
+    TEST_F(TcpSocketInputStreamTest, ReadContinuesAfterTimeout)
+    {
+        ConnectedTcpSockets sockets;
+        sockets.serverSideSocket->setTimeout(20);
+        TcpSocketInputStream<> inStream(*sockets.serverSideSocket);
+
+        const int32_t value = htonl(0x01020304);
+        TestTcpSocketSender::SendToSocket(sockets.clientSocket, reinterpret_cast<const char*>(&value), 2);
+
+        int32_t result = 0;
+        inStream >> result;
+        EXPECT_EQ(CAPU_ETIMEOUT, inStream.getState());
+
+        TestTcpSocketSender::SendToSocket(sockets.clientSocket, reinterpret_cast<const char*>(&value) + 2, 2);
+        inStream.resetState();
+        inStream >> result;
+        EXPECT_EQ(CAPU_OK, inStream.getState());
+        EXPECT_EQ(0x01020304, result);
+    }
+
+    TEST_F(TcpSocketInputStreamTest, ReceiveFailsWhenOtherSideClosed)
+    {
+        ConnectedTcpSockets sockets;
+        TcpSocketInputStream<> inStream(*sockets.serverSideSocket);
+        sockets.clientSocket.close();
+
+        int32_t result = 0;
+        inStream >> result;
+        EXPECT_EQ(CAPU_ERROR, inStream.getState());
+    }
+
+    namespace
+    {
+        template<uint16_t RCVBUFSIZE>
+        double MeasureInt32Reads(const uint32_t valueCount)
+        {
+            ConnectedTcpSockets sockets;
+            sockets.clientSocket.setBufferSize(1024 * 1024);
+            sockets.serverSideSocket->setBufferSize(1024 * 1024);
+
+            const int32_t value = htonl(42);
+            for (uint32_t i = 0; i < valueCount; ++i)
+            {
+                TestTcpSocketSender::SendToSocket(sockets.clientSocket, reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+
+            TcpSocketInputStream<RCVBUFSIZE> inStream(*sockets.serverSideSocket);
+            int32_t result = 0;
+            const uint64_t start = Time::GetMonotonicNanoseconds();
+            for (uint32_t i = 0; i < valueCount; ++i)
+            {
+                inStream >> result;
+            }
+            return static_cast<double>(Time::GetMonotonicNanoseconds() - start) / valueCount;
+        }
+    }
+
+    TEST(TcpSocketInputStreamPerformanceTest, DISABLED_ReadInt32Values)
+    {
+        // a buffer of one byte receives every value separately, like the stream without buffer
+        const uint32_t valueCount = 100000;
+        const double unbufferedNanos = MeasureInt32Reads<1>(valueCount);
+        const double bufferedNanos = MeasureInt32Reads<4096>(valueCount);
+        printf("int32 reads: %.1f ns/value unbuffered, %.1f ns/value buffered\n", unbufferedNanos, bufferedNanos);
+    }
+
     enum SendType
     {
         SENDTYPE_UNKNOWN = -1,
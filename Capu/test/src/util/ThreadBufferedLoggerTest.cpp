@@ -0,0 +1,440 @@
+/*
+ * Copyright (C) 2017 BMW Car IT GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include "capu/util/ThreadBufferedLogger.h"
+#include "capu/util/AsynchronousLogger.h"
+#include "capu/util/LogAppenderBase.h"
+#include "capu/util/CountDownLatch.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/util/ScopedLock.h"
+#include "capu/container/String.h"
+#include "capu/container/vector.h"
+#include "capu/os/Time.h"
+#include "capu/os/Mutex.h"
+#include "capu/os/CondVar.h"
+#include <cstdlib>
+
+namespace capu
+{
+    namespace
+    {
+        /**
+         * Records the text of all messages and the number of batches,
+         * optionally blocks the sink on the first message until it is released
+         */
+        class RecordingLogAppender : public LogAppenderBase
+        {
+        public:
+            explicit RecordingLogAppender(bool blockOnFirstMessage = false)
+                : entered(1)
+                , released(blockOnFirstMessage ? 1 : 0)
+                , batchCount(0)
+            {
+            }
+
+            virtual void logMessage(const LogMessage& message) override
+            {
+                bool first = false;
+                {
+                    ScopedLightweightMutexLock lock(mutex);
+                    first = texts.empty();
+                    texts.push_back(message.getLogMessage());
+                }
+                if(first)
+                {
+                    entered.countDown();
+                    released.await();
+                }
+            }
+
+            virtual void logBatch(const LogMessage* messages, uint_t count) override
+            {
+                ++batchCount;
+                LogAppenderBase::logBatch(messages, count);
+            }
+
+            vector<String> getTexts()
+            {
+                ScopedLightweightMutexLock lock(mutex);
+                return texts;
+            }
+
+            void waitForTexts(uint_t count)
+            {
+                while(getTexts().size() < count)
+                {
+                    Thread::Sleep(1);
+                }
+            }
+
+            CountDownLatch entered;
+            CountDownLatch released;
+            Atomic<uint32_t> batchCount;
+
+        private:
+            LightweightMutex mutex;
+            vector<String> texts;
+        };
+
+        vector<String> ToTexts(std::initializer_list<const char*> texts)
+        {
+            vector<String> result;
+            for(const char* text : texts)
+            {
+                result.push_back(text);
+            }
+            return result;
+        }
+
+        const char* LogInner(Logger& logger, const LogContext& context)
+        {
+            LOG_INFO_EXT(logger, context, "inner");
+            return "x";
+        }
+    }
+
+    TEST(ThreadBufferedLogger, OutputsMessagesOfOneThreadInOrder)
+    {
+        RecordingLogAppender appender;
+        vector<String> expected;
+        {
+            // a small buffer makes the thread wait for the sink and the records wrap around
+            ThreadBufferedLogger logger(appender, 256);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            for(uint32_t i = 0; i < 500; ++i)
+            {
+                LOG_INFO_EXT(logger, context, "message " << i);
+                StringOutputStream text;
+                text << "message " << i;
+                expected.push_back(text.c_str());
+            }
+        }
+        EXPECT_TRUE(expected == appender.getTexts());
+    }
+
+    TEST(ThreadBufferedLogger, TruncatesMessagesLargerThanTheBuffer)
+    {
+        RecordingLogAppender appender;
+        {
+            ThreadBufferedLogger logger(appender, 64);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            LOG_INFO_EXT(logger, context, "0123456789012345678901234567890123456789012345678901234567890123456789");
+        }
+        const vector<String> texts = appender.getTexts();
+        ASSERT_EQ(1u, texts.size());
+        EXPECT_GT(64u, texts[0].getLength());
+        EXPECT_TRUE(texts[0].startsWith("0123456789"));
+    }
+
+    TEST(ThreadBufferedLogger, MergesThreadsByTimestampAndOutputsBatches)
+    {
+        RecordingLogAppender appender(true);
+        ThreadBufferedLogger logger(appender);
+        LogContext& context = logger.createContext("capu.Test");
+        context.setLogLevel(LL_ALL);
+
+        LOG_INFO_EXT(logger, context, "0");
+        appender.entered.await();
+
+        // both threads log alternately while the sink is blocked
+        ThreadPool first(1);
+        ThreadPool second(1);
+        const char* texts[4] = { "a1", "b1", "a2", "b2" };
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            const char* text = texts[i];
+            ThreadPool& pool = (i % 2 == 0) ? first : second;
+            EXPECT_EQ(CAPU_OK, pool.submit([&logger, &context, text]()
+            {
+                LOG_INFO_EXT(logger, context, text);
+            }).wait());
+            Thread::Sleep(1);
+        }
+
+        appender.released.countDown();
+        appender.waitForTexts(5);
+        EXPECT_TRUE(ToTexts({ "0", "a1", "b1", "a2", "b2" }) == appender.getTexts());
+        EXPECT_EQ(2u, appender.batchCount.load());
+    }
+
+    TEST(ThreadBufferedLogger, StatementLoggedWhileFormattingUsesMessageOfItsOwn)
+    {
+        RecordingLogAppender appender;
+        {
+            ThreadBufferedLogger logger(appender);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            LOG_INFO_EXT(logger, context, "outer " << LogInner(logger, context));
+        }
+        EXPECT_TRUE(ToTexts({ "inner", "outer x" }) == appender.getTexts());
+    }
+
+    TEST(ThreadBufferedLogger, SinkFormatsDeferredStatements)
+    {
+        RecordingLogAppender appender;
+        {
+            ThreadBufferedLogger logger(appender, 256);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_INFO);
+            for(uint32_t i = 0; i < 100; ++i)
+            {
+                LOG_INFO_DEFERRED_EXT(logger, context, "deferred {} of {}", i, "statements");
+                LOG_DEBUG_DEFERRED_EXT(logger, context, "filtered {}", i);
+            }
+            LOG_INFO_EXT(logger, context, "text");
+            LOG_INFO_DEFERRED_EXT(logger, context, "no arguments");
+        }
+        const vector<String> texts = appender.getTexts();
+        ASSERT_EQ(102u, texts.size());
+        EXPECT_STREQ("deferred 0 of statements", texts[0].c_str());
+        EXPECT_STREQ("deferred 99 of statements", texts[99].c_str());
+        EXPECT_STREQ("text", texts[100].c_str());
+        EXPECT_STREQ("no arguments", texts[101].c_str());
+    }
+
+    TEST(ThreadBufferedLogger, ManyThreadsLogEveryMessageOnceInThreadOrder)
+    {
+        const uint32_t threadCount = 8;
+        const uint32_t messagesPerThread = 2000;
+        RecordingLogAppender appender;
+        {
+            ThreadBufferedLogger logger(appender, 1024);
+            LogContext& context = logger.createContext("capu.Test");
+            context.setLogLevel(LL_ALL);
+            ThreadPool pool(threadCount);
+            for(uint32_t t = 0; t < threadCount; ++t)
+            {
+                pool.submit([&logger, &context, t, messagesPerThread]()
+                {
+                    for(uint32_t i = 0; i < messagesPerThread; ++i)
+                    {
+                        LOG_INFO_EXT(logger, context, t * messagesPerThread + i);
+                    }
+                });
+            }
+            pool.close();
+        }
+
+        const vector<String> texts = appender.getTexts();
+        ASSERT_EQ(threadCount * messagesPerThread, texts.size());
+        vector<uint32_t> nextOfThread(threadCount, 0);
+        for(uint32_t i = 0; i < texts.size(); ++i)
+        {
+            const uint32_t value = static_cast<uint32_t>(strtoul(texts[i].c_str(), 0, 10));
+            const uint32_t thread = value / messagesPerThread;
+            EXPECT_EQ(nextOfThread[thread], value % messagesPerThread);
+            nextOfThread[thread] = value % messagesPerThread + 1;
+        }
+    }
+
+    namespace
+    {
+        class CountingLogAppender : public LogAppenderBase
+        {
+        public:
+            CountingLogAppender()
+                : count(0)
+            {
+            }
+
+            virtual void logMessage(const LogMessage&) override
+            {
+                ++count;
+            }
+
+            Atomic<uint32_t> count;
+        };
+
+        /**
+         * Logs from several threads and returns the elapsed microseconds until all messages are output
+         */
+        uint64_t MeasureLogCalls(Logger& logger, LogContext& context, uint32_t threadCount, uint32_t messagesPerThread)
+        {
+            const uint64_t start = Time::GetMicroseconds();
+            ThreadPool pool(threadCount);
+            for(uint32_t t = 0; t < threadCount; ++t)
+            {
+                pool.submit([&logger, &context, messagesPerThread]()
+                {
+                    for(uint32_t i = 0; i < messagesPerThread; ++i)
+                    {
+                        LOG_INFO_EXT(logger, context, "message " << i << " of " << messagesPerThread);
+                    }
+                });
+            }
+            pool.close();
+            return Time::GetMicroseconds() - start;
+        }
+    }
+
+    namespace
+    {
+        /**
+         * Counts messages, holds the sink in logMessage() while it is closed
+         */
+        class GatedLogAppender : public LogAppenderBase
+        {
+        public:
+            GatedLogAppender()
+                : count(0)
+                , closed(false)
+                , holding(false)
+            {
+            }
+
+            virtual void logMessage(const LogMessage&) override
+            {
+                ++count;
+                ScopedMutexLock lock(mutex);
+                if(closed)
+                {
+                    holding = true;
+                    changed.broadcast();
+                    while(closed)
+                    {
+                        changed.wait(mutex);
+                    }
+                    holding = false;
+                }
+            }
+
+            void close()
+            {
+                ScopedMutexLock lock(mutex);
+                closed = true;
+            }
+
+            void awaitHolding()
+            {
+                ScopedMutexLock lock(mutex);
+                while(!holding)
+                {
+                    changed.wait(mutex);
+                }
+            }
+
+            void open()
+            {
+                ScopedMutexLock lock(mutex);
+                closed = false;
+                changed.broadcast();
+            }
+
+            void waitForCount(uint32_t expected)
+            {
+                while(count.load() < expected)
+                {
+                    Thread::Sleep(1);
+                }
+            }
+
+            Atomic<uint32_t> count;
+
+        private:
+            Mutex mutex;
+            CondVar changed;
+            bool closed;
+            bool holding;
+        };
+
+        /**
+         * Returns the nanoseconds of messageCount log calls while the sink is held in the appender,
+         * so it does not share the core with the calls. Earlier rounds touch all pages of the buffer.
+         */
+        template<typename LogCall>
+        uint64_t MeasureHeldLogCalls(Logger& logger, LogContext& context, GatedLogAppender& appender, uint32_t messageCount, LogCall logCall)
+        {
+            const uint32_t rounds = 3;
+            uint64_t nanos = 0;
+            for(uint32_t round = 0; round < rounds; ++round)
+            {
+                appender.close();
+                LOG_INFO_EXT(logger, context, "hold");
+                appender.awaitHolding();
+                const uint64_t start = Time::GetMonotonicNanoseconds();
+                for(uint32_t i = 0; i < messageCount; ++i)
+                {
+                    logCall(i);
+                }
+                nanos = Time::GetMonotonicNanoseconds() - start;
+                appender.open();
+                appender.waitForCount((round + 1) * (messageCount + 1));
+            }
+            return nanos;
+        }
+    }
+
+    TEST(ThreadBufferedLoggerPerformanceTest, DISABLED_DeferredLogCalls)
+    {
+        const uint32_t messageCount = 100000;
+        const uint32_t bufferSize = 8 * 1024 * 1024;
+        const char* name = "frame";
+
+        GatedLogAppender formattedAppender;
+        ThreadBufferedLogger formatted(formattedAppender, bufferSize);
+        LogContext& formattedContext = formatted.createContext("capu.Performance");
+        formattedContext.setLogLevel(LL_ALL);
+        const uint64_t formattedNanos = MeasureHeldLogCalls(formatted, formattedContext, formattedAppender, messageCount, [&](uint32_t i)
+        {
+            LOG_INFO_EXT(formatted, formattedContext, name << " " << i << " took " << 0.001f * i << " ms, " << static_cast<int64_t>(i) * -4096 << " bytes");
+        });
+
+        GatedLogAppender deferredAppender;
+        ThreadBufferedLogger deferred(deferredAppender, bufferSize);
+        LogContext& deferredContext = deferred.createContext("capu.Performance");
+        deferredContext.setLogLevel(LL_ALL);
+        const uint64_t deferredNanos = MeasureHeldLogCalls(deferred, deferredContext, deferredAppender, messageCount, [&](uint32_t i)
+        {
+            LOG_INFO_DEFERRED_EXT(deferred, deferredContext, "{} {} took {} ms, {} bytes", name, i, 0.001f * i, static_cast<int64_t>(i) * -4096);
+        });
+
+        printf("ns per log call with 4 arguments: LOG_INFO_EXT %.1f, LOG_INFO_DEFERRED_EXT %.1f\n",
+            static_cast<double>(formattedNanos) / messageCount, static_cast<double>(deferredNanos) / messageCount);
+    }
+
+    TEST(ThreadBufferedLoggerPerformanceTest, DISABLED_LogCallsFromEightThreads)
+    {
+        const uint32_t threadCount = 8;
+        const uint32_t messagesPerThread = 200000;
+        const double messageCount = threadCount * messagesPerThread;
+
+        CountingLogAppender synchronousAppender;
+        Logger synchronous(synchronousAppender);
+        LogContext& synchronousContext = synchronous.createContext("capu.Performance");
+        synchronousContext.setLogLevel(LL_ALL);
+        const uint64_t synchronousMicros = MeasureLogCalls(synchronous, synchronousContext, threadCount, messagesPerThread);
+
+        CountingLogAppender asynchronousAppender;
+        AsynchronousLogger* asynchronous = new AsynchronousLogger(asynchronousAppender);
+        LogContext& asynchronousContext = asynchronous->createContext("capu.Performance");
+        asynchronousContext.setLogLevel(LL_ALL);
+        const uint64_t asynchronousMicros = MeasureLogCalls(*asynchronous, asynchronousContext, threadCount, messagesPerThread);
+        delete asynchronous;
+
+        CountingLogAppender threadBufferedAppender;
+        ThreadBufferedLogger* threadBuffered = new ThreadBufferedLogger(threadBufferedAppender);
+        LogContext& threadBufferedContext = threadBuffered->createContext("capu.Performance");
+        threadBufferedContext.setLogLevel(LL_ALL);
+        const uint64_t threadBufferedMicros = MeasureLogCalls(*threadBuffered, threadBufferedContext, threadCount, messagesPerThread);
+        delete threadBuffered;
+
+        printf("log calls/s from %u threads: Logger %.2f M, AsynchronousLogger %.2f M, ThreadBufferedLogger %.2f M\n", threadCount,
+            messageCount / synchronousMicros, messageCount / asynchronousMicros, messageCount / threadBufferedMicros);
+    }
+}
@@ -20,6 +20,8 @@
 #include "capu/os/Mutex.h"
 #include "capu/os/Semaphore.h"
 #include "capu/os/Atomic.h"
+#include "capu/os/Time.h"
+#include "capu/util/CountDownLatch.h"
 
 namespace {
     static capu::Atomic<capu::uint_t> GlobalVar(0);
@@ -164,3 +166,175 @@ TEST(ThreadPool, CloseTest)
 
     EXPECT_TRUE(pool.isClosed());
 }
+
+TEST(ThreadPool, DefaultModeIsSharedQueue)
+{
+    capu::ThreadPool pool(2);
+    EXPECT_EQ(capu::ThreadPool::SHARED_QUEUE, pool.getMode());
+
+    capu::ThreadPool stealingPool(2, capu::ThreadPool::WORK_STEALING);
+    EXPECT_EQ(capu::ThreadPool::WORK_STEALING, stealingPool.getMode());
+}
+
+TEST(ThreadPool, WorkStealingAddCloseTest)
+{
+    GlobalVar = 0;
+    capu::ThreadPool pool(8, capu::ThreadPool::WORK_STEALING);
+    for (int32_t i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(capu::CAPU_OK, pool.add(capu::shared_ptr<capu::Runnable>(new WorkToDo())));
+    }
+    EXPECT_EQ(capu::CAPU_OK, pool.close());
+    EXPECT_EQ(500u, GlobalVar.load());
+    EXPECT_TRUE(pool.isClosed());
+    EXPECT_EQ(capu::CAPU_ERROR, pool.add(capu::shared_ptr<capu::Runnable>(new WorkToDo())));
+}
+
+TEST(ThreadPool, WorkStealingAddCloseCancelTest)
+{
+    GlobalVar = 0;
+    capu::Semaphore waiter;
+    const uint32_t poolSize = 5;
+    capu::ThreadPool pool(poolSize, capu::ThreadPool::WORK_STEALING);
+
+    for (int32_t i = 0; i < 1000; i++)
+    {
+        EXPECT_EQ(capu::CAPU_OK, pool.add(capu::shared_ptr<capu::Runnable>(new WorkToDoCancelable(waiter))));
+    }
+    for (uint32_t i = 0; i < poolSize; i++)
+    {
+        waiter.aquire();
+    }
+
+    EXPECT_EQ(capu::CAPU_OK, pool.close(true));
+    EXPECT_EQ(25u, GlobalVar.load());
+    EXPECT_TRUE(pool.isClosed());
+}
+
+namespace
+{
+    /**
+     * Splits itself up into two runnables until the depth is reached, then counts down the latch
+     */
+    class SplittingWork : public capu::Runnable
+    {
+    public:
+        SplittingWork(capu::ThreadPool& pool, capu::Atomic<capu::uint_t>& remaining, capu::CountDownLatch& done, uint32_t depth)
+            : m_pool(pool)
+            , m_remaining(remaining)
+            , m_done(done)
+            , m_depth(depth)
+        {
+        }
+
+        void run() override
+        {
+            if (m_depth > 0)
+            {
+                m_pool.add(capu::shared_ptr<capu::Runnable>(new SplittingWork(m_pool, m_remaining, m_done, m_depth - 1)));
+                m_pool.add(capu::shared_ptr<capu::Runnable>(new SplittingWork(m_pool, m_remaining, m_done, m_depth - 1)));
+            }
+            else if (--m_remaining == 0)
+            {
+                m_done.countDown();
+            }
+        }
+
+    private:
+        capu::ThreadPool& m_pool;
+        capu::Atomic<capu::uint_t>& m_remaining;
+        capu::CountDownLatch& m_done;
+        uint32_t m_depth;
+    };
+
+    /**
+     * Tiny runnable which counts down the latch when it ran as often as expected
+     */
+    class TinyWork : public capu::Runnable
+    {
+    public:
+        TinyWork(capu::Atomic<capu::uint_t>& remaining, capu::CountDownLatch& done)
+            : m_remaining(remaining)
+            , m_done(done)
+        {
+        }
+
+        void run() override
+        {
+            if (--m_remaining == 0)
+            {
+                m_done.countDown();
+            }
+        }
+
+    private:
+        capu::Atomic<capu::uint_t>& m_remaining;
+        capu::CountDownLatch& m_done;
+    };
+
+    uint64_t MeasureSplitting(capu::ThreadPool::Mode mode, uint32_t threadCount, uint32_t depth)
+    {
+        capu::ThreadPool pool(threadCount, mode);
+        capu::Atomic<capu::uint_t> remaining(static_cast<capu::uint_t>(1) << depth);
+        capu::CountDownLatch done(1);
+        const uint64_t start = capu::Time::GetMicroseconds();
+        pool.add(capu::shared_ptr<capu::Runnable>(new SplittingWork(pool, remaining, done, depth)));
+        done.await();
+        return capu::Time::GetMicroseconds() - start;
+    }
+
+    uint64_t MeasureFanOut(capu::ThreadPool::Mode mode, uint32_t threadCount, capu::uint_t taskCount)
+    {
+        capu::ThreadPool pool(threadCount, mode);
+        capu::Atomic<capu::uint_t> remaining(taskCount);
+        capu::CountDownLatch done(1);
+        const capu::shared_ptr<capu::Runnable> work(new TinyWork(remaining, done));
+        const uint64_t start = capu::Time::GetMicroseconds();
+        for (capu::uint_t i = 0; i < taskCount; i++)
+        {
+            pool.add(work);
+        }
+        done.await();
+        return capu::Time::GetMicroseconds() - start;
+    }
+}
+
+TEST(ThreadPool, WorkStealingRunsWorkAddedFromPoolThreads)
+{
+    capu::ThreadPool pool(4, capu::ThreadPool::WORK_STEALING);
+    capu::Atomic<capu::uint_t> remaining(1024);
+    capu::CountDownLatch done(1);
+    EXPECT_EQ(capu::CAPU_OK, pool.add(capu::shared_ptr<capu::Runnable>(new SplittingWork(pool, remaining, done, 10))));
+    EXPECT_EQ(capu::CAPU_OK, done.await(60000));
+    EXPECT_EQ(0u, remaining.load());
+}
+
+TEST(ThreadPool, WorkStealingRunsMoreWorkThanDequesHold)
+{
+    // a single thread fills its deque and continues in the shared queue
+    capu::ThreadPool pool(1, capu::ThreadPool::WORK_STEALING);
+    capu::Atomic<capu::uint_t> remaining(1u << 12);
+    capu::CountDownLatch done(1);
+    EXPECT_EQ(capu::CAPU_OK, pool.add(capu::shared_ptr<capu::Runnable>(new SplittingWork(pool, remaining, done, 12))));
+    EXPECT_EQ(capu::CAPU_OK, done.await(60000));
+    EXPECT_EQ(0u, remaining.load());
+}
+
+TEST(ThreadPoolPerformanceTest, DISABLED_FanOutFanIn)
+{
+    // 2^20 tiny runnables
+    const uint32_t depth = 20;
+    const capu::uint_t taskCount = static_cast<capu::uint_t>(1) << depth;
+    for (uint32_t threadCount = 1; threadCount <= capu::ThreadPool::MAX_THREAD_POOL_THREADS; threadCount *= 4)
+    {
+        const uint64_t sharedSplit = MeasureSplitting(capu::ThreadPool::SHARED_QUEUE, threadCount, depth);
+        const uint64_t stealingSplit = MeasureSplitting(capu::ThreadPool::WORK_STEALING, threadCount, depth);
+        const uint64_t sharedFanOut = MeasureFanOut(capu::ThreadPool::SHARED_QUEUE, threadCount, taskCount);
+        const uint64_t stealingFanOut = MeasureFanOut(capu::ThreadPool::WORK_STEALING, threadCount, taskCount);
+        printf("%2u threads, %u tasks: split in pool: shared queue %8u us, work stealing %8u us; "
+            "added from outside: shared queue %8u us, work stealing %8u us\n",
+            threadCount, static_cast<uint32_t>(taskCount),
+            static_cast<uint32_t>(sharedSplit), static_cast<uint32_t>(stealingSplit),
+            static_cast<uint32_t>(sharedFanOut), static_cast<uint32_t>(stealingFanOut));
+    }
+}
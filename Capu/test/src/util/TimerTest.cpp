@@ -19,6 +19,11 @@
 #include "capu/util/Timer.h"
 #include "capu/os/Thread.h"
 #include "capu/util/ScopedLock.h"
+#include "capu/util/ThreadPool.h"
+#include "capu/util/CountDownLatch.h"
+#include "capu/container/vector.h"
+#include "capu/os/Atomic.h"
+#include "capu/os/Time.h"
 
 
 /**
@@ -334,3 +339,369 @@ TEST(TimerTest, QuickExecutions)
         capu::Thread::Sleep(1);
     }
 }
+
+namespace
+{
+    /**
+     * Appends its id to a shared list when its timer fires
+     */
+    class FiringRecorder
+    {
+    public:
+        FiringRecorder()
+            : m_id(0)
+            , m_firings(NULL)
+            , m_firingsMutex(NULL)
+        {
+        }
+
+        void fire()
+        {
+            capu::ScopedLock<capu::Mutex> mutexGuard(*m_firingsMutex);
+            m_firings->push_back(m_id);
+        }
+
+        int m_id;
+        capu::vector<int>* m_firings;
+        capu::Mutex* m_firingsMutex;
+    };
+
+    /**
+     * Delegate target which blocks until it is released and counts its calls
+     */
+    class BlockingCallback
+    {
+    public:
+        BlockingCallback()
+            : m_entered(1)
+            , m_released(1)
+            , m_calls(0)
+            , m_threadId(0)
+            , m_timer(NULL)
+        {
+        }
+
+        void block()
+        {
+            ++m_calls;
+            m_entered.countDown();
+            m_released.await(1000);
+        }
+
+        void count()
+        {
+            ++m_calls;
+            m_threadId = capu::Thread::CurrentThreadId();
+        }
+
+        void countAndDeleteTimer()
+        {
+            ++m_calls;
+            delete m_timer;
+            m_timer = NULL;
+        }
+
+        capu::CountDownLatch m_entered;
+        capu::CountDownLatch m_released;
+        capu::Atomic<uint32_t> m_calls;
+        capu::Atomic<capu::uint_t> m_threadId;
+        capu::Timer* m_timer;
+    };
+
+    void WaitForCalls(const BlockingCallback& callback, uint32_t calls)
+    {
+        const uint64_t waitUntil = capu::Time::GetMilliseconds() + 1000;
+        while (callback.m_calls.load() < calls && capu::Time::GetMilliseconds() < waitUntil)
+        {
+            capu::Thread::Sleep(1);
+        }
+    }
+}
+
+TEST(TimerTest, ManyTimersFireInOrderOfTheirTimeouts)
+{
+    const int timerCount = 40;
+    capu::shared_ptr<capu::TimerManager> manager = capu::TimerManager::GetNewTimerManager();
+    capu::vector<int> firings;
+    capu::Mutex firingsMutex;
+    FiringRecorder recorders[timerCount];
+    capu::vector<capu::Timer*> timers;
+    for (int i = 0; i < timerCount; ++i)
+    {
+        recorders[i].m_id = i;
+        recorders[i].m_firings = &firings;
+        recorders[i].m_firingsMutex = &firingsMutex;
+        // start in scrambled order, fire in order of the timeouts
+        const int id = (i * 7) % timerCount;
+        timers.push_back(new capu::Timer(manager, capu::Delegate<>::Create<FiringRecorder, &FiringRecorder::fire>(recorders[id]), 30 + id * 3, 1));
+    }
+    for (int i = 0; i < timerCount; ++i)
+    {
+        timers[i]->start();
+    }
+    // stop every third timer, which removes executions from the middle of the queue
+    for (int i = 0; i < timerCount; i += 3)
+    {
+        timers[i]->stop();
+    }
+
+    capu::vector<int> expected;
+    for (int id = 0; id < timerCount; ++id)
+    {
+        bool stopped = false;
+        for (int i = 0; i < timerCount; i += 3)
+        {
+            stopped = stopped || (i * 7) % timerCount == id;
+        }
+        if (!stopped)
+        {
+            expected.push_back(id);
+        }
+    }
+
+    const uint64_t waitUntil = capu::Time::GetMilliseconds() + 2000;
+    for (;;)
+    {
+        {
+            capu::ScopedLock<capu::Mutex> mutexGuard(firingsMutex);
+            if (firings.size() >= expected.size() || capu::Time::GetMilliseconds() > waitUntil)
+            {
+                break;
+            }
+        }
+        capu::Thread::Sleep(5);
+    }
+    for (int i = 0; i < timerCount; ++i)
+    {
+        delete timers[i];
+    }
+
+    EXPECT_TRUE(expected == firings);
+}
+
+TEST(TimerTest, DelegateRunsWithoutManagerLock)
+{
+    capu::shared_ptr<capu::TimerManager> manager = capu::TimerManager::GetNewTimerManager();
+    BlockingCallback blocking;
+    BlockingCallback counting;
+    capu::Timer blockingTimer(manager, capu::Delegate<>::Create<BlockingCallback, &BlockingCallback::block>(blocking), 1, 1);
+    capu::Timer otherTimer(manager, capu::Delegate<>::Create<BlockingCallback, &BlockingCallback::count>(counting), 1000, 1);
+
+    blockingTimer.start();
+    ASSERT_EQ(capu::CAPU_OK, blocking.m_entered.await(1000));
+    // the delegate is running, the manager accepts other timers meanwhile
+    const uint64_t start = capu::Time::GetMilliseconds();
+    otherTimer.start();
+    EXPECT_EQ(1u, otherTimer.executionsRemaining());
+    EXPECT_LT(capu::Time::GetMilliseconds() - start, 500u);
+    otherTimer.stop();
+    blocking.m_released.countDown();
+}
+
+TEST(TimerTest, ExecutesOnThreadPool)
+{
+    capu::ThreadPool pool(2);
+    BlockingCallback callback;
+    {
+        capu::Timer timer(capu::TimerManager::GetNewTimerManager("", &pool), capu::Delegate<>::Create<BlockingCallback, &BlockingCallback::count>(callback), 1, 5);
+        timer.start();
+        WaitForCalls(callback, 5);
+    }
+    EXPECT_EQ(5u, callback.m_calls.load());
+    EXPECT_NE(capu::Thread::CurrentThreadId(), callback.m_threadId.load());
+}
+
+TEST(TimerTest, StopWithdrawsExecutionQueuedOnThreadPool)
+{
+    capu::ThreadPool pool(1);
+    capu::CountDownLatch poolBlocked(1);
+    capu::CountDownLatch releasePool(1);
+    capu::Future<void> blocker = pool.submit([&]() { poolBlocked.countDown(); releasePool.await(1000); });
+    ASSERT_EQ(capu::CAPU_OK, poolBlocked.await(1000));
+
+    BlockingCallback callback;
+    capu::Timer timer(capu::TimerManager::GetNewTimerManager("", &pool), capu::Delegate<>::Create<BlockingCallback, &BlockingCallback::count>(callback), 1, 3);
+    timer.start();
+    // the first execution waits behind the blocking runnable, the others are skipped meanwhile
+    while (timer.executionsRemaining() == 3)
+    {
+        capu::Thread::Sleep(1);
+    }
+    timer.stop();
+    EXPECT_EQ(3u, timer.executionsRemaining());
+
+    releasePool.countDown();
+    EXPECT_EQ(capu::CAPU_OK, blocker.wait());
+    pool.close();
+    EXPECT_EQ(0u, callback.m_calls.load());
+}
+
+TEST(TimerTest, DelegateDeletesItsTimerOnThreadPool)
+{
+    capu::ThreadPool pool(2);
+    BlockingCallback callback;
+    callback.m_timer = new capu::Timer(capu::TimerManager::GetNewTimerManager("", &pool),
+        capu::Delegate<>::Create<BlockingCallback, &BlockingCallback::countAndDeleteTimer>(callback), 1, 0);
+    callback.m_timer->start();
+    WaitForCalls(callback, 1);
+    pool.close();
+    EXPECT_EQ(1u, callback.m_calls.load());
+    EXPECT_TRUE(callback.m_timer == NULL);
+}
+
+namespace
+{
+    /**
+     * Records the monotonic time of every call, the first call takes longer
+     */
+    class CallTimeRecorder
+    {
+    public:
+        CallTimeRecorder(uint32_t firstCallMillis)
+            : m_firstCallMillis(firstCallMillis)
+        {
+        }
+
+        void record()
+        {
+            bool firstCall = false;
+            {
+                capu::ScopedLock<capu::Mutex> mutexGuard(m_mutex);
+                m_callTimes.push_back(capu::Time::GetMonotonicNanoseconds());
+                firstCall = m_callTimes.size() == 1;
+            }
+            if (firstCall)
+            {
+                capu::Thread::Sleep(m_firstCallMillis);
+            }
+        }
+
+        capu::vector<uint64_t> getCallTimes() const
+        {
+            capu::ScopedLock<capu::Mutex> mutexGuard(m_mutex);
+            return m_callTimes;
+        }
+
+    private:
+        const uint32_t m_firstCallMillis;
+        mutable capu::Mutex m_mutex;
+        capu::vector<uint64_t> m_callTimes;
+    };
+
+    void WaitForTimer(const capu::Timer& timer)
+    {
+        const uint64_t waitUntil = capu::Time::GetMilliseconds() + 2000;
+        while (!timer.maxExecutionsReached() && capu::Time::GetMilliseconds() < waitUntil)
+        {
+            capu::Thread::Sleep(1);
+        }
+    }
+}
+
+TEST(TimerTest, FixedRateKeepsDueTimesAfterDelay)
+{
+    const uint64_t period = 10 * 1000000;
+    CallTimeRecorder recorder(45);
+    capu::Timer timer(capu::TimerManager::GetNewTimerManager(), capu::Delegate<>::Create<CallTimeRecorder, &CallTimeRecorder::record>(recorder),
+        10, 5, capu::Timer::FIXED_RATE);
+    const uint64_t start = capu::Time::GetMonotonicNanoseconds();
+    timer.start();
+    WaitForTimer(timer);
+    // wait for the last call to finish
+    capu::Thread::Sleep(5);
+
+    const capu::vector<uint64_t> callTimes = recorder.getCallTimes();
+    ASSERT_EQ(5u, callTimes.size());
+    for (uint32_t i = 0; i < callTimes.size(); ++i)
+    {
+        EXPECT_GE(callTimes[i], start + (i + 1) * period);
+    }
+    // the executions missed during the long first call are caught up, not shifted
+    const capu::Timer::Statistics statistics = timer.getStatistics();
+    EXPECT_EQ(5u, statistics.executions);
+    EXPECT_GE(statistics.maxLatenessMicros, 25000u);
+    EXPECT_GE(statistics.totalLatenessMicros, statistics.maxLatenessMicros);
+}
+
+TEST(TimerTest, FixedDelayShiftsDueTimesAfterDelay)
+{
+    const uint64_t period = 10 * 1000000;
+    CallTimeRecorder recorder(45);
+    capu::Timer timer(capu::TimerManager::GetNewTimerManager(), capu::Delegate<>::Create<CallTimeRecorder, &CallTimeRecorder::record>(recorder),
+        10, 3, capu::Timer::FIXED_DELAY);
+    timer.start();
+    WaitForTimer(timer);
+    capu::Thread::Sleep(5);
+
+    const capu::vector<uint64_t> callTimes = recorder.getCallTimes();
+    ASSERT_EQ(3u, callTimes.size());
+    // the second execution was due one period after the first one was dispatched
+    EXPECT_GE(callTimes[1] - callTimes[0], period);
+    EXPECT_GE(callTimes[2] - callTimes[1], period);
+    EXPECT_EQ(3u, timer.getStatistics().executions);
+}
+
+TEST(TimerTest, StatisticsCountSkippedExecutions)
+{
+    capu::ThreadPool pool(1);
+    CallTimeRecorder recorder(50);
+    capu::Timer timer(capu::TimerManager::GetNewTimerManager("", &pool), capu::Delegate<>::Create<CallTimeRecorder, &CallTimeRecorder::record>(recorder),
+        5, 0, capu::Timer::FIXED_RATE);
+    EXPECT_EQ(0u, timer.getStatistics().executions);
+    timer.start();
+    capu::Thread::Sleep(40);
+    timer.stop();
+
+    // the executions which became due during the long first call were skipped
+    const capu::Timer::Statistics statistics = timer.getStatistics();
+    EXPECT_EQ(1u, statistics.executions);
+    EXPECT_GE(statistics.skippedExecutions, 1u);
+    EXPECT_EQ(statistics.lastLatenessMicros, statistics.totalLatenessMicros);
+}
+
+TEST(TimerPerformanceTest, DISABLED_ManyActiveTimers)
+{
+    const uint32_t timerCount = 100000;
+    capu::shared_ptr<capu::TimerManager> manager = capu::TimerManager::GetNewTimerManager();
+    BlockingCallback callback;
+    capu::vector<capu::Timer*> timers;
+    timers.reserve(timerCount);
+    for (uint32_t i = 0; i < timerCount; ++i)
+    {
+        // keep-alive timers, some fire during the test
+        timers.push_back(new capu::Timer(manager, capu::Delegate<>::Create<BlockingCallback, &BlockingCallback::count>(callback), 50 + (i * 7919) % 3600000, 0));
+    }
+
+    uint64_t start = capu::Time::GetMicroseconds();
+    for (uint32_t i = 0; i < timerCount; ++i)
+    {
+        timers[i]->start();
+    }
+    const uint64_t startTime = capu::Time::GetMicroseconds() - start;
+
+    start = capu::Time::GetMicroseconds();
+    for (uint32_t round = 0; round < 10; ++round)
+    {
+        for (uint32_t i = round; i < timerCount; i += 10)
+        {
+            timers[i]->restart();
+        }
+    }
+    const uint64_t restartTime = capu::Time::GetMicroseconds() - start;
+
+    start = capu::Time::GetMicroseconds();
+    for (uint32_t i = 0; i < timerCount; ++i)
+    {
+        timers[timerCount - 1 - i]->stop();
+    }
+    const uint64_t stopTime = capu::Time::GetMicroseconds() - start;
+
+    for (uint32_t i = 0; i < timerCount; ++i)
+    {
+        delete timers[i];
+    }
+
+    printf("%u timers: start %.3f us, restart %.3f us, stop %.3f us per timer, %u executions\n", timerCount,
+        static_cast<double>(startTime) / timerCount, static_cast<double>(restartTime) / timerCount,
+        static_cast<double>(stopTime) / timerCount, callback.m_calls.load());
+}